@@ -0,0 +1,161 @@
+// btdf_gemv_bench.cpp
+//
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+
+//	Micro-benchmark of the sky x BTDF integration kernels on an M x N btdf (default 1000 x 1000).
+//	Build against the DElight sources, e.g.
+//		g++ -O2 -DHAS_ISNAN -I../SourceCode btdf_gemv_bench.cpp ../SourceCode/*.cpp ../SourceCode/*.CPP -lpthread
+//	(add -DBTDF_MATRIX_FLOAT to all files for the float matrix), then run
+//		btdf_gemv_bench [M [N [nrep]]]
+//	Each kernel is timed over nrep calls and checked against the row-by-row reference.
+
+#pragma warning(disable:4786)
+
+#include <stdlib.h>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+using namespace std;
+
+// BGLincludes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+
+static unsigned int	uSeed = 12345;
+
+//	deterministic uniform [0,1) values, so every run benchmarks the same data
+static Double	BenchRand()
+{
+	uSeed = uSeed*1103515245 + 12345;
+	return ((uSeed >> 8) & 0xffffff)/(Double)0x1000000;
+}
+
+static Double	BenchSeconds()
+{
+	return chrono::duration<Double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//	the pre-matrix integration: one temporary output map per incident dir, filled element by element
+static void	RowLoopGemv(btdf* pbtdf0, int nterm, const int* irow, const Double* s, int ncols, HemiSphiral& LumMap)
+{
+	HemiSphiral	lm((int)LumMap.size());
+	for (int kk=0; kk<nterm; kk++) {
+		for (int jj=0; jj<ncols; jj++) lm[jj] = pbtdf0->qexact(irow[kk],jj)*s[kk];
+		LumMap += lm;
+	}
+}
+
+static void	BenchReport(string sName, Double dSeconds, int nrep, int M, int N, vector<Double>& y, vector<Double>& yref)
+{
+	Double	dSec = dSeconds/nrep;
+	Double	dDiff = 0;
+	for (int jj=0; jj<(int)y.size(); jj++) dDiff = max(dDiff,fabs(y[jj] - yref[jj]));
+	cout << left << setw(14) << sName << right
+		<< setw(12) << setprecision(4) << dSec*1000 << " ms"
+		<< setw(10) << setprecision(3) << 2.*M*N/dSec*1.e-9 << " GFLOP/s"
+		<< setw(10) << setprecision(3) << (Double)M*N*sizeof(BTDFReal)/dSec*1.e-9 << " GB/s"
+		<< "   max |diff| " << setprecision(3) << dDiff << "\n";
+}
+
+int	main(int argc, char** argv)
+{
+	int	M = (argc > 1) ? atoi(argv[1]) : 1000;
+	int	N = (argc > 2) ? atoi(argv[2]) : 1000;
+	int	nrep = (argc > 3) ? atoi(argv[3]) : 20;
+	int	ii, jj, irep;
+	Double	t0;
+
+	if ((M <= 0) || (N <= 0) || (nrep <= 0)) {
+		cerr << "usage: btdf_gemv_bench [M [N [nrep]]]\n";
+		return 1;
+	}
+
+	//	random btdf rows and sky flux over every incident dir
+	btdfHS	btdf0(M,N);
+	btdf0.btdftype = "HS";
+	for (ii=0; ii<M; ii++) {
+		for (jj=0; jj<N; jj++) btdf0.HSoutList[ii][jj] = BenchRand();
+	}
+	btdf0.packMatrix();
+	vector<int>		irow(M);
+	vector<Double>	s(M);
+	for (ii=0; ii<M; ii++) {
+		irow[ii] = ii;
+		s[ii] = BenchRand();
+	}
+
+	cout << "BTDF " << M << " x " << N << ", " << sizeof(BTDFReal)*8 << " bit matrix, " << nrep << " reps\n";
+
+	HemiSphiral	LumRef(N);
+	t0 = BenchSeconds();
+	for (irep=0; irep<nrep; irep++) {
+		LumRef = HemiSphiral(N);
+		RowLoopGemv(&btdf0,M,&irow[0],&s[0],N,LumRef);
+	}
+	BenchReport("rowloop",BenchSeconds() - t0,nrep,M,N,LumRef.valList,LumRef.valList);
+
+	vector<Double>	y(N);
+	t0 = BenchSeconds();
+	for (irep=0; irep<nrep; irep++) {
+		y.assign(N,0);
+		BTDFGemvScalar(btdf0.Qmat,M,&irow[0],&s[0],N,&y[0]);
+	}
+	BenchReport("gemv scalar",BenchSeconds() - t0,nrep,M,N,y,LumRef.valList);
+
+	y.assign(N,0);
+	if (BTDFGemvAVX2(btdf0.Qmat,M,&irow[0],&s[0],N,&y[0])) {
+		t0 = BenchSeconds();
+		for (irep=0; irep<nrep; irep++) {
+			y.assign(N,0);
+			BTDFGemvAVX2(btdf0.Qmat,M,&irow[0],&s[0],N,&y[0]);
+		}
+		BenchReport("gemv avx2",BenchSeconds() - t0,nrep,M,N,y,LumRef.valList);
+	}
+	else cout << "gemv avx2     not available\n";
+
+	//	whole integration including the sky interpolation per incident dir
+	HemiSphiral	sky0(N);
+	for (jj=0; jj<N; jj++) sky0[jj] = BenchRand();
+	BGL::RHCoordSys3	ics;
+	HemiSphiral	LumMap;
+	t0 = BenchSeconds();
+	for (irep=0; irep<nrep; irep++) LumMap = SkyBTDFIntegration(sky0,&btdf0,ics);
+	Double	dSec = (BenchSeconds() - t0)/nrep;
+	cout << left << setw(14) << "integration" << right << setw(12) << setprecision(4) << dSec*1000 << " ms\n";
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+// bvh_bench.cpp
+//
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+
+//	Micro-benchmark of the shading BVH ray test dhitsh_bvh() against the linear dhitsh().
+//	Loads an EPlus format DElight input (e.g. eplusout.delightin), runs its daylight factor
+//	preprocessing so that the surface meshes and the BVH are built, then calls bvh_benchmark()
+//	with nrays rays from every reference point and surface node.
+//	Build against the DElight sources, e.g.
+//		g++ -O2 -DHAS_ISNAN -I../SourceCode bvh_bench.cpp ../SourceCode/*.cpp ../SourceCode/*.CPP -lpthread
+//	then run, from a scratch directory,
+//		bvh_bench input.delightin [nrays]
+//	The timings and the number of rays whose results differ are printed; the exit status is
+//	nonzero if any result differs. DELIGHT_DF_CACHE must be unset, since a cached run does not
+//	mesh the surfaces.
+
+#pragma warning(disable:4786)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "NodeMesh2.h"
+#include "WLCSurface.h"
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+#include "CFSSurface.h"
+
+// includes
+#include "DOE2DL.H"
+#include "DElight2.h"
+#include "ShadeBVH.h"
+
+#define BENCH_OUTPUT_NAME "bvh_bench.out"
+#define BENCH_DUMP_NAME "bvh_bench.dmp"
+#define BENCH_RESULT_NAME "bvh_bench.txt"
+
+static BLDG	bldg;	// DElight bldg data structure
+static LIB	lib;	// DElight library data structure
+
+int	main(int argc, char** argv)
+{
+	if ((argc < 2) || (argc > 3) || (strlen(argv[1]) > MAX_CHAR_LINE)) {
+		cerr << "usage: bvh_bench input.delightin [nrays]\n";
+		return 1;
+	}
+	int	nrays = (argc > 2) ? atoi(argv[2]) : 200;
+	if (nrays < 1) {
+		cerr << "bvh_bench: nrays must be positive\n";
+		return 1;
+	}
+	const char*	cCacheDir = getenv("DELIGHT_DF_CACHE");
+	if ((cCacheDir != NULL) && (cCacheDir[0] != '\0')) {
+		cerr << "bvh_bench: unset DELIGHT_DF_CACHE so that the surfaces are meshed\n";
+		return 1;
+	}
+
+	char	cInputName[MAX_CHAR_LINE+1], cOutputName[MAX_CHAR_LINE+1];
+	strcpy(cInputName,argv[1]);
+	strcpy(cOutputName,BENCH_OUTPUT_NAME);
+	ofstream	ofdmpfile(BENCH_DUMP_NAME);
+	int	iRetVal = DElightDaylightFactors4EPlus(cInputName,cOutputName,&bldg,&lib,5,0.0,10,10,NPHS,10.,NTHS,-110.,&ofdmpfile);
+	if (iRetVal < 0) {
+		cerr << "bvh_bench: cannot load " << cInputName << " (see " BENCH_DUMP_NAME ")\n";
+		return 1;
+	}
+
+	//	bvh_benchmark() reports to a dump file stream; copy its report to stdout
+	ofstream	ofresult(BENCH_RESULT_NAME);
+	iRetVal = bvh_benchmark(&bldg,nrays,&ofresult);
+	ofresult.close();
+	DElightFreeMemory4EPlus(&bldg,&lib);
+
+	ifstream	ifresult(BENCH_RESULT_NAME);
+	string	sLine;
+	while (getline(ifresult,sLine)) cout << sLine << "\n";
+	ifresult.close();
+	remove(BENCH_RESULT_NAME);
+
+	return (iRetVal < 0) ? 1 : 0;
+}
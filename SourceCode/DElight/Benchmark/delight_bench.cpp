@@ -0,0 +1,559 @@
+// delight_bench.cpp
+//
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+
+//	Preprocessing benchmark: generates synthetic EPlus format DElight inputs over a range of
+//	building sizes, runs DElightDaylightFactors4EPlus() on each and reports the time spent in
+//	each preprocessing phase (see DLPhase.h) as JSON.
+//	Build against the DElight sources, e.g.
+//		g++ -O2 -DHAS_ISNAN -I../SourceCode delight_bench.cpp ../SourceCode/*.cpp ../SourceCode/*.CPP -lpthread
+//	then run, from a scratch directory,
+//		delight_bench [-zones 1,4] [-windows 1] [-cfs 0,1] [-refpts 2] [-gridarea 2.0]
+//			[-threads 1] [-adapttol 0,0.05,0.1,0.2] [-maxdev 0.05] [-reps 3] [-o results.json]
+//	Every list option takes a comma separated list and every combination is run reps times.
+//	Each synthetic zone is a 20 x 15 x 10 ft box with the given number of windows on its South
+//	and North walls, CFS surfaces on its East wall and reference points on a grid at 2.5 ft.
+//	Phase times are summed over zones; "direct" includes "cfs". With more than one thread the
+//	zone phases are reported once per thread pool run.
+//	On Linux each phase also reports CPU cycles and instructions from perf_event_open()
+//	when the kernel allows it (see /proc/sys/kernel/perf_event_paranoid).
+//	DELIGHT_DF_CACHE must be unset, so that every run calculates its daylight factors.
+//	An -adapttol value above 0 runs with DELIGHT_WNDO_ADAPT_TOL set to it and with
+//	DELIGHT_WNDO_ADAPT_CHECK set, so every adaptive window element evaluation is validated
+//	against the uniform window elements (whose cost is then included in the phase times).
+//	For each zone the run reports the window elements saved and the largest deviation relative
+//	to the uniform mesh; the exit status is 2 if any deviation exceeds -maxdev (default 0.05).
+
+#pragma warning(disable:4786)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+using namespace std;
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "NodeMesh2.h"
+#include "WLCSurface.h"
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+#include "CFSSurface.h"
+
+// includes
+#include "DOE2DL.H"
+#include "DElight2.h"
+#include "DLPhase.h"
+
+#define BENCH_INPUT_NAME "delight_bench.in"
+#define BENCH_OUTPUT_NAME "delight_bench.out"
+#define BENCH_DUMP_NAME "delight_bench.dmp"
+
+static BLDG	bldg;	// DElight bldg data structure
+static LIB	lib;	// DElight library data structure
+
+//	one combination of synthetic building parameters
+typedef struct {
+	int	nzones;			// number of zones
+	int	nwndos;			// windows on each of the South and North walls
+	int	ncfs;			// CFS surfaces on the East wall
+	int	nrefpts;		// reference points per zone
+	Double	dGridArea;	// Max_Grid_Node_Area (ft2)
+	int	nthreads;		// DELIGHT_NUM_THREADS
+	Double	dAdaptTol;	// DELIGHT_WNDO_ADAPT_TOL (0 = uniform window elements)
+} BENCHCASE;
+
+//	hardware counters read at phase boundaries
+enum {BENCH_CYCLES, BENCH_INSTRUCTIONS, NBENCHCOUNTERS};
+
+//	totals of one phase over one run
+typedef struct {
+	int	ncalls;			// completed begin/end pairs
+	Double	dSeconds;	// wall clock time
+	Double	dCount[NBENCHCOUNTERS];	// hardware counter deltas
+} BENCHPHASE;
+
+//	phase hook data for one run
+typedef struct {
+	BENCHPHASE	phase[NDLPHASES];	// phase totals
+	Double	dBegin[NDLPHASES];		// time of the open begin of each phase
+	Double	dBeginCount[NDLPHASES][NBENCHCOUNTERS];	// counters at the open begin of each phase
+	int	iOpen[NDLPHASES];			// is the phase open? (0=No 1=Yes)
+} BENCHRUN;
+
+#ifdef __linux__
+static int	iCounterFd[NBENCHCOUNTERS] = {-1, -1};	// perf event file descriptors (-1 = unavailable)
+#endif
+
+static Double	BenchSeconds()
+{
+	return chrono::duration<Double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//	opens the hardware counters of the calling thread; returns 1 if they are available
+static int	BenchOpenCounters()
+{
+#ifdef __linux__
+	static const unsigned long long	uConfig[NBENCHCOUNTERS] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS};
+	for (int ii=0; ii<NBENCHCOUNTERS; ii++) {
+		struct perf_event_attr	attr;
+		memset(&attr,0,sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = uConfig[ii];
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = 1;	// include pool threads created after this point
+		iCounterFd[ii] = (int)syscall(__NR_perf_event_open,&attr,0,-1,-1,0);
+		if (iCounterFd[ii] < 0) {
+			for (int jj=0; jj<ii; jj++) {
+				close(iCounterFd[jj]);
+				iCounterFd[jj] = -1;
+			}
+			iCounterFd[ii] = -1;
+			return 0;
+		}
+	}
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+//	reads the hardware counters (zeros if unavailable)
+static void	BenchReadCounters(Double dCount[NBENCHCOUNTERS])
+{
+	for (int ii=0; ii<NBENCHCOUNTERS; ii++) {
+		dCount[ii] = 0;
+#ifdef __linux__
+		unsigned long long	uCount;
+		if ((iCounterFd[ii] >= 0) && (read(iCounterFd[ii],&uCount,sizeof(uCount)) == (int)sizeof(uCount))) dCount[ii] = (Double)uCount;
+#endif
+	}
+}
+
+//	DLPHASEHOOK: phases do not nest with themselves, so one open begin per phase suffices
+static void	BenchPhaseHook(int iphase, int iBegin, void* pdata)
+{
+	BENCHRUN*	prun = (BENCHRUN*)pdata;
+	Double	dCount[NBENCHCOUNTERS];
+
+	BenchReadCounters(dCount);
+	Double	dNow = BenchSeconds();
+	if (iBegin) {
+		prun->dBegin[iphase] = dNow;
+		for (int ii=0; ii<NBENCHCOUNTERS; ii++) prun->dBeginCount[iphase][ii] = dCount[ii];
+		prun->iOpen[iphase] = 1;
+	}
+	else if (prun->iOpen[iphase]) {
+		prun->phase[iphase].ncalls++;
+		prun->phase[iphase].dSeconds += dNow - prun->dBegin[iphase];
+		for (int ii=0; ii<NBENCHCOUNTERS; ii++) prun->phase[iphase].dCount[ii] += dCount[ii] - prun->dBeginCount[iphase][ii];
+		prun->iOpen[iphase] = 0;
+	}
+}
+
+//	"Vertex" line of an EPlus format input file
+static void	WriteVertex(FILE* fp, Double x, Double y, Double z)
+{
+	fprintf(fp,"Vertex %12.4f %12.4f %12.4f\n",x,y,z);
+}
+
+//	one zone surface with its windows and CFS surfaces, as in an EnergyPlus generated input
+static void	WriteSurface(FILE* fp, const char* cName, Double dAzm, Double dTilt, Double dRefl, const Double vert[4][3],
+							int nwndos, const Double (*wvert)[4][3], int ncfs, const Double (*cvert)[4][3], const char* cZone)
+{
+	int	ii, iv;
+
+	fprintf(fp,"\nZONE SURFACE DATA\n");
+	fprintf(fp,"Surface %s_%s\n",cZone,cName);
+	fprintf(fp,"WCS_Azimuth %12.4f\n",dAzm);
+	fprintf(fp,"WCS_Tilt %12.4f\n",dTilt);
+	fprintf(fp,"Vis_Refl %12.4f\n",dRefl);
+	fprintf(fp,"Ext_Refl %12.4f\n",0.3);
+	fprintf(fp,"Gnd_Refl     0.2\n");
+	fprintf(fp,"N_WCS_Vertices      4\n");
+	for (iv=0; iv<4; iv++) WriteVertex(fp,vert[iv][0],vert[iv][1],vert[iv][2]);
+
+	fprintf(fp,"\nSURFACE WINDOWS\nN_Windows %6d\n",nwndos);
+	for (ii=0; ii<nwndos; ii++) {
+		fprintf(fp,"\nSURFACE WINDOW DATA\n");
+		fprintf(fp,"Window     %s_%sWin%d\n",cZone,cName,ii+1);
+		fprintf(fp,"Glass_Type    10001\n");
+		fprintf(fp,"Shade_Flag   0\n");
+		fprintf(fp,"Overhang_Fin_Depth    0.0 0.0 0.0\n");
+		fprintf(fp,"Overhang_Fin_Distance 0.0 0.0 0.0\n");
+		fprintf(fp,"N_WCS_Vertices    4\n");
+		for (iv=0; iv<4; iv++) WriteVertex(fp,wvert[ii][iv][0],wvert[ii][iv][1],wvert[ii][iv][2]);
+	}
+
+	fprintf(fp,"\nSURFACE CFS\nN_CFS %6d\n",ncfs);
+	for (ii=0; ii<ncfs; ii++) {
+		fprintf(fp,"\nCFS\n");
+		fprintf(fp,"CFS_Name    %s_%sCFS%d\n",cZone,cName,ii+1);
+		fprintf(fp,"CFS_Params  BTDF^GEN^WINDOW^0.8^0.1\n");
+		fprintf(fp,"CFS_Rotation 0.0\n");
+		fprintf(fp,"N_WCS_Vertices    4\n");
+		for (iv=0; iv<4; iv++) WriteVertex(fp,cvert[ii][iv][0],cvert[ii][iv][1],cvert[ii][iv][2]);
+	}
+}
+
+//	openings spread evenly along a wall from (x0,y0) to (x1,y1), each filling 60% of its bay,
+//	between heights zlo and zhi; vertices follow the wall vertex order (top left first)
+static void	WallOpenings(int nopen, Double x0, Double y0, Double x1, Double y1, Double zlo, Double zhi, vector<Double>& v)
+{
+	v.assign(nopen*12,0);
+	for (int ii=0; ii<nopen; ii++) {
+		Double	ta = (ii + 0.2)/nopen;
+		Double	tb = (ii + 0.8)/nopen;
+		Double	xa = x0 + ta*(x1 - x0), ya = y0 + ta*(y1 - y0);
+		Double	xb = x0 + tb*(x1 - x0), yb = y0 + tb*(y1 - y0);
+		Double	q[12] = {xa,ya,zhi, xa,ya,zlo, xb,yb,zlo, xb,yb,zhi};
+		for (int jj=0; jj<12; jj++) v[ii*12+jj] = q[jj];
+	}
+}
+
+//	writes the synthetic building of one case; returns 0 (ok) or -1 (error)
+static int	WriteBenchInput(const char* cFileName, const BENCHCASE& bc)
+{
+	FILE*	fp = fopen(cFileName,"w");
+	if (fp == NULL) return -1;
+
+	fprintf(fp,"Version EPlus : DElight input generated by delight_bench\n\n");
+	fprintf(fp,"Building_Name Bench\n");
+	fprintf(fp,"Site_Latitude        40.0000\n");
+	fprintf(fp,"Site_Longitude     -105.0000\n");
+	fprintf(fp,"Site_Altitude      5000.0000\n");
+	fprintf(fp,"Bldg_Azimuth          0.0000\n");
+	fprintf(fp,"Site_Time_Zone       -7.0000\n");
+	fprintf(fp,"Atm_Moisture  0.07 0.07 0.07 0.07 0.07 0.07 0.07 0.07 0.07 0.07 0.07 0.07\n");
+	fprintf(fp,"Atm_Turbidity 0.12 0.12 0.12 0.12 0.12 0.12 0.12 0.12 0.12 0.12 0.12 0.12\n");
+	fprintf(fp,"\nZONES\nN_Zones %6d\n",bc.nzones);
+
+	vector<Double>	vwin, vcfs;
+	for (int izone=0; izone<bc.nzones; izone++) {
+		char	cZone[32];
+		sprintf(cZone,"Z%d",izone+1);
+		Double	x0 = 25.*izone, x1 = x0 + 20., y0 = 0., y1 = 15., z0 = 0., z1 = 10.;
+
+		fprintf(fp,"\nZONE DATA\n");
+		fprintf(fp,"Zone %s\n",cZone);
+		fprintf(fp,"BldgSystem_Zone_Origin       0.0000      0.0000      0.0000\n");
+		fprintf(fp,"Zone_Azimuth          0.0000\n");
+		fprintf(fp,"Zone_Multiplier     1\n");
+		fprintf(fp,"Zone_Floor_Area     300.0000\n");
+		fprintf(fp,"Zone_Volume        3000.0000\n");
+		fprintf(fp,"Zone_Installed_Lighting    1000.0000\n");
+		fprintf(fp,"Min_Input_Power          0.3000\n");
+		fprintf(fp,"Min_Light_Fraction       0.2000\n");
+		fprintf(fp,"Light_Ctrl_Steps     1\n");
+		fprintf(fp,"Light_Ctrl_Prob          1.0000\n");
+		fprintf(fp,"View_Azimuth  0.0\n");
+		fprintf(fp,"Max_Grid_Node_Area %12.4f\n",bc.dGridArea);
+		fprintf(fp,"\nZONE LIGHTING SCHEDULES\nN_Lt_Scheds 0\n");
+		fprintf(fp,"\nZONE SURFACES\nN_Surfaces    6\n");
+
+		const Double	south[4][3] = {{x0,y0,z1},{x0,y0,z0},{x1,y0,z0},{x1,y0,z1}};
+		const Double	north[4][3] = {{x1,y1,z1},{x1,y1,z0},{x0,y1,z0},{x0,y1,z1}};
+		const Double	east[4][3] = {{x1,y0,z1},{x1,y0,z0},{x1,y1,z0},{x1,y1,z1}};
+		const Double	west[4][3] = {{x0,y1,z1},{x0,y1,z0},{x0,y0,z0},{x0,y0,z1}};
+		const Double	flr[4][3] = {{x1,y0,z0},{x0,y0,z0},{x0,y1,z0},{x1,y1,z0}};
+		const Double	ceiling[4][3] = {{x0,y1,z1},{x0,y0,z1},{x1,y0,z1},{x1,y1,z1}};
+
+		WallOpenings(bc.nwndos,x0,y0,x1,y0,3.,7.,vwin);
+		WriteSurface(fp,"South",180.,90.,0.5,south,bc.nwndos,(const Double (*)[4][3])(vwin.empty() ? NULL : &vwin[0]),0,NULL,cZone);
+		WallOpenings(bc.nwndos,x1,y1,x0,y1,3.,7.,vwin);
+		WriteSurface(fp,"North",0.,90.,0.5,north,bc.nwndos,(const Double (*)[4][3])(vwin.empty() ? NULL : &vwin[0]),0,NULL,cZone);
+		WallOpenings(bc.ncfs,x1,y0,x1,y1,3.,7.,vcfs);
+		WriteSurface(fp,"East",90.,90.,0.5,east,0,NULL,bc.ncfs,(const Double (*)[4][3])(vcfs.empty() ? NULL : &vcfs[0]),cZone);
+		WriteSurface(fp,"West",270.,90.,0.5,west,0,NULL,0,NULL,cZone);
+		WriteSurface(fp,"Floor",0.,180.,0.2,flr,0,NULL,0,NULL,cZone);
+		WriteSurface(fp,"Ceiling",0.,0.,0.7,ceiling,0,NULL,0,NULL,cZone);
+
+		//	reference points on a grid over the floor
+		int	ncols = (int)ceil(sqrt((Double)bc.nrefpts));
+		int	nrows = (bc.nrefpts + ncols - 1)/ncols;
+		fprintf(fp,"\nZONE REFERENCE POINTS\nN_Ref_Pts %6d\n",bc.nrefpts);
+		for (int irp=0; irp<bc.nrefpts; irp++) {
+			fprintf(fp,"\nZONE REFERENCE POINT DATA\n");
+			fprintf(fp,"Reference_Point %s_RP%d\n",cZone,irp+1);
+			fprintf(fp,"RefPt_WCS_Coords %12.4f %12.4f %12.4f\n",x0 + 20.*(irp%ncols + 0.5)/ncols,y0 + 15.*(irp/ncols + 0.5)/nrows,2.5);
+			fprintf(fp,"Zone_Fraction %12.6f\n",floor(1.e6/bc.nrefpts)*1.e-6);
+			fprintf(fp,"Light_Set_Pt      50.0000\n");
+			fprintf(fp,"Light_Ctrl_Type    1\n");
+		}
+	}
+
+	fprintf(fp,"\nBUILDING SHADES\nN_BShades 0\n");
+	fprintf(fp,"\nLIBRARY DATA\nGLASS TYPES\nN_Glass_Types    1\n");
+	fprintf(fp,"\nGLASS TYPE DATA\n");
+	fprintf(fp,"Name  10001\n");
+	fprintf(fp,"EPlusDiffuse_Transmittance         0.7000\n");
+	fprintf(fp,"EPlusDiffuse_Int_Reflectance       0.1000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_1       0.200000000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_2       1.200000000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_3      -0.800000000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_4       0.200000000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_5       0.000000000\n");
+	fprintf(fp,"EPlus_Vis_Trans_Coeff_6       0.000000000\n");
+
+	fclose(fp);
+	return 0;
+}
+
+static void	BenchSetThreads(int nthreads)
+{
+	char	cThreads[16];
+	sprintf(cThreads,"%d",nthreads);
+#ifdef _WIN32
+	_putenv_s("DELIGHT_NUM_THREADS",cThreads);
+#else
+	setenv("DELIGHT_NUM_THREADS",cThreads,1);
+#endif
+}
+
+//	adaptive window elements with the check against the uniform ones, or uniform ones (dTol = 0)
+static void	BenchSetAdapt(Double dTol)
+{
+	char	cTol[32];
+	sprintf(cTol,"%g",dTol);
+#ifdef _WIN32
+	_putenv_s("DELIGHT_WNDO_ADAPT_TOL",(dTol > 0) ? cTol : "");
+	_putenv_s("DELIGHT_WNDO_ADAPT_CHECK",(dTol > 0) ? "1" : "");
+#else
+	if (dTol > 0) {
+		setenv("DELIGHT_WNDO_ADAPT_TOL",cTol,1);
+		setenv("DELIGHT_WNDO_ADAPT_CHECK","1",1);
+	}
+	else {
+		unsetenv("DELIGHT_WNDO_ADAPT_TOL");
+		unsetenv("DELIGHT_WNDO_ADAPT_CHECK");
+	}
+#endif
+}
+
+//	runs the daylight factor preprocessing of one case and appends its JSON record;
+//	returns the largest adaptive window element deviation over all zones (-1 if not checked)
+static Double	RunBenchCase(const BENCHCASE& bc, int irep, int iCounters, Double dMaxDev, ostream& os)
+{
+	BENCHRUN	run;
+	memset(&run,0,sizeof(run));
+
+	char	cInputName[MAX_CHAR_LINE+1], cOutputName[MAX_CHAR_LINE+1];
+	strcpy(cInputName,BENCH_INPUT_NAME);
+	strcpy(cOutputName,BENCH_OUTPUT_NAME);
+	BenchSetThreads(bc.nthreads);
+	BenchSetAdapt(bc.dAdaptTol);
+
+	ofstream	ofdmpfile(BENCH_DUMP_NAME);
+	set_dl_phase_hook(BenchPhaseHook,&run);
+	Double	t0 = BenchSeconds();
+	int	iRetVal = DElightDaylightFactors4EPlus(cInputName,cOutputName,&bldg,&lib,5,0.0,10,10,NPHS,10.,NTHS,-110.,&ofdmpfile);
+	Double	dTotal = BenchSeconds() - t0;
+	set_dl_phase_hook(NULL,NULL);
+
+	//	mesh sizes actually used, and the adaptive window element counts and deviation of each zone
+	int	nSurfNodes = 0, nWndoNodes = 0;
+	Double	dDev = -1;
+	stringstream	ssAdapt;
+	for (int izone=0; izone<bldg.nzones; izone++) {
+		ZONE*	zone_ptr = bldg.zone[izone];
+		for (int isurf=0; isurf<zone_ptr->nsurfs; isurf++) {
+			nSurfNodes += zone_ptr->surf[isurf]->nnodes;
+			for (int iw=0; iw<zone_ptr->surf[isurf]->nwndos; iw++) nWndoNodes += zone_ptr->surf[isurf]->wndo[iw]->nnodes;
+		}
+		if (bc.dAdaptTol > 0) {
+			ssAdapt << (izone ? ", " : "") << "{\"zone\": " << izone+1
+				<< ", \"elements_uniform\": " << zone_ptr->wndo_elems_uniform << ", \"elements_adaptive\": " << zone_ptr->wndo_elems_adaptive
+				<< ", \"elements_saved\": " << zone_ptr->wndo_elems_uniform - zone_ptr->wndo_elems_adaptive
+				<< ", \"max_deviation\": " << zone_ptr->wndo_adapt_dev << "}";
+			dDev = max(dDev,zone_ptr->wndo_adapt_dev);
+			cerr << "  adapttol " << bc.dAdaptTol << " zone " << izone+1 << ": " << zone_ptr->wndo_elems_uniform - zone_ptr->wndo_elems_adaptive
+				<< " of " << zone_ptr->wndo_elems_uniform << " window elements saved, max deviation " << zone_ptr->wndo_adapt_dev
+				<< ((zone_ptr->wndo_adapt_dev > dMaxDev) ? " EXCEEDS -maxdev\n" : "\n");
+		}
+	}
+	DElightFreeMemory4EPlus(&bldg,&lib);
+
+	os << "    {\"zones\": " << bc.nzones << ", \"windows_per_surface\": " << bc.nwndos << ", \"cfs\": " << bc.ncfs
+		<< ", \"ref_pts\": " << bc.nrefpts << ", \"max_grid_node_area\": " << bc.dGridArea << ", \"threads\": " << bc.nthreads
+		<< ", \"adapt_tol\": " << bc.dAdaptTol << ", \"rep\": " << irep << ",\n     \"status\": " << iRetVal << ", \"surf_nodes\": " << nSurfNodes << ", \"wndo_nodes\": " << nWndoNodes
+		<< ", \"total_seconds\": " << dTotal << ",\n     \"phases\": {";
+	for (int iphase=0; iphase<NDLPHASES; iphase++) {
+		os << (iphase ? ",\n                " : "") << "\"" << dl_phase_name(iphase) << "\": {\"calls\": " << run.phase[iphase].ncalls
+			<< ", \"seconds\": " << run.phase[iphase].dSeconds;
+		if (iCounters) os << ", \"cycles\": " << run.phase[iphase].dCount[BENCH_CYCLES] << ", \"instructions\": " << run.phase[iphase].dCount[BENCH_INSTRUCTIONS];
+		os << "}";
+	}
+	os << "}";
+	if (bc.dAdaptTol > 0) os << ",\n     \"adaptive\": {\"max_deviation_limit\": " << dMaxDev << ", \"zones\": [" << ssAdapt.str() << "]}";
+	os << "}";
+
+	cerr << "zones " << bc.nzones << " windows " << bc.nwndos << " cfs " << bc.ncfs << " refpts " << bc.nrefpts
+		<< " gridarea " << bc.dGridArea << " threads " << bc.nthreads << " adapttol " << bc.dAdaptTol << " rep " << irep << ": " << dTotal << " s"
+		<< (iRetVal < 0 ? " (error, see " BENCH_DUMP_NAME ")" : "") << "\n";
+	return dDev;
+}
+
+//	parses a comma separated option value
+static int	ParseList(const char* cList, vector<Double>& v)
+{
+	stringstream	ss(cList);
+	string	sItem;
+	v.clear();
+	while (getline(ss,sItem,',')) {
+		char*	cEnd;
+		Double	d = strtod(sItem.c_str(),&cEnd);
+		if ((sItem.empty()) || (*cEnd != '\0') || (d < 0)) return -1;
+		v.push_back(d);
+	}
+	return v.empty() ? -1 : 0;
+}
+
+static int	Usage()
+{
+	cerr << "usage: delight_bench [-zones N,..] [-windows N,..] [-cfs N,..] [-refpts N,..] [-gridarea A,..]\n"
+		<< "                     [-threads N,..] [-adapttol T,..] [-maxdev D] [-reps N] [-o file.json]\n";
+	return 1;
+}
+
+int	main(int argc, char** argv)
+{
+	map<string,vector<Double> >	mOpts;
+	mOpts["-zones"] = vector<Double>(1,1);
+	mOpts["-windows"] = vector<Double>(1,1);
+	mOpts["-cfs"] = vector<Double>(1,0);
+	mOpts["-refpts"] = vector<Double>(1,2);
+	mOpts["-gridarea"] = vector<Double>(1,2.0);
+	mOpts["-threads"] = vector<Double>(1,1);
+	mOpts["-adapttol"] = vector<Double>(1,0);
+	mOpts["-maxdev"] = vector<Double>(1,0.05);
+	mOpts["-reps"] = vector<Double>(1,3);
+	string	sJsonName;
+
+	for (int iarg=1; iarg<argc; iarg++) {
+		if ((strcmp(argv[iarg],"-o") == 0) && (iarg+1 < argc)) sJsonName = argv[++iarg];
+		else if ((mOpts.count(argv[iarg]) == 0) || (iarg+1 >= argc) || (ParseList(argv[iarg+1],mOpts[argv[iarg]]) < 0)) return Usage();
+		else iarg++;
+	}
+	const char*	cCacheDir = getenv("DELIGHT_DF_CACHE");
+	if ((cCacheDir != NULL) && (cCacheDir[0] != '\0')) {
+		cerr << "delight_bench: unset DELIGHT_DF_CACHE so that every run calculates its daylight factors\n";
+		return 1;
+	}
+
+	//	every combination of the option lists, checked against the DElight input limits
+	vector<BENCHCASE>	vCases;
+	BENCHCASE	bc;
+	vector<Double>&	vZones = mOpts["-zones"];
+	vector<Double>&	vWndos = mOpts["-windows"];
+	vector<Double>&	vCFS = mOpts["-cfs"];
+	vector<Double>&	vRefPts = mOpts["-refpts"];
+	vector<Double>&	vGridArea = mOpts["-gridarea"];
+	vector<Double>&	vThreads = mOpts["-threads"];
+	vector<Double>&	vAdaptTol = mOpts["-adapttol"];
+	for (size_t iz=0; iz<vZones.size(); iz++) for (size_t iw=0; iw<vWndos.size(); iw++) for (size_t ic=0; ic<vCFS.size(); ic++)
+	for (size_t ir=0; ir<vRefPts.size(); ir++) for (size_t ig=0; ig<vGridArea.size(); ig++) for (size_t it=0; it<vThreads.size(); it++)
+	for (size_t ia=0; ia<vAdaptTol.size(); ia++) {
+		bc.nzones = (int)vZones[iz];
+		bc.nwndos = (int)vWndos[iw];
+		bc.ncfs = (int)vCFS[ic];
+		bc.nrefpts = (int)vRefPts[ir];
+		bc.dGridArea = vGridArea[ig];
+		bc.nthreads = (int)vThreads[it];
+		bc.dAdaptTol = vAdaptTol[ia];
+		if ((bc.nzones < 1) || (bc.nzones > MAX_BLDG_ZONES) || (bc.nwndos > MAX_SURF_WNDOS) || (bc.ncfs > MAX_SURF_CFS)
+			|| (bc.nrefpts < 1) || (bc.nrefpts > MAX_REF_PTS) || (bc.dGridArea <= 0)) {
+			cerr << "delight_bench: case out of range (zones 1-" << MAX_BLDG_ZONES << ", windows 0-" << MAX_SURF_WNDOS
+				<< ", cfs 0-" << MAX_SURF_CFS << ", refpts 1-" << MAX_REF_PTS << ", gridarea > 0)\n";
+			return 1;
+		}
+		vCases.push_back(bc);
+	}
+	int	nreps = max(1,(int)mOpts["-reps"][0]);
+	Double	dMaxDev = mOpts["-maxdev"][0];
+	Double	dWorstDev = -1;
+
+	int	iCounters = BenchOpenCounters();
+	ofstream	ofjson;
+	if (!sJsonName.empty()) {
+		ofjson.open(sJsonName.c_str());
+		if (!ofjson) {
+			cerr << "delight_bench: cannot open " << sJsonName << "\n";
+			return 1;
+		}
+	}
+	ostream&	os = sJsonName.empty() ? cout : ofjson;
+	os.precision(6);
+
+	os << "{\"benchmark\": \"delight_bench\", \"counters\": \"" << (iCounters ? "perf_event" : "none") << "\",\n \"runs\": [\n";
+	for (size_t icase=0; icase<vCases.size(); icase++) {
+		if (WriteBenchInput(BENCH_INPUT_NAME,vCases[icase]) < 0) {
+			cerr << "delight_bench: cannot write " BENCH_INPUT_NAME "\n";
+			return 1;
+		}
+		for (int irep=0; irep<nreps; irep++) {
+			if ((icase > 0) || (irep > 0)) os << ",\n";
+			dWorstDev = max(dWorstDev,RunBenchCase(vCases[icase],irep,iCounters,dMaxDev,os));
+		}
+	}
+	os << "\n ]}\n";
+
+	if (dWorstDev > dMaxDev) {
+		cerr << "delight_bench: adaptive window elements deviate from the uniform mesh by " << dWorstDev
+			<< ", more than -maxdev " << dMaxDev << "\n";
+		return 2;
+	}
+	return 0;
+}
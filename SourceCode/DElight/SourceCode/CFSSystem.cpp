@@ -68,6 +68,7 @@ namespace BGL = BldgGeomLib;
 #include	"NodeMesh2.h"
 #include	"WLCSurface.h"
 #include	"btdf.h"
+#include	"hsfile.h"
 #include	"CFSSystem.h"
 #include	"CFSSurface.h"
 #include	"DOE2DL.H"
@@ -90,14 +91,17 @@ syst_type(SysType), lp(lpIn), pbtdf0(0)
 		}
 		//	load btdf
 		else if (lp.source == "FILE") {
-			//	open a file for reading ...
+			//	text or binary file, shared with other systems using it
 			ifstream	infile(lp.filename.c_str());
 
             if (!(infile.rdbuf( )->is_open( )))	{
                 writewndo("Cannot Open BTDF Data File - must be located in EnergyPlus EXE directory\n","e");
             }
 
-            if (infile)	pbtdf0 = btdfLoad(infile);
+            if (infile)	{
+				spbtdf0 = btdfCacheGet(lp.filename);
+				pbtdf0 = spbtdf0.get();
+			}
         }
 //		cout << "CFSSystem::CFSSystem: pbtdf0->summary(): \n";
 //		pbtdf0->summary();
@@ -139,10 +143,9 @@ HemiSphiral CFSSystem::CFSLuminanceMap(HemiSphiral& sky, BGL::RHCoordSys3 ics)
 //		if (lp.source == "GEN") LumMap = GenLuminanceMap(Nsize,lp);
 		if (lp.source == "GEN") LumMap = GenLuminanceMap(lp);
 		else if (lp.source == "FILE") {
-			//	open a file for reading ...
-			ifstream	infile(lp.filename.c_str());
-			if (infile)	LumMap.load(infile);
-		//	if (!infile) throw (string("Error: Can't open infile: \"") + infilename) + string("\"");
+			//	text or binary file, loaded once per process
+			shared_ptr<const HemiSphiral>	pLumMap = HemiSphiralCacheGet(lp.filename);
+			if (pLumMap) LumMap = *pLumMap;
 		}
 	}
 	else if (lp.object == "BTDF")	{
@@ -166,10 +169,9 @@ HemiSphiral CFSSystem::CFSLuminanceMap(HemiSphiral& sky, BGL::RHCoordSys3 ics)
 //		if (lp.source == "GEN") LumMap = GenWindowMap(Nsize,lp,sky,ics);
 		if (lp.source == "GEN") LumMap = GenWindowMap(lp,sky,ics);
 		else if (lp.source == "FILE") {
-			//	open a file for reading ...
-			ifstream	infile(lp.filename.c_str());
-			if (infile)	LumMap.load(infile);
-		//	if (!infile) throw (string("Error: Can't open infile: \"") + infilename) + string("\"");
+			//	text or binary file, loaded once per process
+			shared_ptr<const HemiSphiral>	pLumMap = HemiSphiralCacheGet(lp.filename);
+			if (pLumMap) LumMap = *pLumMap;
 		}
 	}
 	return LumMap;
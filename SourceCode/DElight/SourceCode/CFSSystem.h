@@ -55,5 +55,6 @@ public:
 	string		sky_type;	/* sky environment uname */
 	LumParam	lp;
 	btdf*		pbtdf0;
+	std::shared_ptr<btdf>	spbtdf0;	//	keeps a btdf from btdfCacheGet() alive (pbtdf0 points to it)
 };
 
@@ -63,6 +63,49 @@ DllExport int	DElightDaylightFactors4EPlus(
 	double dMinAzm,						/* Minimum daylight factor sun azimuth angle */
     ofstream* pofdmpfile);              // ptr to Error message dump file
 
+DllExport int	DElightSessionOpen4EPlus(
+	char sInputName[MAX_CHAR_LINE+1],	/* input file name */
+	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
+	BLDG* bldg_ptr,							/* bldg data structure */
+	LIB* lib_ptr,							/* library data structure */
+	int iIterations,					/* Number of radiosity iterations */
+	double dCloudFraction,				/* fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+	int iSurfNodes,						/* Desired total number of surface nodes */
+	int iWndoNodes,						/* Desired total number of window nodes */
+	int iNumAlts,						/* Number of daylight factor sun altitude angles */
+	double dMinAlt,						/* Minimum daylight factor sun altitude angle */
+	int iNumAzms,						/* Number of daylight factor sun azimuth angles */
+	double dMinAzm,						/* Minimum daylight factor sun azimuth angle */
+    ofstream* pofdmpfile);              // ptr to Error message dump file
+
+DllExport int	DElightSessionSetGlass4EPlus(
+	LIB* lib_ptr,						/* library data structure */
+	char* sGlassName,					/* library glass type name */
+	double dDiffuseTrans,				/* diffuse visible transmittance */
+	double dInsideRefl,					/* inside visible reflectance */
+	double dEPlusCoef[6],				/* coefs of angular visible transmission */
+    ofstream* pofdmpfile);              // ptr to Error message dump file
+
+DllExport int	DElightSessionSetWndoGlass4EPlus(
+	BLDG* bldg_ptr,						/* bldg data structure */
+	LIB* lib_ptr,						/* library data structure */
+	char* sWndoName,					/* window name */
+	char* sGlassName,					/* library glass type name */
+    ofstream* pofdmpfile);              // ptr to Error message dump file
+
+DllExport int	DElightSessionSetSurfRefl4EPlus(
+	BLDG* bldg_ptr,						/* bldg data structure */
+	char* sZoneName,					/* zone name */
+	char* sSurfName,					/* surface name */
+	double dVisRefl,					/* inside visible reflectance */
+    ofstream* pofdmpfile);              // ptr to Error message dump file
+
+DllExport int	DElightSessionRecalc4EPlus(
+	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
+	BLDG* bldg_ptr,							/* bldg data structure */
+	LIB* lib_ptr,							/* library data structure */
+    ofstream* pofdmpfile);              // ptr to Error message dump file
+
 DllExport int DElightElecLtgCtrl4EPlus(
 	BLDG* bldg_ptr,			/* pointer to DElight Bldg data structure */
 	ZONE* zone_ptr,			/* pointer to DElight Zone data structure */
@@ -76,6 +119,26 @@ DllExport int DElightElecLtgCtrl4EPlus(
 	double dMaxAzm,			/* Maximum daylight factor sun azimuth angle */
 	double dAltInc,			/* Increment of daylight factor sun altitude angles */
 	double dAzmInc, 		/* Increment of daylight factor sun azimuth angles */
+	ofstream* pofillumfile,	/* ptr to ref pt illuminance dump file (NULL for none) */
+    ofstream* pofdmpfile);  // ptr to Error message dump file
+
+DllExport int DElightElecLtgCtrlBatch4EPlus(
+	BLDG* bldg_ptr,			/* pointer to DElight Bldg data structure */
+	int nsteps,				/* # of timesteps */
+	double* pdHISKF,		/* [nsteps] Exterior horizontal illuminance from sky (lum/ft^2) */
+	double* pdHISUNF,		/* [nsteps] Exterior horizontal beam illuminance (lum/ft^2) */
+	double* pdCloudFraction,	/* [nsteps] fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+	double* pdSOLCOSX,		/* [nsteps] x direction cosines of sun positions */
+	double* pdSOLCOSY,		/* [nsteps] y direction cosines of sun positions */
+	double* pdSOLCOSZ,		/* [nsteps] z direction cosines of sun positions */
+	double dMinAlt,			/* Minimum daylight factor sun altitude angle */
+	double dMinAzm,			/* Minimum daylight factor sun azimuth angle */
+	double dMaxAlt,			/* Maximum daylight factor sun altitude angle */
+	double dMaxAzm,			/* Maximum daylight factor sun azimuth angle */
+	double dAltInc,			/* Increment of daylight factor sun altitude angles */
+	double dAzmInc,			/* Increment of daylight factor sun azimuth angles */
+	double* pdRefPtIllum,	/* [nsteps][total # of ref pts] returned ref pt daylight illuminances (lum/ft^2) */
+	double* pdPowerReducFac,	/* [nsteps][nzones] returned Zone Power Reduction Factors */
     ofstream* pofdmpfile);  // ptr to Error message dump file
 
 DllExport int DElightFreeMemory4EPlus(
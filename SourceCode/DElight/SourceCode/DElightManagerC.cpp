@@ -47,7 +47,9 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <vector>
 #include <map>
 #include <fstream>
+#include <sstream>
 #include <cstring>
+#include <cstdlib>
 #include <limits>
 using namespace std;
 
@@ -84,16 +86,49 @@ LIB lib;	// DElight library data structure
 ofstream ofdmpfile;	// Error message dump file */
 int iErrorOccurred = 0; // Error/Warning occurred flag
 
+// Buffered message channels for the handle-based timestep call delightelecltgctrlzone()
+static stringbuf sbElMsg;		// Error/Warning messages of the current call
+static ofstream ofelmsgfile;	// dump file stand-in writing to sbElMsg
+static stringbuf sbElDiag;		// ref pt illuminance diagnostics, kept only when DELIGHT_ELTG_DUMP is set
+static ofstream ofeldiagfile;	// dump file stand-in writing to sbElDiag
+static int iElDiagOn = -1;		// diagnostics enabled? (-1=not yet checked 0=No 1=Yes)
+
+// Per-thread redirection of writewndo() output, set by run_task_pool() around each task
+static thread_local ofstream* pofTaskDmpFile = NULL;	// task message buffer (NULL => ofdmpfile)
+static thread_local int* piTaskErrorOccurred = NULL;	// task Error/Warning flag (NULL => iErrorOccurred)
+
+/******************************** subroutine writewndo_redirect *******************************/
+/* Routes writewndo() messages and flags raised on the calling thread to a task's */
+/* own buffer and flag (NULL pointers restore the shared dump file and flag). */
+/******************************** subroutine writewndo_redirect *******************************/
+void writewndo_redirect(ofstream* pofdmpfile, int* piErrorOccurred)
+{
+	pofTaskDmpFile = pofdmpfile;
+	piTaskErrorOccurred = piErrorOccurred;
+}
+
+/******************************** subroutine writewndo_set_error_flag *******************************/
+/* Sets the shared Error/Warning flag when merging task flags after a parallel run. */
+/******************************** subroutine writewndo_set_error_flag *******************************/
+void writewndo_set_error_flag(int iFlag)
+{
+	iErrorOccurred = iFlag;
+}
+
 /******************************** subroutine writewndo *******************************/
 /* Error/Warning handling routine for WLC code modules. */
 /******************************** subroutine writewndo *******************************/
 void writewndo(const char* instring, string sfpflg)
 {
+	// Use the current task's buffer and flag when called from a run_task_pool() task
+	ofstream& ofmsgfile = (pofTaskDmpFile != NULL) ? *pofTaskDmpFile : ofdmpfile;
+	int& iErrorFlag = (piTaskErrorOccurred != NULL) ? *piTaskErrorOccurred : iErrorOccurred;
+
 	// Check for open Error message dump file.
-	if(!ofdmpfile)
+	if(!ofmsgfile)
 	{
         // Register that an Error file opening error has occurred
-        iErrorOccurred = 1;
+        iErrorFlag = 1;
 
         // Throw an appropriate message to highest level calling routine
 		throw "ERROR: DElight - No open Error Message file\n";
@@ -103,20 +138,20 @@ void writewndo(const char* instring, string sfpflg)
     if (sfpflg.size() == 0) return;
     if (sfpflg[0] == 'e') {
         // Write properly formulated Error message to Error file
-		ofdmpfile << "ERROR: DElight - " << instring << "\n";
+		ofmsgfile << "ERROR: DElight - " << instring << "\n";
 
         // Register that an Error has occurred
-        iErrorOccurred = 2;
+        iErrorFlag = 2;
 
         // Throw to highest level calling routine
 		throw "";
     }
     else if (sfpflg[0] == 'w') {
         // Formulate Warning message and write it to Error file
-		ofdmpfile << "WARNING: DElight - " << instring << "\n";
+		ofmsgfile << "WARNING: DElight - " << instring << "\n";
 
         // Register that a Warning has occurred
-        iErrorOccurred = 3;
+        iErrorFlag = 3;
 
         // Return to calling location
         return;
@@ -129,13 +164,13 @@ void writewndo(const char* instring, string sfpflg)
     return;
 }
 
-/******************************** subroutine delightdaylightcoefficients *******************************/
-/* Calls the DElight daylighting factors/coefficients routine from the DElight DLL. */
-/* Exported subroutine for EnergyPlus preprocessing call to DElight. */
-/* See corresponding Interface Subroutine in DElightManagerF.f90 EnergyPlus module. */
-/******************************** subroutine delightdaylightcoefficients *******************************/
-extern "C" DllExport void delightdaylightcoefficients(double dBldgLat, 
-                                                      int* piErrorFlag)  // return Error Flag from DElight to EPlus
+/******************************** subroutine daylight_coefficients *******************************/
+/* Calls the DElight daylighting factors/coefficients routine from the DElight DLL, */
+/* keeping a session for delightsessionrecalc() if iSession is set. */
+/******************************** subroutine daylight_coefficients *******************************/
+static void daylight_coefficients(double dBldgLat,
+                                  int iSession,		// keep a session? (0=No 1=Yes)
+                                  int* piErrorFlag)  // return Error Flag from DElight to EPlus
 {
     // Open Error message dump file
     ofdmpfile.open("eplusout.delightdfdmp");
@@ -172,7 +207,7 @@ try {
     // Call DElight Daylight Factor calculation routine from the DElight2.dll
     // Init ErrorFlag return value
     int iErrorFlag = 0;
-    iErrorFlag = DElightDaylightFactors4EPlus(cFullInputFilename,		/* input file name */
+    iErrorFlag = (iSession ? DElightSessionOpen4EPlus : DElightDaylightFactors4EPlus)(cFullInputFilename,		/* input file name */
                                                     cFullOutputFilename,	/* output file name */
                                                     &bldg,		/* pointer to DElight bldg data structure */
                                                     &lib,		/* pointer to DElight library data structure */
@@ -256,6 +291,199 @@ catch(char* cThrownMsg) {
 return;
 }
 
+/******************************** subroutine delightdaylightcoefficients *******************************/
+/* Calls the DElight daylighting factors/coefficients routine from the DElight DLL. */
+/* Exported subroutine for EnergyPlus preprocessing call to DElight. */
+/* See corresponding Interface Subroutine in DElightManagerF.f90 EnergyPlus module. */
+/******************************** subroutine delightdaylightcoefficients *******************************/
+extern "C" DllExport void delightdaylightcoefficients(double dBldgLat, 
+                                                      int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    daylight_coefficients(dBldgLat, 0, piErrorFlag);
+}
+
+/******************************** subroutine delightsessionopen *******************************/
+/* Same as delightdaylightcoefficients(), but keeps a DElight session so that glass and */
+/* surface reflectance changes from delightsessionsetglass() and delightsessionsetrefl() */
+/* can be recalculated by delightsessionrecalc() without redoing the geometry calcs. */
+/******************************** subroutine delightsessionopen *******************************/
+extern "C" DllExport void delightsessionopen(double dBldgLat,
+                                             int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    daylight_coefficients(dBldgLat, 1, piErrorFlag);
+}
+
+/******************************** subroutine session_name *******************************/
+/* Copies a Fortran-like name string, with blanks replaced by underscores to match DElight names. */
+/******************************** subroutine session_name *******************************/
+static void session_name(int iNameLength, char* cName, char cDLName[MAX_CHAR_LINE+1])
+{
+    if (iNameLength > MAX_CHAR_LINE) iNameLength = MAX_CHAR_LINE;
+    if (iNameLength < 0) iNameLength = 0;
+    strncpy(cDLName, cName, iNameLength);
+    cDLName[iNameLength] = '\0';
+    if (iNameLength > 0) str_blnk2undr(cDLName);
+}
+
+/******************************** subroutine delightsessionsetglass *******************************/
+/* Replaces the visible optical data of a glass type of the session opened by delightsessionopen(). */
+/* Messages are appended to eplusout.delightdfdmp. */
+/******************************** subroutine delightsessionsetglass *******************************/
+extern "C" DllExport void delightsessionsetglass(int iNameLength,
+                                    char* cGlassName,
+                                    double dDiffuseTrans,	// diffuse visible transmittance
+                                    double dInsideRefl,		// inside visible reflectance
+                                    double* pdEPlusCoef,	// [6] coefs of angular visible transmission
+                                    int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    char cName[MAX_CHAR_LINE+1];
+
+    session_name(iNameLength, cGlassName, cName);
+    ofdmpfile.open("eplusout.delightdfdmp", ios_base::out | ios_base::app);
+    if (DElightSessionSetGlass4EPlus(&lib, cName, dDiffuseTrans, dInsideRefl, pdEPlusCoef, &ofdmpfile) < 0) *piErrorFlag = -1;
+    ofdmpfile.close();
+}
+
+/******************************** subroutine delightsessionsetrefl *******************************/
+/* Changes the inside visible reflectance of a zone surface of the session opened by delightsessionopen(). */
+/* Messages are appended to eplusout.delightdfdmp. */
+/******************************** subroutine delightsessionsetrefl *******************************/
+extern "C" DllExport void delightsessionsetrefl(int iZoneNameLength,
+                                    char* cZoneName,
+                                    int iSurfNameLength,
+                                    char* cSurfName,
+                                    double dVisRefl,	// inside visible reflectance
+                                    int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    char cZName[MAX_CHAR_LINE+1];
+    char cSName[MAX_CHAR_LINE+1];
+
+    session_name(iZoneNameLength, cZoneName, cZName);
+    session_name(iSurfNameLength, cSurfName, cSName);
+    ofdmpfile.open("eplusout.delightdfdmp", ios_base::out | ios_base::app);
+    if (DElightSessionSetSurfRefl4EPlus(&bldg, cZName, cSName, dVisRefl, &ofdmpfile) < 0) *piErrorFlag = -1;
+    ofdmpfile.close();
+}
+
+/******************************** subroutine delightsessionrecalc *******************************/
+/* Recalculates the daylight factors of the session opened by delightsessionopen() after */
+/* delightsessionsetglass()/delightsessionsetrefl() changes, and rewrites eplusout.delightout. */
+/* Messages are appended to eplusout.delightdfdmp. */
+/******************************** subroutine delightsessionrecalc *******************************/
+extern "C" DllExport void delightsessionrecalc(int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    char cFullOutputFilename[250+1];
+
+    ofdmpfile.open("eplusout.delightdfdmp", ios_base::out | ios_base::app);
+	if(!ofdmpfile)
+	{
+        // Set ErrorFlag return value for interpretation within EPlus
+        *piErrorFlag = -1;
+		return;
+	}
+
+// Wrap try block around the rest of this routine
+try {
+    strcpy( cFullOutputFilename, "eplusout.delightout" );
+    int iErrorFlag = DElightSessionRecalc4EPlus(cFullOutputFilename, &bldg, &lib, &ofdmpfile);
+    if (iErrorFlag < 0) *piErrorFlag = iErrorFlag;
+
+    // Check iErrorOccurred flag used in writewndo() for WLC code module
+    if (iErrorOccurred == 3) *piErrorFlag = -10;
+}   // end try
+// Catch throws from writewndo() that handle errors/warnings in WLC code, whose messages are already written
+catch(string sThrownMsg) {
+    if (iErrorOccurred == 1) ofdmpfile << sThrownMsg << "\n";
+    *piErrorFlag = -2;
+}
+catch(char* cThrownMsg) {
+    if (iErrorOccurred == 1) ofdmpfile << cThrownMsg << "\n";
+    *piErrorFlag = -2;
+}
+
+    ofdmpfile.close();
+    return;
+}
+
+/******************************** subroutine eltg_sun_limits *******************************/
+/* Sets the daylight factor sun position angle limits used for the electric lighting */
+/* control interpolation, as set up by delightdaylightcoefficients(). */
+/******************************** subroutine eltg_sun_limits *******************************/
+static void eltg_sun_limits(double dBldgLat,	/* building latitude */
+                            double* pdphsmin,	/* Minimum daylight factor sun altitude angle */
+                            double* pdphsmax,	/* Maximum daylight factor sun altitude angle */
+                            double* pdphsdel,	/* Increment of daylight factor sun altitude angles */
+                            double* pdthsmin,	/* Minimum daylight factor sun azimuth angle */
+                            double* pdthsmax,	/* Maximum daylight factor sun azimuth angle */
+                            double* pdthsdel)	/* Increment of daylight factor sun azimuth angles */
+{
+    // Minimum altitude angle
+    *pdphsmin = 10.;
+    if (fabs(dBldgLat) >= 48.0) *pdphsmin = 5.;
+
+    /* Maximum altitude and altitude angle increment for sun positions. */
+    *pdphsmax = min(90.0,113.5-fabs(dBldgLat));
+    *pdphsdel = (*pdphsmax - *pdphsmin) / ((double)(4-1));
+
+    // Minimum azimuth angle
+    *pdthsmin = -110.;
+    /* Minimum solar azimuth for southern hemisphere */
+    if (dBldgLat < 0.0) *pdthsmin = 70.;
+
+    /* Maximum azimuth and azimuth angle increment for sun positions. */
+    *pdthsdel = fabs(2.0 * *pdthsmin) / ((double)(5-1));
+    *pdthsmax = *pdthsmin + *pdthsdel * ((double)(5-1));
+}
+
+/******************************** subroutine eltg_flush_messages *******************************/
+/* Appends the buffered Error/Warning messages to eplusout.delighteldmp, where EnergyPlus */
+/* reads them whenever a nonzero Error Flag is returned, and empties the buffer. */
+/******************************** subroutine eltg_flush_messages *******************************/
+static void eltg_flush_messages()
+{
+    ofstream ofeldmpfile("eplusout.delighteldmp", ios_base::out | ios_base::app);
+    if (ofeldmpfile) ofeldmpfile << sbElMsg.str();
+    sbElMsg.str("");
+}
+
+/******************************** subroutine eltg_flush_diagnostics *******************************/
+/* Appends buffered ref pt illuminance diagnostics to eplusout.delighteldiag once */
+/* ELTG_DIAG_FLUSH bytes have accumulated, or unconditionally when bForce is set. */
+/******************************** subroutine eltg_flush_diagnostics *******************************/
+static void eltg_flush_diagnostics(int bForce)
+{
+    if (iElDiagOn != 1) return;
+    if (!bForce && (ofeldiagfile.tellp() < (streamoff)ELTG_DIAG_FLUSH)) return;
+
+    ofstream ofdiagfile("eplusout.delighteldiag", ios_base::out | ios_base::app);
+    if (ofdiagfile) ofdiagfile << sbElDiag.str();
+    sbElDiag.str("");
+}
+
+/* atexit() wrapper: writes any remaining diagnostics */
+static void eltg_flush_diagnostics_at_exit()
+{
+    eltg_flush_diagnostics(1);
+}
+
+/******************************** subroutine eltg_channel_init *******************************/
+/* Attaches the buffered message channels used by delightelecltgctrlzone() and */
+/* reads the DELIGHT_ELTG_DUMP switch for ref pt illuminance diagnostics (once). */
+/******************************** subroutine eltg_channel_init *******************************/
+static void eltg_channel_init()
+{
+    if (iElDiagOn >= 0) return;
+
+    ofelmsgfile.basic_ios<char>::rdbuf(&sbElMsg);
+    ofeldiagfile.basic_ios<char>::rdbuf(&sbElDiag);
+
+    const char *cDiag = getenv("DELIGHT_ELTG_DUMP");
+    iElDiagOn = ((cDiag != NULL) && (atoi(cDiag) != 0)) ? 1 : 0;
+
+    // EnergyPlus does not call delightfreememory(), so write the diagnostics tail at exit
+    if (iElDiagOn == 1) atexit(eltg_flush_diagnostics_at_exit);
+}
+
 /******************************** subroutine delightelecltgctrl *******************************/
 /* Calls the DElight daylighting interior illuminance and electric lighting control routines from the DElight DLL. */
 /* Exported subroutine for EnergyPlus timestep call to DElight. */
@@ -288,23 +516,8 @@ extern "C" DllExport void delightelecltgctrl(int iNameLength,
 try {
 
     /* Set limits of sun position angles. */
-
-    // Minimum altitude angle
-    double dphsmin = 10.;
-    if (fabs(dBldgLat) >= 48.0) dphsmin = 5.;
-
-    /* Maximum altitude and altitude angle increment for sun positions. */
-    double dphsmax = min(90.0,113.5-fabs(dBldgLat));
-    double dphsdel = (dphsmax - dphsmin) / ((double)(4-1));
-
-    // Minimum azimuth angle
-    double dthsmin = -110.;
-    /* Minimum solar azimuth for southern hemisphere */
-    if (dBldgLat < 0.0) dthsmin = 70.;
-
-    /* Maximum azimuth and azimuth angle increment for sun positions. */
-    double dthsdel = fabs(2.0 * dthsmin) / ((double)(5-1));
-    double dthsmax = dthsmin + dthsdel * ((double)(5-1));
+    double dphsmin, dphsmax, dphsdel, dthsmin, dthsmax, dthsdel;
+    eltg_sun_limits(dBldgLat, &dphsmin, &dphsmax, &dphsdel, &dthsmin, &dthsmax, &dthsdel);
 
     // Transfer solar direction cosines to an array
     double dSOLCOS[3];
@@ -341,6 +554,7 @@ try {
         dthsmax,			/* Maximum daylight factor sun azimuth angle */
         dphsdel,			/* Increment of daylight factor sun altitude angles */
         dthsdel,			/* Increment of daylight factor sun azimuth angles */
+        &ofdmpfile,			/* ref pt illuminances are read back from the dump file by EnergyPlus */
         &ofdmpfile);        // Error message dump file
 
     // Check returned ErrorFlag value
@@ -415,6 +629,255 @@ catch(char* cThrownMsg) {
 return;
 }
 
+/******************************** subroutine delightzoneindex *******************************/
+/* Resolves an EnergyPlus Zone name to its index within the DElight Bldg structure. */
+/* Exported subroutine for EnergyPlus setup of the handle-based timestep call delightelecltgctrlzone(). */
+/* See corresponding Interface Subroutine in DElightManagerF.f90 EnergyPlus module. */
+/******************************** subroutine delightzoneindex *******************************/
+extern "C" DllExport void delightzoneindex(int iNameLength,
+                                    char* cZoneName,
+                                    int* piZoneIndex,	// return value for DElight Zone index (-1 if not found)
+                                    int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    char cName[MAX_CHAR_LINE+1];
+	int iZone;
+
+    eltg_channel_init();
+    *piZoneIndex = -1;
+
+    // Copy the Fortran-like string, leaving the caller's buffer untouched
+    if (iNameLength > MAX_CHAR_LINE) iNameLength = MAX_CHAR_LINE;
+    if (iNameLength < 0) iNameLength = 0;
+    strncpy(cName, cZoneName, iNameLength);
+    cName[iNameLength] = '\0';
+    // Replace all blank spaces in the Zone name with underscore characters to match DElight names
+    if (iNameLength > 0) str_blnk2undr(cName);
+
+    // Now search for Zone name in DElight Bldg structure
+    for (iZone=0; iZone<bldg.nzones; iZone++) {
+        if (strcmp(bldg.zone[iZone]->name, cName) == 0) {
+            *piZoneIndex = iZone;
+            return;
+        }
+    }
+
+    ofelmsgfile << "ERROR: DElight Zone [" << cName << "] not found in DElight Building\n";
+    eltg_flush_messages();
+    *piErrorFlag = -1;
+    return;
+}
+
+/******************************** subroutine delightelecltgctrlzone *******************************/
+/* Handle-based form of delightelecltgctrl() for the EnergyPlus timestep call. */
+/* The Zone is given by its index from delightzoneindex() and ref pt illuminances (lux) */
+/* are returned in pdRefPtIllum, so a normal call opens no file, allocates nothing and */
+/* does no string work. Messages are buffered and written to eplusout.delighteldmp only */
+/* when a nonzero Error Flag is returned. Setting DELIGHT_ELTG_DUMP=1 additionally */
+/* collects ref pt illuminances in eplusout.delighteldiag. */
+/* See corresponding Interface Subroutine in DElightManagerF.f90 EnergyPlus module. */
+/******************************** subroutine delightelecltgctrlzone *******************************/
+extern "C" DllExport void delightelecltgctrlzone(int iZoneIndex,
+                                    double dBldgLat,
+                                    double dHISKF,
+                                    double dHISUNF,
+                                    double dCloudFraction,
+                                    double dSOLCOSX,
+                                    double dSOLCOSY,
+                                    double dSOLCOSZ,
+                                    double* pdPowerReducFac,	// return value for calculated Zone Elec Ltg Power Reduction Factor
+                                    double* pdRefPtIllum,		// return values for ref pt daylight illuminances (lux)
+                                    int iMaxRefPts,				// size of pdRefPtIllum
+                                    int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    double dphsmin, dphsmax, dphsdel, dthsmin, dthsmax, dthsdel;
+    double dSOLCOS[3];
+    int iCallErrorOccurred = 0;	// writewndo() Error/Warning flag for this call
+    int iErrorFlag = 0;
+    int irp;
+
+    eltg_channel_init();
+
+    if ((iZoneIndex < 0) || (iZoneIndex >= bldg.nzones)) {
+        ofelmsgfile << "ERROR: DElight Invalid Zone index (" << iZoneIndex << ") passed to delightelecltgctrlzone()\n";
+        eltg_flush_messages();
+        *piErrorFlag = -1;
+        return;
+    }
+    ZONE *zone_ptr = bldg.zone[iZoneIndex];
+
+    /* Set limits of sun position angles. */
+    eltg_sun_limits(dBldgLat, &dphsmin, &dphsmax, &dphsdel, &dthsmin, &dthsmax, &dthsdel);
+
+    // Transfer solar direction cosines to an array
+    dSOLCOS[0] = dSOLCOSX;
+    dSOLCOS[1] = dSOLCOSY;
+    dSOLCOS[2] = dSOLCOSZ;
+
+    if (iElDiagOn == 1) ofeldiagfile << "Zone: " << zone_ptr->name << "\n";
+
+    // Route writewndo() messages from WLC code to this call's buffer and flag
+    writewndo_redirect(&ofelmsgfile, &iCallErrorOccurred);
+    try {
+        iErrorFlag = DElightElecLtgCtrl4EPlus(
+            &bldg,					/* pointer to DElight Bldg data structure */
+            zone_ptr,				/* pointer to DElight Zone data structure */
+            dHISKF,			        /* Exterior horizontal illuminance from sky (lum/m^2) */
+            dHISUNF,		        /* Exterior horizontal beam illuminance (lum/m^2) */
+            dCloudFraction,	        /* fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+            dSOLCOS,				/* Direction cosines of current sun position */
+            dphsmin,			/* Minimum daylight factor sun altitude angle */
+            dthsmin,			/* Minimum daylight factor sun azimuth angle */
+            dphsmax,			/* Maximum daylight factor sun altitude angle */
+            dthsmax,			/* Maximum daylight factor sun azimuth angle */
+            dphsdel,			/* Increment of daylight factor sun altitude angles */
+            dthsdel,			/* Increment of daylight factor sun azimuth angles */
+            (iElDiagOn == 1) ? &ofeldiagfile : NULL,	/* opt-in ref pt illuminance diagnostics */
+            &ofelmsgfile);      // buffered Error message dump file
+    }
+    // Catch throws from writewndo() that handle errors/warnings in WLC code
+    catch(string sThrownMsg) {
+        ofelmsgfile << sThrownMsg << "\n";
+        iErrorFlag = -2;
+    }
+    catch(const char* cThrownMsg) {
+        ofelmsgfile << cThrownMsg;
+        iErrorFlag = -2;
+    }
+    writewndo_redirect(NULL, NULL);
+
+    // Check returned ErrorFlag value
+    if (iErrorFlag < 0) {
+        // Set appropriate ErrorFlag return value for interpretation within EPlus
+        *piErrorFlag = iErrorFlag;
+    }
+
+    // Check the writewndo() flag raised during this call
+    if (iCallErrorOccurred != 0) {
+        writewndo_set_error_flag(iCallErrorOccurred);
+        // Warning(s) occurred
+        if (iCallErrorOccurred == 3) *piErrorFlag = -10;
+    }
+
+    if (iErrorFlag != -2) {
+        // Set the return value for Power Reduction Factor (1.0 => Full Power On)
+        *pdPowerReducFac = zone_ptr->frac_power;
+
+        // Return ref pt daylight illuminances converted to lux
+        for (irp=0; (irp<zone_ptr->nrefpts) && (irp<iMaxRefPts); irp++)
+            pdRefPtIllum[irp] = zone_ptr->ref_pt[irp]->daylight*10.763915;
+    }
+
+    // Hand any messages to EnergyPlus through the dump file it reads on a nonzero Error Flag
+    if (*piErrorFlag != 0) eltg_flush_messages();
+    eltg_flush_diagnostics(0);
+
+    return;
+}
+
+/******************************** subroutine delightbatchsize *******************************/
+/* Returns the # of zones and total # of ref pts in the DElight Bldg structure, */
+/* i.e. the per-timestep sizes of the delightelecltgctrlbatch() result arrays. */
+/* Zone ref pts are numbered zone by zone in the order of the DElight input. */
+/******************************** subroutine delightbatchsize *******************************/
+extern "C" DllExport void delightbatchsize(int* piNumZones,	// return value for # of zones
+                                    int* piNumRefPts)		// return value for total # of ref pts
+{
+	int iZone;
+
+    *piNumZones = bldg.nzones;
+    *piNumRefPts = 0;
+    for (iZone=0; iZone<bldg.nzones; iZone++) *piNumRefPts += bldg.zone[iZone]->nrefpts;
+
+    return;
+}
+
+/******************************** subroutine delightelecltgctrlbatch *******************************/
+/* Batch form of delightelecltgctrlzone() for all zones over nSteps sun-up timesteps */
+/* (e.g. a design day or a whole run period). Inputs are per-timestep arrays; */
+/* pdPowerReducFac is returned as [nSteps][# of zones] and pdRefPtIllum (lux) as */
+/* [nSteps][total # of ref pts], sized as reported by delightbatchsize(). */
+/* Messages are handled as in delightelecltgctrlzone(). */
+/******************************** subroutine delightelecltgctrlbatch *******************************/
+extern "C" DllExport void delightelecltgctrlbatch(int nSteps,
+                                    double dBldgLat,
+                                    double* pdHISKF,
+                                    double* pdHISUNF,
+                                    double* pdCloudFraction,
+                                    double* pdSOLCOSX,
+                                    double* pdSOLCOSY,
+                                    double* pdSOLCOSZ,
+                                    double* pdPowerReducFac,	// return values for Zone Elec Ltg Power Reduction Factors
+                                    double* pdRefPtIllum,		// return values for ref pt daylight illuminances (lux)
+                                    int* piErrorFlag)  // return Error Flag from DElight to EPlus
+{
+    double dphsmin, dphsmax, dphsdel, dthsmin, dthsmax, dthsdel;
+    int iCallErrorOccurred = 0;	// writewndo() Error/Warning flag for this call
+    int iErrorFlag = 0;
+    int iZones, iRefPts, ii;
+
+    eltg_channel_init();
+
+    /* Set limits of sun position angles. */
+    eltg_sun_limits(dBldgLat, &dphsmin, &dphsmax, &dphsdel, &dthsmin, &dthsmax, &dthsdel);
+
+    // Route writewndo() messages from WLC code to this call's buffer and flag
+    writewndo_redirect(&ofelmsgfile, &iCallErrorOccurred);
+    try {
+        iErrorFlag = DElightElecLtgCtrlBatch4EPlus(
+            &bldg,				/* pointer to DElight Bldg data structure */
+            nSteps,				/* # of timesteps */
+            pdHISKF,			/* Exterior horizontal illuminances from sky */
+            pdHISUNF,			/* Exterior horizontal beam illuminances */
+            pdCloudFraction,	/* fractions of sky covered by clouds */
+            pdSOLCOSX,			/* Direction cosines of sun positions */
+            pdSOLCOSY,
+            pdSOLCOSZ,
+            dphsmin,			/* Minimum daylight factor sun altitude angle */
+            dthsmin,			/* Minimum daylight factor sun azimuth angle */
+            dphsmax,			/* Maximum daylight factor sun altitude angle */
+            dthsmax,			/* Maximum daylight factor sun azimuth angle */
+            dphsdel,			/* Increment of daylight factor sun altitude angles */
+            dthsdel,			/* Increment of daylight factor sun azimuth angles */
+            pdRefPtIllum,		/* ref pt daylight illuminances */
+            pdPowerReducFac,	/* Zone Power Reduction Factors */
+            &ofelmsgfile);      // buffered Error message dump file
+    }
+    // Catch throws from writewndo() that handle errors/warnings in WLC code
+    catch(string sThrownMsg) {
+        ofelmsgfile << sThrownMsg << "\n";
+        iErrorFlag = -2;
+    }
+    catch(const char* cThrownMsg) {
+        ofelmsgfile << cThrownMsg;
+        iErrorFlag = -2;
+    }
+    writewndo_redirect(NULL, NULL);
+
+    // Check returned ErrorFlag value
+    if (iErrorFlag < 0) {
+        // Set appropriate ErrorFlag return value for interpretation within EPlus
+        *piErrorFlag = iErrorFlag;
+    }
+
+    // Check the writewndo() flag raised during this call
+    if (iCallErrorOccurred != 0) {
+        writewndo_set_error_flag(iCallErrorOccurred);
+        // Warning(s) occurred
+        if (iCallErrorOccurred == 3) *piErrorFlag = -10;
+    }
+
+    // Convert ref pt daylight illuminances to lux
+    if ((iErrorFlag == 0) || (iErrorFlag == -10)) {
+        delightbatchsize(&iZones, &iRefPts);
+        for (ii=0; ii<nSteps*iRefPts; ii++) pdRefPtIllum[ii] *= 10.763915;
+    }
+
+    // Hand any messages to EnergyPlus through the dump file it reads on a nonzero Error Flag
+    if (*piErrorFlag != 0) eltg_flush_messages();
+
+    return;
+}
+
 /******************************** subroutine delightfreememory *******************************/
 /* Calls the DElight routines to free memory allocated by DElight */
 /* Not currently used by EnergyPlus. */
@@ -426,6 +889,9 @@ extern "C" DllExport void delightfreememory()
         &bldg,		/* pointer to DElight bldg data structure */
         &lib);		/* pointer to DElight library data structure */
 
+    // Write any buffered electric lighting diagnostics
+    eltg_flush_diagnostics(1);
+
     return;
 }
 
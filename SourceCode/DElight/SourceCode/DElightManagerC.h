@@ -30,10 +30,31 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include "DElightAPI.h"
 
 void writewndo(const char* instring, string sfpflg);
+void writewndo_redirect(ofstream* pofdmpfile, int* piErrorOccurred);
+void writewndo_set_error_flag(int iFlag);
 
 extern "C" DllExport void delightdaylightcoefficients(double dBldgLat, 
                                                       int* piErrorFlag); 
 
+extern "C" DllExport void delightsessionopen(double dBldgLat,
+                                             int* piErrorFlag);
+
+extern "C" DllExport void delightsessionsetglass(int iNameLength,
+								   char* cGlassName,
+								   double dDiffuseTrans,
+								   double dInsideRefl,
+								   double* pdEPlusCoef,
+								   int* piErrorFlag);
+
+extern "C" DllExport void delightsessionsetrefl(int iZoneNameLength,
+								   char* cZoneName,
+								   int iSurfNameLength,
+								   char* cSurfName,
+								   double dVisRefl,
+								   int* piErrorFlag);
+
+extern "C" DllExport void delightsessionrecalc(int* piErrorFlag);
+
 extern "C" DllExport void delightelecltgctrl(int iNameLength,
 								   char* cZoneName, 
 								   double dBldgLat, 
@@ -46,6 +67,39 @@ extern "C" DllExport void delightelecltgctrl(int iNameLength,
 								   double* pdPowerReducFac,
                                    int* piErrorFlag);
 
+extern "C" DllExport void delightzoneindex(int iNameLength,
+								   char* cZoneName,
+								   int* piZoneIndex,
+								   int* piErrorFlag);
+
+extern "C" DllExport void delightelecltgctrlzone(int iZoneIndex,
+								   double dBldgLat,
+								   double dHISKF,
+								   double dHISUNF,
+								   double dCloudFraction,
+								   double dSOLCOSX,
+								   double dSOLCOSY,
+								   double dSOLCOSZ,
+								   double* pdPowerReducFac,
+								   double* pdRefPtIllum,
+								   int iMaxRefPts,
+								   int* piErrorFlag);
+
+extern "C" DllExport void delightbatchsize(int* piNumZones,
+								   int* piNumRefPts);
+
+extern "C" DllExport void delightelecltgctrlbatch(int nSteps,
+								   double dBldgLat,
+								   double* pdHISKF,
+								   double* pdHISUNF,
+								   double* pdCloudFraction,
+								   double* pdSOLCOSX,
+								   double* pdSOLCOSY,
+								   double* pdSOLCOSZ,
+								   double* pdPowerReducFac,
+								   double* pdRefPtIllum,
+								   int* piErrorFlag);
+
 extern "C" DllExport void delightfreememory();
 
 extern "C" DllExport void delightoutputgenerator(int iOutputFlag);
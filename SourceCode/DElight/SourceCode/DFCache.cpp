@@ -0,0 +1,364 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <functional>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <process.h>
+#define	getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "NodeMesh2.h"
+#include "WLCSurface.h"
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+#include "CFSSurface.h"
+
+// includes
+#include "DOE2DL.H"
+#include "DFCache.h"
+#include "DFcalcs.h"
+#include "Radiosity.h"
+
+/* Binary daylight factor cache file header. */
+/* The header is followed by the bldg exterior horizontal illuminance arrays */
+/* (hillumskyc, hillumskyo, hillumsunc) and then, for each ref pt in zone order, */
+/* skycillum, suncillum, skyoillum, dfsky, dfsun and dfskyo, all as native doubles */
+/* laid out exactly as in BLDG and REFPT, so the file can be memory-mapped or read */
+/* straight into the structures. */
+/* The dump_bldg() and dump_lib() report of the calculation is kept next to it in */
+/* <hash>.dfr, so that a cached run writes the same output file as a fresh one. */
+/* Its byte count and hash are kept in the header, so that a truncated or mismatched */
+/* report is never taken as complete output. */
+typedef struct {
+	char magic[8];				/* DFCACHE_FILE_MAGIC */
+	unsigned long long hash;	/* content hash from dfcache_key() */
+	int nphs;					/* NPHS of the writer */
+	int nths;					/* NTHS of the writer */
+	int nzones;					/* # of zones */
+	int nrefpts;				/* total # of ref pts */
+	unsigned long long nreport;	/* # of bytes in the report file */
+	unsigned long long reporthash;	/* FNV-1a hash of the report file */
+} DFCHEADER;
+
+/****************************** subroutine fnv1a *****************************/
+/* Accumulates bytes into a 64 bit FNV-1a hash. */
+/****************************************************************************/
+/****************************** subroutine fnv1a *****************************/
+static void fnv1a(
+	unsigned long long *phash,	/* running hash */
+	const char *cbuf,			/* bytes */
+	size_t nbytes)				/* # of bytes */
+{
+	size_t ic;
+
+	for (ic=0; ic<nbytes; ic++) {
+		*phash ^= (unsigned char)cbuf[ic];
+		*phash *= 1099511628211ULL;
+	}
+}
+
+/****************************** subroutine dfcache_key *****************************/
+/* Computes the content hash identifying a daylight factor calculation: the bytes */
+/* of the DElight input file, the calculation parameters (including the radiosity and */
+/* adaptive window element tolerances), the size and date of */
+/* file-based CFS BTDF data, and the file format. */
+/* Returns 0 on success, -1 if the input file cannot be read. */
+/****************************************************************************/
+/****************************** subroutine dfcache_key *****************************/
+int dfcache_key(
+	char *sInputName,			/* DElight input file name */
+	BLDG *bldg_ptr,				/* bldg structure pointer (loaded from sInputName) */
+	SUN_DATA *sun_ptr,			/* sun data structure pointer */
+	int iIterations,			/* Number of radiosity iterations */
+	int iSurfNodes,				/* Desired total number of surface nodes */
+	int iWndoNodes,				/* Desired total number of window nodes */
+	unsigned long long *phash)	/* returned content hash */
+{
+	ostringstream osParams;
+	struct stat statFile;
+	char cbuf[65536];
+	int iz, is, isys;
+
+	*phash = 14695981039346656037ULL;
+
+	/* input file contents */
+	ifstream infile(sInputName, ios::in | ios::binary);
+	if (!infile) return(-1);
+	while (infile.read(cbuf,sizeof(cbuf)) || (infile.gcount() > 0)) fnv1a(phash,cbuf,(size_t)infile.gcount());
+	if (infile.bad()) return(-1);
+
+	/* calculation parameters and file format */
+	osParams.precision(17);
+	osParams << "|" << DFCACHE_FILE_MAGIC << "^" << NPHS << "^" << NTHS << "^" << sizeof(double)
+		<< "|" << iIterations << "^" << iSurfNodes << "^" << iWndoNodes
+		<< "|" << sun_ptr->nphs << "^" << sun_ptr->nths << "^" << sun_ptr->phsmin << "^" << sun_ptr->thsmin
+		<< "|" << radiosity_tolerance() << "^" << wndo_adapt_tolerance();
+
+	/* file-based CFS BTDF data */
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+		for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
+			for (isys=0; isys<(int)bldg_ptr->zone[iz]->surf[is]->vpCFSSystem.size(); isys++) {
+				CFSSystem *pCFSSystem = bldg_ptr->zone[iz]->surf[is]->vpCFSSystem[isys];
+				if (pCFSSystem->lp.source != "FILE") continue;
+				osParams << "|" << pCFSSystem->lp.filename;
+				if (stat(pCFSSystem->lp.filename.c_str(),&statFile) == 0)
+					osParams << "^" << (long long)statFile.st_size << "^" << (long long)statFile.st_mtime;
+			}
+		}
+	}
+	fnv1a(phash,osParams.str().c_str(),osParams.str().size());
+
+	return(0);
+}
+
+/****************************** subroutine dfcache_file_name *****************************/
+/* Returns the daylight factor cache file name: <hash>.dfc in the directory named by */
+/* the DELIGHT_DF_CACHE environment variable, or "" (no cache) if it is unset. */
+/****************************************************************************/
+/****************************** subroutine dfcache_file_name *****************************/
+string dfcache_file_name(
+	unsigned long long hash)	/* content hash from dfcache_key() */
+{
+	const char *cCacheDir = getenv("DELIGHT_DF_CACHE");
+	string sFile;
+	char cName[32];
+
+	if ((cCacheDir == NULL) || (cCacheDir[0] == '\0')) return(string());
+
+	sFile = cCacheDir;
+	if ((sFile[sFile.size()-1] != '/') && (sFile[sFile.size()-1] != '\\')) sFile += "/";
+	sprintf(cName,"%016llx.dfc",hash);
+
+	return(sFile + cName);
+}
+
+/****************************** subroutine dfcache_report_name *****************************/
+/* Returns the name of the report file kept next to a daylight factor cache file. */
+/****************************************************************************/
+/****************************** subroutine dfcache_report_name *****************************/
+static string dfcache_report_name(
+	string& sFile)				/* cache file name */
+{
+	return(sFile.substr(0,sFile.size()-4) + ".dfr");
+}
+
+/****************************** subroutine dfcache_rename *****************************/
+/* Moves a completely written temporary file over a cache file. */
+/****************************************************************************/
+/****************************** subroutine dfcache_rename *****************************/
+static void dfcache_rename(
+	string& sTmpFile,			/* temporary file name */
+	string& sFile)				/* cache file name */
+{
+	/* rename() does not replace an existing file on all platforms */
+	if (rename(sTmpFile.c_str(),sFile.c_str()) != 0) {
+		remove(sFile.c_str());
+		if (rename(sTmpFile.c_str(),sFile.c_str()) != 0) remove(sTmpFile.c_str());
+	}
+}
+
+/****************************** subroutine dfcache_load *****************************/
+/* Reads the results of CalcDFs() from a daylight factor cache file directly into */
+/* the BLDG and REFPT arrays of a building loaded from the same input, and the report */
+/* of the calculation into sReport (as the bytes to append to the output file). */
+/* Returns 1 if both files exist and match the hash and building, and the report */
+/* matches the byte count and hash in the header, else 0 */
+/* (the building arrays may then be partly overwritten and must be recalculated). */
+/****************************************************************************/
+/****************************** subroutine dfcache_load *****************************/
+int dfcache_load(
+	BLDG *bldg_ptr,				/* bldg structure pointer */
+	unsigned long long hash,	/* content hash from dfcache_key() */
+	string& sFile,				/* cache file name */
+	string& sReport)			/* returned bldg and lib data report */
+{
+	DFCHEADER hdr;
+	int iz, irp, nrefpts = 0;
+
+	for (iz=0; iz<bldg_ptr->nzones; iz++) nrefpts += bldg_ptr->zone[iz]->nrefpts;
+
+	ifstream infile(sFile.c_str(), ios::in | ios::binary);
+	if (!infile) return(0);
+	if (!infile.read((char *)&hdr,sizeof(hdr))) return(0);
+	if ((memcmp(hdr.magic,DFCACHE_FILE_MAGIC,sizeof(hdr.magic)) != 0) || (hdr.hash != hash)) return(0);
+	if ((hdr.nphs != NPHS) || (hdr.nths != NTHS) || (hdr.nzones != bldg_ptr->nzones) || (hdr.nrefpts != nrefpts)) return(0);
+
+	infile.read((char *)bldg_ptr->hillumskyc,sizeof(bldg_ptr->hillumskyc));
+	infile.read((char *)bldg_ptr->hillumskyo,sizeof(bldg_ptr->hillumskyo));
+	infile.read((char *)bldg_ptr->hillumsunc,sizeof(bldg_ptr->hillumsunc));
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+		for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
+			REFPT *ref_pt = bldg_ptr->zone[iz]->ref_pt[irp];
+			infile.read((char *)ref_pt->skycillum,sizeof(ref_pt->skycillum));
+			infile.read((char *)ref_pt->suncillum,sizeof(ref_pt->suncillum));
+			infile.read((char *)&ref_pt->skyoillum,sizeof(ref_pt->skyoillum));
+			infile.read((char *)ref_pt->dfsky,sizeof(ref_pt->dfsky));
+			infile.read((char *)ref_pt->dfsun,sizeof(ref_pt->dfsun));
+			infile.read((char *)&ref_pt->dfskyo,sizeof(ref_pt->dfskyo));
+		}
+	}
+	if (!infile) return(0);
+
+	ifstream reportfile(dfcache_report_name(sFile).c_str(), ios::in | ios::binary);
+	if (!reportfile) return(0);
+	ostringstream osReport;
+	osReport << reportfile.rdbuf();
+	if (reportfile.bad()) return(0);
+	sReport = osReport.str();
+	unsigned long long reporthash = 14695981039346656037ULL;
+	fnv1a(&reporthash,sReport.data(),sReport.size());
+	if ((sReport.size() != hdr.nreport) || (reporthash != hdr.reporthash)) return(0);
+
+	return(1);
+}
+
+/****************************** subroutine dfcache_save *****************************/
+/* Writes the results of CalcDFs() to a daylight factor cache file, and the bldg and */
+/* lib data report, from lReportPos to the end of the closed output file, to its report file. */
+/* Writes temporary files, unique to the process and thread, first and renames them, */
+/* the report first, so that concurrent runs sharing the cache directory never write */
+/* the same file or read a partial one. Failures are silently ignored (the cache is */
+/* only an accelerator). */
+/****************************************************************************/
+/****************************** subroutine dfcache_save *****************************/
+void dfcache_save(
+	BLDG *bldg_ptr,				/* bldg structure pointer */
+	unsigned long long hash,	/* content hash from dfcache_key() */
+	string& sFile,				/* cache file name */
+	char *sOutputName,			/* output file name */
+	long lReportPos)			/* offset of the bldg and lib data report in the output file */
+{
+	ostringstream osTmp;
+	string sTmpFile, sReportFile = dfcache_report_name(sFile);
+	DFCHEADER hdr;
+	int iz, irp;
+
+	osTmp << "." << getpid() << "." << std::hash<thread::id>()(this_thread::get_id()) << ".tmp";
+
+	memset(&hdr,0,sizeof(hdr));
+
+	/* The report is copied byte for byte, so that it keeps the line ends of the output file. */
+	sTmpFile = sReportFile + osTmp.str();
+	{
+		ifstream infile(sOutputName, ios::in | ios::binary);
+		if (!infile || !infile.seekg(lReportPos)) return;
+		ostringstream osReport;
+		osReport << infile.rdbuf();
+		if (infile.bad()) return;
+		string sReport = osReport.str();
+		hdr.nreport = sReport.size();
+		hdr.reporthash = 14695981039346656037ULL;
+		fnv1a(&hdr.reporthash,sReport.data(),sReport.size());
+		ofstream outfile(sTmpFile.c_str(), ios::out | ios::binary | ios::trunc);
+		if (!outfile) return;
+		outfile.write(sReport.data(),sReport.size());
+		if (!outfile) {
+			outfile.close();
+			remove(sTmpFile.c_str());
+			return;
+		}
+	}
+	dfcache_rename(sTmpFile,sReportFile);
+
+	memcpy(hdr.magic,DFCACHE_FILE_MAGIC,sizeof(hdr.magic));
+	hdr.hash = hash;
+	hdr.nphs = NPHS;
+	hdr.nths = NTHS;
+	hdr.nzones = bldg_ptr->nzones;
+	for (iz=0; iz<bldg_ptr->nzones; iz++) hdr.nrefpts += bldg_ptr->zone[iz]->nrefpts;
+
+	sTmpFile = sFile + osTmp.str();
+	{
+		ofstream outfile(sTmpFile.c_str(), ios::out | ios::binary | ios::trunc);
+		if (!outfile) return;
+		outfile.write((char *)&hdr,sizeof(hdr));
+		outfile.write((char *)bldg_ptr->hillumskyc,sizeof(bldg_ptr->hillumskyc));
+		outfile.write((char *)bldg_ptr->hillumskyo,sizeof(bldg_ptr->hillumskyo));
+		outfile.write((char *)bldg_ptr->hillumsunc,sizeof(bldg_ptr->hillumsunc));
+		for (iz=0; iz<bldg_ptr->nzones; iz++) {
+			for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
+				REFPT *ref_pt = bldg_ptr->zone[iz]->ref_pt[irp];
+				outfile.write((char *)ref_pt->skycillum,sizeof(ref_pt->skycillum));
+				outfile.write((char *)ref_pt->suncillum,sizeof(ref_pt->suncillum));
+				outfile.write((char *)&ref_pt->skyoillum,sizeof(ref_pt->skyoillum));
+				outfile.write((char *)ref_pt->dfsky,sizeof(ref_pt->dfsky));
+				outfile.write((char *)ref_pt->dfsun,sizeof(ref_pt->dfsun));
+				outfile.write((char *)&ref_pt->dfskyo,sizeof(ref_pt->dfskyo));
+			}
+		}
+		if (!outfile) {
+			outfile.close();
+			remove(sTmpFile.c_str());
+			return;
+		}
+	}
+	dfcache_rename(sTmpFile,sFile);
+}
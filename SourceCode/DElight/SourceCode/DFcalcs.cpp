@@ -77,6 +77,11 @@ namespace BGL = BldgGeomLib;
 #include "geom.h"
 #include "TOOLS.H"
 #include "Radiosity.h"
+#include "ShadeBVH.h"
+#include "TaskPool.h"
+#include "LumMapCache.h"
+#include "DLSession.h"
+#include "DLPhase.h"
 
 /****************************** subroutine CalcDFs *****************************/
 /* Calculates daylighting factors (interior illum / exterior horiz illum) */
@@ -113,8 +118,7 @@ int	CalcDFs(
 	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
 	int iphs, iths;					/* sun position indexes */
-	int izone, isurf, irp, icoord, iIntSurf, inode;	/* bldg component indexes */
-	int iw, igt, ic;				/* indexes */
+	int izone;						/* bldg component indexes */
 	double thsmin;		/* minimum sun postition azimuth (degrees: South=0.0, East=+90.0) */
 	double phsmin;					/* minimum sun postition altitude (degrees) */
 	double phsmax;					/* maximum sun position altitude (degrees) */
@@ -122,30 +126,10 @@ int	CalcDFs(
 	double phsun;				/* sun alt (radians) */
 	double thsun;				/* sun azm in FredW solar coordinate system [S=0, E=90] (radians) */
 	double phsun_deg;				/* sun alt (degrees) */
-	/* Window 4 code modification begin */
-	double cam1, cam2, cam3, cam4;	/* window coefs of trans holders */
-	double E10coef1,E10coef2,E10coef3,E10coef4;	/* Energy-10 angular dependence equation coefs */
-	double W4vis_fit1, W4vis_fit2;	// Window4 angular dependence equation coefs
-	/* Window 4 code modification end */
-	// EnergyPlus code modification
-	double EPlusCoef[6];	/* EnergyPlus angular dependence equation coefs */
-	double wnorm[NCOORDS];			/* window outward normal vector */
-	double node[NCOORDS];			/* surface node coordinate holder */
-	double nodesurfnormal[NCOORDS];		/* node surface INWARD normal unit vector */
-	double ww, hw;		/* surface and window geom vars */
 	double solic[MONTHS];	/* extraterrestrial irrad for 1st of each month (0 to 11) */
 	double zenl;				/* clear sky zenith luminance (Kcd/m2) */
 	double tfac;				/* turbidity factor */
-	double tvisdf;			/* visible trans vars */
-	double vis_trans;		/* visible transmittance of window for illum calcs */
-	double domega;	/* solid angle subtended by window wrt ref_pt */
-	HIT hit;				/* bldg-shade hit structure for dhitsh() test */
-	double rwin[NCOORDS];	/* center of window element */
-	double ray[NCOORDS];		/* ref_pt to center of window element vector */
-	double phray, thray;		/* ray angles */
-	double disq, ddis, dis;	/* ref_pt to window element distance vars */
-	double cosWndoIncidence; 	/* cos of angle between ray and window outward normal */
-	double tvisincidence;	/* tvis of glass for cosWndoIncidence angle */
+	SUNSKY sunsky;			/* sky constants for each sun position */
 
 	/* rjh 4/17/97 Move wsghit[][] outside dreflt() and CalcDiffuseWindowLuminance() to preserve values. */
 
@@ -183,6 +167,8 @@ int	CalcDFs(
 	if (sun_ptr->nths == 1) thsdel = 0.;
 	else thsdel = fabs(2.0 * thsmin) / (sun_ptr->nths - 1);
 
+	dl_phase(DLPHASE_SKY,1);
+
 	/* Calculate extraterrestrial direct normal solar illumination (lum/ft2) */
 	/* for the first day of each month. */
 	dsolic(solic);
@@ -231,248 +217,220 @@ int	CalcDFs(
 		}
 	}
 
-	/* ------ Direct (or Initial) Illuminance at Nodal Surfaces Calculation ------ */
+	/* Sky constants for each sun position, used for every window element ray below. */
+	dsunsky(&sunsky,bldg_ptr,IMREF,sun_ptr->nphs,sun_ptr->nths,phsmin,phsdel,thsmin,thsdel,solic,pofdmpfile);
 
-	/* Lighting Zone Loop */
-	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+	/* Shading polygon BVH for window element ray tests (geometry is final at this point). */
+	delete(bldg_ptr->bvh);
+	bldg_ptr->bvh = build_shade_bvh(bldg_ptr);
 
-		/* Exterior Surface Loop */
-		for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++) {
+	/* Node arrays sized from the final surface and window meshes */
+	if (alloc_bldg_arena(bldg_ptr,pofdmpfile) < 0) return(-1);
 
-			/* Window Loop */
-			for (iw=0; iw<bldg_ptr->zone[izone]->surf[isurf]->nwndos; iw++) {
-
-				/* get library index of current window glass type */
-				igt = lib_index(lib_ptr,"glass",bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->glass_type);
-				if (igt < 0) continue;
-				/* shorten often used bldg structure elements */
-				ww = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->width;
-				hw = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->height;
-
-				// Window 4 implementation 4/2002
-				// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
-				int iGlass_Type_ID = atoi(bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->glass_type);
-				if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
-
-					// DOE2 original angular dependence equation coefs
-					cam1 = lib_ptr->glass[igt]->cam1;
-					cam2 = lib_ptr->glass[igt]->cam2;
-					cam3 = lib_ptr->glass[igt]->cam3;
-					cam4 = lib_ptr->glass[igt]->cam4;
-
-					/* Diffuse and Normal transmittance for total solar spectrum. */
-					double tsoldf = lib_ptr->glass[igt]->cam9;
-					double tsolnm = cam1 + cam2 + cam3 + cam4;
-
-					/* Diffuse transmittance (for normal vis_trans = 1.0) */
-					tvisdf = (1.0 / tsolnm) * tsoldf;
-				}
-				else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
+	/* Session record of the direct contributions, sized from the same meshes */
+	if (bldg_ptr->session != NULL) session_init(bldg_ptr->session,bldg_ptr,sun_ptr,iIterations);
 
-					// Window4 angular dependence Fit4() function coefs.
-					W4vis_fit1 = lib_ptr->glass[igt]->W4vis_fit1;
-					W4vis_fit2 = lib_ptr->glass[igt]->W4vis_fit2;
+	/* ------ Direct (or Initial) Illuminance at Nodal Surfaces Calculation ------ */
 
-					/* Diffuse transmittance (for normal vis_trans = 1.0) */
-					tvisdf = lib_ptr->glass[igt]->W4hemi_trans / (lib_ptr->glass[igt]->vis_trans + 0.000001);
-				}
-				else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
+	/* Sky and CFS luminance map cache, shared by all zones */
+	free_lummap_cache(bldg_ptr->lmcache);
+	bldg_ptr->lmcache = new_lummap_cache();
 
-					// EnergyPlus/Window5 angular dependence POLYF() function coefs.
-					for (int icoef = 0; icoef < 6; icoef++)
-					{
-						EPlusCoef[icoef] = lib_ptr->glass[igt]->EPlusCoef[icoef];
-					}
+	dl_phase(DLPHASE_SKY,0);
+
+	/* Zones are independent from here on, so spread them over a thread pool if requested */
+	int nthreads = dl_num_threads();
+	if ((nthreads > 1) && (bldg_ptr->nzones > 1)) {
+		iReturnVal = CalcDFsZonePool(sun_ptr,bldg_ptr,lib_ptr,iIterations,&sunsky,phsmin,phsdel,thsmin,thsdel,solic,nthreads,pofdmpfile);
+	}
+	else {
+		/* Lighting Zone Loop */
+		for (izone=0; izone<bldg_ptr->nzones; izone++) {
+
+			// Direct Illuminance Calcs
+			int iZoneDirectRetVal;
+			dl_phase(DLPHASE_DIRECT,1);
+			iZoneDirectRetVal = CalcZoneDirectIllum(sun_ptr,bldg_ptr,lib_ptr,izone,&sunsky,phsmin,phsdel,thsmin,thsdel,solic,pofdmpfile);
+			dl_phase(DLPHASE_DIRECT,0);
+			if (iZoneDirectRetVal < 0) {
+				// If errors were detected then return now, else register warnings and continue processing
+				if (iZoneDirectRetVal != -10) return(-1);
+				else iReturnVal = -10;
+			}
 
-					/* Diffuse transmittance (for normal vis_trans = 1.0) */
-					// NOTE: never actually used
+			// Interreflection Calcs
+			int iSliteInterRflRetVal;
+			dl_phase(DLPHASE_INTERREFLECT,1);
+			if ((iSliteInterRflRetVal = slite_interreflect(bldg_ptr, lib_ptr, sun_ptr, iIterations, pofdmpfile)) < 0) {
+				// If errors were detected then return now, else register warnings and continue processing
+				if (iSliteInterRflRetVal != -10) {
+					*pofdmpfile << "ERROR: DElight Bad return from slite_interreflect()\n"; 
+					return(-1);
 				}
-				else if (iGlass_Type_ID < 0) {	// Energy-10
+				else {
+					iReturnVal = -10;
+				}
+			}
 
-					/* Energy-10 angular dependence equation coefs. */
-					E10coef1 = lib_ptr->glass[igt]->E10coef[0];
-					E10coef2 = lib_ptr->glass[igt]->E10coef[1];
-					E10coef3 = lib_ptr->glass[igt]->E10coef[2];
-					E10coef4 = lib_ptr->glass[igt]->E10coef[3];
+			// Daylight Factor Calcs
+			zone_daylight_factors(bldg_ptr,sun_ptr,izone);
+			dl_phase(DLPHASE_INTERREFLECT,0);
+		}	/* end of Lighting Zone Loop */
+	}
 
-					/* Diffuse transmittance (for normal vis_trans = 1.0) */
-					tvisdf = lib_ptr->glass[igt]->E10hemi_trans;
-				}
-				else continue;
+	/* Report zones whose interreflection did not converge to the requested tolerance */
+	if (((iReturnVal == 0) || (iReturnVal == -10)) && (radiosity_convergence(bldg_ptr,pofdmpfile) < 0))
+		iReturnVal = -10;
 
-				/* Visible transmittance for this window for ref_pt illum calcs. */
-				// NOTE: Not used for EnergyPlus/Window5 glass types
-				vis_trans = lib_ptr->glass[igt]->vis_trans;
+	free_lummap_cache(bldg_ptr->lmcache);
+	bldg_ptr->lmcache = NULL;
 
-				/* unit vector normal to window (pointing away from room) */
-				for (icoord=0; icoord<NCOORDS; icoord++) {
-                    wnorm[icoord] = bldg_ptr->zone[izone]->surf[isurf]->outward_uvect[icoord];
-                }
+	return(iReturnVal);
+}
 
-                // Switch from previous DOE2 window discretization method
-                // to new WLC meshing method for polygons
+/****************************** subroutine CalcZoneDirectIllum *****************************/
+/* Calculates the direct (initial) illuminance at the reference points and the direct */
+/* luminance at the surface nodes of one lighting zone, from its windows and CFS apertures, */
+/* for overcast sky and for clear sky and clear sun at each sun position. */
+/* Remeshes each window for the interreflection calcs once done with it. */
+/* With a bldg session, also records the contributions for DElightSessionRecalc4EPlus(). */
+/* Reads shared bldg, lib and sky data but writes only data belonging to zone izone, */
+/* so that zones may be processed concurrently. */
+/****************************************************************************/
+/****************************** subroutine CalcZoneDirectIllum *****************************/
+int	CalcZoneDirectIllum(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	int izone,			/* current zone index */
+	SUNSKY *psunsky,	/* pointer to sky constants for each sun position */
+	double phsmin,		/* minimum sun postition altitude (degrees) */
+	double phsdel,		/* sun position altitude increment (degrees) */
+	double thsmin,		/* minimum sun postition azimuth (degrees: South=0.0, East=+90.0) */
+	double thsdel,		/* sun position azimuth increment (degrees) */
+	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	int iphs, iths;					/* sun position indexes */
+	int isurf, irp, icoord, iIntSurf, inode;	/* bldg component indexes */
+	int iw, igt, ic;				/* indexes */
+	double phsun;				/* sun alt (radians) */
+	double thsun;				/* sun azm in FredW solar coordinate system [S=0, E=90] (radians) */
+	double phsun_deg;				/* sun alt (degrees) */
+	double wnorm[NCOORDS];			/* window outward normal vector */
+	double node[NCOORDS];			/* surface node coordinate holder */
+	double nodesurfnormal[NCOORDS];		/* node surface INWARD normal unit vector */
+	double ww, hw;		/* surface and window geom vars */
+	double zenl;				/* clear sky zenith luminance (Kcd/m2) */
+	double tfac;				/* turbidity factor */
+	double rwin[NCOORDS];	/* center of window element */
+	double dAdaptTol = wndo_adapt_tolerance();	/* adaptive window element tolerance (0 for uniform elements) */
+	int iAdaptCheck = wndo_adapt_check();		/* compare adaptive with uniform window elements? */
+	DLFIXED *pfixed;		/* session record of CFS contributions to a refpt or surfnode */
 
-                // Invoke WLC meshing method by reinvoking the WLCWNDOInit() method
-				// for approx. 1/2 unit squares (i.e., 1/2ft x 1/2ft)
-				// This means that ref pts beyond ~2ft from window will be accurate
-                // wrt the subtended solid angle calculation.
-                // Note that MaxGridNodeArea might get increased if number of nodes exceeds array limits.
-                bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->WLCWNDOInit(0.25);
+    // Init Return Value
+    int iReturnVal = 0;
 
-                // Loop through Wndo nodes
-	            for (int iWndoElement=0; iWndoElement<bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->nnodes; iWndoElement++) {
+	/* reset adaptive window element counts */
+	bldg_ptr->zone[izone]->wndo_elems_uniform = 0;
+	bldg_ptr->zone[izone]->wndo_elems_adaptive = 0;
+	bldg_ptr->zone[izone]->wndo_adapt_dev = -1.;
+
+	/* Exterior Surface Loop */
+	for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++) {
+
+		/* Window Loop */
+		for (iw=0; iw<bldg_ptr->zone[izone]->surf[isurf]->nwndos; iw++) {
+
+			/* get library index of current window glass type */
+			igt = lib_index(lib_ptr,"glass",bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->glass_type);
+			if (igt < 0) continue;
+			/* shorten often used bldg structure elements */
+			ww = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->width;
+			hw = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->height;
+
+			// Window 4 implementation 4/2002
+			// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library, >10000 => EnergyPlus/Window5
+			// (angular dependence of tvis is evaluated by glass_tvis())
+			int iGlass_Type_ID = atoi(bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->glass_type);
+			if (iGlass_Type_ID == 0) continue;
+			session_wndo_recorded(bldg_ptr->session,izone,isurf,iw);
+
+			/* unit vector normal to window (pointing away from room) */
+			for (icoord=0; icoord<NCOORDS; icoord++) {
+                wnorm[icoord] = bldg_ptr->zone[izone]->surf[isurf]->outward_uvect[icoord];
+            }
 
-                    // Tranfer the node position to the old rwin array.
-                    for (ic=0; ic<NCOORDS; ic++) {
-                        rwin[ic] = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node[iWndoElement][ic];
-                    }
+            // Switch from previous DOE2 window discretization method
+            // to new WLC meshing method for polygons
+
+            // Invoke WLC meshing method by reinvoking the WLCWNDOInit() method
+			// for approx. 1/2 unit squares (i.e., 1/2ft x 1/2ft)
+			// This means that ref pts beyond ~2ft from window will be accurate
+            // wrt the subtended solid angle calculation.
+            // Note that MaxGridNodeArea might get increased if number of nodes exceeds array limits.
+            bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->WLCWNDOInit(0.25);
+
+            // Adaptive mode: merge window elements per ref pt and surface node (see wndo_direct_adaptive())
+            if (dAdaptTol > 0.) {
+                int iAdaptRetVal = wndo_direct_adaptive(bldg_ptr, izone, isurf, iw, psunsky,
+                                        lib_ptr->glass[igt], iGlass_Type_ID, wnorm, dAdaptTol, iAdaptCheck, pofdmpfile);
+                if (iAdaptRetVal < 0) {
+                    // If errors were detected then return now, else register warnings and continue processing
+                    if (iAdaptRetVal != -10) return(-1);
+                    iReturnVal = -10;
+                }
+            }
+            else {
 
-						/* Reference Point Loop */
-						for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+	            // Loop through Wndo nodes
+	            for (int iWndoElement=0; iWndoElement<bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->nnodes; iWndoElement++) {
 
-							/* Calc ray from ref_pt to wndo element */
-							/* distance between ref_pt and element */
-							disq = 0.;
-							for (ic=0; ic<NCOORDS; ic++) {
-								ddis = rwin[ic] - bldg_ptr->zone[izone]->ref_pt[irp]->bs[ic];
-								disq += ddis * ddis;
-							}
-							dis = sqrt(disq);
-
-				            // Report distances that are too small for
-				            // accurate window-element solid angle calculation.
-				            if (dis < 2.0) {
-                                // Set Return value to Warning
-                                iReturnVal = -10;
-					            *pofdmpfile << "WARNING: DElight Inaccurate daylight illuminance calculation may result for lighting zone " <<bldg_ptr->zone[izone]->name << "\n";
-					            *pofdmpfile << "WARNING: for reference points closer than 2 feet from window " <<bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->name << "\n";
-                                if (dis <= 0.0) {
-					                *pofdmpfile << "WARNING: DElight Reference Point " << bldg_ptr->zone[izone]->ref_pt[irp]->name << " is positioned on the window surface and will be ignored.\n";
-                                    continue;
-                                }
-				            }
-
-							/* unit vector along ray from ref_pt to element */
-							for (ic=0; ic<NCOORDS; ic++)
-								ray[ic] = (rwin[ic] - bldg_ptr->zone[izone]->ref_pt[irp]->bs[ic]) / dis;
+	                // Tranfer the node position to the old rwin array.
+	                for (ic=0; ic<NCOORDS; ic++) {
+	                    rwin[ic] = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node[iWndoElement][ic];
+	                }
 
-							/* Determine if ray intersects a zone-shade or bldg-shade. */
-							/* NOTE: this includes all zone surfaces */
-							/* contrary to DOE2 check of only "self-shade" */
-							/* surfaces (in addition to zone and bldg shades). */
-							/* dhitsh() resets HIT structure */
-							dhitsh(&hit,bldg_ptr->zone[izone]->ref_pt[irp]->bs,ray,bldg_ptr,izone,isurf,isurf);
+						/* Set ref_pt unit vector "surface" face normal (all ref_pts assumed horizontal facing upward). */
+						nodesurfnormal[0] = 0.0;
+						nodesurfnormal[1] = 0.0;
+						nodesurfnormal[2] = 1.0;
 
-							/* Azm (-PI to PI) and alt (-PI/2 to PI/2) of ray (i.e., azm and alt of sky element) */
-							/* Azm = 0 is along x-axis of bldg coord sys. */
-							phray = asin(ray[2]);
-							if ((ray[0]==0.0) && (ray[1]==0.0)) thray = 0.;
-							else thray = atan2(ray[1],ray[0]);
+						/* Reference Point Loop */
+						for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
 
-// rjh debug
-//if (irp == 0) {
-//	*pofdmpfile << "Window Element ix = " << ix << " iy = " << iy << " icoords = " << rwin[0] << " " << rwin[1] << " " << rwin[2] << "\n"; 
-//	*pofdmpfile << " phray = " << phray << " thray = " << thray << "\n";
-//}
-
-							/* Calc solid angle subtended by element wrt ref_pt */
-							/* cos of angle between ray and window outward normal */
-							cosWndoIncidence = ddot(wnorm,ray);
-
-
-							/* Solid angle subtended by element wrt ref_pt */
-//							domega = dwx * dwy * cosWndoIncidence / disq;
-                            // Modified to use new node areas
-							domega = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node_areas[iWndoElement] * cosWndoIncidence / disq;
-
-							/* Calc tvis of glass for incidence angle */
-							// Window 4 implementation 4/2002
-							// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
-							if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
-								tvisincidence = max(0.0,(cam1+cosWndoIncidence*(cam2+cosWndoIncidence*(cam3+cosWndoIncidence*cam4))));
-							}
-							else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
-								tvisincidence = vis_trans * fit4(cosWndoIncidence, W4vis_fit1, W4vis_fit2);
-							}
-							else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
-								tvisincidence = POLYF(cosWndoIncidence, EPlusCoef);
-							}
-							else if (iGlass_Type_ID < 0) {	// Energy-10
-								tvisincidence = vis_trans * max(0.0,(cosWndoIncidence*(E10coef1+cosWndoIncidence*(E10coef2+cosWndoIncidence*(E10coef3+cosWndoIncidence*E10coef4)))));
-							}
-
-							/* Set ref_pt unit vector "surface" face normal (all ref_pts assumed horizontal facing upward). */
-							nodesurfnormal[0] = 0.0;
-							nodesurfnormal[1] = 0.0;
-							nodesurfnormal[2] = 1.0;
-
-							// Calculate Cos of angle between ray and inward normal unit vector for face of refpt plane.
-							double cosPtSurfIncidence = ddot(nodesurfnormal,ray);
-
-							/* Sun Position Altitude Loop */
-							for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-
-								/* Altitude of sun */
-								phsun_deg = phsmin + (double)iphs * phsdel;
-								phsun = phsun_deg * DTOR;
-
-								/* Get clear sky zenith luminance, moisture, */
-								/* and turbidity coef for reference month. */
-								dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
-
-								/* Sun Position Azimuth Loop */
-								for (iths=0; iths<sun_ptr->nths; iths++) {
-
-									/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
-									thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
-
-									/* Add contribution of current wndo element to */
-									/* direct illum at current ref_pt, */
-									/* for current sky condition. */
-									int iWndoContribRetVal = wndo_element_refpt_illum_contrib(bldg_ptr,		/* pointer to bldg structure */
-															lib_ptr,		/* pointer to lib structure */
-															izone,			/* current zone index */
-															isurf,			/* current surface index for Surface containing Window */
-															isurf,			/* current node surface index NOT applicable */
-															iw,				/* current window index */
-															iWndoElement,	/* window element index */
-															thsun,			/* sun azm (radians) */
-															phsun,			/* sun alt (radians) */
-															thray,			/* sky element azm angle */
-															phray,			/* sky element alt angle */
-															iphs,			/* sun alt index */
-															iths,			/* sun azm index */
-															solic,			/* extraterrestrial irrad for 1st of each month (0 to 11) */
-															bldg_ptr->zone[izone]->ref_pt[irp]->bs,	/* coords of refpt */
-															nodesurfnormal,	/* INWARD normal unit vector from face of refpt virtual surface */
-															cosPtSurfIncidence,	/* cos(angle of incidence) of vector from refpt (on horiz plane) to wndo element */
-															&hit,			/* hit structure pointer for ray from refpt to wndo element */
-															domega,			/* solid angle subtended by window element wrt ref_pt */
-															vis_trans,		/* tvis of glass for normal window incidence angle */
-															tvisincidence,	/* tvis of glass for current window incidence angle */
-															wnorm,			/* window outward normal vector */
-															tfac,			/* turbidity factor */
-															zenl,			/* zenith luminance */
-															// return values stored in ref pt substructure
-															&(bldg_ptr->zone[izone]->ref_pt[irp]->direct_skycillum[iphs][iths]),	/* ptr to direct illuminance from sky - clear */
-															&(bldg_ptr->zone[izone]->ref_pt[irp]->direct_suncillum[iphs][iths]),	/* ptr to direct illuminance from sun - clear */
-															&(bldg_ptr->zone[izone]->ref_pt[irp]->direct_skyoillum),				/* ptr to direct illuminance from sky - overcast */
-															pofdmpfile);		/* ptr to LBLDLL error dump file */
-                                    // Check return value for error/warning
-                                    if (iWndoContribRetVal < 0) {
-                                        // If errors were detected then return now, else register warnings and continue processing
-                                        if (iWndoContribRetVal != -10) {
-					                        *pofdmpfile << "ERROR: DElight Bad return from wndo_element_refpt_illum_contrib()\n"; 
-					                        return(-1);
-                                        }
-                                        else {
-                                            iReturnVal = -10;
-                                        }
-                                    }
-
-								}	/* end of Sun Position Azimuth Loop */
-
-							}	/* end of Sun Position Altitude Loop */
+							/* Add contribution of current wndo element to */
+							/* direct illum at current ref_pt, */
+							/* for all sun positions. */
+							int iWndoContribRetVal = wndo_element_direct_ray(bldg_ptr,		/* pointer to bldg structure */
+													izone,			/* current zone index */
+													isurf,			/* current surface index for Surface containing Window */
+													isurf,			/* current node surface index NOT applicable */
+													iw,				/* current window index */
+													iWndoElement,	/* window element index */
+													irp,			/* current ref pt index */
+													psunsky,		/* sky constants for each sun position */
+													rwin,			/* center of window element */
+													bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node_areas[iWndoElement],	/* area of window element */
+													bldg_ptr->zone[izone]->ref_pt[irp]->bs,	/* coords of refpt */
+													nodesurfnormal,	/* INWARD normal unit vector from face of refpt virtual surface */
+													1.0,			/* no reflectance, illuminance at refpt */
+													0,				/* ray from refpt never sees the ground */
+													lib_ptr->glass[igt],	/* window glass type */
+													iGlass_Type_ID,	/* window glass type ID */
+													wnorm,			/* window outward normal vector */
+													session_tvis_mom(bldg_ptr->session,izone,isurf,iw,-1,irp),	/* session record */
+													// return values stored in ref pt substructure
+													bldg_ptr->zone[izone]->ref_pt[irp]->direct_skycillum,	/* direct illuminance from sky - clear */
+													bldg_ptr->zone[izone]->ref_pt[irp]->direct_suncillum,	/* direct illuminance from sun - clear */
+													&(bldg_ptr->zone[izone]->ref_pt[irp]->direct_skyoillum),	/* ptr to direct illuminance from sky - overcast */
+													pofdmpfile);		/* ptr to LBLDLL error dump file */
+	                        // Check return value for error/warning
+	                        if (iWndoContribRetVal < 0) {
+	                            // If errors were detected then return now, else register warnings and continue processing
+	                            if (iWndoContribRetVal != -10) return(-1);
+	                            else iReturnVal = -10;
+	                        }
 
 						}	/* end of Reference Point Loop */
 
@@ -498,1051 +456,1376 @@ int	CalcDFs(
 								for (ic=0; ic<NCOORDS; ic++)
 									node[ic] = bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][ic];
 
-								/* Calc ray from node to wndo element */
-								/* distance between node and element */
-								disq = 0.;
-								for (ic=0; ic<NCOORDS; ic++) {
-									ddis = rwin[ic] - node[ic];
-									disq += ddis * ddis;
-								}
-								dis = sqrt(disq);
-
-				                // Report distances that are too small for
-				                // accurate window-element solid angle calculation.
-								// RJH 2008-03-07: skip this warning and accept potential error
-//				                if (dis < 2.0) {
-                                    // Set return value for warning
-//                                    iReturnVal = -10;
-//					                *pofdmpfile << "WARNING: DElight Inaccurate daylight illuminance calculation may result for lighting zone " <<bldg_ptr->zone[izone]->name << "\n";
-//					                *pofdmpfile << "WARNING: for surface nodes closer than 2 feet from window " <<bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->name << "\n";
-//                                  if (dis <= 0.0) {
-//					                    *pofdmpfile << "WARNING: DElight Surface Node " << inode << " on Surface " << bldg_ptr->zone[izone]->surf[iIntSurf]->name << " is positioned on the window surface and will be ignored.\n";
-//                                      continue;
-//                                  }
-//				                }
-
-								/* unit vector along ray from node to element */
-								for (ic=0; ic<NCOORDS; ic++)
-									ray[ic] = (rwin[ic] - node[ic]) / dis;
-
-								/* Determine if ray intersects a zone-shade or bldg-shade. */
-								/* NOTE: this includes all zone surfaces */
-								/* contrary to DOE2 check of only "self-shade" */
-								/* surfaces (in addition to zone and bldg shades). */
-								/* dhitsh() sets HIT structure */
-								dhitsh(&hit,node,ray,bldg_ptr,izone,isurf,iIntSurf);
-
-								/* Azm (-PI to PI) and alt (-PI/2 to PI/2) of ray (i.e., azm and alt of sky element) */
-								/* Azm = 0 is along x-axis of bldg coord sys. */
-								phray = asin(ray[2]);
-								if ((ray[0]==0.0) && (ray[1]==0.0)) thray = 0.;
-								else thray = atan2(ray[1],ray[0]);
-
-								/* Calc cos of angle between ray and window outward normal */
-								cosWndoIncidence = ddot(wnorm,ray);
-
-								/* Calc solid angle subtended by element wrt node */
-//								domega = dwx * dwy * cosWndoIncidence / disq;
-                                // Modified to use new node areas
-							    domega = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node_areas[iWndoElement] * cosWndoIncidence / disq;
-
-								/* Calc tvis of glass for incidence angle */
-								// Window 4 implementation 4/2002
-								// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
-								if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
-									tvisincidence = max(0.0,(cam1+cosWndoIncidence*(cam2+cosWndoIncidence*(cam3+cosWndoIncidence*cam4))));
-								}
-								else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
-									tvisincidence = vis_trans * fit4(cosWndoIncidence, W4vis_fit1, W4vis_fit2);
-								}
-								else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
-									tvisincidence = POLYF(cosWndoIncidence, EPlusCoef);
-								}
-								else if (iGlass_Type_ID < 0) {	// Energy-10
-									tvisincidence = vis_trans * max(0.0,(cosWndoIncidence*(E10coef1+cosWndoIncidence*(E10coef2+cosWndoIncidence*(E10coef3+cosWndoIncidence*E10coef4)))));
-								}
-
-								// Calculate Cos of angle between ray and inward normal unit vector for face of node surface plane.
-								double cosPtSurfIncidence = ddot(nodesurfnormal,ray);
-
-								/* Sun Position Altitude Loop */
-								for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-
-									/* Altitude of sun */
-									phsun_deg = phsmin + (double)iphs * phsdel;
-									phsun = phsun_deg * DTOR;
-
-									/* Get clear sky zenith luminance, moisture, */
-									/* and turbidity coef for reference month. */
-									dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
-
-									/* Sun Position Azimuth Loop */
-									for (iths=0; iths<sun_ptr->nths; iths++) {
-
-										/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
-										thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
-
-										/* Add contribution of current wndo element to */
-										/* direct luminance at current surface node, */
-										/* for current sky condition. */
-										wndo_element_surfnode_lum_contrib(bldg_ptr,		/* pointer to bldg structure */
-																lib_ptr,		/* pointer to lib structure */
-																izone,			/* current zone index */
-																isurf,			/* current surface index for Surface containing Window */
-																iIntSurf,		/* current surface index for Surface containing Node */
-																iw,				/* current window index */
-															    iWndoElement,	/* window element index */
-																thsun,			/* sun azm (radians) */
-																phsun,			/* sun alt (radians) */
-																thray,			/* sky element azm angle */
-																phray,			/* sky element alt angle */
-																iphs,			/* sun alt index */
-																iths,			/* sun azm index */
-																solic,			/* extraterrestrial irrad for 1st of each month (0 to 11) */
-																node,			/* coords of surfnode */
-																nodesurfnormal,	/* INWARD normal unit vector from face of surfnode */
-																dNodeSurfaceReflectance, // visible reflectance of node surface
-																cosPtSurfIncidence,	/* cos(angle of incidence) of vector from surfnode (on surface plane) to wndo element */
-																&hit,			/* hit structure pointer for ray from surfnode to wndo element */
-																domega,			/* solid angle subtended by window element wrt surfnode */
-																vis_trans,		/* tvis of glass for normal incidence angle */
-																tvisincidence,	/* tvis of glass for current incidence angle */
-																wnorm,			/* window outward normal vector */
-																tfac,			/* turbidity factor */
-																zenl,			/* zenith luminance */
-																// return values stored in surf node, or wndo node substructure
-																&(bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyclum[inode][iphs][iths]),	/* ptr to direct luminance from sky - clear */
-																&(bldg_ptr->zone[izone]->surf[iIntSurf]->direct_sunclum[inode][iphs][iths]),	/* ptr to direct luminance from sun - clear */
-																&(bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyolum[inode]),				/* ptr to direct luminance from sky - overcast */
-																pofdmpfile);	/* ptr to LBLDLL error dump file */
-
-									}	/* end of Sun Position Azimuth Loop */
-
-								}	/* end of Sun Position Altitude Loop */
+								/* Add contribution of current wndo element to */
+								/* direct luminance at current surface node, */
+								/* for all sun positions. */
+								int iWndoContribRetVal = wndo_element_direct_ray(bldg_ptr,		/* pointer to bldg structure */
+														izone,			/* current zone index */
+														isurf,			/* current surface index for Surface containing Window */
+														iIntSurf,		/* current surface index for Surface containing Node */
+														iw,				/* current window index */
+														iWndoElement,	/* window element index */
+														-1,				/* not a ref pt */
+														psunsky,		/* sky constants for each sun position */
+														rwin,			/* center of window element */
+														bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->node_areas[iWndoElement],	/* area of window element */
+														node,			/* coords of surfnode */
+														nodesurfnormal,	/* INWARD normal unit vector from face of surfnode */
+														dNodeSurfaceReflectance, // visible reflectance of node surface
+														1,				/* ray from surfnode can see the ground */
+														lib_ptr->glass[igt],	/* window glass type */
+														iGlass_Type_ID,	/* window glass type ID */
+														wnorm,			/* window outward normal vector */
+														session_tvis_mom(bldg_ptr->session,izone,isurf,iw,iIntSurf,inode),	/* session record */
+														// return values stored in surf node substructure
+														bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyclum[inode],	/* direct luminance from sky - clear */
+														bldg_ptr->zone[izone]->surf[iIntSurf]->direct_sunclum[inode],	/* direct luminance from sun - clear */
+														&(bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyolum[inode]),	/* ptr to direct luminance from sky - overcast */
+														pofdmpfile);	/* ptr to LBLDLL error dump file */
+	                            // Check return value for error
+	                            if ((iWndoContribRetVal < 0) && (iWndoContribRetVal != -10)) return(-1);
 
 							}	/* end of Surface Nodal Patch Loop */
 
 						}	/* end of Interior Surface Loop */
 
-//					}	/* end of y division Window Element Loop */
-
-//				}	/* end of x division Window Element Loop */
-
 				}	/* end of new Window Element Loop */
 
-                // Now remesh this window using WLC meshing method
-				// based on the user input max grid node area for interreflection calcs
-                bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->WLCWNDOInit(bldg_ptr->zone[izone]->max_grid_node_area);
-			}	/* end of Window Loop */
-
-			/* CFS Surface Loop */
-			for (int icfs = 0; icfs < bldg_ptr->zone[izone]->surf[isurf]->ncfs; icfs++) {
-
-                // Get the CFSSystem for this CFSSurface
-                CFSSystem* pCFSSystem4CFSSurf = NULL;
-                string sCFSSystemType = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TypeName();
-                // Search for the CFSSystem of this Type associated with the current Surface
-                for (int iCFSSys = 0; iCFSSys < (int)bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem.size(); iCFSSys++) {
-                    if (bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem[iCFSSys]->TypeName() == sCFSSystemType) {
-                        pCFSSystem4CFSSurf = bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem[iCFSSys];
-                        break;
-                    }
-                }
-                // Output failure to find CFSSystem for this CFSSurface
-                if (!pCFSSystem4CFSSurf) {
-				    *pofdmpfile << "ERROR: DElight No CFSSystem of Type " << sCFSSystemType << " found for Surface " << bldg_ptr->zone[izone]->surf[isurf]->name << "\n";
-		            return -1;
+            }	/* end of uniform window elements */
+
+            // Now remesh this window using WLC meshing method
+			// based on the user input max grid node area for interreflection calcs
+            bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->WLCWNDOInit(bldg_ptr->zone[izone]->max_grid_node_area);
+			// Node positions may have changed, so drop any form factors cached for the old mesh
+			delete(bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->ff);
+			bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->ff = NULL;
+		}	/* end of Window Loop */
+
+		/* CFS Surface Loop */
+		if (bldg_ptr->zone[izone]->surf[isurf]->ncfs > 0) dl_phase(DLPHASE_CFS,1);
+		for (int icfs = 0; icfs < bldg_ptr->zone[izone]->surf[isurf]->ncfs; icfs++) {
+
+            // Get the CFSSystem for this CFSSurface
+            CFSSystem* pCFSSystem4CFSSurf = NULL;
+            string sCFSSystemType = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TypeName();
+            // Search for the CFSSystem of this Type associated with the current Surface
+            for (int iCFSSys = 0; iCFSSys < (int)bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem.size(); iCFSSys++) {
+                if (bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem[iCFSSys]->TypeName() == sCFSSystemType) {
+                    pCFSSystem4CFSSurf = bldg_ptr->zone[izone]->surf[isurf]->vpCFSSystem[iCFSSys];
+                    break;
                 }
+            }
+            // Output failure to find CFSSystem for this CFSSurface
+            if (!pCFSSystem4CFSSurf) {
+			    *pofdmpfile << "ERROR: DElight No CFSSystem of Type " << sCFSSystemType << " found for Surface " << bldg_ptr->zone[izone]->surf[isurf]->name << "\n";
+	            return -1;
+            }
+
+            // First distribute the Overcast Sky contribution to all interior surface nodes and to reference points
+
+            // Create an Overcast Sky and CFSSystem Luminance Map for the current CFSSurface
+            // HemiSphiral resolution
+            int sphiralM = 200;
+            int sphiralN = 1000;
+            // Create the DNA string for CIE Overcast Sky
+            // "SKY^GEN^CIEOVERCASTSKY^SunAlt^GrndRefl"
+			// For 0th sun position altitude
+			phsun_deg = phsmin;
+            char cSkyStr[MAX_CHAR_LINE];
+            strcpy(cSkyStr,"");
+            sprintf(cSkyStr,"SKY^GEN^CIEOVERCASTSKY^%6.2lf^%4.2lf", phsun_deg, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
+            // Generate the sky and its CFSSystem Luminance Map, or reuse cached ones
+            HemiSphiral	LumMapOvercast;
+            if (cfs_lummap(bldg_ptr->lmcache, pCFSSystem4CFSSurf, cSkyStr, sphiralM, sphiralN, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)), "Overcast Sky", LumMapOvercast, pofdmpfile) < 0) {
+                return -1;
+            }
+            // Reset the current CFSSurface Luminance Map
+            bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapOvercast);
+
+            // Now loop over all Surface Nodes adding Overcast Sky component
+			/* Interior Surface Loop */
+			for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
+
+				// Skip the current surface.
+				if (iIntSurf == isurf) continue;
+
+				// Get the visible reflectance of this surface.
+				double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
+
+				// Get surface inward normal unit vector and transfer to Vec3d.
+				BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
+					bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
+					bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
+
+				/* Surface Nodal Patch Loop */
+				for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
+
+					// Get nodal patch coords and transfer to Point3d.
+					BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
+						bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
+						bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
+
+					// Get surface nodal patch area.
+					double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
+
+					// Get the Overcast Sky illuminance on this node from the current CFS.
+					double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
+
+                    // Add this Overcast Sky illuminance to the Surface Total Direct Illuminance from Overcast sky
+		            bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectOvercastIllum += dCFSTotalIllum;
+
+                    // Add the resulting Luminance from this CFS contribution to the Surface Node
+                    // Note that Luminance is Illuminance * Surface Reflectance
+		            bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyolum[inode] += dCFSTotalIllum * dNodeSurfaceReflectance;
+		            if ((pfixed = session_fixed(bldg_ptr->session,izone,iIntSurf,inode)) != NULL) pfixed->skyo += dCFSTotalIllum;
+
+				}	/* end of Surface Nodal Patch Loop */
+
+			}	/* end of Interior Surface Loop */
+
+            // Now loop over all Reference Points adding Overcast Sky component
+
+			/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
+			BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
+
+			/* Reference Point Loop */
+			for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+
+				// Get refpt coords and transfer to Point3d.
+				BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
+					bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
+					bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
+
+				// Get the Overcast Sky illuminance at this refpt from the current CFS.
+				double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
+				bldg_ptr->zone[izone]->ref_pt[irp]->direct_skyoillum += dCFSTotalIllum;
+				if ((pfixed = session_fixed(bldg_ptr->session,izone,-1,irp)) != NULL) pfixed->skyo += dCFSTotalIllum;
+
+			}	/* end of Reference Point Loop */
+
+            // Next distribute the Clear Direct Sun contribution to all interior surface nodes and to reference points
+            // for all Sun Positions
+
+			/* Sun Position Altitude Loop */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
 
-                // First distribute the Overcast Sky contribution to all interior surface nodes and to reference points
-
-                // Create an Overcast Sky and CFSSystem Luminance Map for the current CFSSurface
-                // HemiSphiral resolution
-	            int sphiralM = 200;
-	            int sphiralN = 1000;
-                // Create the DNA string for CIE Overcast Sky
-                // "SKY^GEN^CIEOVERCASTSKY^SunAlt^GrndRefl"
-				// For 0th sun position altitude
-				phsun_deg = phsmin;
-                char cSkyStr[MAX_CHAR_LINE];
-	            strcpy(cSkyStr,"");
-	            sprintf(cSkyStr,"SKY^GEN^CIEOVERCASTSKY^%6.2lf^%4.2lf", phsun_deg, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
-	            string	skyStr = cSkyStr;
-                // Decode the DNA string
-	            LumParam lpsky;
-	            if (!SecretDecoderRing(lpsky,skyStr)) {
-				    *pofdmpfile << "ERROR: DElight Incorrect Sky Generation Parameter - " << lpsky.BadName << "\n";
-		            return -1;
-	            }
-                // Generate the Overcast Sky
-//	            HemiSphiral	skyOvercast = GenSky(sphiralN, lpsky);
-				// Set the hemisphiral resolutions
-				lpsky.btdfHSResIn = sphiralM;
-				lpsky.btdfHSResOut = sphiralN;
-	            HemiSphiral	skyOvercast = GenSky(lpsky);
-	            if (skyOvercast.size() == 0) {
-				    *pofdmpfile << "ERROR: DElight HemiSphiral for Overcast Sky Size == ZERO\n";
-		            return -1;
-	            }
-
-// Progress indicator
-//    cout << ".";
-//    cout << "Overcast Sky\n";
-//	skyOvercast.plotview(75);
-//	skyOvercast.plotview(75,DegToRad(0),DegToRad(0),DegToRad(0));
-
-                // Create the CFSSystem Luminance Map for this sky type
-//	            HemiSphiral	LumMapOvercast = pCFSSystem4CFSSurf->CFSLuminanceMap(sphiralM, sphiralN, skyOvercast, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	            HemiSphiral	LumMapOvercast = pCFSSystem4CFSSurf->CFSLuminanceMap(skyOvercast, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	            if (LumMapOvercast.size() == 0) {
-				    *pofdmpfile << "ERROR: DElight HemiSphiral CFS Luminance Map Size == ZERO\n";
-		            return -1;
-	            }
-                // Reset the current CFSSurface Luminance Map
-                bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapOvercast);
-
-                // Now loop over all Surface Nodes adding Overcast Sky component
-				/* Interior Surface Loop */
-				for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
-
-					// Skip the current surface.
-					if (iIntSurf == isurf) continue;
-
-					// Get the visible reflectance of this surface.
-					double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
-
-					// Get surface inward normal unit vector and transfer to Vec3d.
-					BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
-						bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
-						bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
-
-					/* Surface Nodal Patch Loop */
-					for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
-
-						// Get nodal patch coords and transfer to Point3d.
-						BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
-							bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
-							bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
-
-						// Get surface nodal patch area.
-						double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
-
-						// Get the Overcast Sky illuminance on this node from the current CFS.
-						double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
-
-                        // Add this Overcast Sky illuminance to the Surface Total Direct Illuminance from Overcast sky
-			            bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectOvercastIllum += dCFSTotalIllum;
-
-                        // Add the resulting Luminance from this CFS contribution to the Surface Node
-                        // Note that Luminance is Illuminance * Surface Reflectance
-			            bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyolum[inode] += dCFSTotalIllum * dNodeSurfaceReflectance;
-
-					}	/* end of Surface Nodal Patch Loop */
-
-				}	/* end of Interior Surface Loop */
-
-                // Now loop over all Reference Points adding Overcast Sky component
-
-				/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
-				BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
-
-				/* Reference Point Loop */
-				for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
-
-					// Get refpt coords and transfer to Point3d.
-					BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
-						bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
-						bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
-
-					// Get the Overcast Sky illuminance at this refpt from the current CFS.
-					double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
-					bldg_ptr->zone[izone]->ref_pt[irp]->direct_skyoillum += dCFSTotalIllum;
-
-				}	/* end of Reference Point Loop */
-
-                // Next distribute the Clear Direct Sun contribution to all interior surface nodes and to reference points
-                // for all Sun Positions
-
-				/* Sun Position Altitude Loop */
-				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-
-					/* Altitude of sun */
-					phsun_deg = phsmin + (double)iphs * phsdel;
-					phsun = phsun_deg * DTOR;
-
-					/* Get clear sky zenith luminance, moisture, */
-					/* and turbidity coef for reference month. */
-					dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
-
-                    /* Sun Position Azimuth Loop */
-					for (iths=0; iths<sun_ptr->nths; iths++) {
-
-						/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
-						thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
-
-                        // Create a Clear Sun sky and CFSSystem Luminance Map for the current Sun Position and CFSSurface
-                        // HemiSphiral resolution
-	                    sphiralM = 200;
-	                    sphiralN = 2000; // BUT also see below for high altitudes
-                        // Create the DNA string for CIE Clear Sun sky
-                        // "SKY^GEN^CIECLEARSUN^SunAlt^SunAzm^Solic^TFac^AtmMoi^AtmTurb^BldgAlt^GrndRefl"
-				        // For current sun position
-                        // Convert Aziumth angle in radians to degrees
-                        // and make sure it falls within -180 to 180
-                        double thsun_deg = thsun/DTOR;
-                        if (thsun_deg < -180.) thsun_deg += 360.;
-                        if (thsun_deg > 180.) thsun_deg -= 360.;
-                        if (phsun_deg > 60) {
-                            sphiralN = 6000;
-                            if (thsun_deg > 150.) {
-                                sphiralN = 10000;
-                            }
+				/* Altitude of sun */
+				phsun_deg = phsmin + (double)iphs * phsdel;
+				phsun = phsun_deg * DTOR;
+
+				/* Get clear sky zenith luminance, moisture, */
+				/* and turbidity coef for reference month. */
+				dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
+
+                /* Sun Position Azimuth Loop */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
+
+					/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
+					thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
+
+                    // Create a Clear Sun sky and CFSSystem Luminance Map for the current Sun Position and CFSSurface
+                    // HemiSphiral resolution
+                    sphiralM = 200;
+                    sphiralN = 2000; // BUT also see below for high altitudes
+                    // Create the DNA string for CIE Clear Sun sky
+                    // "SKY^GEN^CIECLEARSUN^SunAlt^SunAzm^Solic^TFac^AtmMoi^AtmTurb^BldgAlt^GrndRefl"
+			        // For current sun position
+                    // Convert Aziumth angle in radians to degrees
+                    // and make sure it falls within -180 to 180
+                    double thsun_deg = thsun/DTOR;
+                    if (thsun_deg < -180.) thsun_deg += 360.;
+                    if (thsun_deg > 180.) thsun_deg -= 360.;
+                    if (phsun_deg > 60) {
+                        sphiralN = 6000;
+                        if (thsun_deg > 150.) {
+                            sphiralN = 10000;
                         }
-	                    strcpy(cSkyStr,"");
-	                    sprintf(cSkyStr,"SKY^GEN^CIECLEARSUN^%6.2lf^%6.2lf^%10.4lf^%10.4lf^%6.2lf^%6.2lf^%8.2lf^%4.2lf", phsun_deg, thsun_deg, solic[IMREF], tfac, bldg_ptr->atmmoi[IMREF], bldg_ptr->atmtur[IMREF], bldg_ptr->alt, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
-	                    string	skyStr = cSkyStr;
-//    cout << skyStr << "\n";
-                        // Decode the DNA string
-	                    if (!SecretDecoderRing(lpsky,skyStr)) {
-				            *pofdmpfile << "ERROR: DElight Incorrect Sky Generation Parameter - " << lpsky.BadName << "\n";
-		                    return -1;
-	                    }
-//    lpsky.Dump();
-                        // Generate the sky
-//	                    HemiSphiral	skyClearSun = GenSky(sphiralN, lpsky);
-						// Set the hemisphiral resolutions
-						lpsky.btdfHSResIn = sphiralM;
-						lpsky.btdfHSResOut = sphiralN;
-	                    HemiSphiral	skyClearSun = GenSky(lpsky);
-	                    if (skyClearSun.size() == 0) {
-				            *pofdmpfile << "ERROR: DElight HemiSphiral for Clear Sun Size == ZERO\n";
-		                    return -1;
-	                    }
-// Progress indicator
-//    cout << ".";
-//    cout << "Clear Sun: Alt = " << phsun_deg << " Azm = " << RadToDeg(thsun) << "\n";
-//	skyClearSun.plotview(75);
-//	skyClearSun.plotview(75,DegToRad(0),DegToRad(90),DegToRad(0));
-
-                        // Create the new CFSSystem Luminance Map for this sky type
-//	                    HemiSphiral	LumMapClearSun = pCFSSystem4CFSSurf->CFSLuminanceMap(sphiralM, sphiralN, skyClearSun, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	                    HemiSphiral	LumMapClearSun = pCFSSystem4CFSSurf->CFSLuminanceMap(skyClearSun, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	                    if (LumMapClearSun.size() == 0) {
-				            *pofdmpfile << "ERROR: DElight HemiSphiral for CFS Luminance Map Size == ZERO\n";
-		                    return -1;
-	                    }
-                        // Reset the CFSSurface Luminance Map
-                        bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapClearSun);
-
-                        // Now loop over all Surface Nodes adding Clear Sun component for current Sun Position
-
-                        /* Interior Surface Loop */
-						for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
+                    }
+                    strcpy(cSkyStr,"");
+                    sprintf(cSkyStr,"SKY^GEN^CIECLEARSUN^%6.2lf^%6.2lf^%10.4lf^%10.4lf^%6.2lf^%6.2lf^%8.2lf^%4.2lf", phsun_deg, thsun_deg, solic[IMREF], tfac, bldg_ptr->atmmoi[IMREF], bldg_ptr->atmtur[IMREF], bldg_ptr->alt, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
+                    // Generate the sky and its CFSSystem Luminance Map, or reuse cached ones
+                    HemiSphiral	LumMapClearSun;
+                    if (cfs_lummap(bldg_ptr->lmcache, pCFSSystem4CFSSurf, cSkyStr, sphiralM, sphiralN, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)), "Clear Sun", LumMapClearSun, pofdmpfile) < 0) {
+                        return -1;
+                    }
+                    // Reset the current CFSSurface Luminance Map
+                    bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapClearSun);
 
-							// Skip the current surface.
-							if (iIntSurf == isurf) continue;
+                    // Now loop over all Surface Nodes adding Clear Sun component for current Sun Position
 
-					        // Get the visible reflectance of this surface.
-					        double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
+                    /* Interior Surface Loop */
+					for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
 
-							// Get surface inward normal unit vector and transfer to Vec3d.
-							BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
-								bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
-								bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
+						// Skip the current surface.
+						if (iIntSurf == isurf) continue;
 
-							/* Surface Nodal Patch Loop */
-							for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
+				        // Get the visible reflectance of this surface.
+				        double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
 
-								// Get nodal patch coords and transfer to Point3d.
-								BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
-									bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
-									bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
+						// Get surface inward normal unit vector and transfer to Vec3d.
+						BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
+							bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
+							bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
 
-							    // Get surface nodal patch area.
-							    double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
+						/* Surface Nodal Patch Loop */
+						for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
 
-								// Get the illuminance on this node from the current CFS.
-							    // Illuminance from sun - clear
-								double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
+							// Get nodal patch coords and transfer to Point3d.
+							BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
+								bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
+								bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
 
-                                // Accumulate the Surface Total Direct Illuminance from Clear Sun for current sun position
-								bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectSunCIllum[iphs][iths] += dCFSTotalIllum;
+						    // Get surface nodal patch area.
+						    double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
 
-                                // Add the resulting Luminance from this CFS contribution to the Surface Node
-                                // Note that Luminance is Illuminance * Surface Reflectance
-								bldg_ptr->zone[izone]->surf[iIntSurf]->direct_sunclum[inode][iphs][iths] += dCFSTotalIllum * dNodeSurfaceReflectance;
+							// Get the illuminance on this node from the current CFS.
+						    // Illuminance from sun - clear
+							double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
 
-                            }	/* end of Surface Nodal Patch Loop */
+                            // Accumulate the Surface Total Direct Illuminance from Clear Sun for current sun position
+							bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectSunCIllum[iphs][iths] += dCFSTotalIllum;
 
-						}	/* end of Interior Surface Loop */
+                            // Add the resulting Luminance from this CFS contribution to the Surface Node
+                            // Note that Luminance is Illuminance * Surface Reflectance
+							bldg_ptr->zone[izone]->surf[iIntSurf]->direct_sunclum[inode][iphs][iths] += dCFSTotalIllum * dNodeSurfaceReflectance;
+							if ((pfixed = session_fixed(bldg_ptr->session,izone,iIntSurf,inode)) != NULL) pfixed->sunc[iphs][iths] += dCFSTotalIllum;
 
-                        // Now loop over all Reference Points adding Clear Sun component for current sun position
+                        }	/* end of Surface Nodal Patch Loop */
 
-						/* Reference Point Loop */
+					}	/* end of Interior Surface Loop */
 
-						/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
-						BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
+                    // Now loop over all Reference Points adding Clear Sun component for current sun position
 
-						for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+					/* Reference Point Loop */
 
-							// Get refpt coords and transfer to Point3d.
-							BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
-								bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
-								bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
+					/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
+					BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
 
-							// Get the illuminance at this refpt from the current CFS.
-							// Illuminance from sun - clear
-							double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
-							bldg_ptr->zone[izone]->ref_pt[irp]->direct_suncillum[iphs][iths] += dCFSTotalIllum;
+					for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
 
-						}	/* end of Reference Point Loop */
+						// Get refpt coords and transfer to Point3d.
+						BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
+							bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
+							bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
 
-					}	/* end of Sun Position Azimuth Loop */
-
-				}	/* end of Sun Position Altitude Loop */
-
-                // Lastly, distribute the Clear Sky contribution to all interior surface nodes and to reference points
-                // for all Sun Positions
-
-				/* Sun Position Altitude Loop */
-				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-
-					/* Altitude of sun */
-					phsun_deg = phsmin + (double)iphs * phsdel;
-					phsun = phsun_deg * DTOR;
-
-					/* Get clear sky zenith luminance, moisture, */
-					/* and turbidity coef for reference month. */
-					dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
-
-                    /* Sun Position Azimuth Loop */
-					for (iths=0; iths<sun_ptr->nths; iths++) {
-
-						/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
-						thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
-
-                        // Create a Clear Sky and CFSSystem Luminance Map for the current Sun Position and CFSSurface
-                        // "SKY^GEN^CIECLEARSKY^SunAlt^SunAzm^ZenLum^GrndRefl"
-                        // HemiSphiral resolution
-	                    sphiralM = 200;
-	                    sphiralN = 1000;
-                        // Create the DNA string for CIE Clear Sky
-				        // For current sun position
-                        // Convert Aziumth angle in radians to degrees
-                        // and make sure it falls within -180 to 180
-                        double thsun_deg = thsun/DTOR;
-                        if (thsun_deg < -180.) thsun_deg += 360.;
-                        if (thsun_deg > 180.) thsun_deg -= 360.;
-	                    strcpy(cSkyStr,"");
-	                    sprintf(cSkyStr,"SKY^GEN^CIECLEARSKY^%6.2lf^%6.2lf^%10.6lf^%4.2lf", phsun_deg, thsun_deg, zenl, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
-	                    string	skyStr = cSkyStr;
-                        // Decode the DNA string
-	                    if (!SecretDecoderRing(lpsky,skyStr)) {
-				            *pofdmpfile << "ERROR: DElight Incorrect Sky Generation Parameter - " << lpsky.BadName << "\n";
-		                    return -1;
-	                    }
-                        // Generate the sky
-//	                    HemiSphiral	skyClear = GenSky(sphiralN, lpsky);
-						// Set the hemisphiral resolutions
-						lpsky.btdfHSResIn = sphiralM;
-						lpsky.btdfHSResOut = sphiralN;
-	                    HemiSphiral	skyClear = GenSky(lpsky);
-	                    if (skyClear.size() == 0) {
-				            *pofdmpfile << "ERROR: DElight HemiSphiral for Clear Sky Size == ZERO\n";
-		                    return -1;
-	                    }
-// Progress indicator
-//    cout << ".";
-//    cout << "Clear Sky: Alt = " << phsun_deg << " Azm = " << RadToDeg(thsun) << "\n";
-//	skyClear.plotview(75);
-//	skyClear.plotview(75,DegToRad(0),DegToRad(90),DegToRad(0));
-
-                        // Create the new CFSSystem Luminance Map for this sky type
-//	                    HemiSphiral	LumMapClear = pCFSSystem4CFSSurf->CFSLuminanceMap(sphiralM, sphiralN, skyClear, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	                    HemiSphiral	LumMapClear = pCFSSystem4CFSSurf->CFSLuminanceMap(skyClear, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)));
-	                    if (LumMapClear.size() == 0) {
-				            *pofdmpfile << "ERROR: DElight HemiSphiral for CFS Luminance Map Size == ZERO\n";
-		                    return -1;
-	                    }
-                        // Reset the CFSSurface Luminance Map
-                        bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapClear);
-
-                        // Now loop over all Surface Nodes adding Clear Sky component for current Sun Position
-
-                        /* Interior Surface Loop */
-						for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
+						// Get the illuminance at this refpt from the current CFS.
+						// Illuminance from sun - clear
+						double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
+						bldg_ptr->zone[izone]->ref_pt[irp]->direct_suncillum[iphs][iths] += dCFSTotalIllum;
+						if ((pfixed = session_fixed(bldg_ptr->session,izone,-1,irp)) != NULL) pfixed->sunc[iphs][iths] += dCFSTotalIllum;
 
-							// Skip the current surface.
-							if (iIntSurf == isurf) continue;
+					}	/* end of Reference Point Loop */
 
-					        // Get the visible reflectance of this surface.
-					        double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
+				}	/* end of Sun Position Azimuth Loop */
 
-							// Get surface inward normal unit vector and transfer to Vec3d.
-							BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
-								bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
-								bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
+			}	/* end of Sun Position Altitude Loop */
 
-							/* Surface Nodal Patch Loop */
-							for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
+            // Lastly, distribute the Clear Sky contribution to all interior surface nodes and to reference points
+            // for all Sun Positions
 
-								// Get nodal patch coords and transfer to Point3d.
-								BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
-									bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
-									bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
+			/* Sun Position Altitude Loop */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
 
-							    // Get surface nodal patch area.
-							    double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
+				/* Altitude of sun */
+				phsun_deg = phsmin + (double)iphs * phsdel;
+				phsun = phsun_deg * DTOR;
 
-								// Get the illuminance on this node from the current CFS.
-								// Illuminance from sky - clear
-								double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
+				/* Get clear sky zenith luminance, moisture, */
+				/* and turbidity coef for reference month. */
+				dzenlm(&zenl,&tfac,IMREF,bldg_ptr,phsun);
 
-                                // Accumulate the Surface Total Direct Illuminance from Clear Sky for current sun position
-								bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectSkyCIllum[iphs][iths] += dCFSTotalIllum;
+                /* Sun Position Azimuth Loop */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
 
-                                // Add the resulting Luminance from this CFS contribution to the Surface Node
-                                // Note that Luminance is Illuminance * Surface Reflectance
-								bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyclum[inode][iphs][iths] += dCFSTotalIllum * dNodeSurfaceReflectance;
+					/* azm of sun in strange sun coord sys (0=East, counter-clockwise is positive) */
+					thsun = (thsmin + (double)iths * thsdel - 90.0) * DTOR + bldg_ptr->azm * DTOR;
+
+                    // Create a Clear Sky and CFSSystem Luminance Map for the current Sun Position and CFSSurface
+                    // "SKY^GEN^CIECLEARSKY^SunAlt^SunAzm^ZenLum^GrndRefl"
+                    // HemiSphiral resolution
+                    sphiralM = 200;
+                    sphiralN = 1000;
+                    // Create the DNA string for CIE Clear Sky
+			        // For current sun position
+                    // Convert Aziumth angle in radians to degrees
+                    // and make sure it falls within -180 to 180
+                    double thsun_deg = thsun/DTOR;
+                    if (thsun_deg < -180.) thsun_deg += 360.;
+                    if (thsun_deg > 180.) thsun_deg -= 360.;
+                    strcpy(cSkyStr,"");
+                    sprintf(cSkyStr,"SKY^GEN^CIECLEARSKY^%6.2lf^%6.2lf^%10.6lf^%4.2lf", phsun_deg, thsun_deg, zenl, bldg_ptr->zone[izone]->surf[isurf]->gnd_refl);
+                    // Generate the sky and its CFSSystem Luminance Map, or reuse cached ones
+                    HemiSphiral	LumMapClear;
+                    if (cfs_lummap(bldg_ptr->lmcache, pCFSSystem4CFSSurf, cSkyStr, sphiralM, sphiralN, BGL::RHCoordSys3(bldg_ptr->zone[izone]->surf[isurf]->icsAxis(0),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(1),bldg_ptr->zone[izone]->surf[isurf]->icsAxis(2)), "Clear Sky", LumMapClear, pofdmpfile) < 0) {
+                        return -1;
+                    }
+                    // Reset the current CFSSurface Luminance Map
+                    bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->ResetLumMap(LumMapClear);
 
-                            }	/* end of Surface Nodal Patch Loop */
+                    // Now loop over all Surface Nodes adding Clear Sky component for current Sun Position
 
-						}	/* end of Interior Surface Loop */
+                    /* Interior Surface Loop */
+					for (iIntSurf=0; iIntSurf<bldg_ptr->zone[izone]->nsurfs; iIntSurf++) {
 
-                        // Now loop over all Reference Points adding Clear Sky component for current sun position
+						// Skip the current surface.
+						if (iIntSurf == isurf) continue;
 
-						/* Reference Point Loop */
+				        // Get the visible reflectance of this surface.
+				        double dNodeSurfaceReflectance = bldg_ptr->zone[izone]->surf[iIntSurf]->vis_refl;
 
-						/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
-						BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
+						// Get surface inward normal unit vector and transfer to Vec3d.
+						BGL::vector3 v3SurfNormal(bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[0],
+							bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[1],
+							bldg_ptr->zone[izone]->surf[iIntSurf]->inward_uvect[2]);
 
-						for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+						/* Surface Nodal Patch Loop */
+						for (inode=0; inode<bldg_ptr->zone[izone]->surf[iIntSurf]->nnodes; inode++) {
 
-							// Get refpt coords and transfer to Point3d.
-							BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
-								bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
-								bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
+							// Get nodal patch coords and transfer to Point3d.
+							BGL::point3 p3Node(bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][0], 
+								bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][1], 
+								bldg_ptr->zone[izone]->surf[iIntSurf]->node[inode][2]);
 
-							// Get the illuminance at this refpt from the current CFS.
+						    // Get surface nodal patch area.
+						    double dSurfNodeArea = bldg_ptr->zone[izone]->surf[iIntSurf]->node_areas[inode];
+
+							// Get the illuminance on this node from the current CFS.
 							// Illuminance from sky - clear
-							double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
-							bldg_ptr->zone[izone]->ref_pt[irp]->direct_skycillum[iphs][iths] += dCFSTotalIllum;
+							double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3SurfNormal, p3Node) * dSurfNodeArea;
 
-						}	/* end of Reference Point Loop */
+                            // Accumulate the Surface Total Direct Illuminance from Clear Sky for current sun position
+							bldg_ptr->zone[izone]->surf[iIntSurf]->TotDirectSkyCIllum[iphs][iths] += dCFSTotalIllum;
+
+                            // Add the resulting Luminance from this CFS contribution to the Surface Node
+                            // Note that Luminance is Illuminance * Surface Reflectance
+							bldg_ptr->zone[izone]->surf[iIntSurf]->direct_skyclum[inode][iphs][iths] += dCFSTotalIllum * dNodeSurfaceReflectance;
+							if ((pfixed = session_fixed(bldg_ptr->session,izone,iIntSurf,inode)) != NULL) pfixed->skyc[iphs][iths] += dCFSTotalIllum;
+
+                        }	/* end of Surface Nodal Patch Loop */
+
+					}	/* end of Interior Surface Loop */
+
+                    // Now loop over all Reference Points adding Clear Sky component for current sun position
+
+					/* Reference Point Loop */
+
+					/* Set ref_pt "surface" normal unit vector (all ref_pts assumed horizontal facing upward). */
+					BGL::vector3 v3RefPtNormal(0.0,0.0,1.0);
+
+					for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+
+						// Get refpt coords and transfer to Point3d.
+						BGL::point3 p3RefPt(bldg_ptr->zone[izone]->ref_pt[irp]->bs[0], 
+							bldg_ptr->zone[izone]->ref_pt[irp]->bs[1], 
+							bldg_ptr->zone[izone]->ref_pt[irp]->bs[2]);
+
+						// Get the illuminance at this refpt from the current CFS.
+						// Illuminance from sky - clear
+						double dCFSTotalIllum = bldg_ptr->zone[izone]->surf[isurf]->cfs[icfs]->TotRefPtIllum(v3RefPtNormal, p3RefPt);
+						bldg_ptr->zone[izone]->ref_pt[irp]->direct_skycillum[iphs][iths] += dCFSTotalIllum;
+						if ((pfixed = session_fixed(bldg_ptr->session,izone,-1,irp)) != NULL) pfixed->skyc[iphs][iths] += dCFSTotalIllum;
+
+					}	/* end of Reference Point Loop */
+
+				}	/* end of Sun Position Azimuth Loop */
+
+			}	/* end of Sun Position Altitude Loop */
+
+		}	/* end of CFS Surface Loop */
+		if (bldg_ptr->zone[izone]->surf[isurf]->ncfs > 0) dl_phase(DLPHASE_CFS,0);
+
+	}	/* end of Exterior Surface Loop */
+
+	return(iReturnVal);
+}
 
-					}	/* end of Sun Position Azimuth Loop */
+/****************************** subroutine zone_daylight_factors *****************************/
+/* Calculates the daylight factors (interior illum / exterior horiz illum) at each ref_pt */
+/* of one lighting zone from its total illuminances. */
+/****************************************************************************/
+/****************************** subroutine zone_daylight_factors *****************************/
+void	zone_daylight_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	int izone)			/* current zone index */
+{
+	int irp, iphs, iths;	/* loop indexes */
+
+	// for each ref_pt in this zone
+	for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
+		// Calc daylight factor for overcast sky condition
+		if (bldg_ptr->hillumskyo[0])
+			bldg_ptr->zone[izone]->ref_pt[irp]->dfskyo = bldg_ptr->zone[izone]->ref_pt[irp]->skyoillum / bldg_ptr->hillumskyo[0];
+		// for each Sun Position Altitude
+		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+			// for each Sun Position Azimuth 
+			for (iths=0; iths<sun_ptr->nths; iths++) {
+				// Calc component daylight factors for each clear sky sun position
+				if (bldg_ptr->hillumskyc[iphs])
+					bldg_ptr->zone[izone]->ref_pt[irp]->dfsky[iphs][iths] = bldg_ptr->zone[izone]->ref_pt[irp]->skycillum[iphs][iths] / bldg_ptr->hillumskyc[iphs];
+				if (bldg_ptr->hillumsunc[iphs])
+					bldg_ptr->zone[izone]->ref_pt[irp]->dfsun[iphs][iths] = bldg_ptr->zone[izone]->ref_pt[irp]->suncillum[iphs][iths] / bldg_ptr->hillumsunc[iphs];
+			}
+		}
+	}
+}
 
-				}	/* end of Sun Position Altitude Loop */
+/****************************** subroutine radiosity_convergence *****************************/
+/* Writes a warning for each zone whose interreflection stopped short of the */
+/* DELIGHT_RADIOSITY_TOL tolerance. Returns 0, or -10 if any warning was written. */
+/****************************************************************************/
+/****************************** subroutine radiosity_convergence *****************************/
+int	radiosity_convergence(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	int izone;		/* zone index */
+	double dRadTol = radiosity_tolerance();
+	int iReturnVal = 0;
 
-			}	/* end of CFS Surface Loop */
+	if (dRadTol <= 0.) return(0);
+	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+		if (bldg_ptr->zone[izone]->rad_resid <= dRadTol) continue;
+		*pofdmpfile << "WARNING: DElight Radiosity for lighting zone " << bldg_ptr->zone[izone]->name << " stopped at residual " << bldg_ptr->zone[izone]->rad_resid << " after " << bldg_ptr->zone[izone]->rad_iter << " iterations (tolerance " << dRadTol << ")\n";
+		iReturnVal = -10;
+	}
 
-		}	/* end of Exterior Surface Loop */
+	return(iReturnVal);
+}
 
-    // Progress indicator termination
- //   cout << "\n";
+/****************************** subroutine ZoneInterreflectDFs *****************************/
+/* Interreflection and daylight factor calcs for one zone whose direct illuminances are */
+/* set, as done for it by the serial path of CalcDFs(). */
+/* The serial path reruns slite_interreflect() for every zone after each zone's */
+/* direct calcs, and refpt_total_illum() accumulates into the ref_pt reflected */
+/* illuminances on every run. Passes made before a zone's direct calcs add zero, but */
+/* the (nzones-1-izone) passes made after its daylight factors are replayed here */
+/* so that the reported illuminances match the serial path exactly. */
+/****************************************************************************/
+/****************************** subroutine ZoneInterreflectDFs *****************************/
+int	ZoneInterreflectDFs(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	int iIterations,	/* number of radiosity iterations */
+	int izone,			/* current zone index */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	int ipass;		/* serial accumulation pass index */
+
+    // Init Return Value
+    int iReturnVal = 0;
 
-		// Interreflection Calcs
-        int iSliteInterRflRetVal;
-		if ((iSliteInterRflRetVal = slite_interreflect(bldg_ptr, lib_ptr, sun_ptr, iIterations, pofdmpfile)) < 0) {
-            // If errors were detected then return now, else register warnings and continue processing
-            if (iSliteInterRflRetVal != -10) {
-				*pofdmpfile << "ERROR: DElight Bad return from slite_interreflect()\n"; 
+	// Interreflection Calcs
+    int iZoneInterRflRetVal;
+	if ((iZoneInterRflRetVal = zone_interreflect(bldg_ptr,lib_ptr,sun_ptr,izone,iIterations,pofdmpfile)) < 0) {
+        // If errors were detected then return now, else register warnings and continue processing
+        if (iZoneInterRflRetVal != -10) {
+			*pofdmpfile << "ERROR: DElight Bad return from slite_interreflect()\n"; 
+			return(-1);
+        }
+        else {
+            iReturnVal = -10;
+        }
+    }
+
+    // Daylight Factor Calcs
+	zone_daylight_factors(bldg_ptr,sun_ptr,izone);
+
+	// Remaining serial ref_pt accumulation passes
+	for (ipass=izone+1; ipass<bldg_ptr->nzones; ipass++) {
+        int iRefptIllumRetVal;
+		if ((iRefptIllumRetVal = refpt_total_illum(bldg_ptr,sun_ptr,izone,pofdmpfile)) < 0) {
+            if (iRefptIllumRetVal != -10) {
+				*pofdmpfile << "ERROR: DElight Bad return from refpt_total_illum()\n";
 				return(-1);
             }
             else {
                 iReturnVal = -10;
             }
         }
+	}
 
-        // Daylight Factor Calcs
-		// for each ref_pt in this zone
-		for (irp=0; irp<bldg_ptr->zone[izone]->nrefpts; irp++) {
-			// Calc daylight factor for overcast sky condition
-			if (bldg_ptr->hillumskyo[0])
-				bldg_ptr->zone[izone]->ref_pt[irp]->dfskyo = bldg_ptr->zone[izone]->ref_pt[irp]->skyoillum / bldg_ptr->hillumskyo[0];
-			// for each Sun Position Altitude
-			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-				// for each Sun Position Azimuth 
-				for (iths=0; iths<sun_ptr->nths; iths++) {
-					// Calc component daylight factors for each clear sky sun position
-					if (bldg_ptr->hillumskyc[iphs])
-						bldg_ptr->zone[izone]->ref_pt[irp]->dfsky[iphs][iths] = bldg_ptr->zone[izone]->ref_pt[irp]->skycillum[iphs][iths] / bldg_ptr->hillumskyc[iphs];
-					if (bldg_ptr->hillumsunc[iphs])
-						bldg_ptr->zone[izone]->ref_pt[irp]->dfsun[iphs][iths] = bldg_ptr->zone[izone]->ref_pt[irp]->suncillum[iphs][iths] / bldg_ptr->hillumsunc[iphs];
-				}
-			}
+	return(iReturnVal);
+}
+
+/* Shared data for the per-zone tasks of CalcDFsZonePool(). */
+typedef struct {
+	SUN_DATA *sun_ptr;	/* pointer to sun data structure */
+	BLDG *bldg_ptr;		/* pointer to bldg structure */
+	LIB *lib_ptr;		/* pointer to library structure */
+	int iIterations;	/* number of radiosity iterations */
+	SUNSKY *psunsky;	/* pointer to sky constants for each sun position */
+	double phsmin, phsdel;	/* sun position altitude minimum and increment (degrees) */
+	double thsmin, thsdel;	/* sun position azimuth minimum and increment (degrees) */
+	double *solic;		/* extraterrestrial irrad for 1st of each month (0 to 11) */
+} ZONETASK;
+
+/****************************** subroutine zone_direct_task *****************************/
+/* run_task_pool() task: direct illuminance calcs for zone itask. */
+/****************************************************************************/
+/****************************** subroutine zone_direct_task *****************************/
+static int zone_direct_task(
+	int itask,			/* zone index */
+	void *pdata,		/* pointer to ZONETASK data */
+	ofstream* pofdmpfile)	/* ptr to task error dump file */
+{
+	ZONETASK *ptask = (ZONETASK *)pdata;
+
+	return(CalcZoneDirectIllum(ptask->sun_ptr,ptask->bldg_ptr,ptask->lib_ptr,itask,ptask->psunsky,ptask->phsmin,ptask->phsdel,ptask->thsmin,ptask->thsdel,ptask->solic,pofdmpfile));
+}
+
+/****************************** subroutine zone_interreflect_task *****************************/
+/* run_task_pool() task: interreflection and daylight factor calcs for zone itask */
+/* (see ZoneInterreflectDFs()). */
+/****************************************************************************/
+/****************************** subroutine zone_interreflect_task *****************************/
+static int zone_interreflect_task(
+	int itask,			/* zone index */
+	void *pdata,		/* pointer to ZONETASK data */
+	ofstream* pofdmpfile)	/* ptr to task error dump file */
+{
+	ZONETASK *ptask = (ZONETASK *)pdata;
+
+	return(ZoneInterreflectDFs(ptask->sun_ptr,ptask->bldg_ptr,ptask->lib_ptr,ptask->iIterations,itask,pofdmpfile));
+}
+
+/****************************** subroutine CalcDFsZonePool *****************************/
+/* Parallel version of the per-zone part of CalcDFs(), used when DELIGHT_NUM_THREADS */
+/* asks for more than one thread. Runs the direct illuminance calcs of all zones, then */
+/* the interreflection and daylight factor calcs of all zones, each phase over a */
+/* run_task_pool() of nthreads threads. */
+/* Messages are written in zone order and results are identical to the serial path. */
+/* Zones are queued largest first, estimated from their window elements times */
+/* receiving nodes plus a fixed weight per CFS sky map. */
+/****************************************************************************/
+/****************************** subroutine CalcDFsZonePool *****************************/
+int	CalcDFsZonePool(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	int iIterations,	/* number of radiosity iterations */
+	SUNSKY *psunsky,	/* pointer to sky constants for each sun position */
+	double phsmin,		/* minimum sun postition altitude (degrees) */
+	double phsdel,		/* sun position altitude increment (degrees) */
+	double thsmin,		/* minimum sun postition azimuth (degrees: South=0.0, East=+90.0) */
+	double thsdel,		/* sun position azimuth increment (degrees) */
+	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
+	int nthreads,		/* number of threads */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	ZONETASK task;			/* shared task data */
+	vector<double> vdCost(bldg_ptr->nzones, 0.0);	/* estimated cost of each zone */
+	int izone, isurf, iw;	/* loop indexes */
+	double dNodes;			/* number of receiving ref_pts and surface nodes */
+
+    // Init Return Value
+    int iReturnVal = 0;
+
+	task.sun_ptr = sun_ptr;
+	task.bldg_ptr = bldg_ptr;
+	task.lib_ptr = lib_ptr;
+	task.iIterations = iIterations;
+	task.psunsky = psunsky;
+	task.phsmin = phsmin;
+	task.phsdel = phsdel;
+	task.thsmin = thsmin;
+	task.thsdel = thsdel;
+	task.solic = solic;
+
+	/* Estimate the direct calc cost of each zone */
+	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+		dNodes = (double)bldg_ptr->zone[izone]->nrefpts;
+		for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++)
+			dNodes += (double)bldg_ptr->zone[izone]->surf[isurf]->nnodes;
+		for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++) {
+			for (iw=0; iw<bldg_ptr->zone[izone]->surf[isurf]->nwndos; iw++)
+				vdCost[izone] += bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->width * bldg_ptr->zone[izone]->surf[isurf]->wndo[iw]->height / 0.25 * dNodes;
+			vdCost[izone] += (double)bldg_ptr->zone[izone]->surf[isurf]->ncfs * (1 + 2 * sun_ptr->nphs * sun_ptr->nths) * CFS_POOL_COST;
 		}
-	}	/* end of Lighting Zone Loop */
+	}
+
+	// Direct Illuminance Calcs
+	// Zone phases run on pool threads, so each pool is reported as one phase
+    int iPoolRetVal;
+	dl_phase(DLPHASE_DIRECT,1);
+	dl_phase_hold(1);
+	iPoolRetVal = run_task_pool(bldg_ptr->nzones,nthreads,&vdCost[0],zone_direct_task,&task,pofdmpfile);
+	dl_phase_hold(0);
+	dl_phase(DLPHASE_DIRECT,0);
+	if (iPoolRetVal < 0) {
+        // If errors were detected then return now, else register warnings and continue processing
+        if (iPoolRetVal != -10) return(-1);
+        else iReturnVal = -10;
+    }
+
+	// Interreflection and Daylight Factor Calcs
+	dl_phase(DLPHASE_INTERREFLECT,1);
+	dl_phase_hold(1);
+	iPoolRetVal = run_task_pool(bldg_ptr->nzones,nthreads,&vdCost[0],zone_interreflect_task,&task,pofdmpfile);
+	dl_phase_hold(0);
+	dl_phase(DLPHASE_INTERREFLECT,0);
+	if (iPoolRetVal < 0) {
+        // If errors were detected then return now, else register warnings and continue processing
+        if (iPoolRetVal != -10) return(-1);
+        else iReturnVal = -10;
+    }
 
 	return(iReturnVal);
 }
 
-/************************** subroutine wndo_element_refpt_illum_contrib *************************/
+/************************** subroutine wndo_element_direct_slab *************************/
 /* Adds contribution of current window element to direct (initial) illuminance (lm/ft2) at */
-/* current reference point. */
-
-/* Modified from earlier version of wndo_element_contrib() */
-/*   Key modifications are: */
-/*       - remove glare related calculations */
-/*       - replace references to ray[2] (i.e., cos(angle of incidence) for horiz surf) by cosSurfIncidence
-/*   8/2000 modifications: */
-/*       - separate reference point illuminance calc from surface node luminance calculation */
+/* current reference point, or to direct (initial) luminance (cd/ft2) at current surface node, */
+/* for every sun position at once. */
+/* The ray geometry (hit, solid angle, tvis, sky element angles) is independent of sun */
+/* position and is set up once per ray by the caller (see dskyray()), */
+/* and the sky constants for each sun position are set up once by dsunsky(). */
+/* The luminance * solid angle seen along the ray is collected first and then scaled by */
+/* tvis, cos(incidence) on the node surface and dNodeFactor, so that a session can also */
+/* record it without tvis and reflectance (see tvis_mom_add()). */
+
+/* Replaces the per sun position wndo_element_refpt_illum_contrib() and */
+/* wndo_element_surfnode_lum_contrib() routines. */
+/*   Reference points: dNodeFactor = 1.0, iSeesGround = 0 */
+/*   Surface nodes: dNodeFactor = visible reflectance of node surface, iSeesGround = 1 */
 /************************************************************************************************/
 /* C Language Implementation based on modified DOE2 Daylighting Algorithms */
 /* by Rob Hitchcock */
 /* Building Technologies Program, Lawrence Berkeley Laboratory */
-/************************** subroutine wndo_element_refpt_illum_contrib *************************/
-int	wndo_element_refpt_illum_contrib(
+/************************** subroutine wndo_element_direct_slab *************************/
+int	wndo_element_direct_slab(
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
-	LIB *lib_ptr,		/* pointer to lib structure */
 	int izone,			/* current zone index */
 	int iWndoSurf,		/* current index for surface containing Window */
-	int iNodeSurf,		/* current index for surface containing Node, Not Applicable (iWndoSurf==iNodeSurf */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
 	int iwndo,			/* current window index */
 	int iWndoElement,	/* window element index */
-	double thsun,		/* sun azm (radians) */
-	double phsun,		/* sun alt (radians) */
-	double thray,		/* sky element azm angle */
-	double phray,		/* sky element alt angle */
-	int iphs,			/* sun alt index */
-	int iths,			/* sun azm index */
-	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
-	double node[NCOORDS],	/* coords of refpt */
-	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt */
-	double cosPtSurfIncidence,	/* cos(angle of incidence) of vector from refpt (on horiz plane) to wndo element */
-	HIT *hit_ptr,			/* hit structure pointer for ray from refpt to wndo element */
-	double domega,			/* solid angle subtended by window element wrt ref_pt */
-	double vis_trans,		/* tvis of glass for normal incidence angle */
-	double tvisincidence,	/* tvis of glass for incidence angle */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	WRAY *wray_ptr,		/* pointer to ray data from node to wndo element */
+	double node[NCOORDS],	/* coords of refpt or surfnode */
+	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt or surfnode */
+	double dNodeFactor,	/* visible reflectance of node surface (1.0 for refpts) */
+	int iSeesGround,	/* 1 if rays below horizontal see the ground (surfnodes), 0 for refpts */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
 	double wnorm[NCOORDS],	/* window outward normal vector */
-	double tfac,			/* turbidity factor */
-	double zenl,			/* zenith luminance */
-	// return values stored in ref pt substructure
-	double *pdirect_skycillum,	/* ptr to direct illuminance from sky (fc) - clear */
-	double *pdirect_suncillum,	/* ptr to direct illuminance from sun (fc) - clear */
-	double *pdirect_skyoillum,	/* ptr to direct illuminance from sky (fc) - overcast */
-	ofstream* pofdmpfile)		/* ptr to LBLDLL error dump file */
+	// return values stored in ref pt, or surf node substructure
+	double direct_skyc[NPHS][NTHS],	/* direct illuminance or luminance from sky - clear */
+	double direct_sunc[NPHS][NTHS],	/* direct illuminance or luminance from sun - clear */
+	double *pdirect_skyo,	/* ptr to direct illuminance or luminance from sky - overcast */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
-	double elum, dedir;		/* luminance calc vars */
+	int iphs, iths;			/* sun position indexes */
+	int ic;					/* coordinate index */
+	double skylum[NPHS][NTHS];	/* clear sky luminance along ray for each sun position */
+	double elum;			/* luminance calc vars */
+	double dGroundLumSkyC, dGroundLumSunC, dGroundLumSkyO;		/* luminance calc vars */
 	double raycos[NCOORDS];	/* unit vector to sun from anywhere in the bldg */
 	double cosi;			/* cos(incidence) of raycos onto wndo */
 	double tviss;			/* vis trans for angle of incidence of raycos through wndo */
 	double tvis1;			/* dummy vis trans for diffuse glazing calc using wndo luminance (==1.0) */
-	double dnsoli;			/* dnsol() return value */
-	HIT rchit;				/* bldg-shade hit structure for dhitsh() */
+	double cosinc;			/* cos(incidence) of raycos onto node surface */
+	double lumskyc[NPHS][NTHS];	/* luminance * solid angle along ray - clear sky */
+	double lumsunc[NPHS][NTHS];	/* luminance * solid angle along ray - clear sun */
+	double lumskyo = 0.;		/* luminance * solid angle along ray - overcast sky */
+	WNDO *wndo_ptr = bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo];
+	HIT *hit_ptr = &(wray_ptr->hit);
+	double domega = wray_ptr->domega;
+	double tvisincidence = wray_ptr->tvis;
+	double cosPtSurfIncidence = wray_ptr->cospt;
+	int nphs = sunsky_ptr->nphs;
+	int nths = sunsky_ptr->nths;
+
+	memset(lumskyc,0,sizeof(lumskyc));
+	memset(lumsunc,0,sizeof(lumsunc));
 
 	/* CASE 1 - Window without shades (i.e., clear glazing) */
-	if (bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->shade_flag == 0) {
+	if (wndo_ptr->shade_flag == 0) {
 
 		/* If ray hits front of global shading surface, */
-		/* add contrib of shading surf luminance (cd/ft2) */
-		/* to illum at ref_pt.  */
+		/* add contrib of shading surf luminance (cd/ft2).  */
 		if (hit_ptr->ihit == 4) {
-			(*pdirect_skycillum) += bldg_ptr->bshade[hit_ptr->hitshade]->skylum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence;
-			(*pdirect_suncillum) += bldg_ptr->bshade[hit_ptr->hitshade]->sunlum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence;
-			if ((iphs ==0) && (iths ==0))
-				(*pdirect_skyoillum) += bldg_ptr->bshade[hit_ptr->hitshade]->ovrlum*domega*tvisincidence*cosPtSurfIncidence;
+			BSHADE *bshade_ptr = bldg_ptr->bshade[hit_ptr->hitshade];
+			for (iphs=0; iphs<nphs; iphs++) {
+				for (iths=0; iths<nths; iths++) {
+					lumskyc[iphs][iths] = bshade_ptr->skylum[iphs][iths]*domega;
+					lumsunc[iphs][iths] = bshade_ptr->sunlum[iphs][iths]*domega;
+				}
+			}
+			lumskyo = bshade_ptr->ovrlum*domega;
 		}
 
 		/* If ray hits exterior of zone surface, */
-		/* add contrib of zone surface luminance (cd/ft2) */
-		/* to illum at ref_pt.  */
+		/* add contrib of zone surface luminance (cd/ft2).  */
 		if (hit_ptr->ihit == 2) {
-			(*pdirect_skycillum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->skylum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence;
-			(*pdirect_suncillum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->sunlum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence;
-			if ((iphs ==0) && (iths ==0))
-				(*pdirect_skyoillum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->ovrlum*domega*tvisincidence*cosPtSurfIncidence;
+			SURF *hitsurf_ptr = bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade];
+			for (iphs=0; iphs<nphs; iphs++) {
+				for (iths=0; iths<nths; iths++) {
+					lumskyc[iphs][iths] = hitsurf_ptr->skylum[iphs][iths]*domega;
+					lumsunc[iphs][iths] = hitsurf_ptr->sunlum[iphs][iths]*domega;
+				}
+			}
+			lumskyo = hitsurf_ptr->ovrlum*domega;
 		}
 
-		/* If shading surface not hit, add contrib of sky (cd/ft2) if it is visible from ref pt (phray > 0.0). */
-
-		// WHAT ABOUT GROUND HITS (PHRAY <= 0)?
-		// NOTE: PHRAY is z dimension of unit vector of ray from ref pt through window element
+		/* If shading surface not hit, add contrib of */
+		/* sky or ground luminance (cd/ft2). */
 		// NOTE: Ray from ref pt (horiz looking up) can never see the ground, so ignore
-
 		if (hit_ptr->ihit == 0) {
 
 			/* for clear sky */
-			if (phray > 0.0) {
-				elum = dskylu(0,thray,phray,thsun,phsun,zenl);
-				dedir = elum * domega * tvisincidence * cosPtSurfIncidence;
-				(*pdirect_skycillum) += dedir;
+			// If ray points upward above the horizontal plane (or along it for surf nodes), then add contribution from sky
+			if ((wray_ptr->phray > 0.0) || (iSeesGround && (wray_ptr->phray >= 0.0))) {
+				dskylu_slab(sunsky_ptr,wray_ptr,skylum);
+				for (iphs=0; iphs<nphs; iphs++) {
+					for (iths=0; iths<nths; iths++) {
+						lumskyc[iphs][iths] = skylum[iphs][iths] * domega;
+					}
+				}
+			}
+			// If ray points downward below the horizontal plane, then add contribution from ground
+			else if (iSeesGround) {
+				for (iphs=0; iphs<nphs; iphs++) {
+					// Luminance of ground (cd/ft2) is 
+					// illuminance on ground (lum/ft2) * gnd_refl (which gives ft-lamberts) / PI
+					dGroundLumSkyC = bldg_ptr->hillumskyc[iphs] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
+					dGroundLumSunC = bldg_ptr->hillumsunc[iphs] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
+					for (iths=0; iths<nths; iths++) {
+						// Add separate sky and sun components of ground luminance
+						lumskyc[iphs][iths] = dGroundLumSkyC * domega;
+						lumsunc[iphs][iths] = dGroundLumSunC * domega;
+					}
+				}
 			}
 
-			/* for overcast sky */
-			if ((iphs == 0) && (iths == 0)) {
-				if (phray > 0.0) {
-					elum = dskylu(1,thray,phray,thsun,phsun,zenl);
-					dedir = elum * domega * tvisincidence * cosPtSurfIncidence;
-
-// rjh 8/00
-//	*pofdmpfile << "Overcast sky vars for iWndoSurf " << iWndoSurf << " iNodeSurf " << iNodeSurf << " iWndoElement(" << ix << ", " << iy << ") Node(" << node[0] << ", " << node[1] << ", " << node[2] << ")\n"; 
-//	*pofdmpfile << "   elum = " << elum << " domega = " << domega << " tvisincidence = " << tvisincidence << " cosPtSurfIncidence = " << cosPtSurfIncidence << "\n"; 
+			/* for overcast sky (independent of sun azm, taken at first sun position) */
+			if (wray_ptr->phray > 0.0) {
+				elum = dskylu(1,wray_ptr->thray,wray_ptr->phray,sunsky_ptr->thsun[0],sunsky_ptr->phsun[0],sunsky_ptr->zenl[0]);
+				lumskyo = elum * domega;
+			}
+			else if (iSeesGround) {
+				dGroundLumSkyO = bldg_ptr->hillumskyo[0] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
+				lumskyo = dGroundLumSkyO * domega;
+			}
+		}
 
-					
-					(*pdirect_skyoillum) += dedir;
-				}
+		/* add luminance seen through the glass */
+		for (iphs=0; iphs<nphs; iphs++) {
+			for (iths=0; iths<nths; iths++) {
+				direct_skyc[iphs][iths] += lumskyc[iphs][iths]*tvisincidence*cosPtSurfIncidence * dNodeFactor;
+				direct_sunc[iphs][iths] += lumsunc[iphs][iths]*tvisincidence*cosPtSurfIncidence * dNodeFactor;
 			}
 		}
+		(*pdirect_skyo) += lumskyo*tvisincidence*cosPtSurfIncidence * dNodeFactor;
+		if (wray_ptr->pmom != NULL) tvis_mom_add(wray_ptr->pmom,wray_ptr->coswndo,cosPtSurfIncidence,lumskyc,lumsunc,lumskyo);
 
 		/* Illuminance from (unreflected) direct sun. */
-		/* (calculated only once per wndo for each ref pt) */
-//		if ((ix == (nwx-1)) && (iy == (nwy-1))) {
+		/* (calculated only once per wndo for each node) */
 		if (iWndoElement == 0) {
-			/* unit vector to sun from anywhere in the bldg */
-			raycos[0] = cos(phsun) * cos(thsun);
-			raycos[1] = cos(phsun) * sin(thsun);
-			raycos[2] = sin(phsun);
-			/* is sun on front side of current window? */
-			cosi = ddot(wnorm,raycos);
-			if (cosi > 0.0) {
-				/* does raycos from current ref_pt pass thru window? */
-//				dpierc(&ip,w1,w2,w3,node,raycos);
-
-                // Use WLC ray intersect surface polygon method.
-                // Note that this tests ray intersecting surface face on the INSIDE of DOE2 convention surface
-                // So this only works for rays from nodal points intersecting Window Surface polygons from inside zone.
-                BGL::point3	pt3Node = BGL::point3(node[0], node[1], node[2]);	//	center of box
-                BGL::vector3 vRayDir = BGL::vector3(raycos[0], raycos[1], raycos[2]);
-                BGL::ray3	r3Ray(pt3Node,vRayDir);
-                bool bIntersects = false;
-                Double dParam;  // can be used to calculate intersection point
-                bIntersects = bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->intersect(r3Ray,dParam);
-
-				if (bIntersects) {
-//				if (ip != 0) {
-					/* does raycos from current ref_pt intercept shade? */
+			for (iphs=0; iphs<nphs; iphs++) {
+				for (iths=0; iths<nths; iths++) {
+					/* unit vector to sun from anywhere in the bldg */
+					for (ic=0; ic<NCOORDS; ic++)
+						raycos[ic] = sunsky_ptr->raycos[ic][iphs][iths];
+
+					/* is sun on front side of current window? */
+					cosi = ddot(wnorm,raycos);
+					if (cosi <= 0.0) continue;
+
+					/* does raycos from current node pass thru window? */
+					// Use WLC ray intersect surface polygon method.
+					// Note that this tests ray intersecting surface face on the INSIDE of DOE2 convention surface
+					// So this only works for rays from nodal points intersecting Window Surface polygons from inside zone.
+					BGL::point3	pt3Node = BGL::point3(node[0], node[1], node[2]);	//	center of box
+					BGL::vector3 vRayDir = BGL::vector3(raycos[0], raycos[1], raycos[2]);
+					BGL::ray3	r3Ray(pt3Node,vRayDir);
+					Double dParam;  // can be used to calculate intersection point
+					if (!wndo_ptr->intersect(r3Ray,dParam)) continue;
+
+					/* does raycos from current node intercept shade? */
 					/* NOTE: this includes all zone surfaces contrary to DOE2 check of */
 					/* only "self-shade" surfaces (in addition to zone and bldg shades). */
-					// rjh 5/14/97 correction - parameter ray replaced with raycos
-	//				dhitsh(&rchit,rref,ray,bldg_ptr,izone,isurf);
-					dhitsh(&rchit,node,raycos,bldg_ptr,izone,iWndoSurf,iNodeSurf);
-					if (rchit.ihit == 0) {
-						/* sun reaches ref_pt */
-						/* increment illuminance */
-
-						// tvis of glass for cosi incid angle
-						// Window 4 implementation 4/2002
-						/* set lib_index component type to glass */
-						char sLibCompType[MAX_CHAR_UNAME+1];	/* temp str */
-						/* get library index of current window glass type */
-						strcpy(sLibCompType,"glass");
-						int igt = lib_index(lib_ptr,sLibCompType,bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->glass_type);
-						int iGlass_Type_ID = atoi(bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->glass_type);
-						// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
-						if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
-
-							// DOE2 original angular dependence equation coefs
-							double cam1 = lib_ptr->glass[igt]->cam1;
-							double cam2 = lib_ptr->glass[igt]->cam2;
-							double cam3 = lib_ptr->glass[igt]->cam3;
-							double cam4 = lib_ptr->glass[igt]->cam4;
-
-							// tvis of glass for cosi incid angle
-							tviss = max(0.0,(cam1+cosi*(cam2+cosi*(cam3+cosi*cam4))));
-						}
-						else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
-
-							// Window4 angular dependence Fit4() function coefs.
-							double W4vis_fit1 = lib_ptr->glass[igt]->W4vis_fit1;
-							double W4vis_fit2 = lib_ptr->glass[igt]->W4vis_fit2;
-
-							// tvis of glass for cosi incid angle
-							tviss = vis_trans * fit4(cosi, W4vis_fit1, W4vis_fit2);
-						}
-						else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
-
-							// tvis of glass for cosi incid angle
-							tviss = POLYF(cosi, lib_ptr->glass[igt]->EPlusCoef);
-						}
-						else if (iGlass_Type_ID < 0) {	// Energy-10
-
-							/* Energy-10 angular dependence equation coefs. */
-							double E10coef1 = lib_ptr->glass[igt]->E10coef[0];
-							double E10coef2 = lib_ptr->glass[igt]->E10coef[1];
-							double E10coef3 = lib_ptr->glass[igt]->E10coef[2];
-							double E10coef4 = lib_ptr->glass[igt]->E10coef[3];
-
-							// tvis of glass for cosi incid angle
-							tviss = vis_trans * max(0.0,(cosi*(E10coef1+cosi*(E10coef2+cosi*(E10coef3+cosi*E10coef4)))));
-						}
-
-						/* calc direct normal illuminance (lumens/ft2) from solar disk */
-						dnsoli = dnsol(solic,bldg_ptr,IMREF,phsun,tfac,pofdmpfile);
-						if (dnsoli < 0.0) {
-							*pofdmpfile << "ERROR: DElight Bad return from dnsol() = " <<dnsoli << ", exit wndo_element_refpt_illum_contrib()\n";
-							return(-1);
-						}
-
-						/* calc cos(incidence) for raycos on ref_pt surface */
-						double cosinc;
-						cosinc = ddot(nodesurfnormal,raycos);
-
-						/* add illuminance from sun modified by wndo vis trans and angle of incidence on ref_pt surface */
-						(*pdirect_suncillum) += dnsoli*tviss*cosinc;
+					if (dhitsh_any(node,raycos,bldg_ptr,izone,iWndoSurf,iNodeSurf)) continue;
+
+					/* sun reaches node */
+					/* tvis of glass for cosi incid angle */
+					tviss = glass_tvis(glass_ptr,iGlass_Type_ID,cosi);
+
+					/* direct normal illuminance (lumens/ft2) from solar disk */
+					if (sunsky_ptr->dnsol[iphs] < 0.0) {
+						*pofdmpfile << "ERROR: DElight Bad return from dnsol() = " << sunsky_ptr->dnsol[iphs] << ", exit wndo_element_direct_slab()\n";
+						return(-1);
 					}
+
+					/* calc cos(incidence) for raycos on node surface */
+					cosinc = ddot(nodesurfnormal,raycos);
+
+					/* add illuminance from sun modified by wndo vis trans and angle of incidence on node surface */
+					direct_sunc[iphs][iths] += sunsky_ptr->dnsol[iphs]*tviss*cosinc * dNodeFactor;
+					if (wray_ptr->pmom != NULL) tvis_mom_add_sun(wray_ptr->pmom,cosi,iphs,iths,sunsky_ptr->dnsol[iphs]*cosinc);
 				}
 			}
 		}
 	}
 
 	/* CASE 2 - Window with closed shades (i.e., diffuse glazing) */
-	else { // (bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->shade_flag != 0)
+	else { // (wndo_ptr->shade_flag != 0)
 
 		/* Luminance of wndo element is shade luminance. */
 		tvis1 = 1.0;
 
 		/* for clear sky */
-		(*pdirect_skycillum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumsky[iphs][iths]*domega*tvis1*cosPtSurfIncidence;
-		(*pdirect_suncillum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumsun[iphs][iths]*domega*tvis1*cosPtSurfIncidence;
+		for (iphs=0; iphs<nphs; iphs++) {
+			for (iths=0; iths<nths; iths++) {
+				lumskyc[iphs][iths] = wndo_ptr->wlumsky[iphs][iths]*domega;
+				lumsunc[iphs][iths] = wndo_ptr->wlumsun[iphs][iths]*domega;
+				direct_skyc[iphs][iths] += lumskyc[iphs][iths]*tvis1*cosPtSurfIncidence * dNodeFactor;
+				direct_sunc[iphs][iths] += lumsunc[iphs][iths]*tvis1*cosPtSurfIncidence * dNodeFactor;
+			}
+		}
 
 		/* for overcast sky */
-		if ((iphs == 0) && (iths == 0)) {
-			(*pdirect_skyoillum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumskyo*domega*tvis1*cosPtSurfIncidence;
-		}
+		lumskyo = wndo_ptr->wlumskyo*domega;
+		(*pdirect_skyo) += lumskyo*tvis1*cosPtSurfIncidence * dNodeFactor;
+		if (wray_ptr->pmom != NULL) tvis_mom_add(wray_ptr->pmom,wray_ptr->coswndo,cosPtSurfIncidence,lumskyc,lumsunc,lumskyo);
 	}
 
 	return(0);
 }
 
-/************************** subroutine wndo_element_surfnode_lum_contrib *************************/
-/* Adds contribution of current window element to direct (initial) luminance (cd/ft2) at */
-/* current surface node. */
-
-/* Modified from earlier version of wndo_element_contrib() */
-/*   Key modifications are: */
-/*       - remove glare related calculations */
-/*       - replace references to ray[2] (i.e., cos(angle of incidence) for horiz surf) by cosSurfIncidence
-/*   8/2000 modifications: */
-/*       - include visible reflectance of node surface in node luminance calculation */
-/*************************************************************************************************/
-/* C Language Implementation based on modified DOE2 Daylighting Algorithms */
-/* by Rob Hitchcock */
-/* Building Technologies Program, Lawrence Berkeley Laboratory */
-/************************** subroutine wndo_element_surfnode_lum_contrib *************************/
-int	wndo_element_surfnode_lum_contrib(
+/************************** function glass_tvis *************************/
+/* Returns visible transmittance of library glass type for given */
+/* cos(angle of incidence). */
+// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
+/************************** function glass_tvis *************************/
+double	glass_tvis(
+	GLASS *glass_ptr,	/* pointer to library glass type */
+	int iGlass_Type_ID,	/* glass type ID */
+	double cosi)		/* cos of angle of incidence */
+{
+	if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
+		return max(0.0,(glass_ptr->cam1+cosi*(glass_ptr->cam2+cosi*(glass_ptr->cam3+cosi*glass_ptr->cam4))));
+	}
+	else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
+		return glass_ptr->vis_trans * fit4(cosi, glass_ptr->W4vis_fit1, glass_ptr->W4vis_fit2);
+	}
+	else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
+		return POLYF(cosi, glass_ptr->EPlusCoef);
+	}
+	else if (iGlass_Type_ID < 0) {	// Energy-10
+		return glass_ptr->vis_trans * max(0.0,(cosi*(glass_ptr->E10coef[0]+cosi*(glass_ptr->E10coef[1]+cosi*(glass_ptr->E10coef[2]+cosi*glass_ptr->E10coef[3])))));
+	}
+	return 0.0;
+}
+
+/************************** subroutine wndo_element_direct_ray *************************/
+/* Traces the ray from a reference point or surface node to the center of a window */
+/* element (shading hit, sky element angles, solid angle, tvis) and adds the element */
+/* contribution for every sun position (see wndo_element_direct_slab()). */
+/* Reference points (irp >= 0) closer than 2 ft to the element get a warning, */
+/* and are skipped if on the window surface. */
+/* A session record (pmom) also gets the contribution without tvis and reflectance. */
+/* Returns 0, -10 for warnings, -1 for errors. */
+/************************** subroutine wndo_element_direct_ray *************************/
+int	wndo_element_direct_ray(
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
-	LIB *lib_ptr,		/* pointer to lib structure */
 	int izone,			/* current zone index */
 	int iWndoSurf,		/* current index for surface containing Window */
-	int iNodeSurf,		/* current index for surface containing Node */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
 	int iwndo,			/* current window index */
-	int iWndoElement,	/* window element index */
-	double thsun,		/* sun azm (radians) */
-	double phsun,		/* sun alt (radians) */
-	double thray,		/* sky element azm angle */
-	double phray,		/* sky element alt angle */
-	int iphs,			/* sun alt index */
-	int iths,			/* sun azm index */
-	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
-	double node[NCOORDS],	/* coords of surfnode */
-	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of surfnode */
-	double dNodeSurfaceReflectance, // visible reflectance of node surface
-	double cosPtSurfIncidence,	/* cos(angle of incidence) of vector from surfnode (on surface plane) to wndo element */
-	HIT *hit_ptr,			/* hit structure pointer for ray from surfnode to wndo element */
-	double domega,			/* solid angle subtended by window element wrt surfnode */
-	double vis_trans,		/* tvis of glass for normal incidence angle */
-	double tvisincidence,	/* tvis of glass for incidence angle */
+	int iWndoElement,	/* window element index (0 adds the direct sun) */
+	int irp,			/* current ref pt index (-1 for surface nodes) */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	double rwin[NCOORDS],	/* center of window element */
+	double dElemArea,	/* area of window element */
+	double node[NCOORDS],	/* coords of refpt or surfnode */
+	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt or surfnode */
+	double dNodeFactor,	/* visible reflectance of node surface (1.0 for refpts) */
+	int iSeesGround,	/* 1 if rays below horizontal see the ground (surfnodes), 0 for refpts */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
 	double wnorm[NCOORDS],	/* window outward normal vector */
-	double tfac,			/* turbidity factor */
-	double zenl,			/* zenith luminance */
-	// return values stored in surf node, or wndo node substructure
-	double *pdirect_skyclum,	/* ptr to direct luminance from sky - clear */
-	double *pdirect_sunclum,	/* ptr to direct luminance from sun - clear */
-	double *pdirect_skyolum,	/* ptr to direct luminance from sky - overcast */
-	ofstream* pofdmpfile)		/* ptr to LBLDLL error dump file */
+	TVISMOM *pmom,		/* session record of the contribution (NULL for none) */
+	// return values stored in ref pt, or surf node substructure
+	double direct_skyc[NPHS][NTHS],	/* direct illuminance or luminance from sky - clear */
+	double direct_sunc[NPHS][NTHS],	/* direct illuminance or luminance from sun - clear */
+	double *pdirect_skyo,	/* ptr to direct illuminance or luminance from sky - overcast */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
-	double elum, dedir;		/* luminance calc vars */
-	double dGroundLumSkyC, dGroundLumSunC, dGroundLumSkyO;		/* luminance calc vars */
-	double raycos[NCOORDS];	/* unit vector to sun from anywhere in the bldg */
-	double cosi;			/* cos(incidence) of raycos onto wndo */
-	double tviss;			/* vis trans for angle of incidence of raycos through wndo */
-	double tvis1;			/* dummy vis trans for diffuse glazing calc using wndo luminance (==1.0) */
-	double dnsoli;			/* dnsol() return value */
-	HIT rchit;				/* bldg-shade hit structure for dhitsh() */
+	int ic;					/* coordinate index */
+	WRAY wray;				/* ray data from ref_pt or node to window element */
+	double ray[NCOORDS];	/* ref_pt or node to center of window element unit vector */
+	double disq, ddis, dis;	/* ref_pt or node to window element distance vars */
+	double cosWndoIncidence;	/* cos of angle between ray and window outward normal */
+	int iReturnVal = 0;
+
+	/* Calc ray from ref_pt or node to wndo element */
+	/* distance between ref_pt or node and element */
+	disq = 0.;
+	for (ic=0; ic<NCOORDS; ic++) {
+		ddis = rwin[ic] - node[ic];
+		disq += ddis * ddis;
+	}
+	dis = sqrt(disq);
+
+	// Report ref pt distances that are too small for
+	// accurate window-element solid angle calculation.
+	// RJH 2008-03-07: surface nodes skip this warning and accept potential error
+	if ((irp >= 0) && (dis < 2.0)) {
+		// Set Return value to Warning
+		iReturnVal = -10;
+		*pofdmpfile << "WARNING: DElight Inaccurate daylight illuminance calculation may result for lighting zone " <<bldg_ptr->zone[izone]->name << "\n";
+		*pofdmpfile << "WARNING: for reference points closer than 2 feet from window " <<bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->name << "\n";
+		if (dis <= 0.0) {
+			*pofdmpfile << "WARNING: DElight Reference Point " << bldg_ptr->zone[izone]->ref_pt[irp]->name << " is positioned on the window surface and will be ignored.\n";
+			return(iReturnVal);
+		}
+	}
 
-	/* CASE 1 - Window without shades (i.e., clear glazing) */
-	if (bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->shade_flag == 0) {
+	/* unit vector along ray from ref_pt or node to element */
+	for (ic=0; ic<NCOORDS; ic++)
+		ray[ic] = (rwin[ic] - node[ic]) / dis;
+
+	/* Determine if ray intersects a zone-shade or bldg-shade. */
+	/* NOTE: this includes all zone surfaces */
+	/* contrary to DOE2 check of only "self-shade" */
+	/* surfaces (in addition to zone and bldg shades). */
+	/* dhitsh_bvh() resets HIT structure */
+	dhitsh_bvh(&(wray.hit),node,ray,bldg_ptr,izone,iWndoSurf,iNodeSurf);
+
+	/* Azm and alt of ray (i.e., azm and alt of sky element) */
+	dskyray(&wray,ray);
+
+	/* cos of angle between ray and window outward normal */
+	cosWndoIncidence = ddot(wnorm,ray);
+
+	/* Solid angle subtended by element wrt ref_pt or node, */
+	/* tvis of glass for incidence angle, */
+	/* and cos of angle between ray and inward normal of ref_pt or node surface */
+	wray.domega = dElemArea * cosWndoIncidence / disq;
+	wray.tvis = glass_tvis(glass_ptr,iGlass_Type_ID,cosWndoIncidence);
+	wray.cospt = ddot(nodesurfnormal,ray);
+	wray.coswndo = cosWndoIncidence;
+	wray.pmom = pmom;
+
+	int iWndoContribRetVal = wndo_element_direct_slab(bldg_ptr,izone,iWndoSurf,iNodeSurf,iwndo,iWndoElement,
+								sunsky_ptr,&wray,node,nodesurfnormal,dNodeFactor,iSeesGround,
+								glass_ptr,iGlass_Type_ID,wnorm,direct_skyc,direct_sunc,pdirect_skyo,pofdmpfile);
+	if (iWndoContribRetVal < 0) {
+		if (iWndoContribRetVal != -10) {
+			*pofdmpfile << "ERROR: DElight Bad return from wndo_element_direct_slab()\n";
+			return(-1);
+		}
+		iReturnVal = -10;
+	}
 
-		/* If ray hits front of global shading surface, */
-		/* add contrib of shading surf luminance (cd/ft2) */
-		/* to luminance at surf node.  */
-		if (hit_ptr->ihit == 4) {
-			(*pdirect_skyclum) += bldg_ptr->bshade[hit_ptr->hitshade]->skylum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
-			(*pdirect_sunclum) += bldg_ptr->bshade[hit_ptr->hitshade]->sunlum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
-			if ((iphs ==0) && (iths ==0))
-				(*pdirect_skyolum) += bldg_ptr->bshade[hit_ptr->hitshade]->ovrlum*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
+	return(iReturnVal);
+}
+
+/****************************** subroutine wndo_adapt_tolerance *****************************/
+/* Returns the adaptive window element tolerance from the DELIGHT_WNDO_ADAPT_TOL */
+/* environment variable: the largest angle (radians) a merged block of window elements */
+/* may subtend from a ref pt or surface node (e.g. 0.1). */
+/* Unset or <= 0 selects the original uniform window elements (returns 0). */
+/****************************************************************************/
+/****************************** subroutine wndo_adapt_tolerance *****************************/
+double	wndo_adapt_tolerance(void)
+{
+	const char *cTol = getenv("DELIGHT_WNDO_ADAPT_TOL");
+	double dTol;
+
+	if (cTol == NULL) return(0.);
+	dTol = atof(cTol);
+	if (dTol < 0.) dTol = 0.;
+
+	return(dTol);
+}
+
+/****************************** subroutine wndo_adapt_check *****************************/
+/* Returns 1 if adaptive window elements are to be compared with the uniform */
+/* window elements (DELIGHT_WNDO_ADAPT_CHECK set to anything but 0), else 0. */
+/****************************************************************************/
+/****************************** subroutine wndo_adapt_check *****************************/
+int	wndo_adapt_check(void)
+{
+	const char *cCheck = getenv("DELIGHT_WNDO_ADAPT_CHECK");
+
+	if ((cCheck == NULL) || (strcmp(cCheck,"") == 0) || (strcmp(cCheck,"0") == 0)) return(0);
+
+	return(1);
+}
+
+/****************************** subroutine wndo_element_block *****************************/
+/* Recursively builds the quadtree block of window elements covering ispan x ispan grid */
+/* cells from (ix0,iy0). Blocks hold their area and area weighted center. */
+/* A block with a single element is that element; a block with one non-empty quadrant */
+/* is that quadrant. */
+/* Returns the vElem index of the block. */
+/****************************************************************************/
+/****************************** subroutine wndo_element_block *****************************/
+static int	wndo_element_block(
+	WNDO *wndo_ptr,			/* pointer to window */
+	vector<int>& vIndx,		/* window element indexes in this block */
+	vector<int>& vix,		/* grid column of each window element */
+	vector<int>& viy,		/* grid row of each window element */
+	int ix0,				/* first grid column of block */
+	int iy0,				/* first grid row of block */
+	int ispan,				/* grid cells along block side (power of 2) */
+	double dNodeLen,		/* grid cell side length (ft) */
+	vector<WELEM>& vElem)	/* window element blocks */
+{
+	WELEM elem;
+	vector<int> vQuad[4];	/* element indexes in each quadrant */
+	int ii, iq, ic, ihalf;
+
+	/* single window element */
+	if (vIndx.size() == 1) {
+		for (ic=0; ic<NCOORDS; ic++) elem.pos[ic] = wndo_ptr->node[vIndx[0]][ic];
+		elem.area = wndo_ptr->node_areas[vIndx[0]];
+		elem.size = dNodeLen;
+		elem.zlo = elem.zhi = elem.pos[2];
+		for (ii=0; ii<4; ii++) elem.icorner[ii] = vIndx[0];
+		elem.nchild = 0;
+		vElem.push_back(elem);
+		return((int)vElem.size() - 1);
+	}
+
+	/* split into quadrants (or halves of the list, should elements share a grid cell) */
+	ihalf = ispan / 2;
+	for (ii=0; ii<(int)vIndx.size(); ii++) {
+		if (ispan > 1) iq = ((vix[vIndx[ii]] >= ix0 + ihalf) ? 1 : 0) + ((viy[vIndx[ii]] >= iy0 + ihalf) ? 2 : 0);
+		else iq = (2 * ii < (int)vIndx.size()) ? 0 : 1;
+		vQuad[iq].push_back(vIndx[ii]);
+	}
+	if (ispan <= 1) ihalf = ispan = 1;
+
+	elem.nchild = 0;
+	for (iq=0; iq<4; iq++) {
+		if (vQuad[iq].empty()) continue;
+		elem.ichild[elem.nchild++] = wndo_element_block(wndo_ptr,vQuad[iq],vix,viy,
+			ix0 + ((iq & 1) ? ihalf : 0),iy0 + ((iq & 2) ? ihalf : 0),ihalf,dNodeLen,vElem);
+	}
+	if (elem.nchild == 1) return(elem.ichild[0]);
+
+	/* block area and area weighted center, element center z range */
+	elem.area = 0.;
+	for (ic=0; ic<NCOORDS; ic++) elem.pos[ic] = 0.;
+	elem.zlo = vElem[elem.ichild[0]].zlo;
+	elem.zhi = vElem[elem.ichild[0]].zhi;
+	for (ii=0; ii<elem.nchild; ii++) {
+		elem.area += vElem[elem.ichild[ii]].area;
+		for (ic=0; ic<NCOORDS; ic++) elem.pos[ic] += vElem[elem.ichild[ii]].area * vElem[elem.ichild[ii]].pos[ic];
+		elem.zlo = min(elem.zlo,vElem[elem.ichild[ii]].zlo);
+		elem.zhi = max(elem.zhi,vElem[elem.ichild[ii]].zhi);
+	}
+	for (ic=0; ic<NCOORDS; ic++) elem.pos[ic] /= elem.area;
+	elem.size = ispan * dNodeLen;
+
+	/* elements nearest the block corners (lower left, lower right, upper left, upper right on the grid) */
+	for (iq=0; iq<4; iq++) {
+		int iBest = -1, iScore, iBestScore = 0;
+		for (ii=0; ii<(int)vIndx.size(); ii++) {
+			iScore = ((iq & 1) ? vix[vIndx[ii]] : -vix[vIndx[ii]]) + ((iq & 2) ? viy[vIndx[ii]] : -viy[vIndx[ii]]);
+			if ((iBest < 0) || (iScore > iBestScore)) {
+				iBest = vIndx[ii];
+				iBestScore = iScore;
+			}
 		}
+		elem.icorner[iq] = iBest;
+	}
+	vElem.push_back(elem);
 
-		/* If ray hits exterior of zone surface, */
-		/* add contrib of zone surface luminance (cd/ft2) */
-		/* to luminance at surf node.  */
-		if (hit_ptr->ihit == 2) {
-			(*pdirect_skyclum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->skylum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
-			(*pdirect_sunclum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->sunlum[iphs][iths]*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
-			if ((iphs ==0) && (iths ==0))
-				(*pdirect_skyolum) += bldg_ptr->zone[hit_ptr->hitzone]->surf[hit_ptr->hitshade]->ovrlum*domega*tvisincidence*cosPtSurfIncidence * dNodeSurfaceReflectance;
+	return((int)vElem.size() - 1);
+}
+
+/****************************** subroutine wndo_element_tree *****************************/
+/* Builds the quadtree of blocks over the current (uniform) window elements of a window. */
+/* The elements lie on the square grid of the window mesh (see NodeMesh2::grid1()). */
+/* Returns the vElem index of the root block. */
+/****************************************************************************/
+/****************************** subroutine wndo_element_tree *****************************/
+static int	wndo_element_tree(
+	WNDO *wndo_ptr,			/* pointer to window */
+	vector<WELEM>& vElem)	/* returned window element blocks */
+{
+	int nnodes = wndo_ptr->nnodes;
+	vector<int> vIndx(nnodes), vix(nnodes), viy(nnodes);
+	double dNodeLen, dxMin, dyMin;
+	int ii, nspan, ispan;
+
+	vElem.clear();
+	vElem.reserve(2 * nnodes);
+
+	/* grid cell of each element */
+	dNodeLen = sqrt(wndo_ptr->node_areas[0]);
+	dxMin = dyMin = 0.;
+	for (ii=0; ii<nnodes; ii++) {
+		BGL::point2 p2 = wndo_ptr->NodePosition2D(ii);
+		if ((ii == 0) || (p2[0] < dxMin)) dxMin = p2[0];
+		if ((ii == 0) || (p2[1] < dyMin)) dyMin = p2[1];
+	}
+	nspan = 1;
+	for (ii=0; ii<nnodes; ii++) {
+		BGL::point2 p2 = wndo_ptr->NodePosition2D(ii);
+		vIndx[ii] = ii;
+		vix[ii] = (int)floor((p2[0] - dxMin) / dNodeLen + 0.5);
+		viy[ii] = (int)floor((p2[1] - dyMin) / dNodeLen + 0.5);
+		nspan = max(nspan,max(vix[ii],viy[ii]) + 1);
+	}
+	for (ispan=1; ispan<nspan; ispan*=2);
+
+	return(wndo_element_block(wndo_ptr,vIndx,vix,viy,0,0,ispan,dNodeLen,vElem));
+}
+
+/****************************** subroutine wndo_block_shading_changes *****************************/
+/* Returns 1 if the rays from a ref pt or surface node to the window elements of a block */
+/* may differ in what they see, else 0: if the element centers lie both above and below */
+/* the node (sky versus ground), or if the rays to the sub-blocks and to the corner */
+/* elements of the block do not all hit the same shade or surface. */
+/****************************************************************************/
+/****************************** subroutine wndo_block_shading_changes *****************************/
+static int	wndo_block_shading_changes(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* current zone index */
+	int iWndoSurf,		/* current index for surface containing Window */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
+	WNDO *wndo_ptr,		/* pointer to window */
+	vector<WELEM>& vElem,	/* window element blocks */
+	WELEM *pelem,		/* pointer to block */
+	double node[NCOORDS])	/* coords of refpt or surfnode */
+{
+	HIT hit, hit0;		/* shading hits of the sub-block and corner element rays */
+	double ray[NCOORDS];	/* node to sub-block or corner element unit vector */
+	double *ptarget;	/* sub-block center or corner element */
+	double dis;
+	int ii, ic;
+
+	/* sky versus ground */
+	if ((pelem->zlo <= node[2]) && (pelem->zhi >= node[2])) return(1);
+
+	for (ii=0; ii<pelem->nchild+4; ii++) {
+		if (ii < pelem->nchild) ptarget = vElem[pelem->ichild[ii]].pos;
+		else ptarget = wndo_ptr->node[pelem->icorner[ii-pelem->nchild]];
+		dis = 0.;
+		for (ic=0; ic<NCOORDS; ic++) {
+			ray[ic] = ptarget[ic] - node[ic];
+			dis += ray[ic] * ray[ic];
 		}
+		dis = sqrt(dis);
+		if (dis <= 0.0) return(1);
+		for (ic=0; ic<NCOORDS; ic++) ray[ic] /= dis;
+		dhitsh_bvh(&hit,node,ray,bldg_ptr,izone,iWndoSurf,iNodeSurf);
+		if (ii == 0) {
+			hit0 = hit;
+			continue;
+		}
+		if (hit.ihit != hit0.ihit) return(1);
+		if ((hit.ihit != 0) && ((hit.hitshade != hit0.hitshade) || (hit.hitzone != hit0.hitzone))) return(1);
+	}
 
-		/* If shading surface not hit, add contrib of */
-		/* sky or ground luminance (cd/ft2). */
-		if (hit_ptr->ihit == 0) {
+	return(0);
+}
 
-			/* for clear sky */
-			// If ray points upward above or along the horizontal plane, then add contribution from sky
-			if (phray >= 0.0) {
-				elum = dskylu(0,thray,phray,thsun,phsun,zenl);
-				dedir = elum * domega * tvisincidence * cosPtSurfIncidence * dNodeSurfaceReflectance;
-				(*pdirect_skyclum) += dedir;
-			}
-			// If ray points downward below the horizontal plane, then add contribution from ground
-			else {
-				// Add luminance from ground modified by wndo vis trans and angle of incidence on node surface
-				// Luminance of ground (cd/ft2) is 
-				// illuminance on ground (lum/ft2) * gnd_refl (which gives ft-lamberts) / PI
-				dGroundLumSkyC = bldg_ptr->hillumskyc[iphs] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
-				dGroundLumSunC = bldg_ptr->hillumsunc[iphs] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
-				// Add separate sky and sun components of ground luminance
-				(*pdirect_skyclum) += dGroundLumSkyC * domega * tvisincidence * cosPtSurfIncidence * dNodeSurfaceReflectance;
-				(*pdirect_sunclum) += dGroundLumSunC * domega * tvisincidence * cosPtSurfIncidence * dNodeSurfaceReflectance;
+/****************************** subroutine wndo_point_adaptive *****************************/
+/* Adds the direct contribution of one window to one ref pt or surface node, walking */
+/* the window element blocks from the root: a block is refined into its sub-blocks if */
+/* it subtends more than dTol radians from the node, or if the rays to its sub-blocks */
+/* differ in what they see; otherwise it is evaluated as one element at its center. */
+/* Returns 0, -10 for warnings, -1 for errors. */
+/****************************************************************************/
+/****************************** subroutine wndo_point_adaptive *****************************/
+static int	wndo_point_adaptive(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* current zone index */
+	int iWndoSurf,		/* current index for surface containing Window */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
+	int iwndo,			/* current window index */
+	int irp,			/* current ref pt index (-1 for surface nodes) */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	vector<WELEM>& vElem,	/* window element blocks */
+	int iroot,			/* vElem index of root block */
+	double dTol,		/* max angle (radians) subtended by an evaluated block */
+	double node[NCOORDS],	/* coords of refpt or surfnode */
+	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt or surfnode */
+	double dNodeFactor,	/* visible reflectance of node surface (1.0 for refpts) */
+	int iSeesGround,	/* 1 if rays below horizontal see the ground (surfnodes), 0 for refpts */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
+	double wnorm[NCOORDS],	/* window outward normal vector */
+	TVISMOM *pmom,		/* session record of the contributions (NULL for none) */
+	double direct_skyc[NPHS][NTHS],	/* direct illuminance or luminance from sky - clear */
+	double direct_sunc[NPHS][NTHS],	/* direct illuminance or luminance from sun - clear */
+	double *pdirect_skyo,	/* ptr to direct illuminance or luminance from sky - overcast */
+	long *pnevals,		/* ptr to # of evaluated elements (incremented) */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	vector<int> vStack;		/* blocks to visit */
+	WELEM *pelem;
+	double dis, ddis;
+	int ii, ic, ieval = 0;
+	int iReturnVal = 0;
+
+	vStack.push_back(iroot);
+	while (!vStack.empty()) {
+		pelem = &(vElem[vStack.back()]);
+		vStack.pop_back();
+
+		/* refine large or partly shaded blocks */
+		if (pelem->nchild > 0) {
+			dis = 0.;
+			for (ic=0; ic<NCOORDS; ic++) {
+				ddis = pelem->pos[ic] - node[ic];
+				dis += ddis * ddis;
 			}
-
-			/* for overcast sky */
-			if ((iphs == 0) && (iths == 0)) {
-				// If ray points upward above or along the horizontal plane, then add contribution from sky
-				if (phray > 0.0) {
-					elum = dskylu(1,thray,phray,thsun,phsun,zenl);
-					dedir = elum * domega * tvisincidence * cosPtSurfIncidence * dNodeSurfaceReflectance;
-					(*pdirect_skyolum) += dedir;
-				}
-				// If ray points downward below the horizontal plane, then add contribution from ground
-				else {
-					// Add luminance from ground modified by wndo vis trans and angle of incidence on node surface
-					// Luminance of ground (cd/ft2) is 
-					// illuminance on ground (lum/ft2) * gnd_refl (which gives ft-lamberts) / PI
-					dGroundLumSkyO = bldg_ptr->hillumskyo[iphs] * bldg_ptr->zone[izone]->surf[iWndoSurf]->gnd_refl / PI;
-					(*pdirect_skyolum) += dGroundLumSkyO * domega * tvisincidence * cosPtSurfIncidence * dNodeSurfaceReflectance;
-				}
+			dis = sqrt(dis);
+			if ((pelem->size > dTol * dis)
+				|| wndo_block_shading_changes(bldg_ptr,izone,iWndoSurf,iNodeSurf,
+					bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo],vElem,pelem,node)) {
+				for (ii=pelem->nchild-1; ii>=0; ii--) vStack.push_back(pelem->ichild[ii]);
+				continue;
 			}
 		}
 
-		/* Illuminance from (unreflected) direct sun. */
-		/* (calculated only once per wndo for each surf node) */
-//		if ((ix == (nwx-1)) && (iy == (nwy-1))) {
-		if (iWndoElement == 0) {
-			/* unit vector to sun from anywhere in the bldg */
-			raycos[0] = cos(phsun) * cos(thsun);
-			raycos[1] = cos(phsun) * sin(thsun);
-			raycos[2] = sin(phsun);
-			
-			/* is sun on front side of current window? */
-			cosi = ddot(wnorm,raycos);
-			if (cosi > 0.0) {
-				/* does raycos from current surf node pass thru window? */
-//				dpierc(&ip,w1,w2,w3,node,raycos);
-
-                // Use WLC ray intersect surface polygon method.
-                // Note that this tests ray intersecting surface face on the INSIDE of DOE2 convention surface
-                // So this only works for rays from nodal points intersecting Window Surface polygons from inside zone.
-                BGL::point3	pt3Node = BGL::point3(node[0], node[1], node[2]);	//	center of box
-                BGL::vector3 vRayDir = BGL::vector3(raycos[0], raycos[1], raycos[2]);
-                BGL::ray3	r3Ray(pt3Node,vRayDir);
-                bool bIntersects = false;
-                Double dParam;  // can be used to calculate intersection point
-                bIntersects = bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->intersect(r3Ray,dParam);
-
-				if (bIntersects) {
-//				if (ip != 0) {
-					/* does raycos from current surf node intercept shade? */
-					/* NOTE: this includes all zone surfaces contrary to DOE2 check of */
-					/* only "self-shade" surfaces (in addition to zone and bldg shades). */
-					// rjh 5/14/97 correction - parameter ray replaced with raycos
-	//				dhitsh(&rchit,rref,ray,bldg_ptr,izone,isurf);
-					dhitsh(&rchit,node,raycos,bldg_ptr,izone,iWndoSurf,iNodeSurf);
-					if (rchit.ihit == 0) {
-						/* sun reaches surf node */
-						/* increment luminance */
-
-						// tvis of glass for cosi incid angle
-						// Window 4 implementation 4/2002
-						/* set lib_index component type to glass */
-						char sLibCompType[MAX_CHAR_UNAME+1];	/* temp str */
-						/* get library index of current window glass type */
-						strcpy(sLibCompType,"glass");
-						int igt = lib_index(lib_ptr,sLibCompType,bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->glass_type);
-						int iGlass_Type_ID = atoi(bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->glass_type);
-						// glass type ID: 1 to 11 => DOE2 original, >11 => W4lib.dat, <0 => E10 library
-						if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
-
-							// DOE2 original angular dependence equation coefs
-							double cam1 = lib_ptr->glass[igt]->cam1;
-							double cam2 = lib_ptr->glass[igt]->cam2;
-							double cam3 = lib_ptr->glass[igt]->cam3;
-							double cam4 = lib_ptr->glass[igt]->cam4;
-
-							// tvis of glass for cosi incid angle
-							tviss = max(0.0,(cam1+cosi*(cam2+cosi*(cam3+cosi*cam4))));
-						}
-						else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4
-
-							// Window4 angular dependence Fit4() function coefs.
-							double W4vis_fit1 = lib_ptr->glass[igt]->W4vis_fit1;
-							double W4vis_fit2 = lib_ptr->glass[igt]->W4vis_fit2;
-
-							// tvis of glass for cosi incid angle
-							tviss = vis_trans * fit4(cosi, W4vis_fit1, W4vis_fit2);
-						}
-						else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5
-
-							// tvis of glass for cosi incid angle
-							tviss = POLYF(cosi, lib_ptr->glass[igt]->EPlusCoef);
-						}
-						else if (iGlass_Type_ID < 0) {	// Energy-10
-
-							/* Energy-10 angular dependence equation coefs. */
-							double E10coef1 = lib_ptr->glass[igt]->E10coef[0];
-							double E10coef2 = lib_ptr->glass[igt]->E10coef[1];
-							double E10coef3 = lib_ptr->glass[igt]->E10coef[2];
-							double E10coef4 = lib_ptr->glass[igt]->E10coef[3];
-
-							// tvis of glass for cosi incid angle
-							tviss = vis_trans * max(0.0,(cosi*(E10coef1+cosi*(E10coef2+cosi*(E10coef3+cosi*E10coef4)))));
-						}
-
-						/* calc direct normal illuminance (lumens/ft2) from solar disk */
-						dnsoli = dnsol(solic,bldg_ptr,IMREF,phsun,tfac,pofdmpfile);
-						if (dnsoli < 0.0) {
-							*pofdmpfile << "ERROR: DElight Bad return from dnsol() = " <<dnsoli << ", exit wndo_element_lum_contrib()\n";
-							return(-1);
-						}
-
-						/* calc cos(incidence) for raycos on node surface */
-						double cosinc;
-						cosinc = ddot(nodesurfnormal,raycos);
-
-						/* add luminance from sun modified by wndo vis trans and angle of incidence on node surface */
-						(*pdirect_sunclum) += dnsoli*tviss*cosinc * dNodeSurfaceReflectance;
-					}
-				}
-			}
+		/* the first evaluated element adds the direct sun */
+		int iWndoContribRetVal = wndo_element_direct_ray(bldg_ptr,izone,iWndoSurf,iNodeSurf,iwndo,ieval,irp,
+									sunsky_ptr,pelem->pos,pelem->area,node,nodesurfnormal,dNodeFactor,iSeesGround,
+									glass_ptr,iGlass_Type_ID,wnorm,pmom,direct_skyc,direct_sunc,pdirect_skyo,pofdmpfile);
+		ieval++;
+		if (iWndoContribRetVal < 0) {
+			if (iWndoContribRetVal != -10) return(-1);
+			iReturnVal = -10;
 		}
 	}
+	(*pnevals) += ieval;
 
-	/* CASE 2 - Window with closed shades (i.e., diffuse glazing) */
-	else { // (bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->shade_flag != 0)
+	return(iReturnVal);
+}
 
-		/* Luminance of wndo element is shade luminance. */
-		tvis1 = 1.0;
+/****************************** subroutine wndo_direct_adaptive *****************************/
+/* Adaptive alternative to the uniform window element loop of CalcZoneDirectIllum(): */
+/* adds the direct contribution of one window to every ref pt and surface node of the */
+/* zone, merging the (uniform) window elements into quadtree blocks wherever a block */
+/* is small as seen from the node and uniformly shaded (see wndo_point_adaptive()). */
+/* Counts the uniform and evaluated elements in the zone (wndo_elems_uniform, */
+/* wndo_elems_adaptive). If iCheck is set, also evaluates the uniform elements and */
+/* keeps the largest deviation per node, relative to its largest uniform value, */
+/* in the zone (wndo_adapt_dev). */
+/* Returns 0, -10 for warnings, -1 for errors. */
+/****************************************************************************/
+/****************************** subroutine wndo_direct_adaptive *****************************/
+int	wndo_direct_adaptive(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* current zone index */
+	int isurf,			/* current index for surface containing Window */
+	int iw,				/* current window index */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
+	double wnorm[NCOORDS],	/* window outward normal vector */
+	double dTol,		/* max angle (radians) subtended by an evaluated block */
+	int iCheck,			/* compare with uniform window elements? (0=No 1=Yes) */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	ZONE *zone_ptr = bldg_ptr->zone[izone];
+	WNDO *wndo_ptr = zone_ptr->surf[isurf]->wndo[iw];
+	vector<WELEM> vElem;	/* window element blocks */
+	int iroot;				/* root block index */
+	double skyc[NPHS][NTHS], sunc[NPHS][NTHS], skyo;	/* adaptive contribution to current node */
+	double uskyc[NPHS][NTHS], usunc[NPHS][NTHS], uskyo;	/* uniform contribution to current node (iCheck) */
+	double nodesurfnormal[NCOORDS];	/* node surface INWARD normal unit vector */
+	double *pnode;			/* coords of current refpt or surfnode */
+	double (*pskyc)[NTHS], (*psunc)[NTHS], *pskyo;	/* direct illum or lum of current refpt or surfnode */
+	double dNodeFactor, dmax, ddev;
+	ofstream ofnull;		/* unopened: discards messages of the uniform check */
+	int irp, iIntSurf, inode, iNodeSurf, iSeesGround, iphs, iths, ie, ic;
+	TVISMOM *pmom;			/* session record of current refpt or surfnode */
+	int iRetVal;
+	int iReturnVal = 0;
+
+	iroot = wndo_element_tree(wndo_ptr,vElem);
+
+	/* ref pts, then the nodes of the other zone surfaces */
+	for (iIntSurf=-1; iIntSurf<zone_ptr->nsurfs; iIntSurf++) {
+		if (iIntSurf == isurf) continue;
+		if (iIntSurf < 0) {
+			/* all ref_pts assumed horizontal facing upward */
+			nodesurfnormal[0] = 0.0;
+			nodesurfnormal[1] = 0.0;
+			nodesurfnormal[2] = 1.0;
+		}
+		else {
+			for (ic=0; ic<NCOORDS; ic++) nodesurfnormal[ic] = zone_ptr->surf[iIntSurf]->inward_uvect[ic];
+		}
 
-		/* for clear sky */
-		(*pdirect_skyclum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumsky[iphs][iths]*domega*tvis1*cosPtSurfIncidence * dNodeSurfaceReflectance;
-		(*pdirect_sunclum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumsun[iphs][iths]*domega*tvis1*cosPtSurfIncidence * dNodeSurfaceReflectance;
+		for (inode=0; inode<((iIntSurf < 0) ? zone_ptr->nrefpts : zone_ptr->surf[iIntSurf]->nnodes); inode++) {
+			if (iIntSurf < 0) {
+				irp = inode;
+				iNodeSurf = isurf;
+				iSeesGround = 0;
+				dNodeFactor = 1.0;
+				pnode = zone_ptr->ref_pt[irp]->bs;
+				pskyc = zone_ptr->ref_pt[irp]->direct_skycillum;
+				psunc = zone_ptr->ref_pt[irp]->direct_suncillum;
+				pskyo = &(zone_ptr->ref_pt[irp]->direct_skyoillum);
+			}
+			else {
+				irp = -1;
+				iNodeSurf = iIntSurf;
+				iSeesGround = 1;
+				dNodeFactor = zone_ptr->surf[iIntSurf]->vis_refl;
+				pnode = zone_ptr->surf[iIntSurf]->node[inode];
+				pskyc = zone_ptr->surf[iIntSurf]->direct_skyclum[inode];
+				psunc = zone_ptr->surf[iIntSurf]->direct_sunclum[inode];
+				pskyo = &(zone_ptr->surf[iIntSurf]->direct_skyolum[inode]);
+			}
 
-		/* for overcast sky */
-		if ((iphs == 0) && (iths == 0)) {
-			(*pdirect_skyolum) += bldg_ptr->zone[izone]->surf[iWndoSurf]->wndo[iwndo]->wlumskyo*domega*tvis1*cosPtSurfIncidence * dNodeSurfaceReflectance;
+			pmom = session_tvis_mom(bldg_ptr->session,izone,isurf,iw,iIntSurf,inode);
+			memset(skyc,0,sizeof(skyc));
+			memset(sunc,0,sizeof(sunc));
+			skyo = 0.;
+			iRetVal = wndo_point_adaptive(bldg_ptr,izone,isurf,iNodeSurf,iw,irp,sunsky_ptr,vElem,iroot,dTol,
+						pnode,nodesurfnormal,dNodeFactor,iSeesGround,glass_ptr,iGlass_Type_ID,wnorm,
+						pmom,skyc,sunc,&skyo,&(zone_ptr->wndo_elems_adaptive),pofdmpfile);
+			if (iRetVal < 0) {
+				// surface nodes register errors only
+				if (iRetVal != -10) return(-1);
+				if (irp >= 0) iReturnVal = -10;
+			}
+			zone_ptr->wndo_elems_uniform += wndo_ptr->nnodes;
+
+			/* compare with the uniform window elements */
+			if (iCheck) {
+				memset(uskyc,0,sizeof(uskyc));
+				memset(usunc,0,sizeof(usunc));
+				uskyo = 0.;
+				for (ie=0; ie<wndo_ptr->nnodes; ie++) {
+					iRetVal = wndo_element_direct_ray(bldg_ptr,izone,isurf,iNodeSurf,iw,ie,irp,sunsky_ptr,
+								wndo_ptr->node[ie],wndo_ptr->node_areas[ie],pnode,nodesurfnormal,dNodeFactor,iSeesGround,
+								glass_ptr,iGlass_Type_ID,wnorm,NULL,uskyc,usunc,&uskyo,&ofnull);
+					if ((iRetVal < 0) && (iRetVal != -10)) return(-1);
+				}
+				dmax = fabs(uskyo);
+				ddev = fabs(skyo - uskyo);
+				for (iphs=0; iphs<NPHS; iphs++) {
+					for (iths=0; iths<NTHS; iths++) {
+						dmax = max(dmax,max(fabs(uskyc[iphs][iths]),fabs(usunc[iphs][iths])));
+						ddev = max(ddev,max(fabs(skyc[iphs][iths] - uskyc[iphs][iths]),fabs(sunc[iphs][iths] - usunc[iphs][iths])));
+					}
+				}
+				if (dmax > 0.) zone_ptr->wndo_adapt_dev = max(zone_ptr->wndo_adapt_dev,ddev / dmax);
+			}
+
+			/* add window contribution to refpt or surfnode */
+			for (iphs=0; iphs<NPHS; iphs++) {
+				for (iths=0; iths<NTHS; iths++) {
+					pskyc[iphs][iths] += skyc[iphs][iths];
+					psunc[iphs][iths] += sunc[iphs][iths];
+				}
+			}
+			(*pskyo) += skyo;
 		}
 	}
 
-	return(0);
+	return(iReturnVal);
 }
@@ -34,65 +34,115 @@ int	CalcDFs(
 	int iIterations,		/* number of radiosity iterations */
 	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
 
-int	wndo_element_refpt_illum_contrib(
+int	CalcZoneDirectIllum(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
-	LIB *lib_ptr,		/* pointer to lib structure */
+	LIB *lib_ptr,		/* pointer to library structure */
 	int izone,			/* current zone index */
-	int iWndoSurf,		/* current surface index for Surface containing Window */
-	int iNodeSurf,		/* current surface index for Surface containing Node (Not Applicable) */
+	SUNSKY *psunsky,	/* pointer to sky constants for each sun position */
+	double phsmin,		/* minimum sun postition altitude (degrees) */
+	double phsdel,		/* sun position altitude increment (degrees) */
+	double thsmin,		/* minimum sun postition azimuth (degrees: South=0.0, East=+90.0) */
+	double thsdel,		/* sun position azimuth increment (degrees) */
+	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
+
+void	zone_daylight_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	int izone);			/* current zone index */
+
+int	radiosity_convergence(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
+
+int	ZoneInterreflectDFs(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	int iIterations,	/* number of radiosity iterations */
+	int izone,			/* current zone index */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
+
+int	CalcDFsZonePool(
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	int iIterations,	/* number of radiosity iterations */
+	SUNSKY *psunsky,	/* pointer to sky constants for each sun position */
+	double phsmin,		/* minimum sun postition altitude (degrees) */
+	double phsdel,		/* sun position altitude increment (degrees) */
+	double thsmin,		/* minimum sun postition azimuth (degrees: South=0.0, East=+90.0) */
+	double thsdel,		/* sun position azimuth increment (degrees) */
+	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
+	int nthreads,		/* number of threads */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
+
+int	wndo_element_direct_slab(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* current zone index */
+	int iWndoSurf,		/* current index for surface containing Window */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
 	int iwndo,			/* current window index */
 	int iWndoElement,	/* window element index */
-	double thsun,		/* sun azm (radians) */
-	double phsun,		/* sun alt (radians) */
-	double thray,		/* sky element azm angle */
-	double phray,		/* sky element alt angle */
-	int iphs,			/* sun alt index */
-	int iths,			/* sun azm index */
-	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
-	double node[NCOORDS],	/* coords of refpt */
-	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt virtual surface */
-	double cosincidence,	/* cos(angle of incidence) of vector from refpt to wndo element */
-	HIT *hit_ptr,			/* hit structure pointer for ray from refpt to wndo element */
-	double domega,			/* solid angle subtended by window element wrt ref_pt */
-	double vis_trans,		/* tvis of glass for normal incidence angle */
-	double tvisincidence,	/* tvis of glass for current incidence angle */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	WRAY *wray_ptr,		/* pointer to ray data from node to wndo element */
+	double node[NCOORDS],	/* coords of refpt or surfnode */
+	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt or surfnode */
+	double dNodeFactor,	/* visible reflectance of node surface (1.0 for refpts) */
+	int iSeesGround,	/* 1 if rays below horizontal see the ground (surfnodes), 0 for refpts */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
 	double wnorm[NCOORDS],	/* window outward normal vector */
-	double tfac,			/* turbidity factor */
-	double zenl,			/* zenith luminance */
-	// return values stored in ref pt substructure
-	double *pdirect_skycillum,	/* ptr to direct illuminance from sky - clear */
-	double *pdirect_suncillum,	/* ptr to direct illuminance from sun - clear */
-	double *pdirect_skyoillum,	/* ptr to direct illuminance from sky - overcast */
-	ofstream* pofdmpfile);		/* ptr to LBLDLL error dump file */
+	// return values stored in ref pt, or surf node substructure
+	double direct_skyc[NPHS][NTHS],	/* direct illuminance or luminance from sky - clear */
+	double direct_sunc[NPHS][NTHS],	/* direct illuminance or luminance from sun - clear */
+	double *pdirect_skyo,	/* ptr to direct illuminance or luminance from sky - overcast */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
 
-int	wndo_element_surfnode_lum_contrib(
+double	glass_tvis(
+	GLASS *glass_ptr,	/* pointer to library glass type */
+	int iGlass_Type_ID,	/* glass type ID */
+	double cosi);		/* cos of angle of incidence */
+
+int	wndo_element_direct_ray(
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
-	LIB *lib_ptr,		/* pointer to lib structure */
 	int izone,			/* current zone index */
-	int iWndoSurf,		/* current surface index for Surface containing Window */
-	int iNodeSurf,		/* current surface index for Surface containing Node */
+	int iWndoSurf,		/* current index for surface containing Window */
+	int iNodeSurf,		/* current index for surface containing Node (iWndoSurf for refpts) */
 	int iwndo,			/* current window index */
-	int iWndoElement,	/* window element index */
-	double thsun,		/* sun azm (radians) */
-	double phsun,		/* sun alt (radians) */
-	double thray,		/* sky element azm angle */
-	double phray,		/* sky element alt angle */
-	int iphs,			/* sun alt index */
-	int iths,			/* sun azm index */
-	double solic[MONTHS],	/* extraterrestrial irrad for 1st of each month (0 to 11) */
-	double node[NCOORDS],	/* coords of surfnode */
-	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of surfnode */
-	double dNodeSurfaceReflectance, // visible reflectance of node surface
-	double cosincidence,	/* cos(angle of incidence) of vector from surfnode to wndo element */
-	HIT *hit_ptr,			/* hit structure pointer for ray from surfnode to wndo element */
-	double domega,			/* solid angle subtended by window element wrt surfnode */
-	double vis_trans,		/* tvis of glass for normal incidence angle */
-	double tvisincidence,	/* tvis of glass for current incidence angle */
+	int iWndoElement,	/* window element index (0 adds the direct sun) */
+	int irp,			/* current ref pt index (-1 for surface nodes) */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	double rwin[NCOORDS],	/* center of window element */
+	double dElemArea,	/* area of window element */
+	double node[NCOORDS],	/* coords of refpt or surfnode */
+	double nodesurfnormal[NCOORDS],	/* INWARD normal unit vector from face of refpt or surfnode */
+	double dNodeFactor,	/* visible reflectance of node surface (1.0 for refpts) */
+	int iSeesGround,	/* 1 if rays below horizontal see the ground (surfnodes), 0 for refpts */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
 	double wnorm[NCOORDS],	/* window outward normal vector */
-	double tfac,			/* turbidity factor */
-	double zenl,			/* zenith luminance */
-	// return values stored in surf node, or wndo node substructure
-	double *pdirect_skyclum,	/* ptr to direct luminance from sky - clear */
-	double *pdirect_sunclum,	/* ptr to direct luminance from sun - clear */
-	double *pdirect_skyolum,	/* ptr to direct luminance from sky - overcast */
-	ofstream* pofdmpfile);		/* ptr to LBLDLL error dump file */
+	TVISMOM *pmom,		/* session record of the contribution (NULL for none) */
+	// return values stored in ref pt, or surf node substructure
+	double direct_skyc[NPHS][NTHS],	/* direct illuminance or luminance from sky - clear */
+	double direct_sunc[NPHS][NTHS],	/* direct illuminance or luminance from sun - clear */
+	double *pdirect_skyo,	/* ptr to direct illuminance or luminance from sky - overcast */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
+
+double	wndo_adapt_tolerance(void);
+
+int	wndo_adapt_check(void);
+
+int	wndo_direct_adaptive(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* current zone index */
+	int isurf,			/* current index for surface containing Window */
+	int iw,				/* current window index */
+	SUNSKY *sunsky_ptr,	/* pointer to sky constants for each sun position */
+	GLASS *glass_ptr,	/* pointer to library glass type of window */
+	int iGlass_Type_ID,	/* glass type ID of window */
+	double wnorm[NCOORDS],	/* window outward normal vector */
+	double dTol,		/* max angle (radians) subtended by an evaluated block */
+	int iCheck,			/* compare with uniform window elements? (0=No 1=Yes) */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
@@ -0,0 +1,110 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <cstdlib>
+
+// includes
+#include "DLPhase.h"
+
+/* Phase hook state: set once by the caller before preprocessing starts. */
+static DLPHASEHOOK phase_hook = NULL;	/* phase hook (NULL for none) */
+static void *phase_data = NULL;			/* hook data */
+static int iPhaseHold = 0;				/* phase reports held back? (>0 = Yes) */
+
+static const char *phase_names[NDLPHASES] = {
+	"load", "geom", "sky", "direct", "cfs", "interreflect", "dump"
+};
+
+/****************************** subroutine set_dl_phase_hook *****************************/
+/* Installs a hook that is called at the beginning and end of each preprocessing phase, */
+/* e.g. to time phases or read hardware counters from a benchmark driver. */
+/* Not thread safe: set it before, and clear it after, the DElight calls it should see. */
+/****************************************************************************/
+/****************************** subroutine set_dl_phase_hook *****************************/
+void set_dl_phase_hook(
+	DLPHASEHOOK hook,	/* phase hook (NULL for none) */
+	void *pdata)		/* hook data */
+{
+	phase_hook = hook;
+	phase_data = pdata;
+	iPhaseHold = 0;
+}
+
+/****************************** subroutine dl_phase *****************************/
+/* Reports the beginning or end of a phase to the phase hook, if any. */
+/* Per-zone phases are reported once per zone. Reports are held back while zones run */
+/* over a thread pool (see dl_phase_hold()), so the hook is only ever called from the */
+/* thread that runs the preprocessing. */
+/****************************************************************************/
+/****************************** subroutine dl_phase *****************************/
+void dl_phase(
+	int iphase,			/* phase (DLPHASE_*) */
+	int iBegin)			/* beginning or end of phase? (1=Begin 0=End) */
+{
+	if ((phase_hook == NULL) || (iPhaseHold > 0)) return;
+	phase_hook(iphase,iBegin,phase_data);
+}
+
+/****************************** subroutine dl_phase_hold *****************************/
+/* Holds back (iHold=1) or resumes (iHold=0) phase reports; calls nest. */
+/* Called on the preprocessing thread around thread pool runs only. */
+/****************************************************************************/
+/****************************** subroutine dl_phase_hold *****************************/
+void dl_phase_hold(
+	int iHold)			/* hold back (1) or resume (0) phase reports */
+{
+	if (iHold) iPhaseHold++;
+	else if (iPhaseHold > 0) iPhaseHold--;
+}
+
+/****************************** subroutine dl_phase_name *****************************/
+/* Returns the short name of a phase, as used in benchmark reports. */
+/****************************************************************************/
+/****************************** subroutine dl_phase_name *****************************/
+const char *dl_phase_name(
+	int iphase)			/* phase (DLPHASE_*) */
+{
+	if ((iphase < 0) || (iphase >= NDLPHASES)) return("unknown");
+	return(phase_names[iphase]);
+}
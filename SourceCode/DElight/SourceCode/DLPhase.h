@@ -0,0 +1,73 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency 
+// and Renewable Energy, Office of Building Technologies, 
+// Building Systems and Materials Division of the 
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf 
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce, 
+prepare derivative works, and perform publicly and display publicly. 
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself 
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to 
+the public, perform publicly and display publicly, and to permit others to do so. 
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL 
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY 
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE 
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+
+/* Preprocessing phases reported to a phase hook (see DLPhase.cpp) */
+enum {
+	DLPHASE_LOAD,			/* input file read */
+	DLPHASE_GEOM,			/* geometry and meshes */
+	DLPHASE_SKY,			/* exterior sky, shade luminances and node arrays */
+	DLPHASE_DIRECT,			/* direct illuminance of one zone (includes DLPHASE_CFS) */
+	DLPHASE_CFS,			/* CFS surfaces of one zone */
+	DLPHASE_INTERREFLECT,	/* interreflection and daylight factors of one zone */
+	DLPHASE_DUMP,			/* output file write */
+	NDLPHASES
+};
+
+/* Phase hook called at the beginning (iBegin=1) and end (iBegin=0) of each phase. */
+typedef void (*DLPHASEHOOK)(
+	int iphase,			/* phase (DLPHASE_*) */
+	int iBegin,			/* beginning or end of phase? (1=Begin 0=End) */
+	void *pdata);		/* hook data */
+
+void set_dl_phase_hook(
+	DLPHASEHOOK hook,	/* phase hook (NULL for none) */
+	void *pdata);		/* hook data */
+
+void dl_phase(
+	int iphase,			/* phase (DLPHASE_*) */
+	int iBegin);		/* beginning or end of phase? (1=Begin 0=End) */
+
+void dl_phase_hold(
+	int iHold);			/* hold back (1) or resume (0) phase reports */
+
+const char *dl_phase_name(
+	int iphase);		/* phase (DLPHASE_*) */
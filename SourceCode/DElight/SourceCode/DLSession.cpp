@@ -0,0 +1,576 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <string>
+using namespace std;
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "NodeMesh2.h"
+#include "WLCSurface.h"
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+#include "CFSSurface.h"
+
+// includes
+#include "DOE2DL.H"
+#include "DFcalcs.h"
+#include "TOOLS.H"
+#include "TaskPool.h"
+#include "DLSession.h"
+
+/* A session keeps what CalcDFs() worked out from the geometry, so that changes of glass */
+/* or surface reflectance can be recalculated without ray casts, sky luminances or form */
+/* factors. Every glass tvis curve used by DElight is a polynomial in the cos(incidence) */
+/* c of the ray on the window (at most 6th degree, clipped at zero), so the direct */
+/* contribution of a window to a ref pt or surface node is sum(a[k] * M[k]) with a[k] the */
+/* polynomial coefs and M[k] the sum of the unit tvis, unit reflectance contributions */
+/* times c^k over its rays (TVISMOM). CFS contributions do not depend on glass and are */
+/* kept before reflectance (DLFIXED). The form factors stay cached on the surfaces. */
+
+typedef struct {	/* direct contributions recorded for one lighting zone */
+	int ntargets;				/* # of ref pts and surface nodes */
+	vector<int> surf_t0;		/* [surf] target index of first surface node (ref pts come first) */
+	vector<int> surf_w0;		/* [surf] index of first window of surface */
+	vector<char> wrecorded;		/* [window] were the window contributions recorded? */
+	vector<TVISMOM> wmom;		/* [window*ntargets + target] window contributions */
+	vector<DLFIXED> fixed;		/* [target] CFS contributions */
+} DLZONEREC;
+
+struct DLSESSION {	/* incremental recalculation data of a bldg */
+	SUN_DATA sun;			/* sun positions of the recorded calcs */
+	int iIterations;		/* number of radiosity iterations */
+	int recorded;			/* has CalcDFs() recorded the contributions? */
+	vector<DLZONEREC> zone;	/* [zone] recorded contributions */
+};
+
+/****************************** subroutine new_dl_session *****************************/
+/* Creates an empty session. Hang it on bldg->session before CalcDFs() to have the */
+/* direct contributions recorded. */
+/****************************************************************************/
+/****************************** subroutine new_dl_session *****************************/
+DLSESSION *new_dl_session(void)
+{
+	DLSESSION *session_ptr = new DLSESSION;
+
+	memset(&(session_ptr->sun),0,sizeof(SUN_DATA));
+	session_ptr->iIterations = 0;
+	session_ptr->recorded = 0;
+
+	return(session_ptr);
+}
+
+/****************************** subroutine free_dl_session *****************************/
+/* Releases a session created by new_dl_session() (NULL is ignored). */
+/****************************************************************************/
+/****************************** subroutine free_dl_session *****************************/
+void free_dl_session(
+	DLSESSION *session_ptr)	/* pointer to session data */
+{
+	delete session_ptr;
+}
+
+/****************************** subroutine session_init *****************************/
+/* Sizes and clears the session record for the final bldg meshes. */
+/* Called by CalcDFs() before the direct illuminance calcs. */
+/****************************************************************************/
+/****************************** subroutine session_init *****************************/
+void session_init(
+	DLSESSION *session_ptr,	/* pointer to session data */
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	SUN_DATA *sun_ptr,		/* pointer to sun data structure */
+	int iIterations)		/* number of radiosity iterations */
+{
+	int izone, isurf, nwndos;	/* indexes and counters */
+	TVISMOM mom0;			/* empty window contribution record */
+	DLFIXED fixed0;			/* empty CFS contribution record */
+
+	memset(&mom0,0,sizeof(mom0));
+	mom0.cmin = 1.e30;
+	mom0.cmax = -1.e30;
+	memset(&fixed0,0,sizeof(fixed0));
+
+	session_ptr->sun = *sun_ptr;
+	session_ptr->iIterations = iIterations;
+	session_ptr->recorded = 1;
+	session_ptr->zone.assign(bldg_ptr->nzones,DLZONEREC());
+	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+		ZONE *zone_ptr = bldg_ptr->zone[izone];
+		DLZONEREC& zrec = session_ptr->zone[izone];
+		zrec.ntargets = zone_ptr->nrefpts;
+		zrec.surf_t0.resize(zone_ptr->nsurfs);
+		zrec.surf_w0.resize(zone_ptr->nsurfs);
+		nwndos = 0;
+		for (isurf=0; isurf<zone_ptr->nsurfs; isurf++) {
+			zrec.surf_t0[isurf] = zrec.ntargets;
+			zrec.surf_w0[isurf] = nwndos;
+			zrec.ntargets += zone_ptr->surf[isurf]->nnodes;
+			nwndos += zone_ptr->surf[isurf]->nwndos;
+		}
+		zrec.wrecorded.assign(nwndos,0);
+		zrec.wmom.assign((size_t)nwndos * zrec.ntargets,mom0);
+		zrec.fixed.assign(zrec.ntargets,fixed0);
+	}
+}
+
+/****************************** subroutine session_wndo_recorded *****************************/
+/* Marks a window whose contributions are being recorded. */
+/****************************************************************************/
+/****************************** subroutine session_wndo_recorded *****************************/
+void session_wndo_recorded(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int isurf,				/* index of surface containing window */
+	int iw)					/* window index */
+{
+	if (session_ptr == NULL) return;
+	DLZONEREC& zrec = session_ptr->zone[izone];
+	zrec.wrecorded[zrec.surf_w0[isurf] + iw] = 1;
+}
+
+/****************************** subroutine session_tvis_mom *****************************/
+/* Returns the record of the contributions of a window to a ref pt or surface node, */
+/* or NULL without a session. */
+/****************************************************************************/
+/****************************** subroutine session_tvis_mom *****************************/
+TVISMOM *session_tvis_mom(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int isurf,				/* index of surface containing window */
+	int iw,					/* window index */
+	int iNodeSurf,			/* index of surface containing node (-1 for ref pts) */
+	int inode)				/* surface node index (ref pt index for ref pts) */
+{
+	if (session_ptr == NULL) return(NULL);
+	DLZONEREC& zrec = session_ptr->zone[izone];
+	int itarget = (iNodeSurf < 0) ? inode : zrec.surf_t0[iNodeSurf] + inode;
+	return(&(zrec.wmom[(size_t)(zrec.surf_w0[isurf] + iw) * zrec.ntargets + itarget]));
+}
+
+/****************************** subroutine session_fixed *****************************/
+/* Returns the record of the CFS contributions to a ref pt or surface node, */
+/* or NULL without a session. */
+/****************************************************************************/
+/****************************** subroutine session_fixed *****************************/
+DLFIXED *session_fixed(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int iNodeSurf,			/* index of surface containing node (-1 for ref pts) */
+	int inode)				/* surface node index (ref pt index for ref pts) */
+{
+	if (session_ptr == NULL) return(NULL);
+	DLZONEREC& zrec = session_ptr->zone[izone];
+	return(&(zrec.fixed[(iNodeSurf < 0) ? inode : zrec.surf_t0[iNodeSurf] + inode]));
+}
+
+/****************************** subroutine tvis_mom_add *****************************/
+/* Adds the unit tvis, unit reflectance contribution of a window element ray, */
+/* times each power of its cos(incidence) on the window, to a record. */
+/****************************************************************************/
+/****************************** subroutine tvis_mom_add *****************************/
+void tvis_mom_add(
+	TVISMOM *pmom,			/* pointer to window contribution record */
+	double c,				/* cos(incidence) of ray on window */
+	double cospt,			/* cos(incidence) of ray on node surface */
+	double lumskyc[NPHS][NTHS],	/* luminance * solid angle along ray - clear sky */
+	double lumsunc[NPHS][NTHS],	/* luminance * solid angle along ray - clear sun */
+	double lumskyo)			/* luminance * solid angle along ray - overcast sky */
+{
+	int iphs, iths, k;	/* loop indexes */
+	double ck;			/* c^k */
+
+	for (iphs=0; iphs<NPHS; iphs++) {
+		for (iths=0; iths<NTHS; iths++) {
+			ck = cospt;
+			for (k=0; k<NTVISMOM; k++) {
+				pmom->skyc[iphs][iths][k] += lumskyc[iphs][iths] * ck;
+				pmom->sunc[iphs][iths][k] += lumsunc[iphs][iths] * ck;
+				ck *= c;
+			}
+		}
+	}
+	ck = cospt;
+	for (k=0; k<NTVISMOM; k++) {
+		pmom->skyo[k] += lumskyo * ck;
+		ck *= c;
+	}
+	pmom->cmin = min(pmom->cmin,c);
+	pmom->cmax = max(pmom->cmax,c);
+}
+
+/****************************** subroutine tvis_mom_add_sun *****************************/
+/* Adds the unit tvis, unit reflectance direct sun illuminance of one sun position, */
+/* times each power of the sun cos(incidence) on the window, to a record. */
+/****************************************************************************/
+/****************************** subroutine tvis_mom_add_sun *****************************/
+void tvis_mom_add_sun(
+	TVISMOM *pmom,			/* pointer to window contribution record */
+	double c,				/* cos(incidence) of sun on window */
+	int iphs,				/* sun position altitude index */
+	int iths,				/* sun position azimuth index */
+	double dillum)			/* direct sun illuminance on node surface at unit tvis */
+{
+	int k;			/* power index */
+	double ck = dillum;
+
+	for (k=0; k<NTVISMOM; k++) {
+		pmom->sunc[iphs][iths][k] += ck;
+		ck *= c;
+	}
+	pmom->cmin = min(pmom->cmin,c);
+	pmom->cmax = max(pmom->cmax,c);
+}
+
+/****************************** subroutine glass_tvis_poly *****************************/
+/* Sets coef[] so that sum(coef[k] * c^k) equals glass_tvis() for every cos(incidence) c */
+/* in [cmin,cmax]. The curves are clipped at zero (and EnergyPlus curves outside [0,1]), */
+/* so the polynomial only holds where it does not clip; this is checked at NTVISCHK+1 */
+/* evenly spaced points of [cmin,cmax]. */
+/* Returns 0, or -1 if the glass type has no such polynomial over the range. */
+/****************************************************************************/
+/****************************** subroutine glass_tvis_poly *****************************/
+int glass_tvis_poly(
+	GLASS *glass_ptr,		/* pointer to library glass type */
+	int iGlass_Type_ID,		/* glass type ID */
+	double cmin,			/* min cos(incidence) the polynomial must hold for */
+	double cmax,			/* max cos(incidence) the polynomial must hold for */
+	double coef[NTVISMOM])	/* returned coefs of powers of cos(incidence) */
+{
+	double q[NTVISMOM];		/* coefs of the (unscaled) curve that is clipped at zero */
+	double scale = 1.0;		/* factor applied after clipping */
+	double fit1, fit2;		/* Window 4 curve fit coefs */
+	double c, qc;			/* check point and curve value */
+	int iClip = 1;			/* is the curve clipped at zero? */
+	int k, ichk;			/* loop indexes */
+
+	for (k=0; k<NTVISMOM; k++) q[k] = 0.;
+
+	if ((iGlass_Type_ID > 0) && (iGlass_Type_ID <= 11))  {	// DOE2 original
+		q[0] = glass_ptr->cam1;
+		q[1] = glass_ptr->cam2;
+		q[2] = glass_ptr->cam3;
+		q[3] = glass_ptr->cam4;
+	}
+	else if ((iGlass_Type_ID > 11) && (iGlass_Type_ID <= 10000)) {	// Window4, fit4() expanded
+		fit1 = glass_ptr->W4vis_fit1 + 2.0 * glass_ptr->W4vis_fit2;
+		fit2 = glass_ptr->W4vis_fit2;
+		q[1] = 2.0 + fit1;
+		q[2] = fit2 - 2.0 * fit1 - 1.0;
+		q[3] = fit1 - 2.0 * fit2;
+		q[4] = fit2;
+		scale = glass_ptr->vis_trans;
+	}
+	else if (iGlass_Type_ID > 10000) {	// EnergyPlus/Window5, POLYF()
+		if ((cmin < 0.0) || (cmax > 1.0)) return(-1);
+		for (k=0; k<6; k++) q[k+1] = glass_ptr->EPlusCoef[k];
+		iClip = 0;
+	}
+	else if (iGlass_Type_ID < 0) {	// Energy-10
+		for (k=0; k<4; k++) q[k+1] = glass_ptr->E10coef[k];
+		scale = glass_ptr->vis_trans;
+	}
+	else return(-1);
+
+	if (iClip) {
+		for (ichk=0; ichk<=NTVISCHK; ichk++) {
+			c = cmin + (cmax - cmin) * (double)ichk / (double)NTVISCHK;
+			qc = 0.;
+			for (k=NTVISMOM-1; k>=0; k--) qc = qc * c + q[k];
+			if (qc < 0.) return(-1);
+		}
+	}
+
+	for (k=0; k<NTVISMOM; k++) coef[k] = scale * q[k];
+
+	return(0);
+}
+
+/****************************** subroutine session_zone_direct *****************************/
+/* Rebuilds the direct illuminance at the ref pts and direct luminance at the surface */
+/* nodes of one zone from the session record, current glass (coefs from glass_tvis_poly()) */
+/* and current surface reflectances. */
+/****************************************************************************/
+/****************************** subroutine session_zone_direct *****************************/
+static void session_zone_direct(
+	DLSESSION *session_ptr,	/* pointer to session data */
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	int izone,				/* zone index */
+	const double *pcoef)	/* [window][NTVISMOM] tvis polynomial coefs of each window */
+{
+	ZONE *zone_ptr = bldg_ptr->zone[izone];
+	DLZONEREC& zrec = session_ptr->zone[izone];
+	int nwndos = (int)zrec.wrecorded.size();
+	int iNodeSurf, inode, itarget, iwndo, iphs, iths, k;	/* loop indexes */
+	double skyc[NPHS][NTHS], sunc[NPHS][NTHS], skyo;	/* direct illuminance before reflectance */
+	double (*pskyc)[NTHS], (*psunc)[NTHS], *pskyo;	/* direct illum or lum of current refpt or surfnode */
+	double dNodeFactor;		/* visible reflectance of node surface (1.0 for refpts) */
+
+	/* ref pts, then the nodes of the zone surfaces */
+	for (iNodeSurf=-1; iNodeSurf<zone_ptr->nsurfs; iNodeSurf++) {
+		for (inode=0; inode<((iNodeSurf < 0) ? zone_ptr->nrefpts : zone_ptr->surf[iNodeSurf]->nnodes); inode++) {
+			if (iNodeSurf < 0) {
+				itarget = inode;
+				dNodeFactor = 1.0;
+				pskyc = zone_ptr->ref_pt[inode]->direct_skycillum;
+				psunc = zone_ptr->ref_pt[inode]->direct_suncillum;
+				pskyo = &(zone_ptr->ref_pt[inode]->direct_skyoillum);
+			}
+			else {
+				itarget = zrec.surf_t0[iNodeSurf] + inode;
+				dNodeFactor = zone_ptr->surf[iNodeSurf]->vis_refl;
+				pskyc = zone_ptr->surf[iNodeSurf]->direct_skyclum[inode];
+				psunc = zone_ptr->surf[iNodeSurf]->direct_sunclum[inode];
+				pskyo = &(zone_ptr->surf[iNodeSurf]->direct_skyolum[inode]);
+			}
+
+			/* CFS, then each window */
+			DLFIXED& fixed = zrec.fixed[itarget];
+			memcpy(skyc,fixed.skyc,sizeof(skyc));
+			memcpy(sunc,fixed.sunc,sizeof(sunc));
+			skyo = fixed.skyo;
+			for (iwndo=0; iwndo<nwndos; iwndo++) {
+				const double *a = pcoef + iwndo * NTVISMOM;
+				const TVISMOM& mom = zrec.wmom[(size_t)iwndo * zrec.ntargets + itarget];
+				if (mom.cmin > mom.cmax) continue;
+				for (iphs=0; iphs<NPHS; iphs++) {
+					for (iths=0; iths<NTHS; iths++) {
+						for (k=0; k<NTVISMOM; k++) {
+							skyc[iphs][iths] += a[k] * mom.skyc[iphs][iths][k];
+							sunc[iphs][iths] += a[k] * mom.sunc[iphs][iths][k];
+						}
+					}
+				}
+				for (k=0; k<NTVISMOM; k++) skyo += a[k] * mom.skyo[k];
+			}
+
+			for (iphs=0; iphs<NPHS; iphs++) {
+				for (iths=0; iths<NTHS; iths++) {
+					pskyc[iphs][iths] = skyc[iphs][iths] * dNodeFactor;
+					psunc[iphs][iths] = sunc[iphs][iths] * dNodeFactor;
+				}
+			}
+			(*pskyo) = skyo * dNodeFactor;
+		}
+	}
+}
+
+/****************************** subroutine reset_zone_accumulators *****************************/
+/* Clears the ref pt reflected illuminances accumulated by refpt_total_illum() and, */
+/* if iDirect is set, the ref pt direct illuminances and surface CFS illuminance totals */
+/* accumulated by CalcZoneDirectIllum(), so that a zone can be calculated again. */
+/****************************************************************************/
+/****************************** subroutine reset_zone_accumulators *****************************/
+static void reset_zone_accumulators(
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	int izone,				/* zone index */
+	int iDirect)			/* also clear the direct illuminances? (0=No 1=Yes) */
+{
+	ZONE *zone_ptr = bldg_ptr->zone[izone];
+	int irp, isurf;			/* loop indexes */
+
+	for (irp=0; irp<zone_ptr->nrefpts; irp++) {
+		REFPT *refpt_ptr = zone_ptr->ref_pt[irp];
+		refpt_ptr->delf_overcast = 0.;
+		memset(refpt_ptr->delf_skyclear,0,sizeof(refpt_ptr->delf_skyclear));
+		memset(refpt_ptr->delf_sunclear,0,sizeof(refpt_ptr->delf_sunclear));
+		if (!iDirect) continue;
+		refpt_ptr->direct_skyoillum = 0.;
+		memset(refpt_ptr->direct_skycillum,0,sizeof(refpt_ptr->direct_skycillum));
+		memset(refpt_ptr->direct_suncillum,0,sizeof(refpt_ptr->direct_suncillum));
+	}
+	if (!iDirect) return;
+	for (isurf=0; isurf<zone_ptr->nsurfs; isurf++) {
+		zone_ptr->surf[isurf]->TotDirectOvercastIllum = 0.;
+		memset(zone_ptr->surf[isurf]->TotDirectSkyCIllum,0,sizeof(zone_ptr->surf[isurf]->TotDirectSkyCIllum));
+		memset(zone_ptr->surf[isurf]->TotDirectSunCIllum,0,sizeof(zone_ptr->surf[isurf]->TotDirectSunCIllum));
+	}
+}
+
+/* Shared data for the per-zone tasks of session_recalc(). */
+typedef struct {
+	DLSESSION *session_ptr;		/* pointer to session data */
+	BLDG *bldg_ptr;				/* pointer to bldg structure */
+	LIB *lib_ptr;				/* pointer to library structure */
+	vector< vector<double> > *pvvdCoef;	/* [zone][window][NTVISMOM] tvis polynomial coefs */
+} SESSIONTASK;
+
+/****************************** subroutine session_zone_task *****************************/
+/* run_task_pool() task: direct, interreflection and daylight factor recalc of zone itask. */
+/****************************************************************************/
+/****************************** subroutine session_zone_task *****************************/
+static int session_zone_task(
+	int itask,			/* zone index */
+	void *pdata,		/* pointer to SESSIONTASK data */
+	ofstream* pofdmpfile)	/* ptr to task error dump file */
+{
+	SESSIONTASK *ptask = (SESSIONTASK *)pdata;
+	vector<double>& vdCoef = (*(ptask->pvvdCoef))[itask];
+
+	session_zone_direct(ptask->session_ptr,ptask->bldg_ptr,itask,vdCoef.empty() ? NULL : &vdCoef[0]);
+	reset_zone_accumulators(ptask->bldg_ptr,itask,0);
+
+	return(ZoneInterreflectDFs(&(ptask->session_ptr->sun),ptask->bldg_ptr,ptask->lib_ptr,ptask->session_ptr->iIterations,itask,pofdmpfile));
+}
+
+/****************************** subroutine session_recalc *****************************/
+/* Recalculates the daylight factors of a bldg after its glass (library glass data or */
+/* window glass types) or surface visible reflectances changed, geometry unchanged. */
+/* The direct illuminances are rebuilt from the session record (see session_zone_direct()) */
+/* and only the interreflection is solved again, with the cached form factors. */
+/* Falls back on a full CalcDFs(), which records the session again, when a window */
+/* glass has no exact tvis polynomial over the recorded incidence angles or a window */
+/* that was skipped before now has valid glass. */
+/* Returns 0, -10 for warnings, -1 for errors. */
+/****************************************************************************/
+/****************************** subroutine session_recalc *****************************/
+int session_recalc(
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	LIB *lib_ptr,			/* pointer to library structure */
+	int *piFull,			/* returned 1 if a full CalcDFs() was needed, else 0 */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	DLSESSION *session_ptr = bldg_ptr->session;
+	vector< vector<double> > vvdCoef(bldg_ptr->nzones);	/* [zone][window][NTVISMOM] tvis polynomial coefs */
+	int izone, isurf, iw, iwndo, igt, itarget;	/* indexes */
+	int iGlass_Type_ID;		/* glass type ID of window */
+	double cmin, cmax;		/* recorded cos(incidence) range of window */
+	SESSIONTASK task;		/* shared task data */
+
+    // Init return value
+    int iReturnVal = 0;
+
+	*piFull = 0;
+	if ((session_ptr == NULL) || !session_ptr->recorded || ((int)session_ptr->zone.size() != bldg_ptr->nzones)) {
+		*pofdmpfile << "ERROR: DElight No recorded session for recalculation\n";
+		return(-1);
+	}
+
+	/* tvis polynomial of each window from its current glass */
+	for (izone=0; (izone<bldg_ptr->nzones) && !(*piFull); izone++) {
+		ZONE *zone_ptr = bldg_ptr->zone[izone];
+		DLZONEREC& zrec = session_ptr->zone[izone];
+		vvdCoef[izone].assign(zrec.wrecorded.size() * NTVISMOM,0.);
+		for (isurf=0; (isurf<zone_ptr->nsurfs) && !(*piFull); isurf++) {
+			for (iw=0; iw<zone_ptr->surf[isurf]->nwndos; iw++) {
+				WNDO *wndo_ptr = zone_ptr->surf[isurf]->wndo[iw];
+				iwndo = zrec.surf_w0[isurf] + iw;
+				/* windows without valid glass add nothing, as in CalcZoneDirectIllum() */
+				igt = lib_index(lib_ptr,"glass",wndo_ptr->glass_type);
+				iGlass_Type_ID = atoi(wndo_ptr->glass_type);
+				if ((igt < 0) || (iGlass_Type_ID == 0)) continue;
+				if (!zrec.wrecorded[iwndo]) {
+					*piFull = 1;
+					break;
+				}
+				/* closed shades: window luminance is independent of glass */
+				if (wndo_ptr->shade_flag != 0) {
+					vvdCoef[izone][iwndo * NTVISMOM] = 1.0;
+					continue;
+				}
+				cmin = 1.e30;
+				cmax = -1.e30;
+				for (itarget=0; itarget<zrec.ntargets; itarget++) {
+					cmin = min(cmin,zrec.wmom[(size_t)iwndo * zrec.ntargets + itarget].cmin);
+					cmax = max(cmax,zrec.wmom[(size_t)iwndo * zrec.ntargets + itarget].cmax);
+				}
+				if (cmin > cmax) continue;
+				if (glass_tvis_poly(lib_ptr->glass[igt],iGlass_Type_ID,cmin,cmax,&vvdCoef[izone][iwndo * NTVISMOM]) < 0) {
+					*piFull = 1;
+					break;
+				}
+			}
+		}
+	}
+
+	/* full calcs, recording the session again */
+	if (*piFull) {
+		for (izone=0; izone<bldg_ptr->nzones; izone++) reset_zone_accumulators(bldg_ptr,izone,1);
+		return(CalcDFs(&(session_ptr->sun),bldg_ptr,lib_ptr,session_ptr->iIterations,pofdmpfile));
+	}
+
+	/* recalc zones from the record, over a thread pool if requested */
+	task.session_ptr = session_ptr;
+	task.bldg_ptr = bldg_ptr;
+	task.lib_ptr = lib_ptr;
+	task.pvvdCoef = &vvdCoef;
+	int nthreads = dl_num_threads();
+	if ((nthreads > 1) && (bldg_ptr->nzones > 1)) {
+		if ((iReturnVal = run_task_pool(bldg_ptr->nzones,nthreads,NULL,session_zone_task,&task,pofdmpfile)) < 0) {
+			// If errors were detected then return now, else register warnings and continue processing
+			if (iReturnVal != -10) return(-1);
+		}
+	}
+	else {
+		for (izone=0; izone<bldg_ptr->nzones; izone++) {
+			int iZoneRetVal;
+			if ((iZoneRetVal = session_zone_task(izone,&task,pofdmpfile)) < 0) {
+				// If errors were detected then return now, else register warnings and continue processing
+				if (iZoneRetVal != -10) return(-1);
+				else iReturnVal = -10;
+			}
+		}
+	}
+
+	/* Report zones whose interreflection did not converge to the requested tolerance */
+	if (radiosity_convergence(bldg_ptr,pofdmpfile) < 0) iReturnVal = -10;
+
+	return(iReturnVal);
+}
@@ -0,0 +1,107 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency 
+// and Renewable Energy, Office of Building Technologies, 
+// Building Systems and Materials Division of the 
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf 
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce, 
+prepare derivative works, and perform publicly and display publicly. 
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself 
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to 
+the public, perform publicly and display publicly, and to permit others to do so. 
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL 
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY 
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE 
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+typedef struct {	/* CFS direct illuminance at one ref pt or surface node, before reflectance (see DLSession.cpp) */
+	double skyc[NPHS][NTHS];	/* from sky - clear */
+	double sunc[NPHS][NTHS];	/* from sun - clear */
+	double skyo;				/* from sky - overcast */
+} DLFIXED;
+
+struct DLSESSION;	/* incremental recalculation data (see DLSession.cpp) */
+
+DLSESSION *new_dl_session(void);
+
+void free_dl_session(
+	DLSESSION *session_ptr);	/* pointer to session data */
+
+void session_init(
+	DLSESSION *session_ptr,	/* pointer to session data */
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	SUN_DATA *sun_ptr,		/* pointer to sun data structure */
+	int iIterations);		/* number of radiosity iterations */
+
+void session_wndo_recorded(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int isurf,				/* index of surface containing window */
+	int iw);				/* window index */
+
+TVISMOM *session_tvis_mom(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int isurf,				/* index of surface containing window */
+	int iw,					/* window index */
+	int iNodeSurf,			/* index of surface containing node (-1 for ref pts) */
+	int inode);				/* surface node index (ref pt index for ref pts) */
+
+DLFIXED *session_fixed(
+	DLSESSION *session_ptr,	/* pointer to session data (NULL for none) */
+	int izone,				/* zone index */
+	int iNodeSurf,			/* index of surface containing node (-1 for ref pts) */
+	int inode);				/* surface node index (ref pt index for ref pts) */
+
+void tvis_mom_add(
+	TVISMOM *pmom,			/* pointer to window contribution record */
+	double c,				/* cos(incidence) of ray on window */
+	double cospt,			/* cos(incidence) of ray on node surface */
+	double lumskyc[NPHS][NTHS],	/* luminance * solid angle along ray - clear sky */
+	double lumsunc[NPHS][NTHS],	/* luminance * solid angle along ray - clear sun */
+	double lumskyo);		/* luminance * solid angle along ray - overcast sky */
+
+void tvis_mom_add_sun(
+	TVISMOM *pmom,			/* pointer to window contribution record */
+	double c,				/* cos(incidence) of sun on window */
+	int iphs,				/* sun position altitude index */
+	int iths,				/* sun position azimuth index */
+	double dillum);			/* direct sun illuminance on node surface at unit tvis */
+
+int glass_tvis_poly(
+	GLASS *glass_ptr,		/* pointer to library glass type */
+	int iGlass_Type_ID,		/* glass type ID */
+	double cmin,			/* min cos(incidence) the polynomial must hold for */
+	double cmax,			/* max cos(incidence) the polynomial must hold for */
+	double coef[NTVISMOM]);	/* returned coefs of powers of cos(incidence) */
+
+int session_recalc(
+	BLDG *bldg_ptr,			/* pointer to bldg structure */
+	LIB *lib_ptr,			/* pointer to library structure */
+	int *piFull,			/* returned 1 if a full CalcDFs() was needed, else 0 */
+	ofstream* pofdmpfile);	/* ptr to LBLDLL error dump file */
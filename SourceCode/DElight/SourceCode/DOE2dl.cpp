@@ -65,7 +65,7 @@ namespace BGL = BldgGeomLib;
 #include	"DOE2DL.H"
 
 SURF::SURF() :
-nwndos(0), ncfs(0)
+nwndos(0), ncfs(0), ff(NULL)
 {  }
 
 void	SURF::WLCSURFInit(string Name, Double maxNodeArea)
@@ -73,17 +73,10 @@ void	SURF::WLCSURFInit(string Name, Double maxNodeArea)
 	//	assumes SURF.v3List_WLC has been initialized: CCW order for INWARD-pointing normal
 
 	//	initialize the WLCSurface part of SURF
-	WLCSurfInit(Name, v3List_WLC, maxNodeArea);
-
-    // Check to assure that the number of mesh nodes does not exceed the array limit
-    int iMaxSurfNodes = MAX_SURF_NODES;
-    Double dSurfArea = Area();
-    while (MeshSize() > MAX_SURF_NODES) {
-        Double dAllowableMaxNodeArea = dSurfArea / iMaxSurfNodes;
-        // Re-init the WLCSurface part of SURF using this maxNodeArea
-	    WLCSurfInit("", v3List_WLC, dAllowableMaxNodeArea);
-        iMaxSurfNodes--;
-    }
+	WLCSurfGeomInit(Name, v3List_WLC);
+
+    // Mesh with the largest node area that keeps the number of mesh nodes within the array limit
+	MeshGrid1(NodeMesh2::grid1LimitArea(vert2D(), maxNodeArea, MAX_SURF_NODES));
 
 	//	do mesh cutouts for child apertures
     // assumes child apertures have been fully initialized prior to this point
@@ -142,18 +135,28 @@ void	WNDO::WLCWNDOInit(Double maxNodeArea)
 {
 	//	assumes WNDO.v3List_WLC has been initialized: CCW order for INWARD-pointing normal
 
-	//	initialize the WLCSurface part of WNDO
-	WLCSurfInit("", v3List_WLC, maxNodeArea);
-
-    // Check to assure that the number of mesh nodes does not exceed the array limit
-    int iMaxWndoNodes = MAX_WNDO_NODES;
-    Double dWndoArea = Area();
-    while (MeshSize() > MAX_WNDO_NODES) {
-        Double dAllowableMaxNodeArea = dWndoArea / iMaxWndoNodes;
-        // Re-init the WLCSurface part of WNDO using this maxNodeArea
-	    WLCSurfInit("", v3List_WLC, dAllowableMaxNodeArea);
-        iMaxWndoNodes--;
-    }
+	//	initialize the WLCSurface part of WNDO, dropping cached meshes if the window has moved
+	if (v3List_WLC != v3MeshCacheVerts) {
+		WLCSurfGeomInit("", v3List_WLC);
+		v3MeshCacheVerts = v3List_WLC;
+		vMeshCacheArea.clear();
+		vMeshCache.clear();
+	}
+
+	//	reuse the mesh of an earlier call with the same maxNodeArea
+	int icache;
+	for (icache=0; icache<(int)vMeshCacheArea.size(); icache++) {
+		if (vMeshCacheArea[icache] == maxNodeArea) break;
+	}
+	if (icache < (int)vMeshCacheArea.size()) {
+		SetMesh(vMeshCache[icache]);
+	}
+	else {
+	    // Mesh with the largest node area that keeps the number of mesh nodes within the array limit
+		MeshGrid1(NodeMesh2::grid1LimitArea(vert2D(), maxNodeArea, MAX_WNDO_NODES));
+		vMeshCacheArea.push_back(maxNodeArea);
+		vMeshCache.push_back(Mesh());
+	}
 	nnodes =  MeshSize();
 
 	for (int ii=0; ii<nnodes; ii++) {
@@ -81,12 +81,16 @@ namespace BGL = BldgGeomLib;
 #include "TOOLS.H"
 #include "WxTMY2.h"
 #include "W4Lib.h"
+#include "DFCache.h"
+#include "DLSession.h"
+#include "DLPhase.h"
 
-/******************************** subroutine DElightDaylightFactors4EPlus *******************************/
-// Called from DElightManagerC.cpp
+/******************************** subroutine DaylightFactors4EPlus *******************************/
 /* Calls key daylighting simulation modules necessary for calculating a set of daylight factors for EnergyPlus. */
-/******************************** subroutine DElightDaylightFactors4EPlus *******************************/
-DllExport int	DElightDaylightFactors4EPlus(
+/* With iSession set, the bldg gets a session recording the calcs for DElightSessionRecalc4EPlus() */
+/* and the daylight factor cache is bypassed. */
+/******************************** subroutine DaylightFactors4EPlus *******************************/
+static int	DaylightFactors4EPlus(
 	char sInputName[MAX_CHAR_LINE+1],	/* input file name */
 	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
 	BLDG* bldg_ptr,							/* bldg data structure */
@@ -99,6 +103,7 @@ DllExport int	DElightDaylightFactors4EPlus(
 	double dMinAlt,						/* Minimum daylight factor sun altitude angle */
 	int iNumAzms,						/* Number of daylight factor sun azimuth angles */
 	double dMinAzm,						/* Minimum daylight factor sun azimuth angle */
+	int iSession,						/* record a session? (0=No 1=Yes) */
     ofstream* pofdmpfile)               // ptr to Error message dump file
 {
 	FILE *infile;						/* input file pointer */
@@ -113,6 +118,8 @@ DllExport int	DElightDaylightFactors4EPlus(
 	struct_init("BLDG",(char *)bldg_ptr);
 	struct_init("LIB",(char *)lib_ptr);
 
+	dl_phase(DLPHASE_LOAD,1);
+
 	// Open the input file for loading
 	if((infile = fopen(sInputName, "r" )) == NULL ) {
 //	if ((infile=fopen(sInputName,"r")) == NULL) {
@@ -154,14 +161,17 @@ DllExport int	DElightDaylightFactors4EPlus(
 
 	/* Close input file after successful read. */
 	fclose(infile);
+	dl_phase(DLPHASE_LOAD,0);
 
 	/* Calculate geometrical values required for DF calcs. */
 	if (iSurfNodes > MAX_SURF_NODES) iSurfNodes = MAX_SURF_NODES;
 	if (iWndoNodes > MAX_WNDO_NODES) iWndoNodes = MAX_WNDO_NODES;
+	dl_phase(DLPHASE_GEOM,1);
 	if (CalcGeomFromEPlus(bldg_ptr,iSurfNodes,iWndoNodes,pofdmpfile) < 0) {
 		*pofdmpfile << "ERROR: DElight Bad return from CalcGeomFromEPlus()\n";
 		return(-4);
 	}
+	dl_phase(DLPHASE_GEOM,0);
 
 	/* Fill SUN_DATA structure for sun position calculations. */
 	if ((iNumAlts == 0) || (iNumAzms == 0)) {
@@ -180,21 +190,43 @@ DllExport int	DElightDaylightFactors4EPlus(
 		sun_data.thsmin = dMinAzm;	/* minimum sun azimuth (degrees: South=0.0, East=+90.0) */
 	}
 
-	/* Calculate daylight illuminances and daylight factors. */
-	// NOTE: Use same version of CalcDFs as for standard DElight2 to avoid having to maintain separate versions.
-    int iCalcDFsReturnVal = CalcDFs(&sun_data,bldg_ptr,lib_ptr,iIterations,pofdmpfile);
-	if (iCalcDFsReturnVal < 0) {
-        // If Errors have been detected then return now, else ignore Warnings (return value == -10) until return from DElight
-	    if (iCalcDFsReturnVal != -10) {
-		    *pofdmpfile << "ERROR: DElight Bad return from CalcDFs()\n";
-		    return(-4);
-        }
-        else {
-            iReturnVal = -10;
-        }
+	/* Reuse the daylight factors of an unchanged building from an earlier run, if any, */
+	/* when the DELIGHT_DF_CACHE directory is set. */
+	/* A session needs the calcs themselves, so it always calculates. */
+	unsigned long long dfhash;	/* content hash of input file and calculation parameters */
+	string sDFCacheFile;		/* binary daylight factor cache file name ("" = no cache) */
+	string sDFCacheReport;		/* bldg and lib data report of the cached calculation */
+	int iDFCacheHit = 0;		/* were the daylight factors loaded from the cache? (0=No 1=Yes) */
+	int iDFCacheSave = 0;		/* should the daylight factors be saved to the cache? (0=No 1=Yes) */
+	if (iSession) bldg_ptr->session = new_dl_session();
+	else if (dfcache_key(sInputName,bldg_ptr,&sun_data,iIterations,iSurfNodes,iWndoNodes,&dfhash) == 0) {
+		sDFCacheFile = dfcache_file_name(dfhash);
+		if (!sDFCacheFile.empty()) iDFCacheHit = dfcache_load(bldg_ptr,dfhash,sDFCacheFile,sDFCacheReport);
+	}
+
+	if (!iDFCacheHit) {
+		streampos posDmpFile = pofdmpfile->tellp();
+
+		/* Calculate daylight illuminances and daylight factors. */
+		// NOTE: Use same version of CalcDFs as for standard DElight2 to avoid having to maintain separate versions.
+		int iCalcDFsReturnVal = CalcDFs(&sun_data,bldg_ptr,lib_ptr,iIterations,pofdmpfile);
+		if (iCalcDFsReturnVal < 0) {
+			// If Errors have been detected then return now, else ignore Warnings (return value == -10) until return from DElight
+			if (iCalcDFsReturnVal != -10) {
+				*pofdmpfile << "ERROR: DElight Bad return from CalcDFs()\n";
+				return(-4);
+			}
+			else {
+				iReturnVal = -10;
+			}
+		}
+
+		/* Cache only runs without Error/Warning messages, so that reuse never hides them. */
+		iDFCacheSave = (!sDFCacheFile.empty() && (iReturnVal == 0) && (pofdmpfile->tellp() == posDmpFile));
 	}
 
 	/* Open output file. */
+	dl_phase(DLPHASE_DUMP,1);
 	if((outfile = fopen(sOutputName, "w" )) == NULL ) {
 //	if ((outfile=fopen(sOutputName,"w")) == NULL) {
 		*pofdmpfile << "ERROR: DElight Cannot open output file [" <<sOutputName << "]\n";
@@ -215,12 +247,220 @@ DllExport int	DElightDaylightFactors4EPlus(
 	fprintf(outfile,"Min_Azimuth       %5.2lf\n", dMinAzm);
 	fprintf(outfile,"N_Azimuth_Angles   %d\n", iNumAzms);
 
+	// Reused daylight factors leave the intermediate surface results of CalcDFs() unset,
+	// so copy the bldg and lib data report of the cached calculation instead of dumping them.
+	// The report holds the bytes dumped by the calculating run, so it is appended in binary mode.
+	if (iDFCacheHit) {
+		fclose(outfile);
+		if ((outfile = fopen(sOutputName, "ab")) == NULL) {
+			*pofdmpfile << "ERROR: DElight Cannot open output file [" <<sOutputName << "]\n";
+			return(-2);
+		}
+		fwrite(sDFCacheReport.data(),1,sDFCacheReport.size(),outfile);
+		fclose(outfile);
+		dl_phase(DLPHASE_DUMP,0);
+		return(iReturnVal);
+	}
+	long lReportPos = ftell(outfile);
+
 	/* Dump bldg data. */
 	dump_bldg(bldg_ptr,outfile);
 
 	/* Dump lib data. */
 	dump_lib(lib_ptr,outfile);
                         
+	/* Close output file. */
+	fclose(outfile);
+	if (iDFCacheSave && (lReportPos >= 0)) dfcache_save(bldg_ptr,dfhash,sDFCacheFile,sOutputName,lReportPos);
+	dl_phase(DLPHASE_DUMP,0);
+
+	return(iReturnVal);
+}
+
+/******************************** subroutine DElightDaylightFactors4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Calls key daylighting simulation modules necessary for calculating a set of daylight factors for EnergyPlus. */
+/******************************** subroutine DElightDaylightFactors4EPlus *******************************/
+DllExport int	DElightDaylightFactors4EPlus(
+	char sInputName[MAX_CHAR_LINE+1],	/* input file name */
+	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
+	BLDG* bldg_ptr,							/* bldg data structure */
+	LIB* lib_ptr,							/* library data structure */
+	int iIterations,					/* Number of radiosity iterations */
+	double dCloudFraction,				/* fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+	int iSurfNodes,						/* Desired total number of surface nodes */
+	int iWndoNodes,						/* Desired total number of window nodes */
+	int iNumAlts,						/* Number of daylight factor sun altitude angles */
+	double dMinAlt,						/* Minimum daylight factor sun altitude angle */
+	int iNumAzms,						/* Number of daylight factor sun azimuth angles */
+	double dMinAzm,						/* Minimum daylight factor sun azimuth angle */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	return(DaylightFactors4EPlus(sInputName,sOutputName,bldg_ptr,lib_ptr,iIterations,dCloudFraction,iSurfNodes,iWndoNodes,
+								iNumAlts,dMinAlt,iNumAzms,dMinAzm,0,pofdmpfile));
+}
+
+/******************************** subroutine DElightSessionOpen4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Same as DElightDaylightFactors4EPlus(), but keeps a session of the geometry dependent */
+/* calcs so that glass and surface reflectance changes made with the DElightSessionSet...() */
+/* routines can be recalculated by DElightSessionRecalc4EPlus(). */
+/* The session is released with the bldg by DElightFreeMemory4EPlus(). */
+/******************************** subroutine DElightSessionOpen4EPlus *******************************/
+DllExport int	DElightSessionOpen4EPlus(
+	char sInputName[MAX_CHAR_LINE+1],	/* input file name */
+	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
+	BLDG* bldg_ptr,							/* bldg data structure */
+	LIB* lib_ptr,							/* library data structure */
+	int iIterations,					/* Number of radiosity iterations */
+	double dCloudFraction,				/* fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+	int iSurfNodes,						/* Desired total number of surface nodes */
+	int iWndoNodes,						/* Desired total number of window nodes */
+	int iNumAlts,						/* Number of daylight factor sun altitude angles */
+	double dMinAlt,						/* Minimum daylight factor sun altitude angle */
+	int iNumAzms,						/* Number of daylight factor sun azimuth angles */
+	double dMinAzm,						/* Minimum daylight factor sun azimuth angle */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	return(DaylightFactors4EPlus(sInputName,sOutputName,bldg_ptr,lib_ptr,iIterations,dCloudFraction,iSurfNodes,iWndoNodes,
+								iNumAlts,dMinAlt,iNumAzms,dMinAzm,1,pofdmpfile));
+}
+
+/******************************** subroutine DElightSessionSetGlass4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Replaces the optical data of an EnergyPlus library glass type of a session. */
+/******************************** subroutine DElightSessionSetGlass4EPlus *******************************/
+DllExport int	DElightSessionSetGlass4EPlus(
+	LIB* lib_ptr,						/* library data structure */
+	char* sGlassName,					/* library glass type name */
+	double dDiffuseTrans,				/* diffuse visible transmittance */
+	double dInsideRefl,					/* inside visible reflectance */
+	double dEPlusCoef[6],				/* coefs of angular visible transmission */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	int igt, ii;	/* glass type index and loop index */
+
+	if ((igt = lib_index(lib_ptr,"glass",sGlassName)) < 0) {
+		*pofdmpfile << "ERROR: DElight Glass Type [" << sGlassName << "] not found in DElight Library\n";
+		return(-1);
+	}
+	lib_ptr->glass[igt]->EPlusDiffuse_Trans = dDiffuseTrans;
+	lib_ptr->glass[igt]->inside_refl = dInsideRefl;
+	for (ii=0; ii<6; ii++) lib_ptr->glass[igt]->EPlusCoef[ii] = dEPlusCoef[ii];
+
+	return(0);
+}
+
+/******************************** subroutine DElightSessionSetWndoGlass4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Changes the library glass type of every window of the given name in a session. */
+/******************************** subroutine DElightSessionSetWndoGlass4EPlus *******************************/
+DllExport int	DElightSessionSetWndoGlass4EPlus(
+	BLDG* bldg_ptr,						/* bldg data structure */
+	LIB* lib_ptr,						/* library data structure */
+	char* sWndoName,					/* window name */
+	char* sGlassName,					/* library glass type name */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	int izone, isurf, iw;	/* loop indexes */
+	int igt;				/* glass type index */
+	int nfound = 0;			/* # of windows found */
+
+	if ((igt = lib_index(lib_ptr,"glass",sGlassName)) < 0) {
+		*pofdmpfile << "ERROR: DElight Glass Type [" << sGlassName << "] not found in DElight Library\n";
+		return(-1);
+	}
+	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+		for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++) {
+			for (iw=0; iw<bldg_ptr->zone[izone]->surf[isurf]->nwndos; iw++) {
+				WNDO *wndo_ptr = bldg_ptr->zone[izone]->surf[isurf]->wndo[iw];
+				if (strcmp(wndo_ptr->name,sWndoName) != 0) continue;
+				strcpy(wndo_ptr->glass_type,lib_ptr->glass[igt]->name);
+				nfound++;
+			}
+		}
+	}
+	if (nfound == 0) {
+		*pofdmpfile << "ERROR: DElight Window [" << sWndoName << "] not found in DElight Building\n";
+		return(-1);
+	}
+
+	return(0);
+}
+
+/******************************** subroutine DElightSessionSetSurfRefl4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Changes the inside visible reflectance of a zone surface in a session. */
+/******************************** subroutine DElightSessionSetSurfRefl4EPlus *******************************/
+DllExport int	DElightSessionSetSurfRefl4EPlus(
+	BLDG* bldg_ptr,						/* bldg data structure */
+	char* sZoneName,					/* zone name */
+	char* sSurfName,					/* surface name */
+	double dVisRefl,					/* inside visible reflectance */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	int izone, isurf;	/* loop indexes */
+
+	for (izone=0; izone<bldg_ptr->nzones; izone++) {
+		if (strcmp(bldg_ptr->zone[izone]->name,sZoneName) != 0) continue;
+		for (isurf=0; isurf<bldg_ptr->zone[izone]->nsurfs; isurf++) {
+			if (strcmp(bldg_ptr->zone[izone]->surf[isurf]->name,sSurfName) != 0) continue;
+			bldg_ptr->zone[izone]->surf[isurf]->vis_refl = dVisRefl;
+			return(0);
+		}
+	}
+	*pofdmpfile << "ERROR: DElight Surface [" << sSurfName << "] of Zone [" << sZoneName << "] not found in DElight Building\n";
+
+	return(-1);
+}
+
+/******************************** subroutine DElightSessionRecalc4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Recalculates the daylight factors of a session after DElightSessionSet...() changes, */
+/* reusing its geometry dependent calcs (see session_recalc()), and rewrites the output file. */
+/******************************** subroutine DElightSessionRecalc4EPlus *******************************/
+DllExport int	DElightSessionRecalc4EPlus(
+	char sOutputName[MAX_CHAR_LINE+1],	/* output file name */
+	BLDG* bldg_ptr,							/* bldg data structure */
+	LIB* lib_ptr,							/* library data structure */
+    ofstream* pofdmpfile)               // ptr to Error message dump file
+{
+	FILE *outfile;		/* output file pointer */
+	int iFull;			/* was a full recalc needed? */
+
+    // Init return value
+    int iReturnVal = 0;
+
+	int iRecalcReturnVal = session_recalc(bldg_ptr,lib_ptr,&iFull,pofdmpfile);
+	if (iRecalcReturnVal < 0) {
+		// If Errors have been detected then return now, else ignore Warnings (return value == -10) until return from DElight
+		if (iRecalcReturnVal != -10) {
+			*pofdmpfile << "ERROR: DElight Bad return from session_recalc()\n";
+			return(-4);
+		}
+		else {
+			iReturnVal = -10;
+		}
+	}
+
+	/* Open output file. */
+	if((outfile = fopen(sOutputName, "w" )) == NULL ) {
+		*pofdmpfile << "ERROR: DElight Cannot open output file [" <<sOutputName << "]\n";
+		return(-2);
+	}
+
+	/* Dump runtime data. */
+	fprintf(outfile,"\n");
+	fprintf(outfile,"RUNTIME DATA\n");
+	fprintf(outfile,"Output_File_Name   %s\n", sOutputName);
+	fprintf(outfile,"Session_Recalc   %s\n", iFull ? "full" : "incremental");
+
+	/* Dump bldg data. */
+	dump_bldg(bldg_ptr,outfile);
+
+	/* Dump lib data. */
+	dump_lib(lib_ptr,outfile);
+
 	/* Close output file. */
 	fclose(outfile);
 
@@ -247,6 +487,7 @@ DllExport int DElightElecLtgCtrl4EPlus(
 	double dMaxAzm,			/* Maximum daylight factor sun azimuth angle */
 	double dAltInc,			/* Increment of daylight factor sun altitude angles */
 	double dAzmInc,			/* Increment of daylight factor sun azimuth angles */
+	ofstream* pofillumfile,	/* ptr to ref pt illuminance dump file (NULL for none) */
     ofstream* pofdmpfile)   // ptr to Error message dump file
 {
     // Init return value
@@ -267,12 +508,11 @@ DllExport int DElightElecLtgCtrl4EPlus(
 	}
 
 	// Calc electric lighting power reduction factor for the given zone
-	// Create a new SUN2_DATA instance and 
-	// init the fsunup to 1.0 for no correction due to partial timestep sun up
-	SUN2_DATA *sun2_ptr = new SUN2_DATA;
-	sun2_ptr->fsunup = 1.0;
+	// Init the fsunup to 1.0 for no correction due to partial timestep sun up
+	SUN2_DATA sun2_data;
+	sun2_data.fsunup = 1.0;
     int iDltsysRetVal;
-	if ((iDltsysRetVal = dltsys(zone_ptr, sun2_ptr, pofdmpfile)) < 0) {
+	if ((iDltsysRetVal = dltsys(zone_ptr, &sun2_data, pofillumfile, pofdmpfile)) < 0) {
         // If errors were detected then write error and return, else write warning and return
         if (iDltsysRetVal != -10) {
 			*pofdmpfile << "ERROR: DElight error return from dltsys()\n"; 
@@ -288,6 +528,87 @@ DllExport int DElightElecLtgCtrl4EPlus(
 	return(iReturnVal);
 }
 
+/******************************** subroutine DElightElecLtgCtrlBatch4EPlus *******************************/
+// Called from DElightManagerC.cpp
+/* Batch form of DElightElecLtgCtrl4EPlus() for every zone over nsteps timesteps, */
+/* e.g. a design day or a whole run period, so daylighting can be precomputed */
+/* outside the timestep loop. Results match nsteps*nzones single calls. */
+/******************************** subroutine DElightElecLtgCtrlBatch4EPlus *******************************/
+DllExport int DElightElecLtgCtrlBatch4EPlus(
+	BLDG* bldg_ptr,			/* pointer to DElight Bldg data structure */
+	int nsteps,				/* # of timesteps */
+	double* pdHISKF,		/* [nsteps] Exterior horizontal illuminance from sky (lum/ft^2) */
+	double* pdHISUNF,		/* [nsteps] Exterior horizontal beam illuminance (lum/ft^2) */
+	double* pdCloudFraction,	/* [nsteps] fraction of sky covered by clouds (0.0=clear 1.0=overcast) */
+	double* pdSOLCOSX,		/* [nsteps] x direction cosines of sun positions */
+	double* pdSOLCOSY,		/* [nsteps] y direction cosines of sun positions */
+	double* pdSOLCOSZ,		/* [nsteps] z direction cosines of sun positions */
+	double dMinAlt,			/* Minimum daylight factor sun altitude angle */
+	double dMinAzm,			/* Minimum daylight factor sun azimuth angle */
+	double dMaxAlt,			/* Maximum daylight factor sun altitude angle */
+	double dMaxAzm,			/* Maximum daylight factor sun azimuth angle */
+	double dAltInc,			/* Increment of daylight factor sun altitude angles */
+	double dAzmInc,			/* Increment of daylight factor sun azimuth angles */
+	double* pdRefPtIllum,	/* [nsteps][total # of ref pts] returned ref pt daylight illuminances (lum/ft^2) */
+	double* pdPowerReducFac,	/* [nsteps][nzones] returned Zone Power Reduction Factors */
+    ofstream* pofdmpfile)   // ptr to Error message dump file
+{
+    // Init return value
+    int iReturnVal = 0;
+	int istep, izone, irp;		/* loop indexes */
+	double dSOLCOS[3];			/* direction cosines of current sun position */
+	DFTABLE dft;				/* building daylight factors laid out for batch interpolation */
+
+	if (nsteps <= 0) return(0);
+
+	// Calc interpolation indexes and ratios for every timestep, once for all zones
+	vector<int> iphs(nsteps), iths(nsteps);				/* sun position alt and azm interpolation indexes */
+	vector<double> phratio(nsteps), thratio(nsteps);	/* sun position alt and azm interpolation displacement ratios */
+	for (istep=0; istep<nsteps; istep++) {
+		dSOLCOS[0] = pdSOLCOSX[istep];
+		dSOLCOS[1] = pdSOLCOSY[istep];
+		dSOLCOS[2] = pdSOLCOSZ[istep];
+		if (CalcInterpolationVars(bldg_ptr, dSOLCOS, dMinAlt, dMaxAlt, dAltInc, dMinAzm, dMaxAzm, dAzmInc, &iphs[istep], &iths[istep], &phratio[istep], &thratio[istep], pofdmpfile) < 0) {
+			*pofdmpfile << "ERROR: DElight Bad return from CalcInterpolationVars()\n";
+			return(-5);
+		}
+	}
+
+	// Calc interior daylight illuminance at each refpt of every zone for every timestep
+	BuildDFTable(bldg_ptr, &dft);
+	if (CalcBldgInteriorIllumBatch(&dft, nsteps, pdHISKF, pdHISUNF, pdCloudFraction, &iphs[0], &iths[0], &phratio[0], &thratio[0], pdRefPtIllum) < 0) {
+		*pofdmpfile << "ERROR: DElight Bad return from CalcBldgInteriorIllumBatch()\n";
+		return(-6);
+	}
+
+	// Calc electric lighting power reduction factor for each zone and timestep
+	// Init the fsunup to 1.0 for no correction due to partial timestep sun up
+	SUN2_DATA sun2_data;
+	sun2_data.fsunup = 1.0;
+    int iDltsysRetVal;
+	for (istep=0; istep<nsteps; istep++) {
+		for (izone=0; izone<bldg_ptr->nzones; izone++) {
+			ZONE *zone_ptr = bldg_ptr->zone[izone];
+			for (irp=0; irp<zone_ptr->nrefpts; irp++)
+				zone_ptr->ref_pt[irp]->daylight = pdRefPtIllum[istep*dft.nrefpts + dft.zone_rp0[izone] + irp];
+			if ((iDltsysRetVal = dltsys(zone_ptr, &sun2_data, NULL, pofdmpfile)) < 0) {
+				// If errors were detected then write error and return, else write warning and continue
+				if (iDltsysRetVal != -10) {
+					*pofdmpfile << "ERROR: DElight error return from dltsys()\n"; 
+					return(-7);
+				}
+				else if (iReturnVal == 0) {
+					*pofdmpfile << "WARNING: DElight warning return from dltsys()\n";
+					iReturnVal = -10;
+				}
+			}
+			pdPowerReducFac[istep*bldg_ptr->nzones + izone] = zone_ptr->frac_power;
+		}
+	}
+
+	return(iReturnVal);
+}
+
 /******************************** subroutine DElightFreeMemory4EPlus *******************************/
 // Not currently called from EnergyPlus
 /* Calls key daylighting simulation modules necessary for freeing memory allocated by DElight for EnergyPlus. */
@@ -459,18 +459,7 @@ int load_bldg(
 			sscanf(cInputLine,"%*s %lf\n",&bldg_ptr->zone[iz]->ref_pt[irp]->lt_set_pt);
 			fgets(cInputLine, MAX_CHAR_LINE, infile);
 			sscanf(cInputLine,"%*s %d\n",&bldg_ptr->zone[iz]->ref_pt[irp]->lt_ctrl_type);
-			/* Allocate memory for window luminance factors for each ref_pt<->wndo combination */
-			for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
-				for (iw=0; iw<bldg_ptr->zone[iz]->surf[is]->nwndos; iw++) {
-					bldg_ptr->zone[iz]->ref_pt[irp]->wlum[is][iw] = new WLUM;
-					if (bldg_ptr->zone[iz]->ref_pt[irp]->wlum[is][iw] == NULL) {
-//					if ((bldg_ptr->zone[iz]->ref_pt[irp]->wlum[is][iw] = (WLUM *)malloc(sizeof(WLUM))) == NULL) {
-						*pofdmpfile << "ERROR: DElight Insufficient memory for WINDOW LUMINANCE allocation\n";
-						return(-1);
-					}
-					struct_init("WLUM",(char *)bldg_ptr->zone[iz]->ref_pt[irp]->wlum[is][iw]);
-				}
-			}
+			/* Window luminance factors for each ref_pt<->wndo combination are allocated by alloc_bldg_arena() */
 		}
 	}
 
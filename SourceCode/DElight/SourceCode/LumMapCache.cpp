@@ -0,0 +1,315 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <sys/stat.h>
+
+using namespace std;
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+
+// includes
+#include "LumMapCache.h"
+
+/* Memoized skies and CFS luminance maps for CalcDFs(), plus optional on-disk copies of the maps. */
+struct LUMMAPCACHE {
+	string sCacheDir;					/* on-disk cache directory ("" = memory only) */
+	mutex mtx;							/* lock for the maps below (CalcDFs zones may run concurrently) */
+	map<string,HemiSphiral> mapSky;		/* generated skies keyed by sky DNA string and resolution */
+	map<string,HemiSphiral> mapLumMap;	/* CFS luminance maps keyed by sky key, CFS type and ICS */
+};
+
+/****************************** subroutine new_lummap_cache *****************************/
+/* Creates an empty sky and CFS luminance map cache. */
+/* The DELIGHT_LUMMAP_CACHE environment variable names an optional directory where */
+/* luminance maps are also saved, so that later runs of the same building can skip */
+/* the sky generation and CFS integration. */
+/****************************************************************************/
+/****************************** subroutine new_lummap_cache *****************************/
+LUMMAPCACHE *new_lummap_cache(void)
+{
+	LUMMAPCACHE *cache_ptr = new LUMMAPCACHE;
+	const char *cCacheDir = getenv("DELIGHT_LUMMAP_CACHE");
+
+	if ((cCacheDir != NULL) && (cCacheDir[0] != '\0')) {
+		cache_ptr->sCacheDir = cCacheDir;
+		char cLast = cache_ptr->sCacheDir[cache_ptr->sCacheDir.size()-1];
+		if ((cLast != '/') && (cLast != '\\')) cache_ptr->sCacheDir += "/";
+	}
+
+	return(cache_ptr);
+}
+
+/****************************** subroutine free_lummap_cache *****************************/
+/* Releases a cache created by new_lummap_cache() (NULL is ignored). */
+/****************************************************************************/
+/****************************** subroutine free_lummap_cache *****************************/
+void free_lummap_cache(
+	LUMMAPCACHE *cache_ptr)	/* pointer to sky and CFS luminance map cache */
+{
+	delete(cache_ptr);
+}
+
+/****************************** subroutine lummap_key *****************************/
+/* Builds the cache key of a CFS luminance map: sky DNA string and resolutions, */
+/* CFS type DNA string and BTDF resolutions (plus size and date of its data file, */
+/* if any), and the CFS inside coordinate system axes. */
+/****************************************************************************/
+/****************************** subroutine lummap_key *****************************/
+static string lummap_key(
+	string sSkyKey,				/* sky cache key */
+	CFSSystem *pCFSSystem,		/* pointer to CFS system */
+	BGL::RHCoordSys3& ics)		/* CFS inside coordinate system */
+{
+	ostringstream osKey;
+	struct stat statFile;
+	int ii, jj;
+
+	osKey.precision(17);
+	osKey << sSkyKey << "|" << pCFSSystem->TypeName() << "^" << pCFSSystem->lp.btdfHSResIn << "^" << pCFSSystem->lp.btdfHSResOut;
+	if ((pCFSSystem->lp.source == "FILE") && (stat(pCFSSystem->lp.filename.c_str(),&statFile) == 0))
+		osKey << "^" << (long long)statFile.st_size << "^" << (long long)statFile.st_mtime;
+	osKey << "|";
+	for (ii=0; ii<3; ii++) {
+		for (jj=0; jj<3; jj++) osKey << ics[ii][jj] << ((ii == 2 && jj == 2) ? "" : "^");
+	}
+
+	return(osKey.str());
+}
+
+/****************************** subroutine lummap_file_name *****************************/
+/* Returns the on-disk cache file name for a luminance map key (64 bit FNV-1a hash). */
+/****************************************************************************/
+/****************************** subroutine lummap_file_name *****************************/
+static string lummap_file_name(
+	LUMMAPCACHE *cache_ptr,	/* pointer to sky and CFS luminance map cache */
+	string& sKey)			/* luminance map cache key */
+{
+	unsigned long long hash = 14695981039346656037ULL;
+	char cName[32];
+	size_t ic;
+
+	for (ic=0; ic<sKey.size(); ic++) {
+		hash ^= (unsigned char)sKey[ic];
+		hash *= 1099511628211ULL;
+	}
+	sprintf(cName,"%016llx.lmc",hash);
+
+	return(cache_ptr->sCacheDir + cName);
+}
+
+/****************************** subroutine lummap_load *****************************/
+/* Reads a luminance map from the on-disk cache. */
+/* Returns 1 if found with a matching key, else 0. */
+/****************************************************************************/
+/****************************** subroutine lummap_load *****************************/
+static int lummap_load(
+	LUMMAPCACHE *cache_ptr,	/* pointer to sky and CFS luminance map cache */
+	string& sKey,			/* luminance map cache key */
+	HemiSphiral& LumMap)	/* returned luminance map */
+{
+	string sLine;
+	int nsize;
+	double zMin;
+
+	ifstream infile(lummap_file_name(cache_ptr,sKey).c_str(), ios::in | ios::binary);
+	if (!infile) return(0);
+	if (!getline(infile,sLine) || (sLine != LUMMAP_FILE_VERSION)) return(0);
+	if (!getline(infile,sLine) || (sLine != sKey)) return(0);
+	infile.read((char *)&nsize,sizeof(nsize));
+	infile.read((char *)&zMin,sizeof(zMin));
+	if (!infile || (nsize <= 0)) return(0);
+	vector<Double> vals(nsize);
+	infile.read((char *)&vals[0],nsize*sizeof(Double));
+	if (!infile) return(0);
+
+	LumMap = HemiSphiral(zMin,vals);
+	return(1);
+}
+
+/****************************** subroutine lummap_save *****************************/
+/* Writes a luminance map to the on-disk cache. */
+/* Writes a temporary file first and renames it, so that concurrent runs never read */
+/* a partial file. Failures are silently ignored (the cache is only an accelerator). */
+/****************************************************************************/
+/****************************** subroutine lummap_save *****************************/
+static void lummap_save(
+	LUMMAPCACHE *cache_ptr,	/* pointer to sky and CFS luminance map cache */
+	string& sKey,			/* luminance map cache key */
+	HemiSphiral& LumMap)	/* luminance map */
+{
+	string sFile = lummap_file_name(cache_ptr,sKey);
+	ostringstream osTmp;
+	int nsize = LumMap.size();
+	double zMin = LumMap.zMin;
+
+	osTmp << sFile << "." << hash<thread::id>()(this_thread::get_id()) << ".tmp";
+	{
+		ofstream outfile(osTmp.str().c_str(), ios::out | ios::binary | ios::trunc);
+		if (!outfile) return;
+		outfile << LUMMAP_FILE_VERSION << "\n" << sKey << "\n";
+		outfile.write((char *)&nsize,sizeof(nsize));
+		outfile.write((char *)&zMin,sizeof(zMin));
+		outfile.write((char *)&LumMap.valList[0],nsize*sizeof(Double));
+		if (!outfile) {
+			outfile.close();
+			remove(osTmp.str().c_str());
+			return;
+		}
+	}
+	if (rename(osTmp.str().c_str(),sFile.c_str()) != 0) remove(osTmp.str().c_str());
+}
+
+/****************************** subroutine cfs_lummap *****************************/
+/* Returns the luminance map of a CFS system for a generated sky and CFS orientation. */
+/* Skies are generated once per DNA string and resolution, and luminance maps are */
+/* integrated once per sky, CFS type and orientation, then copied from the cache. */
+/* A NULL cache_ptr generates and integrates every time. */
+/* Returns 0 on success, -1 (with an error message) on failure. */
+/****************************************************************************/
+/****************************** subroutine cfs_lummap *****************************/
+int cfs_lummap(
+	LUMMAPCACHE *cache_ptr,	/* pointer to sky and CFS luminance map cache (NULL for none) */
+	CFSSystem *pCFSSystem,	/* pointer to CFS system */
+	char *cSkyStr,			/* sky DNA string */
+	int sphiralM,			/* sky HemiSphiral input resolution */
+	int sphiralN,			/* sky HemiSphiral output resolution */
+	BGL::RHCoordSys3 ics,	/* CFS inside coordinate system */
+	const char *cSkyName,	/* sky name for error messages */
+	HemiSphiral& LumMap,	/* returned luminance map */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	ostringstream osSkyKey;
+	string sSkyKey, sMapKey;
+	map<string,HemiSphiral>::iterator itMap;
+	HemiSphiral sky;
+	int iHaveSky = 0;
+
+	osSkyKey << cSkyStr << "^" << sphiralM << "^" << sphiralN;
+	sSkyKey = osSkyKey.str();
+
+	/* luminance map from memory or disk */
+	if (cache_ptr != NULL) {
+		sMapKey = lummap_key(sSkyKey,pCFSSystem,ics);
+		{
+			lock_guard<mutex> lock(cache_ptr->mtx);
+			if ((itMap = cache_ptr->mapLumMap.find(sMapKey)) != cache_ptr->mapLumMap.end()) {
+				LumMap = itMap->second;
+				return(0);
+			}
+		}
+		if (!cache_ptr->sCacheDir.empty() && lummap_load(cache_ptr,sMapKey,LumMap)) {
+			lock_guard<mutex> lock(cache_ptr->mtx);
+			cache_ptr->mapLumMap[sMapKey] = LumMap;
+			return(0);
+		}
+		lock_guard<mutex> lock(cache_ptr->mtx);
+		if ((itMap = cache_ptr->mapSky.find(sSkyKey)) != cache_ptr->mapSky.end()) {
+			sky = itMap->second;
+			iHaveSky = 1;
+		}
+	}
+
+	/* generate the sky */
+	if (!iHaveSky) {
+		// Decode the DNA string
+		LumParam lpsky;
+		if (!SecretDecoderRing(lpsky,string(cSkyStr))) {
+			*pofdmpfile << "ERROR: DElight Incorrect Sky Generation Parameter - " << lpsky.BadName << "\n";
+			return(-1);
+		}
+		// Set the hemisphiral resolutions
+		lpsky.btdfHSResIn = sphiralM;
+		lpsky.btdfHSResOut = sphiralN;
+		sky = GenSky(lpsky);
+		if (sky.size() == 0) {
+			*pofdmpfile << "ERROR: DElight HemiSphiral for " << cSkyName << " Size == ZERO\n";
+			return(-1);
+		}
+		if (cache_ptr != NULL) {
+			lock_guard<mutex> lock(cache_ptr->mtx);
+			cache_ptr->mapSky[sSkyKey] = sky;
+		}
+	}
+
+	/* integrate the CFS luminance map */
+	LumMap = pCFSSystem->CFSLuminanceMap(sky,ics);
+	if (LumMap.size() == 0) {
+		*pofdmpfile << "ERROR: DElight HemiSphiral for CFS Luminance Map Size == ZERO\n";
+		return(-1);
+	}
+	if (cache_ptr != NULL) {
+		{
+			lock_guard<mutex> lock(cache_ptr->mtx);
+			cache_ptr->mapLumMap[sMapKey] = LumMap;
+		}
+		if (!cache_ptr->sCacheDir.empty()) lummap_save(cache_ptr,sMapKey,LumMap);
+	}
+
+	return(0);
+}
@@ -31,6 +31,8 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <iostream>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <cmath>
 using namespace std;
 
 #include "BGL.h"
@@ -90,63 +92,128 @@ int		NodeMesh2::grid1(const BGL::poly2& b2, double maxNodeArea)
 	//	NOTE: order of 1st two lines is important
 	meshList.clear();	//	reset container
 
+	grid1Scan(b2, maxNodeArea, &meshList);
+
+	return meshList.size();
+}
+
+//	Count the grid1() nodes for maxNodeArea without building the mesh
+int		NodeMesh2::grid1Count(const BGL::poly2& b2, double maxNodeArea)
+{
+	return grid1Scan(b2, maxNodeArea, NULL);
+}
+
+//	Largest node area, starting from maxNodeArea, whose grid1() mesh has at most maxNodes nodes.
+//	Gives the same area as re-meshing with b2.Area()/N for N = maxNodes, maxNodes-1, ...
+//	but only counts nodes, so no intermediate meshes are built.
+double	NodeMesh2::grid1LimitArea(const BGL::poly2& b2, double maxNodeArea, int maxNodes)
+{
+	if (grid1Count(b2, maxNodeArea) <= maxNodes) return maxNodeArea;
+
+	double	area = b2.Area();
+	double	limitArea = area;
+	for (int nn=maxNodes; nn>0; nn--) {
+		limitArea = area / nn;
+		if (grid1Count(b2, limitArea) <= maxNodes) break;
+	}
+	return limitArea;
+}
+
+//	grid1() node generator: returns the node count and, if pList is not NULL, appends the nodes.
+//	Each mesh row is rasterized from its sorted polygon edge crossings instead of testing
+//	every candidate point separately; candidates that fall (nearly) on an edge, and rows
+//	that pass (nearly) through a vertex, are decided by poly2::PointInPoly() as before.
+int		NodeMesh2::grid1Scan(const BGL::poly2& b2, double maxNodeArea, vector<Node>* pList)
+{
 	Node		nodeTmp;
-	BGL::point2	p2Tmp;
 
 	double		area = b2.Area();
 	if ( (area == 0) || (maxNodeArea <= 0) || (maxNodeArea >= area) ) {	// force one node
-		nodeTmp.area = area;
-		nodeTmp.position = b2.Centroid();
-		meshList.push_back(nodeTmp);
-		return meshList.size();
+		if (pList != NULL) {
+			nodeTmp.area = area;
+			nodeTmp.position = b2.Centroid();
+			pList->push_back(nodeTmp);
+		}
+		return 1;
 	}
 
 	//	set node properties, etc...
 	double	nodeLen = sqrt(maxNodeArea);
-//	cout << "mesh properties:\n";
-//	cout << "nodeLen: " << nodeLen << "\n";
+
+	//	crossing and vertex tolerance, relative to the polygon extent
+	double	tol = 1.e-9 * max(1., max(b2.xMax() - b2.xMin(), b2.yMax() - b2.yMin()));	//	VS2008
 
 	//	find "starting point minus one square" for mesh
 	double	px, px0 = b2.xMin() + nodeLen/2;
 	double	py, py0 = b2.yMin() + nodeLen/2;
-//	cout << "pstart: " << BGL::point2(px0,py0) << "\n";
 
-	int count1 = 0;
-	int count2 = 0;
+	int		nVerts = b2.size();
+	int		count2 = 0;
+	vector<double>	xCross;
+	xCross.reserve(nVerts);
 	//	form candidate mesh points
 	px = px0;
 	py = py0;
 	while( py < b2.yMax() ) {
+		//	gather the edge crossings of this row
+		bool	rowExact = true;
+		xCross.clear();
+		for (int jj=0; jj<nVerts; jj++) {
+			const BGL::point2&	p1 = b2[jj];
+			const BGL::point2&	p2 = b2[(jj+1)%nVerts];
+			if (fabs(p1[1] - py) <= tol) {	//	row through a vertex
+				rowExact = false;
+				break;
+			}
+			if ( (p1[1] < py) == (p2[1] < py) ) continue;	//	edge does not span row
+			xCross.push_back(p1[0] + (py - p1[1]) * (p2[0] - p1[0]) / (p2[1] - p1[1]));
+		}
+		sort(xCross.begin(), xCross.end());
+
+		int		iCross = 0;
 		while( px < b2.xMax() ) {
-			count1 += 1;
 			BGL::point2 p2Tmp(px,py);
-//			cout << count1 << " " << p2Tmp;
+			bool	inFlag;
+			if (rowExact) {
+				//	crossings at or left of px; inside if the count to the right is odd
+				while ( (iCross < (int)xCross.size()) && (xCross[iCross] <= px) ) iCross++;
+				if ( ((iCross > 0) && (px - xCross[iCross-1] <= tol))
+					|| ((iCross < (int)xCross.size()) && (xCross[iCross] - px <= tol)) ) {
+					inFlag = b2.PointInPoly(p2Tmp);	//	on (or next to) an edge
+				}
+				else {
+					inFlag = (((int)xCross.size() - iCross) % 2) == 1;
+				}
+			}
+			else {
+				inFlag = b2.PointInPoly(p2Tmp);
+			}
 			//	if PointInPoly2 - add to mesh list
-			if 	(b2.PointInPoly(p2Tmp)) {
+			if 	(inFlag) {
 				count2 += 1;
-				nodeTmp.position = p2Tmp;
-				nodeTmp.area = maxNodeArea;
-				meshList.push_back(nodeTmp);
-//				cout << " 1\n";
+				if (pList != NULL) {
+					nodeTmp.position = p2Tmp;
+					nodeTmp.area = maxNodeArea;
+					pList->push_back(nodeTmp);
+				}
 			}
-//			else {
-//				cout << " 0\n";
-//			}
 			px += nodeLen;
 		}
 		px = px0;
 		py += nodeLen;
 	}
-//	cout << "count1: " << count1 << " count2: " << count2 << "\n";
-	
+
 	// no qualifying nodes found
-	if ( meshList.size() == 0 ) {	// force one node
-		nodeTmp.area = area;
-		nodeTmp.position = b2.Centroid();
-		meshList.push_back(nodeTmp);
+	if ( count2 == 0 ) {	// force one node
+		if (pList != NULL) {
+			nodeTmp.area = area;
+			nodeTmp.position = b2.Centroid();
+			pList->push_back(nodeTmp);
+		}
+		count2 = 1;
 	}
 
-	return meshList.size();
+	return count2;
 }
 
 int		NodeMesh2::grid2(const BGL::poly2& b2, double maxNodeArea)
@@ -60,11 +60,16 @@ struct	NodeMesh2
 
 	Int			grid1(const BGL::poly2&, int);	//	min required nodes
 	Int			grid1(const BGL::poly2&, Double);	//	max allowed node area
+	static Int	grid1Count(const BGL::poly2&, Double);	//	grid1() node count only
+	static Double	grid1LimitArea(const BGL::poly2&, Double, Int);	//	node area limited to max nodes
 	Int			grid2(const BGL::poly2&, Double);	//	adaptive method - not used
 
 	Int			remove(const BGL::poly2&);
 
 	vector<Node>	meshList;
+
+private:
+	static Int	grid1Scan(const BGL::poly2&, Double, vector<Node>*);
 };
 
 inline Node &NodeMesh2::operator [] (Int i)
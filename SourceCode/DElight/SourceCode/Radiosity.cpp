@@ -47,6 +47,7 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <fstream>
 #include <cstring>
 #include <limits>
+#include <cstdlib>
 
 using namespace std;
 
@@ -93,92 +94,171 @@ int slite_interreflect(
 	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
 	int niterate,		/* number of radiosity iterations */
 	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	int iz;		/* zone loop index */
+
+    // Init return value
+    int iReturnVal = 0;
+
+	/* for each zone in the bldg */
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+        int iZoneRetVal;
+		if ((iZoneRetVal = zone_interreflect(bldg_ptr,lib_ptr,sun_ptr,iz,niterate,pofdmpfile)) < 0) {
+            // If errors were detected then return now, else register warnings and continue processing
+            if (iZoneRetVal != -10) return(-1);
+            else iReturnVal = -10;
+        }
+	}
+
+	return(iReturnVal);
+}
+
+/************************* subroutine radiosity_tolerance ************************/
+/* Returns the relative residual tolerance to which zone_interreflect() solves the */
+/* interreflection, from the DELIGHT_RADIOSITY_TOL environment variable. */
+/* Unset or <= 0 selects the original fixed number of sweeps (returns 0). */
+/****************************************************************************/
+/************************* subroutine radiosity_tolerance ************************/
+double radiosity_tolerance(void)
+{
+	const char *cTol = getenv("DELIGHT_RADIOSITY_TOL");
+	double dTol;
+
+	if (cTol == NULL) return(0.);
+	dTol = atof(cTol);
+	if (dTol < 0.) dTol = 0.;
+
+	return(dTol);
+}
+
+/************************* subroutine zone_interreflect ************************/
+/* Interreflection calculations for a single zone (see slite_interreflect). */
+/* Reads and writes only data belonging to zone iz, so that zones may be */
+/* processed concurrently. */
+/* By default runs niterate Gauss-Seidel sweeps over the zone surfaces, neglecting */
+/* surfaces and windows with reflectance <= RADIOSITY_MIN_REFL. When a tolerance is */
+/* set (see radiosity_tolerance()) all reflecting surfaces are included and sweeps */
+/* run until the largest node luminance change of a sweep, relative to the largest */
+/* node luminance, is within the tolerance (at most RADIOSITY_MAX_ITER sweeps). */
+/* The sweeps done and the final residual are kept in the zone (rad_iter, rad_resid). */
+/****************************************************************************/
+/************************* subroutine zone_interreflect ************************/
+int zone_interreflect(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	int iz,				/* current zone index */
+	int niterate,		/* number of radiosity iterations */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
 	int iter;		/* interreflection iteration loop index */
-	int iz, is, iw, inode, iphs, iths;	/* loop indexes */
+	int is, iw, inode, iphs, iths;	/* loop indexes */
 	int igt;		/* glass type index */
+	int nsweeps;	/* max number of interreflection sweeps */
 	double frac;	/* surface reflectance divided by PI */
+	double dTol = radiosity_tolerance();	/* relative residual tolerance (0 for fixed sweeps) */
+	double dMinRefl;	/* reflectance at or below which a surface is neglected */
+	double dMaxChange, dMaxLum;	/* largest node luminance change and value of a sweep */
+	double dResid = -1.;	/* relative residual of the last sweep */
 
     // Init return value
     int iReturnVal = 0;
 
-	/* for each zone in the bldg */
-	for (iz=0; iz<bldg_ptr->nzones; iz++) {
-		/* for each surface in the zone */
-		for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
-			/* for each surface node */
-			for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->nnodes; inode++) {
-				/* for overcast sky condition, init each surface node total illuminance to its initial illuminance */
-				bldg_ptr->zone[iz]->surf[is]->skyolum[inode] = bldg_ptr->zone[iz]->surf[is]->direct_skyolum[inode];
+	if (dTol > 0.) {
+		nsweeps = RADIOSITY_MAX_ITER;
+		dMinRefl = 0.;
+	}
+	else {
+		nsweeps = niterate;
+		dMinRefl = RADIOSITY_MIN_REFL;
+	}
+
+	/* for each surface in the zone */
+	for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
+		/* for each surface node */
+		for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->nnodes; inode++) {
+			/* for overcast sky condition, init each surface node total illuminance to its initial illuminance */
+			bldg_ptr->zone[iz]->surf[is]->skyolum[inode] = bldg_ptr->zone[iz]->surf[is]->direct_skyolum[inode];
+			/* for each Sun Position Altitude */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+				/* for each Sun Position Azimuth */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
+					/* for each clear sky sun position, init each surface node total luminance to its initial luminance */
+					bldg_ptr->zone[iz]->surf[is]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->direct_skyclum[inode][iphs][iths];
+					bldg_ptr->zone[iz]->surf[is]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->direct_sunclum[inode][iphs][iths];
+				}
+			}
+		}
+		/* for each window in the surface */
+		for (iw=0; iw<bldg_ptr->zone[iz]->surf[is]->nwndos; iw++) {
+			/* for each window node */
+			for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->wndo[iw]->nnodes; inode++) {
+				/* for overcast sky condition, init each window node total luminance to its initial luminance */
+				bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyolum[inode] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyolum[inode];
 				/* for each Sun Position Altitude */
 				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
 					/* for each Sun Position Azimuth */
 					for (iths=0; iths<sun_ptr->nths; iths++) {
-						/* for each clear sky sun position, init each surface node total luminance to its initial luminance */
-						bldg_ptr->zone[iz]->surf[is]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->direct_skyclum[inode][iphs][iths];
-						bldg_ptr->zone[iz]->surf[is]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->direct_sunclum[inode][iphs][iths];
+						/* for each clear sky sun position, init each window node total luminance to its initial luminance */
+						bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyclum[inode][iphs][iths];
+						bldg_ptr->zone[iz]->surf[is]->wndo[iw]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_sunclum[inode][iphs][iths];
 					}
 				}
 			}
-			/* for each window in the surface */
+		}
+	}
+	/* go through desired number of iterations */
+	for (iter=0; iter<nsweeps; iter++) {
+		dMaxChange = 0.;
+		dMaxLum = 0.;
+		/* for each surface in this zone */
+		for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
+			/* for each window in this surface */
 			for (iw=0; iw<bldg_ptr->zone[iz]->surf[is]->nwndos; iw++) {
-				/* for each window node */
-				for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->wndo[iw]->nnodes; inode++) {
-					/* for overcast sky condition, init each window node total luminance to its initial luminance */
-					bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyolum[inode] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyolum[inode];
-					/* for each Sun Position Altitude */
-					for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-						/* for each Sun Position Azimuth */
-						for (iths=0; iths<sun_ptr->nths; iths++) {
-							/* for each clear sky sun position, init each window node total luminance to its initial luminance */
-							bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyclum[inode][iphs][iths];
-							bldg_ptr->zone[iz]->surf[is]->wndo[iw]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_sunclum[inode][iphs][iths];
-						}
-					}
-				}
+				/* get library index of current window glass type */
+				igt = lib_index(lib_ptr,"glass",bldg_ptr->zone[iz]->surf[is]->wndo[iw]->glass_type);
+				/* if invalid glass type, continue */
+				if (igt < 0) continue;
+				/* if window inside reflectance is small, its contribution */
+				/* is neglected, for computer efficiency */
+				if (lib_ptr->glass[igt]->inside_refl <= dMinRefl) continue;
+				frac = lib_ptr->glass[igt]->inside_refl / PI;
+				/* call window interreflection routine to loop through other surfaces */
+				/* in this zone and interreflect between this window */
+				wndo_interreflect(bldg_ptr,sun_ptr,iz,is,iw,frac,pofdmpfile);
 			}
+			/* now, for this surface itself - */
+			/* if surface inside reflectance is small, its contribution */
+			/* is neglected, for computer efficiency */
+			if (bldg_ptr->zone[iz]->surf[is]->vis_refl <= dMinRefl) continue;
+			frac = bldg_ptr->zone[iz]->surf[is]->vis_refl / PI;
+			/* call surface interreflection routine to loop through other surfaces */
+			/* in this zone and interreflect to current surface */
+			surf_interreflect(bldg_ptr,sun_ptr,iz,is,frac,&dMaxChange,&dMaxLum,pofdmpfile);
 		}
-		/* go through desired number of iterations */
-		for (iter=0; iter<niterate; iter++) {
-			/* for each surface in this zone */
-			for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
-				/* for each window in this surface */
-				for (iw=0; iw<bldg_ptr->zone[iz]->surf[is]->nwndos; iw++) {
-					/* get library index of current window glass type */
-					igt = lib_index(lib_ptr,"glass",bldg_ptr->zone[iz]->surf[is]->wndo[iw]->glass_type);
-					/* if invalid glass type, continue */
-					if (igt < 0) continue;
-					/* if window inside reflectance is small, its contribution */
-					/* is neglected, for computer efficiency */
-					if (lib_ptr->glass[igt]->inside_refl <= 0.15) continue;
-					frac = lib_ptr->glass[igt]->inside_refl / PI;
-					/* call window interreflection routine to loop through other surfaces */
-					/* in this zone and interreflect between this window */
-					wndo_interreflect(bldg_ptr,sun_ptr,iz,is,iw,frac,pofdmpfile);
-				}
-				/* now, for this surface itself - */
-				/* if surface inside reflectance is small, its contribution */
-				/* is neglected, for computer efficiency */
-				if (bldg_ptr->zone[iz]->surf[is]->vis_refl <= 0.15) continue;
-				frac = bldg_ptr->zone[iz]->surf[is]->vis_refl / PI;
-				/* call surface interreflection routine to loop through other surfaces */
-				/* in this zone and interreflect to current surface */
-				surf_interreflect(bldg_ptr,sun_ptr,iz,is,frac,pofdmpfile);
+		/* stop once converged (a dark zone gets there in very few sweeps) */
+		if (dTol > 0.) {
+			dResid = (dMaxLum > 0.) ? dMaxChange / dMaxLum : 0.;
+			if (dResid <= dTol) {
+				iter++;
+				break;
 			}
 		}
-		/* calculate totl illumination for ref_pts due to initial direct and interreflected daylight */
-        int iRefptIllumRetVal;
-		if ((iRefptIllumRetVal = refpt_total_illum(bldg_ptr,sun_ptr,iz,pofdmpfile)) < 0) {
-            // If errors were detected then return now, else register warnings and continue processing
-            if (iRefptIllumRetVal != -10) {
-				*pofdmpfile << "ERROR: DElight Bad return from refpt_total_illum()\n";
-				return(-1);
-            }
-            else {
-                iReturnVal = -10;
-            }
-        }
 	}
+	bldg_ptr->zone[iz]->rad_iter = iter;
+	bldg_ptr->zone[iz]->rad_resid = dResid;
+	/* calculate totl illumination for ref_pts due to initial direct and interreflected daylight */
+    int iRefptIllumRetVal;
+	if ((iRefptIllumRetVal = refpt_total_illum(bldg_ptr,sun_ptr,iz,pofdmpfile)) < 0) {
+        // If errors were detected then return now, else register warnings and continue processing
+        if (iRefptIllumRetVal != -10) {
+			*pofdmpfile << "ERROR: DElight Bad return from refpt_total_illum()\n";
+			return(-1);
+        }
+        else {
+            iReturnVal = -10;
+        }
+    }
 
 	return(iReturnVal);
 }
@@ -188,6 +268,8 @@ int slite_interreflect(
 /* light with current surface. */
 /* Based on Superlite conventions. */
 /* cfs modification */
+/* Configuration factors are taken from the surface form factor matrix, */
+/* which is calculated on the first pass and reused for later iterations. */
 /****************************************************************************/
 /* C Language Implementation of Superlite Daylighting Algorithms */
 /* by Rob Hitchcock */
@@ -199,96 +281,85 @@ int surf_interreflect(
 	int iz,				/* current zone index */
 	int isurf,			/* current surface index */
 	double frac,		/* surface reflectance divided by PI */
+	double *pdMaxChange,	/* running max change of node luminance (NULL for none) */
+	double *pdMaxLum,		/* running max node luminance (NULL for none) */
 	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
 	int inode;					/* current surface node loop index */
-	int icoord;					/* node coordinate loop index */
 	int iphs, iths;				/* sun position loop indexes */
-	int jsurf, jnode;		/* loop indexes for other surfaces in current zone */
-	double scb1, scb2, ssq;	/* temp calc vars */
-	int icos1, icos2;				/* temp calc vars */
-	double yyy[NCOORDS];	/* temp coordinate calc var */
+	int ij, jnode;				/* form factor entry index and reflecting node index */
 	double fij;	/* configuration factor between nodes on surfs i and j */
-	double delf_overcast[MAX_SURF_NODES];
-	double delf_skyclear[MAX_SURF_NODES][NPHS][NTHS];	/* temp accumulators for reflected light */
-	double delf_sunclear[MAX_SURF_NODES][NPHS][NTHS];	/* temp accumulators for reflected light */
-
-	/* init accumulators for each node on current surface */
-	for (inode=0; inode<bldg_ptr->zone[iz]->surf[isurf]->nnodes; inode++) {
-		/* for overcast sky condition */
-		delf_overcast[inode] = 0.;
-		/* for each Sun Position Altitude */
+	double delf_overcast;
+	double delf_skyclear[NPHS][NTHS];	/* temp accumulators for reflected light */
+	double delf_sunclear[NPHS][NTHS];	/* temp accumulators for reflected light */
+	double dnew;			/* improved node luminance */
+	double dchange = 0.;	/* max change of node luminance */
+	double dlum = 0.;		/* max node luminance */
+	SURF *surf_ptr = bldg_ptr->zone[iz]->surf[isurf];	/* current surface */
+	SURF *jsurf_ptr;	/* other (reflecting) surface */
+	FFMAT *ff_ptr;		/* form factor matrix for current surface */
+
+	/* calc configuration (form) factors if not yet done for the current mesh */
+	if ((surf_ptr->ff == NULL) || (surf_ptr->ff->nrows != surf_ptr->nnodes)) {
+		delete(surf_ptr->ff);
+		surf_ptr->ff = surf_form_factors(bldg_ptr,iz,isurf);
+	}
+	ff_ptr = surf_ptr->ff;
+
+	/* for each node on current surface */
+	/* Note - nodes on the current surface do not reflect onto each other, */
+	/* so each node can be improved as soon as its accumulators are complete. */
+	for (inode=0; inode<ff_ptr->nrows; inode++) {
+		/* init accumulators */
+		delf_overcast = 0.;
 		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-			/* for each Sun Position Azimuth */
 			for (iths=0; iths<sun_ptr->nths; iths++) {
-				/* for each clear sky sun position */
-				delf_skyclear[inode][iphs][iths] = 0.;
-				delf_sunclear[inode][iphs][iths] = 0.;
+				delf_skyclear[iphs][iths] = 0.;
+				delf_sunclear[iphs][iths] = 0.;
 			}
 		}
-	}
-	/* for each non-window surface in current zone */
-	/* Note - the present assumption is that there are */
-	/* no internal obstructions. */
-	for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
-		/* skip current surface */
-		if (jsurf == isurf) continue;
-		/* for each node on current surface */
-		for (inode=0; inode<bldg_ptr->zone[iz]->surf[isurf]->nnodes; inode++) {
-			/* for each node on other (reflecting) surface */
-			for (jnode=0; jnode<bldg_ptr->zone[iz]->surf[jsurf]->nnodes; jnode++) {
-				/* calc configuration (form) factor fij */
-				scb1 = 0.;
-				scb2 = 0.;
-				ssq = 0.;
-				for (icoord=0; icoord<NCOORDS; icoord++) {
-					yyy[icoord] = bldg_ptr->zone[iz]->surf[jsurf]->node[jnode][icoord] - bldg_ptr->zone[iz]->surf[isurf]->node[inode][icoord];
-					/* Note: yyy[Y] sign is changed to account for differences in */
-					/* slite and doe2 coordinate systems */
-					// RJH - removed 1/9/2004 after correcting direction cosines to DOE2 coordinate system
-					//if (icoord == 1) yyy[icoord] = -(yyy[icoord]);
-					scb1 += yyy[icoord] * bldg_ptr->zone[iz]->surf[isurf]->dircos[icoord+6];
-					scb2 -= yyy[icoord] * bldg_ptr->zone[iz]->surf[jsurf]->dircos[icoord+6];
-					ssq += yyy[icoord] * yyy[icoord];
-				}
-				icos1 = (int)(1.0 + scb1 / (1.0 + ssq));
-				icos2 = (int)(1.0 + scb2 / (1.0 + ssq));
-				fij = scb1 * scb2 / (ssq * ssq) * bldg_ptr->zone[iz]->surf[jsurf]->node_areas[jnode] * icos1 * icos2;
-				fij = fij / (1.0 + 0.6 * fij * fij);
-				/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
-				delf_overcast[inode] += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyolum[jnode];
-
-// rjh debug
-//*pofdmpfile << "Configuration Factor: fij = " << fij << " isurf = " << isurf << " inode = " << inode << " jsurf = " << jsurf << " jnode = " << jnode << "\n";
-
-				/* for each Sun Position Altitude */
-				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-					/* for each Sun Position Azimuth */
-					for (iths=0; iths<sun_ptr->nths; iths++) {
-						/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
-						delf_skyclear[inode][iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyclum[jnode][iphs][iths];
-						delf_sunclear[inode][iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->sunclum[jnode][iphs][iths];
-					}
+		/* for each stored node on other (reflecting) surfaces */
+		for (ij=ff_ptr->row_start[inode]; ij<ff_ptr->row_start[inode+1]; ij++) {
+			jsurf_ptr = bldg_ptr->zone[iz]->surf[ff_ptr->col[ij].jsurf];
+			jnode = ff_ptr->col[ij].jnode;
+			fij = ff_ptr->fij[ij];
+			/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
+			delf_overcast += fij * jsurf_ptr->skyolum[jnode];
+			/* for each Sun Position Altitude */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+				/* for each Sun Position Azimuth */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
+					/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
+					delf_skyclear[iphs][iths] += fij * jsurf_ptr->skyclum[jnode][iphs][iths];
+					delf_sunclear[iphs][iths] += fij * jsurf_ptr->sunclum[jnode][iphs][iths];
 				}
 			}
 		}
-	}
 
-	/* iteration finished for current surface, */
-	/* improve values for total node luminance for each node on current surface */
-	for (inode=0; inode<bldg_ptr->zone[iz]->surf[isurf]->nnodes; inode++) {
+		/* improve values for total node luminance for current node */
 		/* for overcast sky condition */
-		bldg_ptr->zone[iz]->surf[isurf]->skyolum[inode] = bldg_ptr->zone[iz]->surf[isurf]->direct_skyolum[inode] + frac * delf_overcast[inode];
+		dnew = surf_ptr->direct_skyolum[inode] + frac * delf_overcast;
+		dchange = max(dchange,fabs(dnew - surf_ptr->skyolum[inode]));
+		dlum = max(dlum,fabs(dnew));
+		surf_ptr->skyolum[inode] = dnew;
 		/* for each Sun Position Altitude */
 		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
 			/* for each Sun Position Azimuth */
 			for (iths=0; iths<sun_ptr->nths; iths++) {
 				/* for each clear sky sun position */
-				bldg_ptr->zone[iz]->surf[isurf]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[isurf]->direct_skyclum[inode][iphs][iths] + frac * delf_skyclear[inode][iphs][iths];
-				bldg_ptr->zone[iz]->surf[isurf]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[isurf]->direct_sunclum[inode][iphs][iths] + frac * delf_sunclear[inode][iphs][iths];
+				dnew = surf_ptr->direct_skyclum[inode][iphs][iths] + frac * delf_skyclear[iphs][iths];
+				dchange = max(dchange,fabs(dnew - surf_ptr->skyclum[inode][iphs][iths]));
+				dlum = max(dlum,fabs(dnew));
+				surf_ptr->skyclum[inode][iphs][iths] = dnew;
+				dnew = surf_ptr->direct_sunclum[inode][iphs][iths] + frac * delf_sunclear[iphs][iths];
+				dchange = max(dchange,fabs(dnew - surf_ptr->sunclum[inode][iphs][iths]));
+				dlum = max(dlum,fabs(dnew));
+				surf_ptr->sunclum[inode][iphs][iths] = dnew;
 			}
 		}
 	}
+	if ((pdMaxChange != NULL) && (dchange > *pdMaxChange)) *pdMaxChange = dchange;
+	if ((pdMaxLum != NULL) && (dlum > *pdMaxLum)) *pdMaxLum = dlum;
 
 	return(0);
 }
@@ -299,6 +370,8 @@ int surf_interreflect(
 /* Based on Superlite conventions. */
 /* Note that Superlite does not interreflect light between pairs of windows. */
 /* cfs modification */
+/* Configuration factors are taken from the window form factor matrix, */
+/* which is calculated on the first pass and reused for later iterations. */
 /****************************************************************************/
 /* C Language Implementation of Superlite Daylighting Algorithms */
 /* by Rob Hitchcock */
@@ -314,39 +387,265 @@ int wndo_interreflect(
 	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
 {
 	int inode;					/* current window node loop index */
-	int icoord;					/* node coordinate loop index */
 	int iphs, iths;				/* sun position loop indexes */
-	int jsurf, jnode;		/* loop indexes for other surfaces in current zone */
-	double scb1, scb2, ssq, icos1, icos2;	/* temp calc vars */
-	double yyy[NCOORDS];	/* temp coordinate calc var */
+	int ij, jnode;				/* form factor entry index and reflecting node index */
 	double fij;	/* configuration factor between nodes on wndo i and surfs j */
-	double delf_overcast[MAX_SURF_NODES];
-	double delf_skyclear[MAX_SURF_NODES][NPHS][NTHS];	/* temp accumulators for reflected light */
-	double delf_sunclear[MAX_SURF_NODES][NPHS][NTHS];	/* temp accumulators for reflected light */
+	double delf_overcast;
+	double delf_skyclear[NPHS][NTHS];	/* temp accumulators for reflected light */
+	double delf_sunclear[NPHS][NTHS];	/* temp accumulators for reflected light */
+	WNDO *wndo_ptr = bldg_ptr->zone[iz]->surf[is]->wndo[iw];	/* current window */
+	SURF *jsurf_ptr;	/* other (reflecting) surface */
+	FFMAT *ff_ptr;		/* form factor matrix for current window */
+
+	/* calc configuration (form) factors if not yet done for the current mesh */
+	if ((wndo_ptr->ff == NULL) || (wndo_ptr->ff->nrows != wndo_ptr->nnodes)) {
+		delete(wndo_ptr->ff);
+		wndo_ptr->ff = wndo_form_factors(bldg_ptr,iz,is,iw);
+	}
+	ff_ptr = wndo_ptr->ff;
 
-	/* init accumulators for each node on current window */
-	for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->wndo[iw]->nnodes; inode++) {
+	/* for each node on current window */
+	for (inode=0; inode<ff_ptr->nrows; inode++) {
+		/* init accumulators */
+		delf_overcast = 0.;
+		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+			for (iths=0; iths<sun_ptr->nths; iths++) {
+				delf_skyclear[iphs][iths] = 0.;
+				delf_sunclear[iphs][iths] = 0.;
+			}
+		}
+		/* for each stored node on other surfaces */
+		for (ij=ff_ptr->row_start[inode]; ij<ff_ptr->row_start[inode+1]; ij++) {
+			jsurf_ptr = bldg_ptr->zone[iz]->surf[ff_ptr->col[ij].jsurf];
+			jnode = ff_ptr->col[ij].jnode;
+			fij = ff_ptr->fij[ij];
+			/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
+			delf_overcast += fij * jsurf_ptr->skyolum[jnode];
+			/* for each Sun Position Altitude */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+				/* for each Sun Position Azimuth */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
+					/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
+					delf_skyclear[iphs][iths] += fij * jsurf_ptr->skyclum[jnode][iphs][iths];
+					delf_sunclear[iphs][iths] += fij * jsurf_ptr->sunclum[jnode][iphs][iths];
+				}
+			}
+		}
+
+		/* improve values for total node luminance for current window node */
 		/* for overcast sky condition */
-		delf_overcast[inode] = 0.;
+		if ( isnan(delf_overcast) )delf_overcast=0.;
+		wndo_ptr->skyolum[inode] = wndo_ptr->direct_skyolum[inode] + frac * delf_overcast;
 		/* for each Sun Position Altitude */
 		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
 			/* for each Sun Position Azimuth */
 			for (iths=0; iths<sun_ptr->nths; iths++) {
 				/* for each clear sky sun position */
-				delf_skyclear[inode][iphs][iths] = 0.;
-				delf_sunclear[inode][iphs][iths] = 0.;
+				if ( isnan(delf_skyclear[iphs][iths]) )delf_skyclear[iphs][iths]=0.;
+				if ( isnan(delf_sunclear[iphs][iths]) )delf_sunclear[iphs][iths]=0.;
+				wndo_ptr->skyclum[inode][iphs][iths] = wndo_ptr->direct_skyclum[inode][iphs][iths] + frac * delf_skyclear[iphs][iths];
+				wndo_ptr->sunclum[inode][iphs][iths] = wndo_ptr->direct_sunclum[inode][iphs][iths] + frac * delf_sunclear[iphs][iths];
 			}
 		}
 	}
 
-	/* for each non-window surface in current zone */
-	/* Note - the present assumption is that there are */
-	/* no internal obstructions. */
-	for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
-		/* skip current window host surface */
-		if (jsurf == is) continue;
-		/* for each node on current window */
-		for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->wndo[iw]->nnodes; inode++) {
+	return(0);
+}
+
+/************************* subroutine refpt_total_illum ************************/
+/* Loops through all reference points in current zone to calculate */
+/* total illuminance. */
+/* Configuration factors are taken from the zone ref_pt form factor matrix, */
+/* which is calculated on the first call and reused for later calls. */
+/* Based on Superlite conventions. */
+/****************************************************************************/
+/* C Language Implementation of Superlite Daylighting Algorithms */
+/* by Rob Hitchcock */
+/* Building Technologies Program, Lawrence Berkeley Laboratory */
+/************************* subroutine refpt_total_illum ************************/
+int refpt_total_illum(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	int iz,				/* current zone index */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	int irp;			/* current reference point index */
+	int ij, jnode;		/* form factor entry index and reflecting node index */
+	int iphs, iths;			/* sun position loop indexes */
+	double fij;	/* configuration factor between ref_pt and node on surf j */
+	REFPT *refpt_ptr;	/* current reference point */
+	SURF *jsurf_ptr;	/* reflecting surface */
+	FFMAT *ff_ptr;		/* form factor matrix for ref_pts in this zone */
+
+    // Init return value
+    int iReturnVal = 0;
+
+	/* calc configuration (form) factors if not yet done for the current ref_pts */
+	if ((bldg_ptr->zone[iz]->refpt_ff == NULL) || (bldg_ptr->zone[iz]->refpt_ff->nrows != bldg_ptr->zone[iz]->nrefpts)) {
+		delete(bldg_ptr->zone[iz]->refpt_ff);
+		bldg_ptr->zone[iz]->refpt_ff = refpt_form_factors(bldg_ptr,iz);
+	}
+	ff_ptr = bldg_ptr->zone[iz]->refpt_ff;
+
+	/* for each ref_pt in this zone */
+	for (irp=0; irp<ff_ptr->nrows; irp++) {
+		refpt_ptr = bldg_ptr->zone[iz]->ref_pt[irp];
+		/* for each stored surface node */
+		for (ij=ff_ptr->row_start[irp]; ij<ff_ptr->row_start[irp+1]; ij++) {
+			jsurf_ptr = bldg_ptr->zone[iz]->surf[ff_ptr->col[ij].jsurf];
+			jnode = ff_ptr->col[ij].jnode;
+			fij = ff_ptr->fij[ij];
+			/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
+			refpt_ptr->delf_overcast += fij * jsurf_ptr->skyolum[jnode];
+			/* for each Sun Position Altitude */
+			for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+				/* for each Sun Position Azimuth */
+				for (iths=0; iths<sun_ptr->nths; iths++) {
+					/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
+					refpt_ptr->delf_skyclear[iphs][iths] += fij * jsurf_ptr->skyclum[jnode][iphs][iths];
+					refpt_ptr->delf_sunclear[iphs][iths] += fij * jsurf_ptr->sunclum[jnode][iphs][iths];
+				}
+			}
+		}
+	}
+
+	/* Add the internal-reflection contribution to the reference point */
+	/* initial illumination due to direct distribution from the cfs. */
+
+	/* for each ref_pt in this zone */
+	for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
+		/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
+		bldg_ptr->zone[iz]->ref_pt[irp]->skyoillum = bldg_ptr->zone[iz]->ref_pt[irp]->direct_skyoillum + bldg_ptr->zone[iz]->ref_pt[irp]->delf_overcast / PI;
+		/* for each Sun Position Altitude */
+		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
+			/* for each Sun Position Azimuth */
+			for (iths=0; iths<sun_ptr->nths; iths++) {
+				/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
+				bldg_ptr->zone[iz]->ref_pt[irp]->skycillum[iphs][iths] = bldg_ptr->zone[iz]->ref_pt[irp]->direct_skycillum[iphs][iths] + bldg_ptr->zone[iz]->ref_pt[irp]->delf_skyclear[iphs][iths] / PI;
+				bldg_ptr->zone[iz]->ref_pt[irp]->suncillum[iphs][iths] = bldg_ptr->zone[iz]->ref_pt[irp]->direct_suncillum[iphs][iths] + bldg_ptr->zone[iz]->ref_pt[irp]->delf_sunclear[iphs][iths] / PI;
+			}
+		}
+	}
+
+	return(iReturnVal);
+}
+
+/************************** subroutine ff_add *************************/
+/* Appends one configuration factor to the current row of a form factor */
+/* matrix, dropping factors too small to affect the interreflection. */
+/************************** subroutine ff_add *************************/
+static void ff_add(
+	FFMAT *ff_ptr,	/* form factor matrix being built */
+	int jsurf,		/* reflecting surface index */
+	int jnode,		/* reflecting surface node index */
+	double fij)		/* configuration factor */
+{
+	FFCOL col;
+
+	if (fabs(fij) < FF_DROP_TOL) return;
+	col.jsurf = (short)jsurf;
+	col.jnode = (short)jnode;
+	ff_ptr->col.push_back(col);
+	ff_ptr->fij.push_back(fij);
+}
+
+/************************** subroutine surf_form_factors *************************/
+/* Calculates configuration (form) factors between each node on current */
+/* surface and each node on the other surfaces in current zone. */
+/* Returns a new form factor matrix with one row per current surface node. */
+/* Based on Superlite conventions. */
+/****************************************************************************/
+/* C Language Implementation of Superlite Daylighting Algorithms */
+/* by Rob Hitchcock */
+/* Building Technologies Program, Lawrence Berkeley Laboratory */
+/************************** subroutine surf_form_factors *************************/
+FFMAT *surf_form_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int iz,				/* current zone index */
+	int isurf)			/* current surface index */
+{
+	int inode;					/* current surface node loop index */
+	int icoord;					/* node coordinate loop index */
+	int jsurf, jnode;		/* loop indexes for other surfaces in current zone */
+	double scb1, scb2, ssq;	/* temp calc vars */
+	int icos1, icos2;				/* temp calc vars */
+	double yyy[NCOORDS];	/* temp coordinate calc var */
+	double fij;	/* configuration factor between nodes on surfs i and j */
+	FFMAT *ff_ptr = new FFMAT;
+
+	ff_ptr->nrows = bldg_ptr->zone[iz]->surf[isurf]->nnodes;
+	ff_ptr->row_start.resize(ff_ptr->nrows+1);
+
+	/* for each node on current surface */
+	for (inode=0; inode<ff_ptr->nrows; inode++) {
+		ff_ptr->row_start[inode] = (int)ff_ptr->fij.size();
+		/* for each non-window surface in current zone */
+		/* Note - the present assumption is that there are */
+		/* no internal obstructions. */
+		for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
+			/* skip current surface */
+			if (jsurf == isurf) continue;
+			/* for each node on other (reflecting) surface */
+			for (jnode=0; jnode<bldg_ptr->zone[iz]->surf[jsurf]->nnodes; jnode++) {
+				/* calc configuration (form) factor fij */
+				scb1 = 0.;
+				scb2 = 0.;
+				ssq = 0.;
+				for (icoord=0; icoord<NCOORDS; icoord++) {
+					yyy[icoord] = bldg_ptr->zone[iz]->surf[jsurf]->node[jnode][icoord] - bldg_ptr->zone[iz]->surf[isurf]->node[inode][icoord];
+					scb1 += yyy[icoord] * bldg_ptr->zone[iz]->surf[isurf]->dircos[icoord+6];
+					scb2 -= yyy[icoord] * bldg_ptr->zone[iz]->surf[jsurf]->dircos[icoord+6];
+					ssq += yyy[icoord] * yyy[icoord];
+				}
+				icos1 = (int)(1.0 + scb1 / (1.0 + ssq));
+				icos2 = (int)(1.0 + scb2 / (1.0 + ssq));
+				fij = scb1 * scb2 / (ssq * ssq) * bldg_ptr->zone[iz]->surf[jsurf]->node_areas[jnode] * icos1 * icos2;
+				fij = fij / (1.0 + 0.6 * fij * fij);
+				ff_add(ff_ptr,jsurf,jnode,fij);
+			}
+		}
+	}
+	ff_ptr->row_start[ff_ptr->nrows] = (int)ff_ptr->fij.size();
+
+	return(ff_ptr);
+}
+
+/************************** subroutine wndo_form_factors *************************/
+/* Calculates configuration (form) factors between each node on current */
+/* window and each node on the other surfaces in current zone. */
+/* Returns a new form factor matrix with one row per current window node. */
+/* Based on Superlite conventions. */
+/****************************************************************************/
+/* C Language Implementation of Superlite Daylighting Algorithms */
+/* by Rob Hitchcock */
+/* Building Technologies Program, Lawrence Berkeley Laboratory */
+/************************** subroutine wndo_form_factors *************************/
+FFMAT *wndo_form_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int iz,				/* current zone index */
+	int is,				/* current surface index */
+	int iw)				/* current window index */
+{
+	int inode;					/* current window node loop index */
+	int icoord;					/* node coordinate loop index */
+	int jsurf, jnode;		/* loop indexes for other surfaces in current zone */
+	double scb1, scb2, ssq, icos1, icos2;	/* temp calc vars */
+	double yyy[NCOORDS];	/* temp coordinate calc var */
+	double fij;	/* configuration factor between nodes on wndo i and surfs j */
+	FFMAT *ff_ptr = new FFMAT;
+
+	ff_ptr->nrows = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->nnodes;
+	ff_ptr->row_start.resize(ff_ptr->nrows+1);
+
+	/* for each node on current window */
+	for (inode=0; inode<ff_ptr->nrows; inode++) {
+		ff_ptr->row_start[inode] = (int)ff_ptr->fij.size();
+		/* for each non-window surface in current zone */
+		/* Note - the present assumption is that there are */
+		/* no internal obstructions. */
+		for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
+			/* skip current window host surface */
+			if (jsurf == is) continue;
 			/* for each node on other surface */
 			for (jnode=0; jnode<bldg_ptr->zone[iz]->surf[jsurf]->nnodes; jnode++) {
 				/* calc configuration (form) factor */
@@ -355,10 +654,6 @@ int wndo_interreflect(
 				ssq = 0.;
 				for (icoord=0; icoord<NCOORDS; icoord++) {
 					yyy[icoord] = bldg_ptr->zone[iz]->surf[jsurf]->node[jnode][icoord] - bldg_ptr->zone[iz]->surf[is]->wndo[iw]->node[inode][icoord];
-					/* Note: yyy[Y] sign is changed to account for differences in */
-					/* slite and doe2 coordinate systems */
-					// RJH - removed 1/9/2004 after correcting direction cosines to DOE2 coordinate system
-					//if (icoord == 1) yyy[icoord] = -(yyy[icoord]);
 					/* note - wndo direction cosine values are same as host surface */
 					scb1 += yyy[icoord] * bldg_ptr->zone[iz]->surf[is]->dircos[icoord+6];
 					scb2 -= yyy[icoord] * bldg_ptr->zone[iz]->surf[jsurf]->dircos[icoord+6];
@@ -371,75 +666,40 @@ int wndo_interreflect(
 				fij = safeDivide(scb1 * scb2 , (ssq * ssq) * bldg_ptr->zone[iz]->surf[jsurf]->node_areas[jnode] * icos1 * icos2);
 				fij = safeDivide(fij , (1.0 + 0.6 * fij * fij));
 				if ( isnan(fij) ) fij=0.;
-
-				/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
-				delf_overcast[inode] += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyolum[jnode];
-				/* for each Sun Position Altitude */
-				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-					/* for each Sun Position Azimuth */
-					for (iths=0; iths<sun_ptr->nths; iths++) {
-						/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
-						delf_skyclear[inode][iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyclum[jnode][iphs][iths];
-						delf_sunclear[inode][iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->sunclum[jnode][iphs][iths];
-					}
-				}
-			}
-		}
-	}
-
-	/* iteration finished for current window, */
-	/* improve values for total node luminance for each node on current window */
-	for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->nnodes; inode++) {
-		/* for overcast sky condition */
-		if ( isnan(delf_overcast[inode]) )delf_overcast[inode]=0.;
-		bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyolum[inode] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyolum[inode] + frac * delf_overcast[inode];
-		/* for each Sun Position Altitude */
-		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-			/* for each Sun Position Azimuth */
-			for (iths=0; iths<sun_ptr->nths; iths++) {
-				/* for each clear sky sun position */
-				if ( isnan(delf_skyclear[inode][iphs][iths]) )delf_skyclear[inode][iphs][iths]=0.;
-				if ( isnan(delf_sunclear[inode][iphs][iths]) )delf_sunclear[inode][iphs][iths]=0.;
-				bldg_ptr->zone[iz]->surf[is]->wndo[iw]->skyclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_skyclum[inode][iphs][iths] + frac * delf_skyclear[inode][iphs][iths];
-				bldg_ptr->zone[iz]->surf[is]->wndo[iw]->sunclum[inode][iphs][iths] = bldg_ptr->zone[iz]->surf[is]->wndo[iw]->direct_sunclum[inode][iphs][iths] + frac * delf_sunclear[inode][iphs][iths];
+				ff_add(ff_ptr,jsurf,jnode,fij);
 			}
 		}
 	}
+	ff_ptr->row_start[ff_ptr->nrows] = (int)ff_ptr->fij.size();
 
-	return(0);
+	return(ff_ptr);
 }
 
-/************************* subroutine refpt_total_illum ************************/
-/* Loops through all reference points in current zone to calculate */
-/* total illuminance. */
+/************************* subroutine refpt_form_factors ************************/
+/* Calculates configuration (form) factors between each reference point */
+/* in current zone and each visible surface node in the zone. */
+/* Returns a new form factor matrix with one row per reference point. */
 /* Based on Superlite conventions. */
 /****************************************************************************/
 /* C Language Implementation of Superlite Daylighting Algorithms */
 /* by Rob Hitchcock */
 /* Building Technologies Program, Lawrence Berkeley Laboratory */
-/************************* subroutine refpt_total_illum ************************/
-int refpt_total_illum(
+/************************* subroutine refpt_form_factors ************************/
+FFMAT *refpt_form_factors(
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
-	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
-	int iz,				/* current zone index */
-	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+	int iz)				/* current zone index */
 {
 	double refpt_dircos[NDC];	/* ref_pt direction cosine values (slite) */
 	int irp;			/* current reference point index */
 	int jsurf, jnode;	/* loop indexes for non-wndo surfaces in current zone */
 	int icoord;	/* coordinate loop index */
-	int iphs, iths;			/* sun position loop indexes */
 	double scb1, scb2, ssq;	/* tmp calc vars */
 	int icos1, icos2;				/* tmp calc vars */
 	double yyy[NCOORDS];	/* tmp coordinate calc var */
 	double fij;	/* configuration factor between ref_pt and node on surf j */
-
-    // Init return value
-    int iReturnVal = 0;
+	FFMAT *ff_ptr = new FFMAT;
 
 	/* Algorithms are the same as for internal reflections, but no iteration. */
-	/* Because of their importance, configuration factors for close nodes */
-	/* are calculated more accurately. */
 
 	/* Note - the present assumption is that there are */
 	/* no internal obstructions. */
@@ -457,10 +717,14 @@ int refpt_total_illum(
 	}
 	refpt_dircos[8] = 1.0;
 
-	/* for each surface in this zone */
-	for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
-		/* for each ref_pt in this zone */
-		for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
+	ff_ptr->nrows = bldg_ptr->zone[iz]->nrefpts;
+	ff_ptr->row_start.resize(ff_ptr->nrows+1);
+
+	/* for each ref_pt in this zone */
+	for (irp=0; irp<ff_ptr->nrows; irp++) {
+		ff_ptr->row_start[irp] = (int)ff_ptr->fij.size();
+		/* for each surface in this zone */
+		for (jsurf=0; jsurf<bldg_ptr->zone[iz]->nsurfs; jsurf++) {
 			/* for each node on surface */
 			for (jnode=0; jnode<bldg_ptr->zone[iz]->surf[jsurf]->nnodes; jnode++) {
 				/* calc configuration (form) factor */
@@ -469,10 +733,6 @@ int refpt_total_illum(
 				ssq = 0.;
 				for (icoord=0; icoord<NCOORDS; icoord++) {
 					yyy[icoord] = bldg_ptr->zone[iz]->surf[jsurf]->node[jnode][icoord] - bldg_ptr->zone[iz]->ref_pt[irp]->bs[icoord];
-					/* Note: yyy[Y] sign is changed to account for differences in */
-					/* slite and doe2 coordinate systems */
-					// RJH - removed 1/9/2004 after correcting direction cosines to DOE2 coordinate system
-					//if (icoord == 1) yyy[icoord] = -(yyy[icoord]);
 					scb1 += yyy[icoord] * refpt_dircos[icoord+6];
 					scb2 -= yyy[icoord] * bldg_ptr->zone[iz]->surf[jsurf]->dircos[icoord+6];
 					ssq += yyy[icoord] * yyy[icoord];
@@ -480,53 +740,13 @@ int refpt_total_illum(
 				icos1 = (int)(1.0 + scb1 / (1.0 + ssq));
 				icos2 = (int)(1.0 + scb2 / (1.0 + ssq));
 				fij = scb1 * scb2 / (ssq * ssq) * bldg_ptr->zone[iz]->surf[jsurf]->node_areas[jnode] * icos1 * icos2;
-				/* if this is a close node (relative to node area) */
-				/* then calculate config factor more accurately */
-
-                // Change to Output warning message - RJH 2/25/04
-                // Change to Output ERROR message and return for termination - RJH 3/11/05
-				// Ignore - RJH 2/12/09
-				if ((bldg_ptr->zone[iz]->surf[jsurf]->node_areas[jnode] / ssq) >= 1.0) {
-//					*pofdmpfile << "ERROR: DElight inaccurate daylight illuminance interreflection calculation for zone " <<bldg_ptr->zone[iz]->name << "\n";
-//					*pofdmpfile << "ERROR: Node area too large relative to distance between reference point [" << bldg_ptr->zone[iz]->ref_pt[irp]->name << "] and node [" << jnode << "] for Surface " <<bldg_ptr->zone[iz]->surf[jsurf]->name << "\n";
-//					*pofdmpfile << "ERROR: Try moving Reference Point away from Surface or reducing Maximum Node Gridding Area for this zone.\n";
-//					*pofdmpfile << "ERROR: This error can also result from too large differences in areas between surfaces in zone.\n";
-// Warning return value  iReturnVal = -10;
-//	                return(-1); // ERROR return value
-				}
-
-				/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
-				bldg_ptr->zone[iz]->ref_pt[irp]->delf_overcast += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyolum[jnode];
-				/* for each Sun Position Altitude */
-				for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-					/* for each Sun Position Azimuth */
-					for (iths=0; iths<sun_ptr->nths; iths++) {
-						/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
-						bldg_ptr->zone[iz]->ref_pt[irp]->delf_skyclear[iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->skyclum[jnode][iphs][iths];
-						bldg_ptr->zone[iz]->ref_pt[irp]->delf_sunclear[iphs][iths] += fij * bldg_ptr->zone[iz]->surf[jsurf]->sunclum[jnode][iphs][iths];
-					}
-				}
+				// Close nodes (node area large relative to distance) are no longer
+				// reported as inaccurate - RJH 2/12/09
+				ff_add(ff_ptr,jsurf,jnode,fij);
 			}
 		}
 	}
+	ff_ptr->row_start[ff_ptr->nrows] = (int)ff_ptr->fij.size();
 
-	/* Add the internal-reflection contribution to the reference point */
-	/* initial illumination due to direct distribution from the cfs. */
-
-	/* for each ref_pt in this zone */
-	for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
-		/* for overcast sky condition, accumulate reflected light from node on reflecting surface */
-		bldg_ptr->zone[iz]->ref_pt[irp]->skyoillum = bldg_ptr->zone[iz]->ref_pt[irp]->direct_skyoillum + bldg_ptr->zone[iz]->ref_pt[irp]->delf_overcast / PI;
-		/* for each Sun Position Altitude */
-		for (iphs=0; iphs<sun_ptr->nphs; iphs++) {
-			/* for each Sun Position Azimuth */
-			for (iths=0; iths<sun_ptr->nths; iths++) {
-				/* for each clear sky sun position, accumulate reflected light from node on reflecting surface */
-				bldg_ptr->zone[iz]->ref_pt[irp]->skycillum[iphs][iths] = bldg_ptr->zone[iz]->ref_pt[irp]->direct_skycillum[iphs][iths] + bldg_ptr->zone[iz]->ref_pt[irp]->delf_skyclear[iphs][iths] / PI;
-				bldg_ptr->zone[iz]->ref_pt[irp]->suncillum[iphs][iths] = bldg_ptr->zone[iz]->ref_pt[irp]->direct_suncillum[iphs][iths] + bldg_ptr->zone[iz]->ref_pt[irp]->delf_sunclear[iphs][iths] / PI;
-			}
-		}
-	}
-
-	return(iReturnVal);
+	return(ff_ptr);
 }
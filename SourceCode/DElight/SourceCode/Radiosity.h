@@ -47,12 +47,24 @@ int slite_interreflect(
 	int niterate,		/* number of radiosity iterations */
 	ofstream* pofdmpfile);/* ptr to LBLDLL error dump file */
 
+int zone_interreflect(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	LIB *lib_ptr,		/* pointer to library structure */
+	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
+	int iz,				/* current zone index */
+	int niterate,		/* number of radiosity iterations */
+	ofstream* pofdmpfile);/* ptr to LBLDLL error dump file */
+
+double radiosity_tolerance(void);
+
 int surf_interreflect(
 	BLDG *bldg_ptr,		/* pointer to bldg structure */
 	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
 	int iz,				/* current zone index */
 	int isurf,			/* current surface index */
 	double frac,		/* surface reflectance divided by PI */
+	double *pdMaxChange,	/* running max change of node luminance (NULL for none) */
+	double *pdMaxLum,		/* running max node luminance (NULL for none) */
 	ofstream* pofdmpfile);/* ptr to LBLDLL error dump file */
 
 int wndo_interreflect(
@@ -69,3 +81,18 @@ int refpt_total_illum(
 	SUN_DATA *sun_ptr,	/* pointer to sun data structure */
 	int iz,				/* current zone index */
 	ofstream* pofdmpfile);/* ptr to LBLDLL error dump file */
+
+FFMAT *surf_form_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int iz,				/* current zone index */
+	int isurf);			/* current surface index */
+
+FFMAT *wndo_form_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int iz,				/* current zone index */
+	int is,				/* current surface index */
+	int iw);			/* current window index */
+
+FFMAT *refpt_form_factors(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int iz);			/* current zone index */
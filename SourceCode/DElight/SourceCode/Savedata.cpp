@@ -142,6 +142,19 @@ void dump_bldg(
 		fprintf(outfile,"Light_Ctrl_Prob %5.2lf\n", bldg_ptr->zone[iz]->lt_ctrl_prob);
 		fprintf(outfile,"View_Azimuth %5.2lf\n", bldg_ptr->zone[iz]->view_azm);
 		fprintf(outfile,"Max_Grid_Node_Area %5.2lf\n", bldg_ptr->zone[iz]->max_grid_node_area);
+		/* ----- radiosity convergence (only when solved to a tolerance) ----- */
+		if (bldg_ptr->zone[iz]->rad_resid >= 0.) {
+			fprintf(outfile,"Radiosity_Iterations %d\n", bldg_ptr->zone[iz]->rad_iter);
+			fprintf(outfile,"Radiosity_Residual %10.3le\n", bldg_ptr->zone[iz]->rad_resid);
+		}
+		/* ----- adaptive window elements (only when enabled) ----- */
+		if (bldg_ptr->zone[iz]->wndo_elems_adaptive > 0) {
+			fprintf(outfile,"Window_Elements_Uniform %ld\n", bldg_ptr->zone[iz]->wndo_elems_uniform);
+			fprintf(outfile,"Window_Elements_Adaptive %ld\n", bldg_ptr->zone[iz]->wndo_elems_adaptive);
+			fprintf(outfile,"Window_Elements_Saved %ld\n", bldg_ptr->zone[iz]->wndo_elems_uniform - bldg_ptr->zone[iz]->wndo_elems_adaptive);
+			if (bldg_ptr->zone[iz]->wndo_adapt_dev >= 0.)
+				fprintf(outfile,"Window_Adaptive_Deviation %10.3le\n", bldg_ptr->zone[iz]->wndo_adapt_dev);
+		}
 
 		/* Write ZONE LIGHTING SCHEDULE headings lines */
 		fprintf(outfile,"\n");
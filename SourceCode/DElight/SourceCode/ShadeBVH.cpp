@@ -0,0 +1,549 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <iostream>
+#include <fstream>
+#include <cmath>
+#include <ctime>
+#include <climits>
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+
+using namespace std;
+
+// BGL includes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+// includes
+#include "CONST.H"
+#include "DBCONST.H"
+#include "DEF.H"
+
+// WLC includes
+#include "NodeMesh2.h"
+#include "WLCSurface.h"
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "CFSSystem.h"
+#include "CFSSurface.h"
+
+// includes
+#include "DOE2DL.H"
+#include "geom.h"
+#include "ShadeBVH.h"
+
+/* Ordering of BVH primitives by bounding box center along one axis, used by nth_element(). */
+struct bvh_centroid_less {
+	int iaxis;	/* split axis (X, Y or Z) */
+	bvh_centroid_less(int ia) : iaxis(ia) {}
+	bool operator()(const BVHPRIM& pa, const BVHPRIM& pb) const {
+		return ((pa.bmin[iaxis] + pa.bmax[iaxis]) < (pb.bmin[iaxis] + pb.bmax[iaxis]));
+	}
+};
+
+/****************************** subroutine bvh_add_prim *****************************/
+/* Appends a dpierc() rectangle to the primitive list of one BVH category. */
+/* Primitive keys record the order in which dhitsh() scans the category. */
+/* dpierc() accepts plane points c with 0 <= (c-v2).a <= a.a and 0 <= (c-v2).b <= b.b */
+/* (a = v1-v2, b = v3-v2), which is the rectangle itself only when a and b are */
+/* perpendicular, so the primitive box encloses the corners of that accepted region. */
+/****************************************************************************/
+/****************************** subroutine bvh_add_prim *****************************/
+static void bvh_add_prim(
+	vector<BVHPRIM>& prim,	/* primitive list of category */
+	int ihit,				/* dhitsh() hit category (1, 2 or 3) */
+	int iz,					/* zone index */
+	int ish,				/* zone shade, surface or bldg shade index */
+	double vert[NCOORDS][NVERTS])	/* polygon vertex coordinates (bldg sys) */
+{
+	BVHPRIM bp;
+	int icoord, ic;
+	double vecta[NCOORDS], vectb[NCOORDS];	/* rectangle edge vectors from v2 */
+	double daa, dbb, dab, det;	/* edge vector dot products */
+	double pa, pb, alpha, beta;	/* accepted region corner */
+	double corner;
+
+	bp.ihit = ihit;
+	bp.iz = iz;
+	bp.ish = ish;
+	bp.key = (int)prim.size();
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		bp.v1[icoord] = vert[icoord][0];
+		bp.v2[icoord] = vert[icoord][1];
+		bp.v3[icoord] = vert[icoord][2];
+		vecta[icoord] = bp.v1[icoord] - bp.v2[icoord];
+		vectb[icoord] = bp.v3[icoord] - bp.v2[icoord];
+	}
+
+	/* degenerate rectangle has no normal, so dpierc() can never report a hit */
+	daa = ddot(vecta,vecta);
+	dbb = ddot(vectb,vectb);
+	dab = ddot(vecta,vectb);
+	det = daa * dbb - dab * dab;
+	if (det <= 0.0) return;
+
+	/* corners c-v2 = alpha*a + beta*b with c.a in {0,a.a} and c.b in {0,b.b} */
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		bp.bmin[icoord] = bp.v2[icoord];
+		bp.bmax[icoord] = bp.v2[icoord];
+	}
+	for (ic=1; ic<4; ic++) {
+		pa = (ic & 1) ? daa : 0.;
+		pb = (ic & 2) ? dbb : 0.;
+		alpha = (pa * dbb - pb * dab) / det;
+		beta = (pb * daa - pa * dab) / det;
+		for (icoord=0; icoord<NCOORDS; icoord++) {
+			corner = bp.v2[icoord] + alpha * vecta[icoord] + beta * vectb[icoord];
+			bp.bmin[icoord] = min(bp.bmin[icoord],corner);
+			bp.bmax[icoord] = max(bp.bmax[icoord],corner);
+		}
+	}
+
+	prim.push_back(bp);
+}
+
+/****************************** subroutine bvh_build_node *****************************/
+/* Recursively builds the BVH subtree over primitives [first, first+count). */
+/* Boxes enclose the primitive boxes, padded by BVH_BOX_TOL so that */
+/* box culling never rejects a ray that dpierc() accepts. */
+/* Primitives are split at the median box center along the longest box axis. */
+/* Returns the index of the subtree root node. */
+/****************************************************************************/
+/****************************** subroutine bvh_build_node *****************************/
+static int bvh_build_node(
+	vector<BVHPRIM>& prim,	/* primitive list of category (reordered) */
+	vector<BVHNODE>& node,	/* node list of category */
+	int first,				/* first primitive of subtree */
+	int count)				/* # of primitives in subtree */
+{
+	BVHNODE bn;
+	int inode;		/* index of new node */
+	int ip, icoord, iaxis;	/* indexes */
+	int nleft;		/* # of primitives in left subtree */
+	int ileft, iright;	/* child node indexes */
+	double ext, extmax;	/* box extents */
+
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		bn.bmin[icoord] = prim[first].bmin[icoord];
+		bn.bmax[icoord] = prim[first].bmax[icoord];
+	}
+	bn.minkey = INT_MAX;
+	for (ip=first; ip<first+count; ip++) {
+		for (icoord=0; icoord<NCOORDS; icoord++) {
+			bn.bmin[icoord] = min(bn.bmin[icoord],prim[ip].bmin[icoord]);
+			bn.bmax[icoord] = max(bn.bmax[icoord],prim[ip].bmax[icoord]);
+		}
+		if (prim[ip].key < bn.minkey) bn.minkey = prim[ip].key;
+	}
+
+	/* longest box axis, then pad box */
+	iaxis = X;
+	extmax = -1.;
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		ext = bn.bmax[icoord] - bn.bmin[icoord];
+		if (ext > extmax) {
+			extmax = ext;
+			iaxis = icoord;
+		}
+	}
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		bn.bmin[icoord] -= BVH_BOX_TOL * (1. + extmax);
+		bn.bmax[icoord] += BVH_BOX_TOL * (1. + extmax);
+	}
+
+	bn.left = -1;
+	bn.right = -1;
+	bn.first = first;
+	bn.count = count;
+	inode = (int)node.size();
+	node.push_back(bn);
+
+	if (count <= BVH_LEAF_SIZE) return(inode);
+
+	/* median split (node list may reallocate during recursion, so store children by index) */
+	nleft = count / 2;
+	nth_element(prim.begin()+first, prim.begin()+first+nleft, prim.begin()+first+count, bvh_centroid_less(iaxis));
+	ileft = bvh_build_node(prim,node,first,nleft);
+	iright = bvh_build_node(prim,node,first+nleft,count-nleft);
+	node[inode].left = ileft;
+	node[inode].right = iright;
+	node[inode].count = 0;
+
+	return(inode);
+}
+
+/****************************** subroutine build_shade_bvh *****************************/
+/* Builds one bounding-volume hierarchy for each dhitsh() hit category: */
+/* zone shades in all zones, zone surfaces in all zones, and bldg shades. */
+/* Must be called after zone shade, surface and bldg shade vertices (bldg sys) are set. */
+/* Caller owns the returned structure (see free_bldg()). */
+/****************************************************************************/
+/****************************** subroutine build_shade_bvh *****************************/
+SHADEBVH *build_shade_bvh(
+	BLDG *bldg_ptr)		/* pointer to bldg structure */
+{
+	SHADEBVH *bvh_ptr = new SHADEBVH;
+	int iz, izs, is, ish, icat;		/* indexes */
+
+	/* same scan order as dhitsh() */
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+		for (izs=0; izs<bldg_ptr->zone[iz]->nzshades; izs++)
+			bvh_add_prim(bvh_ptr->prim[0],1,iz,izs,bldg_ptr->zone[iz]->zshade[izs]->vert);
+	}
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+		for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++)
+			bvh_add_prim(bvh_ptr->prim[1],2,iz,is,bldg_ptr->zone[iz]->surf[is]->vert);
+	}
+	for (ish=0; ish<bldg_ptr->nbshades; ish++)
+		bvh_add_prim(bvh_ptr->prim[2],3,0,ish,bldg_ptr->bshade[ish]->vert);
+
+	for (icat=0; icat<NBVHCATS; icat++) {
+		if (bvh_ptr->prim[icat].size() == 0) continue;
+		bvh_ptr->node[icat].reserve(2 * bvh_ptr->prim[icat].size());
+		bvh_build_node(bvh_ptr->prim[icat],bvh_ptr->node[icat],0,(int)bvh_ptr->prim[icat].size());
+	}
+
+	return(bvh_ptr);
+}
+
+/****************************** subroutine bvh_ray_box *****************************/
+/* Returns 1 if the half-line from r1 along rn touches the node bounding box, else 0. */
+/****************************************************************************/
+/****************************** subroutine bvh_ray_box *****************************/
+static int bvh_ray_box(
+	BVHNODE *node_ptr,	/* pointer to BVH node */
+	double r1[NCOORDS],	/* origin of ray rn */
+	double rn[NCOORDS])	/* ray */
+{
+	int icoord;
+	double tnear = 0.;			/* ray parameter range inside box */
+	double tfar = 1.0e+30;
+	double t1, t2, tswap;
+
+	for (icoord=0; icoord<NCOORDS; icoord++) {
+		if (rn[icoord] == 0.0) {
+			if ((r1[icoord] < node_ptr->bmin[icoord]) || (r1[icoord] > node_ptr->bmax[icoord])) return(0);
+			continue;
+		}
+		t1 = (node_ptr->bmin[icoord] - r1[icoord]) / rn[icoord];
+		t2 = (node_ptr->bmax[icoord] - r1[icoord]) / rn[icoord];
+		if (t1 > t2) {
+			tswap = t1;
+			t1 = t2;
+			t2 = tswap;
+		}
+		if (t1 > tnear) tnear = t1;
+		if (t2 < tfar) tfar = t2;
+		if (tnear > tfar) return(0);
+	}
+
+	return(1);
+}
+
+/****************************** subroutine bvh_first_hit *****************************/
+/* Finds the primitive of one category that dhitsh() would report for ray rn from r1, */
+/* i.e., the accepted primitive with the lowest scan order key. */
+/* Zone surfaces are accepted only if their front is pierced, and the surfaces */
+/* containing the window and the node are skipped. */
+/* Subtrees whose lowest key cannot improve on the current hit are culled. */
+/* If ianyhit is nonzero the search stops at the first accepted primitive. */
+/* Returns 0 (ok) or -1 (traversal stack overflow). */
+/****************************************************************************/
+/****************************** subroutine bvh_first_hit *****************************/
+static int bvh_first_hit(
+	SHADEBVH *bvh_ptr,	/* pointer to shading BVH */
+	int icat,			/* hit category index (0=zone shade, 1=zone surface, 2=bldg shade) */
+	double r1[NCOORDS],	/* origin of ray rn */
+	double rn[NCOORDS],	/* ray */
+	int izone,			/* index of current zone */
+	int iWndoSurf,		/* index of current surface containing the Window */
+	int iNodeSurf,		/* index of current surface containing the Node, if applicable */
+	int ianyhit,		/* stop at first accepted primitive? (0=No 1=Yes) */
+	BVHPRIM **phit_ptr,	/* return value: hit primitive (NULL if none) */
+	int *ipierc_ptr)	/* return value: dpierc() value for hit primitive */
+{
+	int stack[BVH_MAX_DEPTH];	/* node traversal stack */
+	int nstack;
+	int ip, ipierc;
+	int bestkey = INT_MAX;
+	BVHNODE *node_ptr, *left_ptr, *right_ptr;
+	BVHPRIM *prim_ptr;
+
+	*phit_ptr = NULL;
+	*ipierc_ptr = 0;
+	if (bvh_ptr->node[icat].size() == 0) return(0);
+
+	stack[0] = 0;
+	nstack = 1;
+	while (nstack > 0) {
+		node_ptr = &(bvh_ptr->node[icat][stack[--nstack]]);
+		if (node_ptr->minkey >= bestkey) continue;
+		if (!bvh_ray_box(node_ptr,r1,rn)) continue;
+
+		/* leaf */
+		if (node_ptr->left < 0) {
+			for (ip=node_ptr->first; ip<node_ptr->first+node_ptr->count; ip++) {
+				prim_ptr = &(bvh_ptr->prim[icat][ip]);
+				if (prim_ptr->key >= bestkey) continue;
+				if (prim_ptr->ihit == 2) {
+					if ((prim_ptr->iz == izone) && (prim_ptr->ish == iWndoSurf)) continue;
+					if ((prim_ptr->iz == izone) && (prim_ptr->ish == iNodeSurf)) continue;
+				}
+				/* dpierc() return value (0=no intersect, 1=front, -1=back) */
+				dpierc(&ipierc,prim_ptr->v1,prim_ptr->v2,prim_ptr->v3,r1,rn);
+				if (ipierc == 0) continue;
+				if ((prim_ptr->ihit == 2) && (ipierc != 1)) continue;
+				*phit_ptr = prim_ptr;
+				*ipierc_ptr = ipierc;
+				bestkey = prim_ptr->key;
+				if (ianyhit) return(0);
+			}
+			continue;
+		}
+
+		/* interior node: visit child with the lower key first */
+		if (nstack + 2 > BVH_MAX_DEPTH) return(-1);
+		left_ptr = &(bvh_ptr->node[icat][node_ptr->left]);
+		right_ptr = &(bvh_ptr->node[icat][node_ptr->right]);
+		if (left_ptr->minkey <= right_ptr->minkey) {
+			stack[nstack++] = node_ptr->right;
+			stack[nstack++] = node_ptr->left;
+		}
+		else {
+			stack[nstack++] = node_ptr->left;
+			stack[nstack++] = node_ptr->right;
+		}
+	}
+
+	return(0);
+}
+
+/****************************** subroutine dhitsh_bvh *****************************/
+/* BVH version of dhitsh(), with identical results. */
+/* Zone shades take priority over front-facing zone surfaces, which take */
+/* priority over bldg shades; within each category the first polygon in */
+/* dhitsh() scan order is reported. */
+/* Falls back to the linear dhitsh() if no BVH has been built. */
+/****************************************************************************/
+/****************************** subroutine dhitsh_bvh *****************************/
+int dhitsh_bvh(
+	HIT *hit_ptr,		/* pointer to bldg-shade hit structure */
+	double r1[NCOORDS],	/* origin of ray rn */
+	double rn[NCOORDS],	/* ray */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* index of current zone */
+	int iWndoSurf,		/* index of current surface containing the Window */
+	int iNodeSurf)		/* index of current surface containing the Node, if applicable */
+{
+	int icat;		/* hit category index */
+	int ipierc;		/* dpierc() value for hit primitive */
+	BVHPRIM *prim_ptr;	/* hit primitive */
+
+	if (bldg_ptr->bvh == NULL) return(dhitsh(hit_ptr,r1,rn,bldg_ptr,izone,iWndoSurf,iNodeSurf));
+
+	hit_ptr->ihit = 0;
+	hit_ptr->hitshade = 0;
+	hit_ptr->hitzone = 0;
+
+	for (icat=0; icat<NBVHCATS; icat++) {
+		if (bvh_first_hit(bldg_ptr->bvh,icat,r1,rn,izone,iWndoSurf,iNodeSurf,0,&prim_ptr,&ipierc) < 0)
+			return(dhitsh(hit_ptr,r1,rn,bldg_ptr,izone,iWndoSurf,iNodeSurf));
+		if (prim_ptr == NULL) continue;
+		hit_ptr->hitshade = prim_ptr->ish;
+		switch (prim_ptr->ihit)
+		{
+			case 1:	/* zone shade */
+				hit_ptr->ihit = 1;
+				break;
+			case 2:	/* front of zone surface */
+				hit_ptr->hitzone = prim_ptr->iz;
+				hit_ptr->ihit = 2;
+				break;
+			case 3:	/* back (3) or front (4) of bldg shade */
+				if (ipierc == -1) hit_ptr->ihit = 3;
+				if (ipierc == 1) hit_ptr->ihit = 4;
+				break;
+		}
+		return(0);
+	}
+
+	return(0);
+}
+
+/****************************** subroutine dhitsh_any *****************************/
+/* Occlusion-only BVH query. */
+/* Returns 1 if dhitsh() would report any hit for ray rn from r1, else 0. */
+/* Stops at the first accepted polygon of any category. */
+/****************************************************************************/
+/****************************** subroutine dhitsh_any *****************************/
+int dhitsh_any(
+	double r1[NCOORDS],	/* origin of ray rn */
+	double rn[NCOORDS],	/* ray */
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int izone,			/* index of current zone */
+	int iWndoSurf,		/* index of current surface containing the Window */
+	int iNodeSurf)		/* index of current surface containing the Node, if applicable */
+{
+	int icat;		/* hit category index */
+	int ipierc;		/* dpierc() value for hit primitive */
+	BVHPRIM *prim_ptr;	/* hit primitive */
+	HIT hit;		/* linear dhitsh() fallback */
+
+	if (bldg_ptr->bvh != NULL) {
+		for (icat=0; icat<NBVHCATS; icat++) {
+			if (bvh_first_hit(bldg_ptr->bvh,icat,r1,rn,izone,iWndoSurf,iNodeSurf,1,&prim_ptr,&ipierc) < 0) break;
+			if (prim_ptr != NULL) return(1);
+		}
+		if (icat == NBVHCATS) return(0);
+	}
+
+	dhitsh(&hit,r1,rn,bldg_ptr,izone,iWndoSurf,iNodeSurf);
+	return(hit.ihit != 0);
+}
+
+/****************************** subroutine bvh_benchmark *****************************/
+/* Micro-benchmark of dhitsh_bvh() against the linear dhitsh(). */
+/* Fires nrays rays (spiral over the full sphere) from each ref pt and each */
+/* surface node of every zone, times both queries over the same ray set, */
+/* and checks that every HIT result is identical. */
+/* Results are written to the dump file. */
+/* Returns 0 if all results match, -1 otherwise. */
+/****************************************************************************/
+/****************************** subroutine bvh_benchmark *****************************/
+int bvh_benchmark(
+	BLDG *bldg_ptr,		/* pointer to bldg structure */
+	int nrays,			/* # of rays per origin point */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	vector<double> origin;	/* ray origins (NCOORDS per ray) */
+	vector<double> dir;		/* ray directions (NCOORDS per ray) */
+	vector<int> excl;		/* zone and excluded surface index per ray */
+	vector<HIT> hit_lin, hit_bvh;	/* results */
+	double pt[NCOORDS], ray[NCOORDS];
+	double zc, rxy, phi;	/* spiral direction vars */
+	int iz, is, irp, inode, iray, icoord;	/* indexes */
+	int nray_tot, nmismatch, nblock;
+	clock_t tstart;
+	double tlin, tbvh;		/* elapsed times (sec) */
+
+	if (nrays < 1) return(0);
+	if (bldg_ptr->bvh == NULL) bldg_ptr->bvh = build_shade_bvh(bldg_ptr);
+
+	/* ray set */
+	for (iz=0; iz<bldg_ptr->nzones; iz++) {
+		for (irp=0; irp<bldg_ptr->zone[iz]->nrefpts; irp++) {
+			for (iray=0; iray<nrays; iray++) {
+				for (icoord=0; icoord<NCOORDS; icoord++) origin.push_back(bldg_ptr->zone[iz]->ref_pt[irp]->bs[icoord]);
+				excl.push_back(iz);
+				excl.push_back(-1);
+			}
+		}
+		for (is=0; is<bldg_ptr->zone[iz]->nsurfs; is++) {
+			for (inode=0; inode<bldg_ptr->zone[iz]->surf[is]->nnodes; inode++) {
+				for (iray=0; iray<nrays; iray++) {
+					for (icoord=0; icoord<NCOORDS; icoord++) origin.push_back(bldg_ptr->zone[iz]->surf[is]->node[inode][icoord]);
+					excl.push_back(iz);
+					excl.push_back(is);
+				}
+			}
+		}
+	}
+	nray_tot = (int)excl.size() / 2;
+	for (iray=0; iray<nray_tot; iray++) {
+		/* golden angle spiral over the sphere */
+		zc = 1. - (2. * (double)(iray % nrays) + 1.) / (double)nrays;
+		rxy = sqrt(max(0.,1. - zc * zc));
+		phi = 2.39996322972865332 * (double)(iray % nrays);
+		dir.push_back(rxy * cos(phi));
+		dir.push_back(rxy * sin(phi));
+		dir.push_back(zc);
+	}
+	hit_lin.resize(nray_tot);
+	hit_bvh.resize(nray_tot);
+
+	/* linear dhitsh() */
+	tstart = clock();
+	for (iray=0; iray<nray_tot; iray++) {
+		for (icoord=0; icoord<NCOORDS; icoord++) {
+			pt[icoord] = origin[NCOORDS*iray+icoord];
+			ray[icoord] = dir[NCOORDS*iray+icoord];
+		}
+		dhitsh(&(hit_lin[iray]),pt,ray,bldg_ptr,excl[2*iray],excl[2*iray+1],excl[2*iray+1]);
+	}
+	tlin = (double)(clock() - tstart) / CLOCKS_PER_SEC;
+
+	/* BVH dhitsh_bvh() */
+	tstart = clock();
+	for (iray=0; iray<nray_tot; iray++) {
+		for (icoord=0; icoord<NCOORDS; icoord++) {
+			pt[icoord] = origin[NCOORDS*iray+icoord];
+			ray[icoord] = dir[NCOORDS*iray+icoord];
+		}
+		dhitsh_bvh(&(hit_bvh[iray]),pt,ray,bldg_ptr,excl[2*iray],excl[2*iray+1],excl[2*iray+1]);
+	}
+	tbvh = (double)(clock() - tstart) / CLOCKS_PER_SEC;
+
+	nmismatch = 0;
+	nblock = 0;
+	for (iray=0; iray<nray_tot; iray++) {
+		if (hit_lin[iray].ihit != 0) nblock++;
+		if ((hit_lin[iray].ihit != hit_bvh[iray].ihit) || (hit_lin[iray].hitshade != hit_bvh[iray].hitshade) || (hit_lin[iray].hitzone != hit_bvh[iray].hitzone))
+			nmismatch++;
+	}
+
+	*pofdmpfile << "DElight dhitsh() BVH benchmark: " << nray_tot << " rays, " << nblock << " blocked\n";
+	*pofdmpfile << "    linear dhitsh() = " << tlin << " sec, dhitsh_bvh() = " << tbvh << " sec";
+	if (tbvh > 0.0) *pofdmpfile << ", speedup = " << tlin / tbvh;
+	*pofdmpfile << "\n";
+	if (nmismatch > 0) {
+		*pofdmpfile << "ERROR: DElight dhitsh_bvh() differs from dhitsh() for " << nmismatch << " rays\n";
+		return(-1);
+	}
+
+	return(0);
+}
@@ -107,10 +107,9 @@ int struct_init(
 		((WNDO *)sptr)->n_width = 0;
 		((WNDO *)sptr)->n_height = 0;
 		((WNDO *)sptr)->nnodes = 0;
+		((WNDO *)sptr)->ff = NULL;
 		for(ii =0; ii<MAX_WNDO_NODES; ii++) {
 			((WNDO *)sptr)->node_areas[ii] = 0.;
-			((WNDO *)sptr)->direct_skyolum[ii] = 0.;
-			((WNDO *)sptr)->skyolum[ii] = 0.;
 			for(jj =0; jj<NCOORDS; jj++) {
 				((WNDO *)sptr)->node[ii][jj] = 0.;
 			}
@@ -119,15 +118,16 @@ int struct_init(
 			for(ll =0; ll<NTHS; ll++) {
 				((WNDO *)sptr)->wlumsky[kk][ll] = 0.;
 				((WNDO *)sptr)->wlumsun[kk][ll] = 0.;
-				for(ii =0; ii<MAX_WNDO_NODES; ii++) {
-					((WNDO *)sptr)->direct_skyclum[ii][kk][ll] = 0.;
-					((WNDO *)sptr)->direct_sunclum[ii][kk][ll] = 0.;
-					((WNDO *)sptr)->skyclum[ii][kk][ll] = 0.;
-					((WNDO *)sptr)->sunclum[ii][kk][ll] = 0.;
-				}
 			}
 		}
 		((WNDO *)sptr)->wlumskyo = 0;
+		/* ----- node calculation variables (set by alloc_bldg_arena()) ----- */
+		((WNDO *)sptr)->direct_skyclum = NULL;
+		((WNDO *)sptr)->direct_sunclum = NULL;
+		((WNDO *)sptr)->direct_skyolum = NULL;
+		((WNDO *)sptr)->skyclum = NULL;
+		((WNDO *)sptr)->sunclum = NULL;
+		((WNDO *)sptr)->skyolum = NULL;
 	}
 	else if (strcmp(type,"LTSCH") == 0) {
 		strcpy(((LTSCH *)sptr)->name,"");
@@ -185,11 +185,7 @@ int struct_init(
 				((REFPT *)sptr)->glare[ii][jj] = 0.;
 			}
 		}
-		for(ii =0; ii<MAX_ZONE_SURFS; ii++) {
-			for(jj =0; jj<MAX_SURF_WNDOS; jj++) {
-				((REFPT *)sptr)->wlum[ii][jj] = NULL;
-			}
-		}
+		((REFPT *)sptr)->wlum = NULL;
 		for(ii =0; ii<NSKYTYPE; ii++) {
 			((REFPT *)sptr)->dcm_glare[ii] = 0.;
 		}
@@ -257,22 +253,20 @@ int struct_init(
 		((SURF *)sptr)->n_width = 0;
 		((SURF *)sptr)->n_height = 0;
 		((SURF *)sptr)->nnodes = 0;
+		((SURF *)sptr)->ff = NULL;
 		for(ii =0; ii<MAX_SURF_NODES; ii++) {
 			((SURF *)sptr)->node_areas[ii] = 0.;
-			((SURF *)sptr)->direct_skyolum[ii] = 0.;
-			((SURF *)sptr)->skyolum[ii] = 0.;
 			for(jj =0; jj<NCOORDS; jj++) {
 				((SURF *)sptr)->node[ii][jj] = 0.;
 			}
-			for(kk =0; kk<NPHS; kk++) {
-				for(ll =0; ll<NTHS; ll++) {
-					((SURF *)sptr)->direct_skyclum[ii][kk][ll] = 0.;
-					((SURF *)sptr)->direct_sunclum[ii][kk][ll] = 0.;
-					((SURF *)sptr)->skyclum[ii][kk][ll] = 0.;
-					((SURF *)sptr)->sunclum[ii][kk][ll] = 0.;
-				}
-			}
 		}
+		/* ----- node calculation variables (set by alloc_bldg_arena()) ----- */
+		((SURF *)sptr)->direct_skyclum = NULL;
+		((SURF *)sptr)->direct_sunclum = NULL;
+		((SURF *)sptr)->direct_skyolum = NULL;
+		((SURF *)sptr)->skyclum = NULL;
+		((SURF *)sptr)->sunclum = NULL;
+		((SURF *)sptr)->skyolum = NULL;
 	}
 	else if (strcmp(type,"ZONE") == 0) {
 		strcpy(((ZONE *)sptr)->name,"");
@@ -306,6 +300,12 @@ int struct_init(
 		for(ii =0; ii<MAX_REF_PTS; ii++) {
 			((ZONE *)sptr)->ref_pt[ii]  = NULL;
 		}
+		((ZONE *)sptr)->refpt_ff = NULL;
+		((ZONE *)sptr)->rad_iter = 0;
+		((ZONE *)sptr)->rad_resid = -1.;
+		((ZONE *)sptr)->wndo_elems_uniform = 0;
+		((ZONE *)sptr)->wndo_elems_adaptive = 0;
+		((ZONE *)sptr)->wndo_adapt_dev = -1.;
 		strcpy(((ZONE *)sptr)->e10zonename,"");
 		((ZONE *)sptr)->eleclt_details = 0;
 		((ZONE *)sptr)->frac_power = 0.;
@@ -336,6 +336,11 @@ int struct_init(
 		for(ii =0; ii<MAX_BLDG_SHADES; ii++) {
 			((BLDG *)sptr)->bshade[ii]  = NULL;
 		}
+		((BLDG *)sptr)->bvh = NULL;
+		((BLDG *)sptr)->lmcache = NULL;
+		((BLDG *)sptr)->session = NULL;
+		((BLDG *)sptr)->arena = NULL;
+		((BLDG *)sptr)->arena_size = 0;
 		/* ----- derived quantities ----- */
 		for(kk =0; kk<NPHS; kk++) {
 			((BLDG *)sptr)->hillumskyc[kk] = 0.;
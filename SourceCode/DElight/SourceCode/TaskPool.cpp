@@ -0,0 +1,254 @@
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+// Standard includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <exception>
+
+using namespace std;
+
+// writewndo() Error handler include
+#include "DElightManagerC.h"
+
+// includes
+#include "DEF.H"
+#include "TaskPool.h"
+
+/* Per-task state: message buffer standing in for the dump file, status and captured exception. */
+typedef struct {
+	stringbuf sbuf;			/* buffered dump file messages */
+	ofstream ofmsg;			/* dump file stand-in writing to sbuf */
+	int iErrorOccurred;		/* last writewndo() flag raised by the task (0=none) */
+	int iret;				/* task return value */
+	int iran;				/* was the task run? (0=No 1=Yes) */
+	exception_ptr pexc;		/* exception thrown by the task, if any */
+} POOLTASK;
+
+/* Per-thread task queue; owner pops from the front, thieves steal from the back. */
+typedef struct {
+	mutex mtx;			/* queue lock */
+	deque<int> tasks;	/* queued task indexes */
+} POOLQUEUE;
+
+/****************************** subroutine dl_num_threads *****************************/
+/* Returns the number of threads requested for DElight preprocessing through the */
+/* DELIGHT_NUM_THREADS environment variable. */
+/* Unset or 1 selects the serial path; 0 selects one thread per hardware core. */
+/****************************************************************************/
+/****************************** subroutine dl_num_threads *****************************/
+int dl_num_threads(void)
+{
+	const char *cNumThreads = getenv("DELIGHT_NUM_THREADS");
+	int nthreads;
+
+	if (cNumThreads == NULL) return(1);
+	nthreads = atoi(cNumThreads);
+	if (nthreads == 0) nthreads = (int)thread::hardware_concurrency();
+	if (nthreads < 1) nthreads = 1;
+	if (nthreads > MAX_POOL_THREADS) nthreads = MAX_POOL_THREADS;
+
+	return(nthreads);
+}
+
+/****************************** subroutine pool_next_task *****************************/
+/* Gets the next task for thread ithread: front of its own queue, */
+/* else the back of the first non-empty queue of another thread. */
+/* Returns the task index, or -1 when all queues are empty. */
+/****************************************************************************/
+/****************************** subroutine pool_next_task *****************************/
+static int pool_next_task(
+	POOLQUEUE *queues,	/* per-thread task queues */
+	int nthreads,		/* number of threads */
+	int ithread)		/* current thread index */
+{
+	int itask = -1;
+	int ivictim, ii;
+
+	{
+		lock_guard<mutex> lock(queues[ithread].mtx);
+		if (!queues[ithread].tasks.empty()) {
+			itask = queues[ithread].tasks.front();
+			queues[ithread].tasks.pop_front();
+			return(itask);
+		}
+	}
+	for (ii=1; ii<nthreads; ii++) {
+		ivictim = (ithread + ii) % nthreads;
+		lock_guard<mutex> lock(queues[ivictim].mtx);
+		if (!queues[ivictim].tasks.empty()) {
+			itask = queues[ivictim].tasks.back();
+			queues[ivictim].tasks.pop_back();
+			return(itask);
+		}
+	}
+
+	return(-1);
+}
+
+/****************************** subroutine pool_worker *****************************/
+/* Worker thread loop. Runs tasks until all queues are empty. */
+/* Tasks after the lowest failed task are skipped, as the serial loop would */
+/* never have reached them. */
+/****************************************************************************/
+/****************************** subroutine pool_worker *****************************/
+static void pool_worker(
+	POOLQUEUE *queues,	/* per-thread task queues */
+	int nthreads,		/* number of threads */
+	int ithread,		/* current thread index */
+	POOLTASK *ptasks,	/* per-task state */
+	DLTASKFN taskfn,	/* task routine */
+	void *pdata,		/* shared task data */
+	atomic<int> *pifirstfail)	/* lowest failed task index */
+{
+	int itask, ifail;
+
+	while ((itask = pool_next_task(queues,nthreads,ithread)) >= 0) {
+		if (itask > pifirstfail->load()) continue;
+		POOLTASK *ptask = &(ptasks[itask]);
+		/* route writewndo() messages from WLC code to this task */
+		writewndo_redirect(&(ptask->ofmsg),&(ptask->iErrorOccurred));
+		try {
+			ptask->iret = taskfn(itask,pdata,&(ptask->ofmsg));
+		}
+		catch (...) {
+			ptask->pexc = current_exception();
+			ptask->iret = -1;
+		}
+		writewndo_redirect(NULL,NULL);
+		ptask->iran = 1;
+		if ((ptask->iret < 0) && (ptask->iret != -10)) {
+			ifail = pifirstfail->load();
+			while ((itask < ifail) && !pifirstfail->compare_exchange_weak(ifail,itask));
+		}
+	}
+}
+
+/****************************** subroutine run_task_pool *****************************/
+/* Runs tasks 0..ntasks-1 over a work-stealing pool of nthreads threads. */
+/* Tasks must write only their own state; each gets a private dump file stand-in. */
+/* Task messages are then copied to pofdmpfile in task index order, and task return */
+/* values are combined as a serial loop over the tasks would: stop at the first */
+/* error (-1), otherwise report warnings (-10). */
+/* An exception thrown by the first failed task is rethrown on the calling thread. */
+/* Optional task costs (pcost) seed the queues largest-first for load balance; */
+/* they never affect results or message order. */
+/****************************************************************************/
+/****************************** subroutine run_task_pool *****************************/
+int run_task_pool(
+	int ntasks,			/* number of tasks */
+	int nthreads,		/* number of threads */
+	double *pcost,		/* estimated cost of each task (NULL for equal costs) */
+	DLTASKFN taskfn,	/* task routine */
+	void *pdata,		/* shared task data */
+	ofstream* pofdmpfile)	/* ptr to LBLDLL error dump file */
+{
+	POOLTASK *ptasks;			/* per-task state */
+	POOLQUEUE *queues;			/* per-thread task queues */
+	vector<thread> workers;		/* worker threads (thread 0 is the caller) */
+	vector<int> order;			/* tasks by decreasing cost */
+	atomic<int> ifirstfail(ntasks);	/* lowest failed task index */
+	int itask, ithread, ii, jj, itmp;
+	int iReturnVal = 0;
+
+	if (ntasks < 1) return(0);
+	if (nthreads > ntasks) nthreads = ntasks;
+	if (nthreads < 1) nthreads = 1;
+
+	ptasks = new POOLTASK[ntasks];
+	queues = new POOLQUEUE[nthreads];
+	for (itask=0; itask<ntasks; itask++) {
+		ptasks[itask].ofmsg.basic_ios<char>::rdbuf(&(ptasks[itask].sbuf));
+		ptasks[itask].iErrorOccurred = 0;
+		ptasks[itask].iret = 0;
+		ptasks[itask].iran = 0;
+		order.push_back(itask);
+	}
+
+	/* deal tasks round-robin in decreasing cost order (stable, so ties keep index order) */
+	if (pcost != NULL) {
+		for (ii=1; ii<ntasks; ii++) {
+			itmp = order[ii];
+			for (jj=ii; (jj>0) && (pcost[order[jj-1]] < pcost[itmp]); jj--) order[jj] = order[jj-1];
+			order[jj] = itmp;
+		}
+	}
+	for (ii=0; ii<ntasks; ii++) queues[ii % nthreads].tasks.push_back(order[ii]);
+
+	for (ithread=1; ithread<nthreads; ithread++)
+		workers.push_back(thread(pool_worker,queues,nthreads,ithread,ptasks,taskfn,pdata,&ifirstfail));
+	pool_worker(queues,nthreads,0,ptasks,taskfn,pdata,&ifirstfail);
+	for (ithread=0; ithread<(int)workers.size(); ithread++) workers[ithread].join();
+
+	/* merge in task order, stopping where the serial loop would have stopped */
+	exception_ptr pexc;
+	for (itask=0; itask<ntasks; itask++) {
+		if (!ptasks[itask].iran) break;
+		*pofdmpfile << ptasks[itask].sbuf.str();
+		if (ptasks[itask].iErrorOccurred != 0) writewndo_set_error_flag(ptasks[itask].iErrorOccurred);
+		if (ptasks[itask].iret < 0) {
+			if (ptasks[itask].iret != -10) {
+				pexc = ptasks[itask].pexc;
+				iReturnVal = -1;
+				break;
+			}
+			iReturnVal = -10;
+		}
+	}
+
+	delete [] queues;
+	delete [] ptasks;
+
+	if (pexc) rethrow_exception(pexc);
+
+	return(iReturnVal);
+}
@@ -72,6 +72,12 @@ WLCSurface::WLCSurface(string Name, vector<BGL::point3> p3List, Double maxNodeAr
 }
 
 void	WLCSurface::WLCSurfInit(string Name, vector<BGL::point3> p3List, Double maxNodeArea)
+{
+	WLCSurfGeomInit(Name, p3List);
+	mesh = NodeMesh2(vert2,maxNodeArea);
+}
+
+void	WLCSurface::WLCSurfGeomInit(string Name, vector<BGL::point3> p3List)
 {
 	name = Name;
 	origin = p3List[0];
@@ -84,7 +90,6 @@ void	WLCSurface::WLCSurfInit(string Name, vector<BGL::point3> p3List, Double max
 		p2List[ii] = BGL::point2(BGL::dot(v3,ics[0]),BGL::dot(v3,ics[1]));
 	}
 	vert2 = BGL::poly2(p2List);
-	mesh = NodeMesh2(vert2,maxNodeArea);
 }
 
 
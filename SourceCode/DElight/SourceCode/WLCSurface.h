@@ -40,6 +40,8 @@ public:
 	WLCSurface(string InName, vector<BGL::point3> p3List, Double maxNodeArea);
 	// standalone helper for previous form
 	void WLCSurfInit(string InName, vector<BGL::point3> p3List, Double maxNodeArea);
+	// geometry part of WLCSurfInit(), leaves the mesh unchanged
+	void WLCSurfGeomInit(string InName, vector<BGL::point3> p3List);
 
 	~WLCSurface();
 
@@ -54,6 +56,8 @@ public:
 	Int			MeshGrid2(Double nodeArea_max);
 	Int			MeshCutout(const BGL::poly2&);
 	Int			MeshSize();
+	const NodeMesh2&	Mesh() const {return mesh;}
+	void		SetMesh(const NodeMesh2& m) {mesh = m;}
 	Double		TotMeshArea() {return mesh.TotArea();}
 	BGL::point2	NodePosition2D(Int NodeIterator);
 	BGL::point3	NodePosition3D(Int NodeIterator);
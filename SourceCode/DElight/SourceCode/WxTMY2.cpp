@@ -49,6 +49,8 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <fstream>
 #include <cstring>
 #include <limits>
+#include <cctype>
+#include <cmath>
 
 using namespace std;
 
@@ -74,6 +76,19 @@ namespace BGL = BldgGeomLib;
 #include "DOE2DL.H"
 #include "WxTMY2.h"
 
+/* TMY2 hourly data line layout, as read by read_wx_tmy2_hr() */
+#define TMY2_HR_FORMAT "%2d%2d%2d%2d%4d%4d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%2d%1s%1d%2d%1s%1d%4d%1s%1d%4d%1s%1d%3d%1s%1d%4d%1s%1d%3d%1s%1d%3d%1s%1d%4d%1s%1d%5ld%1s%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%3d%1s%1d%3d%1s%1d%3d%1s%1d%2d%1s%1d"
+
+/* Conversion indexes of the fields used by DElight within TMY2_HR_FORMAT */
+#define TMY2_MONTH 1			/* month (begins at 1) */
+#define TMY2_DAY 2				/* day (begins at 1) */
+#define TMY2_HOUR 3				/* hour (begins at 1) */
+#define TMY2_GLOBAL_HORIZ_RAD 6	/* totl horiz solar rad (Wh/m2) */
+#define TMY2_DIRECT_NORM_RAD 9	/* direct normal solar rad (Wh/m2) */
+#define TMY2_TOTAL_SKY_COVER 27	/* hourly cloud amount (in tenths) */
+#define TMY2_DEW_PT_TEMP 36		/* hourly dewpoint temperature (tenths of degreeC) */
+#define TMY2_NFIELDS 79			/* # of conversions in TMY2_HR_FORMAT */
+
 /************************ subroutine read_wx_tmy2_hdr ***********************/
 /* Reads header lines from raw ASCII TMY2 weather file. */
 /* Stores required data in bldg data structure. */
@@ -209,7 +224,7 @@ int read_wx_tmy2_hr(
 	/* read wx hourly data line until matching month/day/hour are found */
     do
     {
-        fscanf ( wxfile, "%2d%2d%2d%2d%4d%4d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%4d%1s%1d%2d%1s%1d%2d%1s%1d%4d%1s%1d%4d%1s%1d%3d%1s%1d%4d%1s%1d%3d%1s%1d%3d%1s%1d%4d%1s%1d%5ld%1s%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%1d%3d%1s%1d%3d%1s%1d%3d%1s%1d%2d%1s%1d",
+        fscanf ( wxfile, TMY2_HR_FORMAT,
                  &yr,
                  &month,
                  &day,
@@ -333,3 +348,144 @@ int read_wx_tmy2_hr(
 
 	return(0);
 }
+
+/************************ subroutine tmy2_scan_record ************************/
+/* Scans one TMY2 hourly data line from an in-memory copy of the weather file, */
+/* converting fields exactly as fscanf() does with TMY2_HR_FORMAT: leading white */
+/* space is skipped, %Nd reads an optional sign and digits within N characters, */
+/* and %1s reads one non-space character (stored as its character code). */
+/* Advances *ppc past the line. */
+/* Returns the # of fields converted (TMY2_NFIELDS for a complete line). */
+/****************************************************************************/
+/************************ subroutine tmy2_scan_record ************************/
+static int tmy2_scan_record(
+	const char **ppc,			/* scan position (updated) */
+	const char *pend,			/* end of weather data */
+	int ival[TMY2_MAX_FIELDS])	/* returned field values */
+{
+	const char *pfmt = TMY2_HR_FORMAT;
+	const char *pc = *ppc;
+	int nfields = 0;
+	int iwidth, isign, idigits, ivalue;
+	char ctype;
+
+	while ((*pfmt == '%') && (nfields < TMY2_MAX_FIELDS)) {
+		/* conversion width and type */
+		pfmt++;
+		iwidth = 0;
+		while ((*pfmt >= '0') && (*pfmt <= '9')) iwidth = iwidth * 10 + (*pfmt++ - '0');
+		if (*pfmt == 'l') pfmt++;
+		ctype = *pfmt++;
+
+		/* skip white space, including the end of the previous line */
+		while ((pc < pend) && isspace((unsigned char)*pc)) pc++;
+		if (pc >= pend) break;
+
+		if (ctype == 's') {
+			ival[nfields] = (unsigned char)*pc;
+			for (idigits=0; (idigits<iwidth) && (pc<pend) && !isspace((unsigned char)*pc); idigits++) pc++;
+		}
+		else {
+			isign = 1;
+			if ((*pc == '-') || (*pc == '+')) {
+				if (*pc == '-') isign = -1;
+				pc++;
+				iwidth--;
+			}
+			ivalue = 0;
+			for (idigits=0; (idigits<iwidth) && (pc<pend) && (*pc>='0') && (*pc<='9'); idigits++) ivalue = ivalue * 10 + (*pc++ - '0');
+			if (idigits == 0) break;
+			ival[nfields] = isign * ivalue;
+		}
+		nfields++;
+	}
+
+	*ppc = pc;
+	return(nfields);
+}
+
+/************************ subroutine read_wx_tmy2_table ***********************/
+/* Reads all remaining hourly data lines from raw ASCII TMY2 weather file */
+/* (positioned after the header by read_wx_tmy2_hdr()) in one bulk read, and */
+/* stores the fields required by the daylighting calcs in columnar form, */
+/* converted as in read_wx_tmy2_hr(). */
+/* Where a month/day/hour appears more than once the first record is used. */
+/* Returns 0 on success, -1 if no complete hourly record was found. */
+/****************************************************************************/
+/************************ subroutine read_wx_tmy2_table ***********************/
+int read_wx_tmy2_table(
+	WX_TABLE *wxtab_ptr,	/* pointer to columnar weather table */
+	FILE *wxfile)			/* TMY2 weather file pointer */
+{
+	vector<char> vBuf;		/* remaining weather file contents */
+	char cbuf[65536];		/* read buffer */
+	size_t nread;
+	const char *pc, *pend;
+	int ival[TMY2_MAX_FIELDS];
+	int month, day, hour, ikey;
+
+	while ((nread = fread(cbuf,1,sizeof(cbuf),wxfile)) > 0) vBuf.insert(vBuf.end(),cbuf,cbuf+nread);
+
+	wxtab_ptr->nrecs = 0;
+	wxtab_ptr->irec.assign(MONTHS*WX_MAX_DAYS*HOURS,-1);
+	wxtab_ptr->cldamt.clear();
+	wxtab_ptr->dirsol.clear();
+	wxtab_ptr->solrad.clear();
+	wxtab_ptr->dewpt.clear();
+	/* a TMY2 file holds one record per hour of the year */
+	wxtab_ptr->cldamt.reserve(8760);
+	wxtab_ptr->dirsol.reserve(8760);
+	wxtab_ptr->solrad.reserve(8760);
+	wxtab_ptr->dewpt.reserve(8760);
+
+	if (vBuf.empty()) return(-1);
+	pc = &vBuf[0];
+	pend = pc + vBuf.size();
+	while (tmy2_scan_record(&pc,pend,ival) == TMY2_NFIELDS) {
+		month = ival[TMY2_MONTH];
+		day = ival[TMY2_DAY];
+		hour = ival[TMY2_HOUR];
+		if ((month < 1) || (month > MONTHS) || (day < 1) || (day >= WX_MAX_DAYS) || (hour < 1) || (hour > HOURS)) continue;
+		ikey = ((month - 1) * WX_MAX_DAYS + day) * HOURS + (hour - 1);
+		if (wxtab_ptr->irec[ikey] >= 0) continue;
+		wxtab_ptr->irec[ikey] = wxtab_ptr->nrecs;
+		/* same conversions as read_wx_tmy2_hr() */
+		wxtab_ptr->solrad.push_back(ceil(ival[TMY2_GLOBAL_HORIZ_RAD] * 0.3170));
+		wxtab_ptr->dirsol.push_back(ceil(ival[TMY2_DIRECT_NORM_RAD] * 0.3170));
+		wxtab_ptr->cldamt.push_back(ival[TMY2_TOTAL_SKY_COVER]);
+		wxtab_ptr->dewpt.push_back((ival[TMY2_DEW_PT_TEMP] / 10.0) * 1.8 + 32.0);
+		wxtab_ptr->nrecs++;
+	}
+
+	if (wxtab_ptr->nrecs == 0) return(-1);
+
+	return(0);
+}
+
+/************************ subroutine wx_tmy2_table_hr ************************/
+/* Looks up the weather record for the given month/day/hour in the columnar */
+/* weather table and stores it in the sun2 data structure, as read_wx_tmy2_hr() */
+/* does for the weather file. */
+/* Returns 0 on success, -1 if the weather table has no such record. */
+/****************************************************************************/
+/************************ subroutine wx_tmy2_table_hr ************************/
+int wx_tmy2_table_hr(
+	int imon,	/* current month (begins at 0) */
+	int iday,	/* current day (begins at 1) */
+	int ihr,	/* current hour (begins at 0) */
+	SUN2_DATA *sun2_ptr,	/* pointer to sun2 data structure */
+	WX_TABLE *wxtab_ptr)	/* pointer to columnar weather table */
+{
+	int irec;
+
+	if ((imon < 0) || (imon >= MONTHS) || (iday < 1) || (iday >= WX_MAX_DAYS) || (ihr < 0) || (ihr >= HOURS)) return(-1);
+	irec = wxtab_ptr->irec[(imon * WX_MAX_DAYS + iday) * HOURS + ihr];
+	if (irec < 0) return(-1);
+
+	sun2_ptr->solrad = wxtab_ptr->solrad[irec];
+	sun2_ptr->dirsol = wxtab_ptr->dirsol[irec];
+	sun2_ptr->cldamt = wxtab_ptr->cldamt[irec];
+	sun2_ptr->dewpt = wxtab_ptr->dewpt[irec];
+
+	return(0);
+}
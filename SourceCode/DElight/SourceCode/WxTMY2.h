@@ -52,3 +52,14 @@ int read_wx_tmy2_hr(
 	int ihr,	/* current hour (begins at 0) */
 	SUN2_DATA *sun2_ptr,	/* pointer to sun2 data structure */
 	FILE *wxfile);	/* weather file pointer */
+
+int read_wx_tmy2_table(
+	WX_TABLE *wxtab_ptr,	/* pointer to columnar weather table */
+	FILE *wxfile);			/* TMY2 weather file pointer */
+
+int wx_tmy2_table_hr(
+	int imon,	/* current month (begins at 0) */
+	int iday,	/* current day (begins at 1) */
+	int ihr,	/* current hour (begins at 0) */
+	SUN2_DATA *sun2_ptr,	/* pointer to sun2 data structure */
+	WX_TABLE *wxtab_ptr);	/* pointer to columnar weather table */
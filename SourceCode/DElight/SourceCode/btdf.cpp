@@ -53,6 +53,18 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <limits>
 using namespace std;
 
+//	AVX2 GEMV kernel: compiled for AVX2 via a target attribute and selected at run time (GCC/clang),
+//	or compiled in when the whole build targets AVX2 (MSVC /arch:AVX2)
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define	BTDF_GEMV_AVX2
+#define	BTDF_TARGET_AVX2	__attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && defined(__AVX2__)
+#define	BTDF_GEMV_AVX2
+#define	BTDF_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
 // BGLincludes
 #include "BGL.h"
 namespace BGL = BldgGeomLib;
@@ -78,6 +90,123 @@ BGL::vector3	btdf::outDir(int ii)
 	return HSoutList[0].dir(ii);
 }
 
+void	btdf::packMatrix()
+{
+	Qmat.pack(HSoutList, HSoutList.empty() ? 0 : (int)HSoutList[0].valList.size());
+}
+
+//	BTDFMatrix
+void	BTDFMatrix::pack(vector<HemiSphiral>& rows, int ncols0)
+//	copies rows (zero padded or truncated to ncols0 columns) into column panels
+{
+	int		irow, jcol, ip, nc;
+
+	nrows = (int)rows.size();
+	ncols = (ncols0 > 0) ? ncols0 : 0;
+	npanels = (ncols + BTDF_PANEL_COLS - 1)/BTDF_PANEL_COLS;
+	data.assign((size_t)npanels*nrows*BTDF_PANEL_COLS,0);
+	for (irow=0; irow<nrows; irow++) {
+		nc = min(ncols,(int)rows[irow].valList.size());
+		for (jcol=0; jcol<nc; jcol++) {
+			ip = jcol/BTDF_PANEL_COLS;
+			data[((size_t)ip*nrows + irow)*BTDF_PANEL_COLS + jcol%BTDF_PANEL_COLS] = (BTDFReal)rows[irow].valList[jcol];
+		}
+	}
+}
+
+void	BTDFGemvScalar(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y)
+{
+	Double	acc[BTDF_PANEL_COLS];
+	int		ip, jj, kk, nc;
+
+	if (ncols > Q.ncols) ncols = Q.ncols;
+	if ((nterm <= 0) || (Q.nrows <= 0)) return;
+	for (ip=0; ip*BTDF_PANEL_COLS < ncols; ip++) {
+		const BTDFReal*	pp = Q.panel(ip);
+		Double*	py = y + ip*BTDF_PANEL_COLS;
+		nc = min(BTDF_PANEL_COLS,ncols - ip*BTDF_PANEL_COLS);
+		for (jj=0; jj<BTDF_PANEL_COLS; jj++) acc[jj] = (jj < nc) ? py[jj] : 0;
+		for (kk=0; kk<nterm; kk++) {
+			const BTDFReal*	q = pp + irow[kk]*BTDF_PANEL_COLS;
+			Double	sk = s[kk];
+			for (jj=0; jj<BTDF_PANEL_COLS; jj++) acc[jj] += q[jj]*sk;
+		}
+		for (jj=0; jj<nc; jj++) py[jj] = acc[jj];
+	}
+}
+
+#ifdef BTDF_GEMV_AVX2
+//	four 4-wide double accumulators cover one 16 column panel; mul then add (no FMA),
+//	so the sums round exactly as in BTDFGemvScalar()
+BTDF_TARGET_AVX2 static void	BTDFGemvAVX2Kernel(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y)
+{
+	Double	ybuf[BTDF_PANEL_COLS];
+	int		ip, jj, kk, nc;
+
+	for (ip=0; ip*BTDF_PANEL_COLS < ncols; ip++) {
+		const BTDFReal*	pp = Q.panel(ip);
+		Double*	py = y + ip*BTDF_PANEL_COLS;
+		nc = min(BTDF_PANEL_COLS,ncols - ip*BTDF_PANEL_COLS);
+		for (jj=0; jj<BTDF_PANEL_COLS; jj++) ybuf[jj] = (jj < nc) ? py[jj] : 0;
+		__m256d	acc0 = _mm256_loadu_pd(ybuf);
+		__m256d	acc1 = _mm256_loadu_pd(ybuf+4);
+		__m256d	acc2 = _mm256_loadu_pd(ybuf+8);
+		__m256d	acc3 = _mm256_loadu_pd(ybuf+12);
+		for (kk=0; kk<nterm; kk++) {
+			const BTDFReal*	q = pp + irow[kk]*BTDF_PANEL_COLS;
+			__m256d	sk = _mm256_set1_pd(s[kk]);
+#ifdef BTDF_MATRIX_FLOAT
+			__m256	q01 = _mm256_loadu_ps(q);
+			__m256	q23 = _mm256_loadu_ps(q+8);
+			acc0 = _mm256_add_pd(acc0,_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(q01)),sk));
+			acc1 = _mm256_add_pd(acc1,_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(q01,1)),sk));
+			acc2 = _mm256_add_pd(acc2,_mm256_mul_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(q23)),sk));
+			acc3 = _mm256_add_pd(acc3,_mm256_mul_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(q23,1)),sk));
+#else
+			acc0 = _mm256_add_pd(acc0,_mm256_mul_pd(_mm256_loadu_pd(q),sk));
+			acc1 = _mm256_add_pd(acc1,_mm256_mul_pd(_mm256_loadu_pd(q+4),sk));
+			acc2 = _mm256_add_pd(acc2,_mm256_mul_pd(_mm256_loadu_pd(q+8),sk));
+			acc3 = _mm256_add_pd(acc3,_mm256_mul_pd(_mm256_loadu_pd(q+12),sk));
+#endif
+		}
+		_mm256_storeu_pd(ybuf,acc0);
+		_mm256_storeu_pd(ybuf+4,acc1);
+		_mm256_storeu_pd(ybuf+8,acc2);
+		_mm256_storeu_pd(ybuf+12,acc3);
+		for (jj=0; jj<nc; jj++) py[jj] = ybuf[jj];
+	}
+}
+#endif
+
+bool	BTDFGemvAVX2(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y)
+//	returns false (y untouched) when this build or CPU has no AVX2 kernel
+{
+#ifdef BTDF_GEMV_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+	if (!__builtin_cpu_supports("avx2")) return false;
+#endif
+	if (ncols > Q.ncols) ncols = Q.ncols;
+	if ((nterm <= 0) || (Q.nrows <= 0)) return true;
+	BTDFGemvAVX2Kernel(Q,nterm,irow,s,ncols,y);
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool	BTDFGemvUseAVX2()
+//	DELIGHT_BTDF_SIMD=0 forces the scalar kernel
+{
+	static const bool	bUse = !(getenv("DELIGHT_BTDF_SIMD") && (atoi(getenv("DELIGHT_BTDF_SIMD")) == 0));
+	return bUse;
+}
+
+void	BTDFGemv(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y)
+{
+	if (BTDFGemvUseAVX2() && BTDFGemvAVX2(Q,nterm,irow,s,ncols,y)) return;
+	BTDFGemvScalar(Q,nterm,irow,s,ncols,y);
+}
+
 
 void btdf::summary()
 {
@@ -140,6 +269,7 @@ btdf* btdfLoad(ifstream& infile)
 		//	init HSin
 		pbtdf0->HSin = HemiSphiral(pbtdf0->size());
 		pbtdf0->HSin.init();
+		pbtdf0->packMatrix();
 		return pbtdf0;
 	}
 	else if (type == "TRGZ")	{
@@ -164,6 +294,7 @@ btdf* btdfLoad(ifstream& infile)
 //		cout << " DataIndx.size(): " << pbtdf0->DataIndx.size() << "\n"; 
 		//	load HSoutList in base class
 		pbtdf0->load(infile);
+		pbtdf0->packMatrix();
 		return pbtdf0;
 	}
 	else {
@@ -208,13 +339,13 @@ Double	btdfHS::qinterp(BGL::vector3 indir, BGL::vector3 outdir)
 //	cout << "BTDF.interp:\n";
 //	cout << "input angles\n";
 //	vector<int>		nnin = HSin.nearestc(2.0*HSin.DA,indir);
-	vector<struct nearestdata> nd;
-	int	nnsize = HSin.nearestc(2.0*HSin.DA,indir, nd);
-	vector<Double>	inwgt = interpwgts(indir,nd);
+	int		inindx[HS_MAX_INTERP];
+	Double	inwgt[HS_MAX_INTERP];
+	int	nwgts = HSin.interpwgts(indir,2.0*HSin.DA,inindx,inwgt);
 	//	final interpolation
 	Double	interpVal = 0;
-	for (int ii=0; ii<(int)inwgt.size(); ii++) {
-		interpVal += inwgt[ii]*HSoutList[nd[ii].indx].interp(outdir);
+	for (int ii=0; ii<nwgts; ii++) {
+		interpVal += inwgt[ii]*HSoutList[inindx[ii]].interp(outdir);
 	}
 	return interpVal;
 
@@ -260,7 +391,7 @@ btdfTrgz::btdfTrgz()
 }
 
 btdfTrgz::btdfTrgz(int inM, int outN)
-: Isym(0), btdf(Trgz0.NTrgz(),outN)
+: Isym(0), btdf(TrgzBasisGet().ii0List.back(),outN)	//	Trgz0 is not constructed yet
 {
 	DataIndx = vector<int>(Trgz0.NTrgz(),-1);
 }
@@ -345,9 +476,11 @@ ofstream& btdfTrgz::save(ofstream& outfile)
 
 
 //	Tregenza
-Tregenza::Tregenza()
+TrgzBasis::TrgzBasis()
 : NTheta(8), deltaTheta(90./(NTheta-0.5))
 {
+	int		itheta, jphi, ii;
+
 	//	table lookups
 	MPhi.resize(NTheta);
 	MPhi[0] = 1;
@@ -366,6 +499,37 @@ Tregenza::Tregenza()
 	omega[5] = 0.0474;
 	omega[6] = 0.0416;
 	omega[7] = 0.0435;
+
+	//	per-direction tables
+	ii0List.resize(NTheta+1);
+	ii0List[0] = 0;
+	for (itheta=0; itheta<NTheta; itheta++) ii0List[itheta+1] = ii0List[itheta] + MPhi[itheta];
+	iThetaList.resize(ii0List[NTheta]);
+	dirList.resize(ii0List[NTheta]);
+	omegaList.resize(ii0List[NTheta]);
+	for (itheta=0; itheta<NTheta; itheta++) {
+		for (jphi=0; jphi<MPhi[itheta]; jphi++) {
+			ii = ii0List[itheta] + jphi;
+			iThetaList[ii] = itheta;
+			dirList[ii] = AnglesToDir3D(DegToRad(jphi*360./MPhi[itheta]), DegToRad(deltaTheta*itheta));
+			omegaList[ii] = omega[itheta];
+		}
+	}
+}
+
+const TrgzBasis&	TrgzBasisGet()
+{
+	static const TrgzBasis	trgzbasis;
+	return trgzbasis;
+}
+
+Tregenza::Tregenza()
+: pbasis(&TrgzBasisGet())
+{
+	NTheta = pbasis->NTheta;
+	deltaTheta = pbasis->deltaTheta;
+	MPhi = pbasis->MPhi;
+	omega = pbasis->omega;
 }
 
 Tregenza::~Tregenza()
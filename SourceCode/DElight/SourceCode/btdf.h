@@ -27,15 +27,49 @@
 // WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 // =================================================================================
 
+//	BTDF matrix element type: build with BTDF_MATRIX_FLOAT to halve the matrix memory traffic
+#ifdef BTDF_MATRIX_FLOAT
+typedef float	BTDFReal;
+#else
+typedef double	BTDFReal;
+#endif
+
+#define	BTDF_PANEL_COLS	16	//	columns per cache block (panel) of a BTDFMatrix
+
+//	btdf output rows packed into one contiguous matrix of column panels:
+//	panel ip holds columns [ip*BTDF_PANEL_COLS, (ip+1)*BTDF_PANEL_COLS) of row 0, then of row 1, ...
+//	so a GEMV sweeps each panel sequentially while its outputs stay in registers
+struct BTDFMatrix
+{
+	int		nrows;
+	int		ncols;
+	int		npanels;
+	vector<BTDFReal>	data;
+
+	BTDFMatrix() : nrows(0), ncols(0), npanels(0) {}
+	void	pack(vector<HemiSphiral>& rows, int ncols0);
+	const BTDFReal*	panel(int ip) const {return &data[(size_t)ip*nrows*BTDF_PANEL_COLS];}
+	Double	elem(int irow, int jcol) const {return panel(jcol/BTDF_PANEL_COLS)[irow*BTDF_PANEL_COLS + jcol%BTDF_PANEL_COLS];}
+};
+
+//	y[jj] += sum over kk of Q[irow[kk]][jj]*s[kk], for jj < ncols, accumulated in kk order
+void	BTDFGemv(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y);
+void	BTDFGemvScalar(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y);
+bool	BTDFGemvAVX2(const BTDFMatrix& Q, int nterm, const int* irow, const Double* s, int ncols, Double* y);
+bool	BTDFGemvUseAVX2();
+
 //	base class
 struct btdf
 {
 	string	btdftype;
 //	HemiSphiral	HSin;	NOT USED in base class
 	vector<HemiSphiral> HSoutList;
+	BTDFMatrix	Qmat;	//	packed copy of HSoutList used for integration, set by packMatrix()
 
 	btdf();
 	btdf(int, int);
+	virtual	~btdf() {}
+	void	packMatrix();	//	call again after changing HSoutList
 
 	string	type() {return btdftype;}
 
@@ -86,6 +120,26 @@ struct btdfHS : public btdf
 };
 
 //Tregenza input dirs
+
+//	immutable Tregenza band and per-direction tables, built once and shared
+//	by every Tregenza; get them from TrgzBasisGet()
+struct TrgzBasis
+{
+	//	NOTE: Phi, Theta are in Degrees
+	int			NTheta;
+	double		deltaTheta;
+	vector<int>	MPhi;
+	vector<double>	omega;		//	solid angle of each band
+	vector<int>	ii0List;		//	first direction of each band (NTheta+1 entries)
+	vector<int>	iThetaList;		//	band of each direction
+	vector<BGL::vector3>	dirList;	//	unit vector of each direction
+	vector<double>	omegaList;	//	solid angle of each direction
+
+	TrgzBasis();
+};
+
+const TrgzBasis&	TrgzBasisGet();
+
 struct Tregenza
 {
 	//	NOTE: Phi, Theta are in Degrees
@@ -93,23 +147,24 @@ struct Tregenza
 	double		deltaTheta;
 	vector<int>	MPhi;
 	vector<double>	omega;
+	const TrgzBasis*	pbasis;	//	shared tables
 
 	Tregenza();
 	~Tregenza();
 
 	int		iTheta(double Theta) {return (int)(Theta/deltaTheta);}
 	int		jPhi(double Theta, double Phi) {return (int) (Phi*MPhi[iTheta(Theta)]/360.);}
-	int		ii0(int itheta) {if (itheta==0) return 0; else return MPhi[itheta-1] + ii0(itheta-1);}
-	int		NTrgz() {return MPhi[NTheta-1] + ii0(NTheta-1);}
+	int		ii0(int itheta) {if ((itheta>=0) && (itheta<=NTheta)) return pbasis->ii0List[itheta]; else return MPhi[itheta-1] + ii0(itheta-1);}
+	int		NTrgz() {return pbasis->ii0List[NTheta];}
 	int		iiTrgz(double Theta, double Phi) {return ii0(iTheta(Theta)) + jPhi(Theta,Phi);}
-	int		iTheta(int ii) {int itheta; for (itheta=0; itheta<NTheta; itheta++) if (ii < ii0(itheta)) break; return itheta - 1;}
+	int		iTheta(int ii) {if ((ii>=0) && (ii<NTrgz())) return pbasis->iThetaList[ii]; return (ii<0) ? -1 : NTheta-1;}
 	int		jPhi(int ii) {return ii - ii0(iTheta(ii));}
 	double	Theta(int ii) {return deltaTheta*iTheta(ii);}
 	double	Phi(int ii) {return jPhi(ii)*360./MPhi[iTheta(ii)];}
 	double	PhiSym(double phi, int Isym);
 	int		iiSym(int ii, int Isym) {return iiTrgz(Theta(ii),PhiSym(Phi(ii),Isym));}
-	BGL::vector3	dir(int ii) {return AnglesToDir3D(DegToRad(Phi(ii)), DegToRad(Theta(ii)));}
-	double	Omega(int ii) {return omega[iTheta(ii)];}
+	BGL::vector3	dir(int ii) {if ((ii>=0) && (ii<NTrgz())) return pbasis->dirList[ii]; return AnglesToDir3D(DegToRad(Phi(ii)), DegToRad(Theta(ii)));}
+	double	Omega(int ii) {if ((ii>=0) && (ii<NTrgz())) return pbasis->omegaList[ii]; return omega[iTheta(ii)];}
 	void	summary();
 
 	int				nearestc(Double admax, BGL::vector3 dirext, vector<struct nearestdata>& nd);
@@ -221,148 +221,180 @@ bool	IsValidTypeName(string nametype, string inname)
 	}
 }
 
-Double	GenDirLum(LumParam lp, BGL::vector3 Direction)
+LumGenType	LumGenTypeOf(const string& type)
 {
-	Double (*fptr) (LumParam, BGL::vector3);
-	if (lp.type == "SUPERLAMBERTIAN") fptr = &SuperLambertianLum;
-	else if (lp.type == "GAUSS") fptr = &GaussLum;
-	else if (lp.type == "SIMPLEBEAM") fptr = &SimpleBeamLum;
-	else if (lp.type == "CONST") fptr = &ConstLum;
-	else if (lp.type == "CIEOVERCASTSKY") fptr = &CIEOvercastSkyLum;
-	else if (lp.type == "CIECLEARSKY") fptr = &CIEClearSkyLum;
-	else if (lp.type == "CIECLEARSUN") fptr = &CIEClearSunLum;
+	if (type == "SUPERLAMBERTIAN") return LUMGEN_SUPERLAMBERTIAN;
+	else if (type == "GAUSS") return LUMGEN_GAUSS;
+	else if (type == "SIMPLEBEAM") return LUMGEN_SIMPLEBEAM;
+	else if (type == "CONST") return LUMGEN_CONST;
+	else if (type == "CIEOVERCASTSKY") return LUMGEN_CIEOVERCASTSKY;
+	else if (type == "CIECLEARSKY") return LUMGEN_CIECLEARSKY;
+	else if (type == "CIECLEARSUN") return LUMGEN_CIECLEARSUN;
 	else {
-//		cerr << "GenLum: Bad type: " << syst_type << "\n";
-		return -1;	//	error value
+//		cerr << "GenLum: Bad type: " << type << "\n";
+		return LUMGEN_BAD;	//	error value
 	}
-	return fptr(lp,Direction);
 }
 
-//HemiSphiral GenLuminanceMap(int size, LumParam lp)
-HemiSphiral GenLuminanceMap(LumParam lp)
+//	direct normal solar intensity (lumens/ft2) for CIE Standard Clear Sky,
+//	i.e. CIEClearSunLum() for a Direction that points at the sun
+static Double	CIEClearSunNormalLum(const LumParam& lp)
 {
-	int	zMin = -1;
-	HemiSphiral	hs0(zMin,lp.btdfHSResOut);
+    // Sun altitude (radians) for this clear sky sun position
+    Double dSunAlt = lp.dSunAltRadians;
+    Double dSinSunAlt = sin(dSunAlt);
 
-	Double (*fptr) (LumParam,BGL::vector3);
+	Double lop, powlop;	/* exponentiation test and result holders */
+	Double am;		/* corrected optical air mass */
+	Double c1, c2, c3, s1, s2, s3;
+	Double abars;
+	Double bc;
+	Double efflum;	/* luminous efficacy */
 
-	if (lp.type == "SUPERLAMBERTIAN") fptr = &SuperLambertianLum;
-	else if (lp.type == "GAUSS") fptr = &GaussLum;
-	else if (lp.type == "SIMPLEBEAM") fptr = &SimpleBeamLum;
-	else if (lp.type == "CONST") fptr = &ConstLum;
-	else if (lp.type == "CIEOVERCASTSKY") fptr = &CIEOvercastSkyLum;
-	else if (lp.type == "CIECLEARSKY") fptr = &CIEClearSkyLum;
-	else if (lp.type == "CIECLEARSUN") fptr = &CIEClearSunLum;
-	else {
-//		cerr << "GenLum: Bad type: " << syst_type << "\n";
-		hs0.resize(0);	//	error value
-		return hs0;
+    // Sun altitude (degrees)
+    Double dSunAltDegrees = RadToDeg(dSunAlt);
+
+	/* optical air mass corrected for building altitude in kilometers */
+	lop = dSunAltDegrees + 3.885;
+	if (lop < 0.0) {
+		return(0.0);
+	}
+	else powlop = pow(lop,1.253);
+	am = (1.0 - 0.1 * lp.dBldgAltitude / 3281.0) / (dSinSunAlt + 0.15 / powlop);
+
+	/* intermediate calculations for monster equation */
+	c1 = 2.1099 * cos(dSunAlt);
+	c2 = 0.6322 * cos(2.0 * dSunAlt);
+	c3 = 0.0252 * cos(3.0 * dSunAlt);
+	s1 = 1.0022 * dSinSunAlt;
+	s2 = 1.0077 * sin(2.0 * dSunAlt);
+	s3 = 0.2606 * sin(3.0 * dSunAlt);
+
+	abars = 1.4899 - c1 + c2 + c3 - s1 + s2 - s3;
+
+	/* lp.dBldgMonthlyAtmosTurb below is BETA in 21d code */
+	bc = min(0.2,lp.dBldgMonthlyAtmosTurb);
+
+	/* luminous efficacy */
+	/* lp.dBldgMonthlyAtmosMois * 2.54 below is W in 21d code */
+	efflum = (99.4+4.7*(lp.dBldgMonthlyAtmosMois*2.54)-52.4*bc)*(1.0-exp((24.0*bc-8.0)*dSunAlt));
+
+	// 93.73 below is extraterrestrial lum eff (lm/w)
+    // lp.dMonthlyExtraTerrIllum is extraterrestrial illum for 1st of month
+    // lp.dTurbidityFactor is turbidity factor calculated with zenith luminance
+	Double CIEClearSunLuminance = efflum * (lp.dMonthlyExtraTerrIllum / 93.73) * exp(-am * lp.dTurbidityFactor * abars);
+
+	return CIEClearSunLuminance;
+}
+
+//	decode lp once for the given generator type: copies the values the kernels
+//	read and precomputes every term that does not depend on the direction
+void	DecodeLumParam(const LumParam& lp, LumGenType type, LumKernelParam& kp)
+{
+	memset(&kp, 0, sizeof(kp));
+	kp.type = type;
+	kp.BFlux0 = lp.BFlux0;
+	SetLumDir0(kp, lp.Dir0);
+	kp.dSunAltRadians = lp.dSunAltRadians;
+	kp.dSunAzmRadians = lp.dSunAzmRadians;
+	kp.bPositiveDisp = (lp.dispersion > 0);
+
+	switch (type) {
+	case LUMGEN_SIMPLEBEAM: {
+		kp.CosConeAngle = cos(lp.dispersion*PI/180.);
+		//  Flux perp to CFS surface per unit of ConeSolidAngle
+		Double ConeSolidAngle = 2*PI*(1. - kp.CosConeAngle);
+		kp.FluxRatio = lp.BFlux0/ConeSolidAngle;	//	flux per unit solid angle of cone
+		break;
 	}
-//	for (int ii=0; ii < size; ii++) {
-	for (int ii=0; ii < lp.btdfHSResOut; ii++) {
-		hs0.valList[ii] = fptr(lp,hs0.dir(ii));
-		//	 convert sun Illum to Lum based on skyMap omega
-		if (lp.type == "CIECLEARSUN") hs0.valList[ii] /= hs0.omega;
+	case LUMGEN_SUPERLAMBERTIAN:
+		if (kp.bPositiveDisp) kp.Power = PI/DegToRad(lp.dispersion) - 1.;
+		break;
+	case LUMGEN_GAUSS: {
+		Double GaussDisp = lp.dispersion/100.;	//	sets roughly equal dispersion with same ConeAngle in other DirLum types
+		kp.SigmaSq = GaussDisp*GaussDisp;
+		break;
 	}
-	return	hs0;
+	case LUMGEN_CIEOVERCASTSKY:
+		//  (0.123 + 8.6 * dSinSunAlt == ZENITH LUM IN KCD/M**2)
+		//  (92.9 is conversion for zenith luminance from KCD/M**2 to CD/ft**2
+		kp.dSinSunAlt = sin(lp.dSunAltRadians);
+		kp.OvercastZenLum = 92.9 * (0.123 + 8.6 * kp.dSinSunAlt);
+		break;
+	case LUMGEN_CIECLEARSKY:
+		kp.dSinSunAlt = sin(lp.dSunAltRadians);
+		kp.dCosSunAlt = cos(lp.dSunAltRadians);
+		// 92.9 is conversion for zenith luminance from KCD/m2 to CD/ft2
+		kp.ClearZenLum = 92.9 * lp.dZenithLum;
+		kp.ClearZ3 = 0.27385 * (0.91 + 10.0 * exp(-3.0 * (1.5708 - lp.dSunAltRadians)) + 0.45 * kp.dSinSunAlt * kp.dSinSunAlt);
+		break;
+	case LUMGEN_CIECLEARSUN:
+		kp.SunLum = CIEClearSunNormalLum(lp);
+		break;
+	default:
+		break;
+	}
+}
+
+void	SetLumDir0(LumKernelParam& kp, BGL::vector3 Dir0)
+{
+	kp.Dir0[0] = Dir0[0];
+	kp.Dir0[1] = Dir0[1];
+	kp.Dir0[2] = Dir0[2];
 }
 
+//	per-type luminance kernels: Direction is UNIT LENGTH and in the NATURAL LOCAL COORD SYST
+template<LumGenType T> inline Double LumKernel(const LumKernelParam& kp, const BGL::vector3& Direction);
 
+static inline Double	Dir0Dot(const LumKernelParam& kp, const BGL::vector3& Direction)
+{
+	return kp.Dir0[0] * Direction[0] + kp.Dir0[1] * Direction[1] + kp.Dir0[2] * Direction[2];
+}
 
-Double	ConstLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_CONST>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
 	//	factor 1/2 is 2PI/4PI:
 	//	source BFlux0 per nit area is scattered into 2PI hemisphere
 	//	LumMap assumes 4PI tot solid angle
-//	return lp.BFlux0/2;
-	return lp.BFlux0;
-}
-
-Double	CosThetaLum(LumParam lp, BGL::vector3 Direction)
-{
-	return lp.BFlux0;
+	return kp.BFlux0;
 }
 
-Double	SimpleBeamLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_SIMPLEBEAM>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
-	//input Direction vec is UNIT LENGTH and in NATRUAL LOCAL COORD SYST for CFSSurf/Syst
-	Double CosConeAngle = cos(lp.dispersion*PI/180.);
 	//	hard cutoff if SURF node direction is outside Beam source light ConeAngle
-	if (BGL::dot(lp.Dir0,Direction) < CosConeAngle) return (0.);
-	//  Flux perp to CFS surface per unit of ConeSolidAngle
-	Double	BFlux1 = lp.BFlux0;
-	Double ConeSolidAngle = 2*PI*(1. - CosConeAngle);
-	Double FluxRatio = BFlux1/ConeSolidAngle;	//	flux per unit solid angle of cone
+	if (Dir0Dot(kp,Direction) < kp.CosConeAngle) return (0.);
 	// otherwise return perp flux per unit ConeSolidAngle per unit CFS node area
-	return(FluxRatio);
+	return(kp.FluxRatio);
 }
 
-Double	SuperLambertianLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_SUPERLAMBERTIAN>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
-	if (lp.dispersion <= 0) return 0;
-
-	Double	ConeAngle = DegToRad(lp.dispersion);
-//	Double Dot = Max(0.,BGL::dot(lp.Dir0,Direction));
-	Double Dot = max(0.,BGL::dot(lp.Dir0,Direction));
-
-	Double Power = PI/ConeAngle - 1.;
-	Double SLbrt = lp.BFlux0*pow(Dot,Power);
-//	cout << " " << Dir0 << " " << Power << " " << Dot << " " << SLbrt << "\n";
-	return SLbrt;
+	if (!kp.bPositiveDisp) return 0;
+	Double Dot = max(0.,Dir0Dot(kp,Direction));
+	return kp.BFlux0*pow(Dot,kp.Power);
 }
 
-Double	GaussLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_GAUSS>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
-	lp.dispersion /= 100.;	//	sets roughly equal dispersion with same ConeAngle in other DirLum types
-	Double Dot = max(min(BGL::dot(lp.Dir0,Direction),1.),-1.);	//	Dot is chord dist between Dir0, Direction unit vecs
+	Double Dot = max(min(Dir0Dot(kp,Direction),1.),-1.);	//	Dot is chord dist between Dir0, Direction unit vecs
 	Double theta = acos(Dot);	//	angle theta is great circle arcdist between Dir0, Direction vecs on unit sphere surface
-//	Double x = (1. - Dot) / (2*(1. + Dot));
 	Double x;
 	if ( fabs(1. - theta/PI) <= 1.e-10) x = theta/1.e-20;	//	avoid underflow
 	else x = theta / (1. - theta/PI);
-	Double sigmasq = lp.dispersion*lp.dispersion;
-	Double exponent = (x*x)/(2.*sigmasq);
+	Double exponent = (x*x)/(2.*kp.SigmaSq);
 	if ( exponent > 50) return 0;	//	avoid too small argument for exp()
-	Double Gbrt = lp.BFlux0*exp(-exponent);
-	return Gbrt;
+	return kp.BFlux0*exp(-exponent);
 }
 
-Double	CIEOvercastSkyLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_CIEOVERCASTSKY>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
-    // Calculates luminance (CD/FT**2) of CIE Standard Overcast skies in the given Direction.
-
-    // Conventions:
-        // Altitudes are 0 at horizon and 90 at zenith
-        // Azimuths are 0 East and counter-clockwise is positive
-
-    // Sun altitude (radians) for this overcast sky condition
-    Double dSunAlt = lp.dSunAltRadians;
-    Double dSinSunAlt = sin(dSunAlt);
-
-    // Sine of sky patch altitude for this calculation
-    Double dSinSkyAlt = Direction[2];
-
     // CIE Overcast Sky luminance (CD/ft2) for given sun and sky patch altitudes
-    //  (0.123 + 8.6 * dSinSunAlt == ZENITH LUM IN KCD/M**2)
-	//  (92.9 is conversion for zenith luminance from KCD/M**2 to CD/ft**2
-	Double CIEOvercastSkyLuminance = 92.9 * (0.123 + 8.6 * dSinSunAlt) * (0.33333 + 0.66667 * dSinSkyAlt);
-
-	return CIEOvercastSkyLuminance;
+    // Direction[2] is the sine of sky patch altitude
+	return kp.OvercastZenLum * (0.33333 + 0.66667 * Direction[2]);
 }
 
-Double	CIEClearSkyLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_CIECLEARSKY>(const LumKernelParam& kp, const BGL::vector3& Direction)
 {
-    // Calculates luminance (CD/FT**2) of CIE Standard Clear skies in the given Direction.
-
-    // Conventions:
-        // Altitudes are 0 at horizon and 90 at zenith
-        // Azimuths are 0 East and counter-clockwise is positive
-        // All angles are in radians
-
-    // Sun altitude (radians) for this clear sky sun position
-    Double dSunAlt = lp.dSunAltRadians;
-    Double dSinSunAlt = sin(dSunAlt);
-
     // Sine of sky patch altitude
     Double dSinSkyAlt = Direction[2];
     // Sky patch altitude
@@ -374,7 +406,7 @@ Double	CIEClearSkyLum(LumParam lp, BGL::vector3 Direction)
     else dSkyAzm = atan2(Direction[1], Direction[0]);
 
 	// angle between sun and element of sky
-	Double cangle = dSinSkyAlt * dSinSunAlt + cos(dSkyAlt) * cos(dSunAlt) * cos(dSkyAzm - lp.dSunAzmRadians);
+	Double cangle = dSinSkyAlt * kp.dSinSunAlt + cos(dSkyAlt) * kp.dCosSunAlt * cos(dSkyAzm - kp.dSunAzmRadians);
 	/* prevent cangle out of range due to roundoff */
 	cangle = max(-1.0,min(cangle,1.0));
 	Double angle = acos(cangle);
@@ -382,17 +414,165 @@ Double	CIEClearSkyLum(LumParam lp, BGL::vector3 Direction)
 	/* various luminance factors */
 	Double z1 = 0.91 + 10.0 * exp(-3.0 * angle) + 0.45 * cangle * cangle;
 	Double z2 = 1.0 - exp(-0.32 / dSinSkyAlt);
-	Double z3 = 0.27385 * (0.91 + 10.0 * exp(-3.0 * (1.5708 - dSunAlt)) + 0.45 * dSinSunAlt * dSinSunAlt);
 
 	/* luminance of sky element */
-	// 92.9 is conversion for zenith luminance from KCD/m2 to CD/ft2
-	Double CIEClearSkyLuminance = 92.9 * lp.dZenithLum * z1 * z2 / z3;
+	Double CIEClearSkyLuminance = kp.ClearZenLum * z1 * z2 / kp.ClearZ3;
 
-//	return CIEClearSkyLuminance;
 	return max(0.,CIEClearSkyLuminance);
 }
 
-Double	CIEClearTurbidSkyLum(LumParam lp, BGL::vector3 Direction)
+template<> inline Double LumKernel<LUMGEN_CIECLEARSUN>(const LumKernelParam& kp, const BGL::vector3& Direction)
+{
+    // Return 0.0 if the current Direction does not point at the sun
+    // or at least within +/- the approximate diameter of the solar disk
+    // solar disk = sun dia / sun dist = 9.291*10^-3 radians = 0.5323 deg
+    Double dDirectionAlt = asin(Direction[2]);
+    if ((dDirectionAlt >= (kp.dSunAltRadians + 7*0.009291)) || (dDirectionAlt <= (kp.dSunAltRadians - 7*0.009291)))
+        return 0.0;
+    Double dDirectionAzm;
+    if ((Direction[0]==0.0) && (Direction[1]==0.0)) dDirectionAzm = 0.;
+    else dDirectionAzm = atan2(Direction[1], Direction[0]);
+    if ((dDirectionAzm >= (kp.dSunAzmRadians + 5*0.009291)) || (dDirectionAzm <= (kp.dSunAzmRadians - 5*0.009291)))
+        return 0.0;
+
+    return kp.SunLum;
+}
+
+//	one pass over the cached spiral directions for a single generator type
+template<LumGenType T> static void	FillLumKernel(const LumKernelParam& kp, HemiSphiral& hs0)
+{
+	int		nsize = min(hs0.size(),(int)hs0.valList.size());
+	Double*	pval = (nsize > 0) ? &hs0.valList[0] : NULL;
+	Double	omega = hs0.omega;
+
+	if (hs0.pbasis && (hs0.pbasis->N >= nsize)) {
+		const BGL::vector3*	pdir = (nsize > 0) ? &hs0.pbasis->dirList[0] : NULL;
+		for (int ii=0; ii < nsize; ii++) {
+			pval[ii] = LumKernel<T>(kp,pdir[ii]);
+			//	 convert sun Illum to Lum based on skyMap omega
+			if (T == LUMGEN_CIECLEARSUN) pval[ii] /= omega;
+		}
+	}
+	else {
+		for (int ii=0; ii < nsize; ii++) {
+			pval[ii] = LumKernel<T>(kp,hs0.dir(ii));
+			if (T == LUMGEN_CIECLEARSUN) pval[ii] /= omega;
+		}
+	}
+}
+
+//	fills hs0 in place from a decoded parameter block; false for a bad type
+bool	FillLuminanceMap(const LumKernelParam& kp, HemiSphiral& hs0)
+{
+	switch (kp.type) {
+	case LUMGEN_SUPERLAMBERTIAN:	FillLumKernel<LUMGEN_SUPERLAMBERTIAN>(kp,hs0);	break;
+	case LUMGEN_GAUSS:				FillLumKernel<LUMGEN_GAUSS>(kp,hs0);			break;
+	case LUMGEN_SIMPLEBEAM:			FillLumKernel<LUMGEN_SIMPLEBEAM>(kp,hs0);		break;
+	case LUMGEN_CONST:				FillLumKernel<LUMGEN_CONST>(kp,hs0);			break;
+	case LUMGEN_CIEOVERCASTSKY:		FillLumKernel<LUMGEN_CIEOVERCASTSKY>(kp,hs0);	break;
+	case LUMGEN_CIECLEARSKY:		FillLumKernel<LUMGEN_CIECLEARSKY>(kp,hs0);		break;
+	case LUMGEN_CIECLEARSUN:		FillLumKernel<LUMGEN_CIECLEARSUN>(kp,hs0);		break;
+	default:	return false;
+	}
+	return true;
+}
+
+Double	GenDirLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LumGenTypeOf(lp.type),kp);
+	switch (kp.type) {
+	case LUMGEN_SUPERLAMBERTIAN:	return LumKernel<LUMGEN_SUPERLAMBERTIAN>(kp,Direction);
+	case LUMGEN_GAUSS:				return LumKernel<LUMGEN_GAUSS>(kp,Direction);
+	case LUMGEN_SIMPLEBEAM:			return LumKernel<LUMGEN_SIMPLEBEAM>(kp,Direction);
+	case LUMGEN_CONST:				return LumKernel<LUMGEN_CONST>(kp,Direction);
+	case LUMGEN_CIEOVERCASTSKY:		return LumKernel<LUMGEN_CIEOVERCASTSKY>(kp,Direction);
+	case LUMGEN_CIECLEARSKY:		return LumKernel<LUMGEN_CIECLEARSKY>(kp,Direction);
+	case LUMGEN_CIECLEARSUN:		return LumKernel<LUMGEN_CIECLEARSUN>(kp,Direction);
+	default:	return -1;	//	error value
+	}
+}
+
+//HemiSphiral GenLuminanceMap(int size, LumParam lp)
+HemiSphiral GenLuminanceMap(const LumParam& lp)
+{
+	int	zMin = -1;
+	LumKernelParam	kp;
+
+	DecodeLumParam(lp,LumGenTypeOf(lp.type),kp);
+	if (kp.type == LUMGEN_BAD) {
+//		cerr << "GenLum: Bad type: " << syst_type << "\n";
+		HemiSphiral	hs0;
+		hs0.resize(0);	//	error value
+		return hs0;
+	}
+
+	HemiSphiral	hs0(zMin,lp.btdfHSResOut);
+	FillLuminanceMap(kp,hs0);
+	return	hs0;
+}
+
+
+
+Double	ConstLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_CONST,kp);
+	return LumKernel<LUMGEN_CONST>(kp,Direction);
+}
+
+Double	CosThetaLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	return lp.BFlux0;
+}
+
+Double	SimpleBeamLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_SIMPLEBEAM,kp);
+	return LumKernel<LUMGEN_SIMPLEBEAM>(kp,Direction);
+}
+
+Double	SuperLambertianLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_SUPERLAMBERTIAN,kp);
+	return LumKernel<LUMGEN_SUPERLAMBERTIAN>(kp,Direction);
+}
+
+Double	GaussLum(const LumParam& lp, BGL::vector3 Direction)
+{
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_GAUSS,kp);
+	return LumKernel<LUMGEN_GAUSS>(kp,Direction);
+}
+
+Double	CIEOvercastSkyLum(const LumParam& lp, BGL::vector3 Direction)
+{
+    // Calculates luminance (CD/FT**2) of CIE Standard Overcast skies in the given Direction.
+
+    // Conventions:
+        // Altitudes are 0 at horizon and 90 at zenith
+        // Azimuths are 0 East and counter-clockwise is positive
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_CIEOVERCASTSKY,kp);
+	return LumKernel<LUMGEN_CIEOVERCASTSKY>(kp,Direction);
+}
+
+Double	CIEClearSkyLum(const LumParam& lp, BGL::vector3 Direction)
+{
+    // Calculates luminance (CD/FT**2) of CIE Standard Clear skies in the given Direction.
+
+    // Conventions:
+        // Altitudes are 0 at horizon and 90 at zenith
+        // Azimuths are 0 East and counter-clockwise is positive
+        // All angles are in radians
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_CIECLEARSKY,kp);
+	return LumKernel<LUMGEN_CIECLEARSKY>(kp,Direction);
+}
+
+Double	CIEClearTurbidSkyLum(const LumParam& lp, BGL::vector3 Direction)
 {
     // Calculates luminance (CD/FT**2) of CIE Standard Clear Turbid skies in the given Direction.
 
@@ -434,7 +614,7 @@ Double	CIEClearTurbidSkyLum(LumParam lp, BGL::vector3 Direction)
 	return max(0.,CIEClearTurbidSkyLuminance);
 }
 
-Double	CIEIntermediateSkyLum(LumParam lp, BGL::vector3 Direction)
+Double	CIEIntermediateSkyLum(const LumParam& lp, BGL::vector3 Direction)
 {
     // Calculates luminance (CD/FT**2) of CIE Intermediate skies in the given Direction.
 
@@ -477,79 +657,19 @@ Double	CIEIntermediateSkyLum(LumParam lp, BGL::vector3 Direction)
 	return max(0.,CIEIntermediateSkyLuminance);
 }
 
-Double	CIEClearSunLum(LumParam lp, BGL::vector3 Direction)
+Double	CIEClearSunLum(const LumParam& lp, BGL::vector3 Direction)
 {
     // Calculates and returns direct normal solar intensity
     // (lumens/ft2) for CIE Standard Clear Sky.
     // For a Direction that points at the sun
 
-    // Check to see if the current Direction points at the sun
-    // Direction altitude angle in radians
-    Double dDirectionAlt = asin(Direction[2]);
-    // Direction azimuth angle in radians
-    // Sky patch azimuth
-    Double dDirectionAzm;
-    if ((Direction[0]==0.0) && (Direction[1]==0.0)) dDirectionAzm = 0.;
-    else dDirectionAzm = atan2(Direction[1], Direction[0]);
-    // Return 0.0 if the current Direction does not point at the sun
-    // or at least within +/- the approximate diameter of the solar disk
-    // solar disk = sun dia / sun dist = 9.291*10^-3 radians = 0.5323 deg
-// RJH debug
-//    if ((dDirectionAlt >= (lp.dSunAltRadians + 5*0.009291)) || (dDirectionAlt <= (lp.dSunAltRadians - 5*0.009291)))
-    if ((dDirectionAlt >= (lp.dSunAltRadians + 7*0.009291)) || (dDirectionAlt <= (lp.dSunAltRadians - 7*0.009291)))
-        return 0.0;
-    if ((dDirectionAzm >= (lp.dSunAzmRadians + 5*0.009291)) || (dDirectionAzm <= (lp.dSunAzmRadians - 5*0.009291)))
-        return 0.0;
-
     // Conventions:
         // Altitudes are 0 at horizon and 90 at zenith
         // Azimuths are 0 East and counter-clockwise is positive
-        // All angles are in radians (except where converted to degrees below)
-
-	Double lop, powlop;	/* exponentiation test and result holders */
-	Double am;		/* corrected optical air mass */
-	Double c1, c2, c3, s1, s2, s3;
-	Double abars;
-	Double bc;
-	Double efflum;	/* luminous efficacy */
-
-    // Sun altitude (radians) for this clear sky sun position
-    Double dSunAlt = lp.dSunAltRadians;
-    Double dSinSunAlt = sin(dSunAlt);
-    // Sun altitude (degrees)
-    Double dSunAltDegrees = RadToDeg(dSunAlt);
-
-	/* optical air mass corrected for building altitude in kilometers */
-	lop = dSunAltDegrees + 3.885;
-	if (lop < 0.0) {
-		return(0.0);
-	}
-	else powlop = pow(lop,1.253);
-	am = (1.0 - 0.1 * lp.dBldgAltitude / 3281.0) / (dSinSunAlt + 0.15 / powlop);
-
-	/* intermediate calculations for monster equation */
-	c1 = 2.1099 * cos(dSunAlt);
-	c2 = 0.6322 * cos(2.0 * dSunAlt);
-	c3 = 0.0252 * cos(3.0 * dSunAlt);
-	s1 = 1.0022 * dSinSunAlt;
-	s2 = 1.0077 * sin(2.0 * dSunAlt);
-	s3 = 0.2606 * sin(3.0 * dSunAlt);
-
-	abars = 1.4899 - c1 + c2 + c3 - s1 + s2 - s3;
-
-	/* lp.dBldgMonthlyAtmosTurb below is BETA in 21d code */
-	bc = min(0.2,lp.dBldgMonthlyAtmosTurb);
-
-	/* luminous efficacy */
-	/* lp.dBldgMonthlyAtmosMois * 2.54 below is W in 21d code */
-	efflum = (99.4+4.7*(lp.dBldgMonthlyAtmosMois*2.54)-52.4*bc)*(1.0-exp((24.0*bc-8.0)*dSunAlt));
-
-	// 93.73 below is extraterrestrial lum eff (lm/w)
-    // lp.dMonthlyExtraTerrIllum is extraterrestrial illum for 1st of month
-    // lp.dTurbidityFactor is turbidity factor calculated with zenith luminance
-	Double CIEClearSunLuminance = efflum * (lp.dMonthlyExtraTerrIllum / 93.73) * exp(-am * lp.dTurbidityFactor * abars);
-
-	return CIEClearSunLuminance;
+        // All angles are in radians
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_CIECLEARSUN,kp);
+	return LumKernel<LUMGEN_CIECLEARSUN>(kp,Direction);
 }
 
 //	generate sky
@@ -606,10 +726,12 @@ btdfHS*	GenBTDF(LumParam& lp)
 {
 	//	ONLY WORKS FOR WINDOW, LIGHTSHELF types
 	//	directional generator for btdf data:  spiral input dirs are fixed by Msize
-	//	make lp temporary copy
-	LumParam	lptmp = lp;
-	lptmp.type = "GAUSS";	//	hardwire gentype
-	lptmp.BFlux0 = 1.00;
+	//	decode lp once; only the beam direction changes per incident dir
+	LumKernelParam	kp;
+	DecodeLumParam(lp,LUMGEN_GAUSS,kp);	//	hardwire gentype
+	kp.BFlux0 = 1.00;
+	bool	bWindow = (lp.btdftype == "WINDOW");
+	bool	bLightShelf = (lp.btdftype == "LIGHTSHELF");
 	//	hardwire
 	BGL::vector3	dirwind, dirLS;
 	HemiSphiral		lmTrans(lp.btdfHSResOut), lmRefl(lp.btdfHSResOut), lmTot(lp.btdfHSResOut);
@@ -625,69 +747,70 @@ btdfHS*	GenBTDF(LumParam& lp)
 //		dirwind *= BGL::vector3(1,-1,1);	//	combined transformation
 
 		//	VisTrans in incident direction
-		tau = lptmp.visTransNormal*pow(dirwind[2],lptmp.visTransExponent);
+		tau = lp.visTransNormal*pow(dirwind[2],lp.visTransExponent);
 		pbtdf0->HSin[ii] = tau;	//	store here for later use
 
-		if (lptmp.btdftype == "WINDOW") {
-			lptmp.Dir0 = BGL::norm(dirwind);	//	renornalize
-			lmTrans = GenLuminanceMap(lptmp);
+		if (bWindow) {
+			SetLumDir0(kp,BGL::norm(dirwind));	//	renornalize
+			FillLuminanceMap(kp,lmTrans);
 			pbtdf0->HSoutList[ii]	= (lmTrans*tau)/lmTrans.TotHorizIllum();	//	normalize output for conservation of light
 		}
-		else if (lptmp.btdftype == "LIGHTSHELF") {
-			lptmp.Dir0 = BGL::norm(dirwind);	//	renornalize
-			lmTrans = GenLuminanceMap(lptmp);
+		else if (bLightShelf) {
+			SetLumDir0(kp,BGL::norm(dirwind));	//	renornalize
+			FillLuminanceMap(kp,lmTrans);
 		//	LIGHTSHELF type: same as WINDOW + one more step to ger reflected ray direction
 		//	downward pointing rays are reflected upward: LCS +y -> -y
 			dirLS = dirwind;
 			if (dirwind[1] < 0) dirLS = dirwind*BGL::vector3(+1,-1,+1);
-			lptmp.Dir0 = BGL::norm(dirLS);	//	renornalize
-			lmRefl = GenLuminanceMap(lptmp);
-			lmTot = lmTrans*(1. - lptmp.LightShelfReflectance) + lmRefl*lptmp.LightShelfReflectance;
+			SetLumDir0(kp,BGL::norm(dirLS));	//	renornalize
+			FillLuminanceMap(kp,lmRefl);
+			lmTot = lmTrans*(1. - lp.LightShelfReflectance) + lmRefl*lp.LightShelfReflectance;
 			//lmTot.plotview(40);
 			pbtdf0->HSoutList[ii]	= (lmTot*tau)/lmTot.TotHorizIllum();	//	normalize output for conservation of light
 		}
 //		cout << "GenBTDF: btdfHSoutList Tot Horizontal Illum: " << ii << " " << btdf0.HSoutList[ii].TotHorizIllum() << "\n";
 	}
+	pbtdf0->packMatrix();
 	return pbtdf0;
 }
 
 //	sky-btdf integration
+//	LumMap[jj] = sum over ii of Q[ii][jj]*skyLum[ii]: one blocked GEMV over the packed btdf
+//	matrix (rows Q[ii] = qexact(ii,.)) and the sky flux through each incident dir
 HemiSphiral	SkyBTDFIntegration(HemiSphiral& sky0, btdf* pbtdf0, BGL::RHCoordSys3 ics)
 {
-	HemiSphiral	LumMap((int)pbtdf0->HSoutList[0].size());
-	HemiSphiral lm((int)pbtdf0->HSoutList[0].size());
-	Tregenza	Trgz0;
+	int	nout = (int)pbtdf0->HSoutList[0].size();
+	HemiSphiral	LumMap(nout);
 	//	integrate over btdf "natural" incident directions
 	//	sky interpolation needed - even if Nsky = Mbtdf because of possible arbitrary relative orientations 
-	int	ii, jj;
-	Double	skyLum, skyLumTot = 0;
-	Double	skyTotIllum = sky0.TotIllum();
+	int	ii, iirow, noutTop;
+	BGL::RHCoordSys3	icsSky = ics.RotateY();
 	BGL::vector3	dir, dirsky;
+	Double	skyLum;
+	vector<Double>	sterm;
+	vector<int>		irow;
+	sterm.reserve(pbtdf0->size());
+	irow.reserve(pbtdf0->size());
+
+	if (pbtdf0->Qmat.nrows != (int)pbtdf0->HSoutList.size()) pbtdf0->packMatrix();
+
+	//	only integrate over top half of btdf transmitted Sphiral
+	for (noutTop=0; noutTop<nout; noutTop++) if (pbtdf0->outDir(noutTop)[2] < 0) break;
+
+	//	sky flux vector and the btdf matrix row of each incident dir
 	for (ii=0; ii<pbtdf0->size(); ii++) {	//	incident dir loop
 		dir = pbtdf0->inDir(ii);	//	"natural" ii'th btdf incident direction in btdf outside LCS coords 
 		if (dir[2] < 0) break;	//	only integrate over top half of btdf incident Sphiral 
-		dirsky = BGL::dirLCStoWCS(dir, ics.RotateY());	//	converted to WCS dir for pointing at sky
+		dirsky = BGL::dirLCStoWCS(dir, icsSky);	//	converted to WCS dir for pointing at sky
 		skyLum = sky0.interp(dirsky)*pbtdf0->inDirOmega(ii)*dir[2];
-		for (jj=0; jj<pbtdf0->HSoutList[0].size(); jj++) {	//	out Dir loop
-//			cout << '.';
-			if (pbtdf0->outDir(jj)[2] < 0) break;	//	only integrate over top half of btdf transmitted Sphiral
-			lm[jj] = pbtdf0->qexact(ii,jj)*skyLum;	//	uses qexact - NO BTDF interpolation
-		}
-//		cout << "\n";
-		LumMap += lm;
-		skyLumTot += skyLum;
-//		cout << ii << " ";
-//		cout << Trgz0.Theta(ii) << " " << Trgz0.Phi(ii) << " "; 
-//		cout << pbtdf0->iisym(ii) << " " << pbtdf0->iidata(ii) << " ";
-//		cout << sky0.interp(dirsky) << " " << skyLum << " " << lm.TotIllum() << "\n";
-//		pbtdf0->HSoutList[pbtdf0->iidata(ii)].plotview(25);
-//		if (skyLum/skyTotIllum >= 0.01) {
-//			cout << "skyInt: " << skyLum/skyTotIllum << "\n";
-//			lm.plotview(25);
-//			LumMap.plotview(30);
-//		}
+		iirow = pbtdf0->iidata(ii);	//	same row as qexact(ii,.) - NO BTDF interpolation
+		if ((skyLum == 0) || (iirow < 0) || (iirow >= pbtdf0->Qmat.nrows)) continue;
+		sterm.push_back(skyLum);
+		irow.push_back(iirow);
 	}
-//	cout << "skyLumTotRatio: " << skyLumTot/skyTotIllum << "\n";
+
+	if ((noutTop > 0) && !sterm.empty())
+		BTDFGemv(pbtdf0->Qmat,(int)sterm.size(),&irow[0],&sterm[0],noutTop,&LumMap.valList[0]);
 	return LumMap;
 }
 
@@ -81,22 +81,63 @@ struct LumParam
 	void	Dump();
 };
 
-Double		ConstLum(LumParam lp, BGL::vector3 Direction);
-Double		CosThetaLum(LumParam lp, BGL::vector3 Direction);
-Double		SimpleBeamLum(LumParam lp, BGL::vector3 Direction);
-Double		SuperLambertianLum(LumParam lp, BGL::vector3 Direction);
-Double		GaussLum(LumParam lp, BGL::vector3 Direction);
+//	luminance generator types, decoded once from LumParam::type
+enum LumGenType
+{
+	LUMGEN_BAD = -1,
+	LUMGEN_SUPERLAMBERTIAN,
+	LUMGEN_GAUSS,
+	LUMGEN_SIMPLEBEAM,
+	LUMGEN_CONST,
+	LUMGEN_CIEOVERCASTSKY,
+	LUMGEN_CIECLEARSKY,
+	LUMGEN_CIECLEARSUN
+};
+
+LumGenType	LumGenTypeOf(const string& type);
+
+//	compact parameter block for the luminance generator kernels:
+//	the LumParam values they read plus all direction-independent terms
+struct LumKernelParam
+{
+	LumGenType	type;
+	Double	BFlux0;
+	Double	Dir0[3];
+	Double	CosConeAngle;	//	SIMPLEBEAM cone cutoff
+	Double	FluxRatio;		//	SIMPLEBEAM flux per unit cone solid angle
+	Double	Power;			//	SUPERLAMBERTIAN exponent (dispersion > 0 only)
+	Double	SigmaSq;		//	GAUSS dispersion squared
+	Double	dSunAltRadians;
+	Double	dSunAzmRadians;
+	Double	dSinSunAlt;
+	Double	dCosSunAlt;
+	Double	OvercastZenLum;	//	CIEOVERCASTSKY zenith luminance (CD/ft2)
+	Double	ClearZenLum;	//	CIECLEARSKY 92.9 * dZenithLum
+	Double	ClearZ3;		//	CIECLEARSKY z3
+	Double	SunLum;			//	CIECLEARSUN luminance inside the solar disk window
+	int		bPositiveDisp;	//	dispersion > 0
+};
+
+void		DecodeLumParam(const LumParam& lp, LumGenType type, LumKernelParam& kp);
+void		SetLumDir0(LumKernelParam& kp, BGL::vector3 Dir0);
+
+Double		ConstLum(const LumParam& lp, BGL::vector3 Direction);
+Double		CosThetaLum(const LumParam& lp, BGL::vector3 Direction);
+Double		SimpleBeamLum(const LumParam& lp, BGL::vector3 Direction);
+Double		SuperLambertianLum(const LumParam& lp, BGL::vector3 Direction);
+Double		GaussLum(const LumParam& lp, BGL::vector3 Direction);
 
-Double		CIEOvercastSkyLum(LumParam lp, BGL::vector3 Direction);
-Double		CIEClearSkyLum(LumParam lp, BGL::vector3 Direction);
-Double		CIEClearTurbidSkyLum(LumParam lp, BGL::vector3 Direction);
-Double		CIEIntermediateSkyLum(LumParam lp, BGL::vector3 Direction);
-Double		CIEClearSunLum(LumParam lp, BGL::vector3 Direction);
+Double		CIEOvercastSkyLum(const LumParam& lp, BGL::vector3 Direction);
+Double		CIEClearSkyLum(const LumParam& lp, BGL::vector3 Direction);
+Double		CIEClearTurbidSkyLum(const LumParam& lp, BGL::vector3 Direction);
+Double		CIEIntermediateSkyLum(const LumParam& lp, BGL::vector3 Direction);
+Double		CIEClearSunLum(const LumParam& lp, BGL::vector3 Direction);
 
-Double		GenDirLum(LumParam lp, BGL::vector3 Direction);
+Double		GenDirLum(const LumParam& lp, BGL::vector3 Direction);
 
 struct HemiSphiral;	//	forward declaration
-HemiSphiral GenLuminanceMap(LumParam lp);
+HemiSphiral GenLuminanceMap(const LumParam& lp);
+bool		FillLuminanceMap(const LumKernelParam& kp, HemiSphiral& hs0);
 
 HemiSphiral	GenSky(LumParam lp);
 
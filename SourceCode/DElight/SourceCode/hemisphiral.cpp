@@ -33,9 +33,12 @@ WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 #include <iostream>
 #include <iomanip>
 #include <fstream>
-#include <strstream>
+#include <sstream>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
 using namespace std;
 
 // BGLincludes
@@ -56,22 +59,42 @@ extern double NaN_QUIET;
 extern double NaN_SIGNAL;
 extern double MAXPointTol;
 
-HemiSphiral::HemiSphiral()
-: N(0), zMin(-1), deltaz(0), omega(0), DA(0), pitch(0)
+//	point direction of a (N, deltaz, pitch) spiral
+static BGL::vector3	HSDirCalc(int ii, int N, Double deltaz, Double pitch)
 {
-//	zMin = -1;	//	zMax always= +1; zMin = -1 -> full sphere
+	if (ii<0) return BGL::vector3(0,0,1);	//	bounds check
+	if (ii>=N) return BGL::vector3(0,0,-1);	//	bounds check
+	if (N==0) return BGL::vector3(0,0,0);	//	BAD!!!
+	if (N==1) return BGL::vector3(0,0,1);
+
+	Double	z, r, phi;
+
+	z = 1 - ii*deltaz;	//	z = cos(theta(ii))
+	r = sqrt(1-z*z);	//	r = sin(theta(ii))
+	phi = acos(z)/pitch;	//	phi = theta/pitch
+
+	return BGL::vector3(r*cos(phi),r*sin(phi),z);
 }
 
-HemiSphiral::HemiSphiral(Double z)
-: N(0), zMin(z), deltaz(0), omega(0), DA(0), pitch(0)
+//	clamped cos(theta) of point ii of a (N, deltaz) spiral
+static Double	HSCosTheta(int ii, int N, Double deltaz)
 {
-//	zMin = -1;	//	zMax always= +1; zMin = -1 -> full sphere
-//	zMin = 0;	//	zMax always= +1; zMin =  0 -> hemisphere
+	if ( (ii<0) || (ii>=N) ) return 1;	//	bounds check
+
+	Double	z = 1 - ii*deltaz;
+	if (z <= -1.) return  -1.;
+	if (z >= 1.) return  1.;
+	return z;
 }
 
-void HemiSphiral::init()
+HSBasis::HSBasis(int n, Double z)
+: N(n), zMin(z), nBands(0), bandDTheta(0)
+//	spiral parameters and per-point tables; the trig is done once here
 {
+	int		ii;
+
 	if (N <= 0) {
+		N = 0;
 		deltaz =  0;
 		omega = 0;
 		DA = 0;
@@ -90,6 +113,118 @@ void HemiSphiral::init()
 		DA = sqrt(omega);
 		pitch = DA/(2*PI);
 	}
+
+	dirList.resize(N);
+	cosList.resize(N);
+	thetaList.resize(N);
+	for (ii=0; ii<N; ii++) {
+		dirList[ii] = HSDirCalc(ii,N,deltaz,pitch);
+		cosList[ii] = HSCosTheta(ii,N,deltaz);
+		thetaList[ii] = acos(cosList[ii]);
+	}
+	initIndex();
+}
+
+void HSBasis::initIndex()
+//	builds the grid-bucket index used by HemiSphiral::nearestk()
+{
+	int		ii, ib, icell;
+
+	if ((N <= 0) || (DA <= 0)) return;
+
+	//	theta bands about DA wide, each split into phi sectors about DA wide at mid-band
+	Double	thetaMax = acos(max(min(zMin,1.),-1.));
+	nBands = (int)ceil(thetaMax/DA);
+	if (nBands < 1) nBands = 1;
+	bandDTheta = thetaMax/nBands;
+	if (bandDTheta <= 0) bandDTheta = PI;
+	bandNPhi.resize(nBands);
+	bandCell0.resize(nBands+1);
+	bandCell0[0] = 0;
+	for (ib=0; ib<nBands; ib++) {
+		bandNPhi[ib] = (int)(2*PI*sin((ib + 0.5)*bandDTheta)/DA + 0.5);
+		if (bandNPhi[ib] < 1) bandNPhi[ib] = 1;
+		bandCell0[ib+1] = bandCell0[ib] + bandNPhi[ib];
+	}
+
+	//	counting sort of points into cells (ascending point index within each cell)
+	vector<int>	cellOf(N);
+	cellStart.assign(bandCell0[nBands]+1,0);
+	for (ii=0; ii<N; ii++) {
+		cellOf[ii] = cellOfDir(dirList[ii]);
+		cellStart[cellOf[ii]+1] += 1;
+	}
+	for (icell=0; icell<bandCell0[nBands]; icell++) cellStart[icell+1] += cellStart[icell];
+	vector<int>	cellFill(cellStart.begin(),cellStart.end()-1);
+	cellIndx.resize(N);
+	for (ii=0; ii<N; ii++) cellIndx[cellFill[cellOf[ii]]++] = ii;
+}
+
+int	HSBasis::cellOfDir(BGL::vector3 dirext) const
+//	returns the grid-bucket index cell containing direction dirext
+{
+	Double	thetaext = acos(max(min(dirext[2],1.),-1.));
+	int		ib = (int)(thetaext/bandDTheta);
+	if (ib < 0) ib = 0;
+	if (ib >= nBands) ib = nBands - 1;
+
+	Double	phiext = atan2(dirext[1],dirext[0]);
+	if (phiext < 0) phiext += 2*PI;
+	int		is = (int)(phiext*bandNPhi[ib]/(2*PI));
+	if (is < 0) is = 0;
+	if (is >= bandNPhi[ib]) is = bandNPhi[ib] - 1;
+
+	return bandCell0[ib] + is;
+}
+
+//	returns the shared basis of an (N, zMin) spiral, building it on first use;
+//	bases are never modified once built, so callers may share them across threads
+shared_ptr<const HSBasis>	HSBasisGet(int N, Double zMin)
+{
+	static mutex	mtx;
+	static map<pair<int,Double>,shared_ptr<const HSBasis> >	mapBasis;
+
+	if (N <= 0) return shared_ptr<const HSBasis>();
+
+	pair<int,Double>	key(N,zMin);
+	{
+		lock_guard<mutex> lock(mtx);
+		map<pair<int,Double>,shared_ptr<const HSBasis> >::iterator	it = mapBasis.find(key);
+		if (it != mapBasis.end()) return it->second;
+	}
+	//	build outside the lock; if another thread got there first, use its copy
+	shared_ptr<const HSBasis>	pbasis0(new HSBasis(N,zMin));
+	lock_guard<mutex> lock(mtx);
+	return mapBasis.insert(make_pair(key,pbasis0)).first->second;
+}
+
+HemiSphiral::HemiSphiral()
+: N(0), zMin(-1), deltaz(0), omega(0), DA(0), pitch(0)
+{
+//	zMin = -1;	//	zMax always= +1; zMin = -1 -> full sphere
+}
+
+HemiSphiral::HemiSphiral(Double z)
+: N(0), zMin(z), deltaz(0), omega(0), DA(0), pitch(0)
+{
+//	zMin = -1;	//	zMax always= +1; zMin = -1 -> full sphere
+//	zMin = 0;	//	zMax always= +1; zMin =  0 -> hemisphere
+}
+
+void HemiSphiral::init()
+{
+	pbasis = HSBasisGet(N,zMin);
+	if (!pbasis) {
+		deltaz =  0;
+		omega = 0;
+		DA = 0;
+		pitch = 0;
+		return;
+	}
+	deltaz = pbasis->deltaz;
+	omega = pbasis->omega;
+	DA = pbasis->DA;
+	pitch = pbasis->pitch;
 }
 
 HemiSphiral::HemiSphiral(int n)
@@ -166,16 +301,13 @@ int	HemiSphiral::valMinIndx()
 
 Double	HemiSphiral::costheta(int ii)
 {
-	if ( (ii<0) || (ii>=N) ) return 1;	//	bounds check
-
-	Double	z = 1 - ii*deltaz;
-	if (z <= -1.) return  -1.;
-	if (z >= 1.) return  1.;
-	return z;
+	if (hasBasis(ii)) return pbasis->cosList[ii];
+	return HSCosTheta(ii,N,deltaz);
 }
 
 Double	HemiSphiral::theta(int ii)
 {
+	if (hasBasis(ii)) return pbasis->thetaList[ii];
 	return acos(costheta(ii));
 }
 
@@ -231,18 +363,13 @@ Double	HemiSphiral::y2D(int ii)
 
 BGL::vector3	HemiSphiral::dir(int ii)
 {
-	if (ii<0) return BGL::vector3(0,0,1);	//	bounds check
-	if (ii>=N) return BGL::vector3(0,0,-1);	//	bounds check
-	if (N==0) return BGL::vector3(0,0,0);	//	BAD!!!
-	if (N==1) return BGL::vector3(0,0,1);
-
-	Double	z, r, phi;
-
-	z = 1 - ii*deltaz;	//	z = cos(theta(ii))
-	r = sqrt(1-z*z);	//	r = sin(theta(ii))
-	phi = acos(z)/pitch;	//	phi = theta/pitch
+	if (hasBasis(ii)) return pbasis->dirList[ii];
+	return dirCalc(ii);
+}
 
-	return BGL::vector3(r*cos(phi),r*sin(phi),z);
+BGL::vector3	HemiSphiral::dirCalc(int ii)
+{
+	return HSDirCalc(ii,N,deltaz,pitch);
 }
 
 HemiSphiral&	HemiSphiral::operator += (const HemiSphiral&	hs)
@@ -337,65 +464,86 @@ vector<int>	HemiSphiral::nearest4(Double phiext, Double thetaext)
 
 vector<int>	HemiSphiral::nearest4(BGL::vector3 dirext)
 {
-	vector<Double> distmax(4,+INFINITY);
-	vector<int> distmaxindx(4);
-
-	Double dist;
-	for (int jj=0; jj < size(); jj++) {
-	// searches entire dataset - ugh!
-		dist = arcdist(dirext,dir(jj));
-		if (  dist < distmax[3]) {
-			distmax[3] = dist;
-			distmaxindx[3] = jj;
-		}
-		if (  dist < distmax[2]) {
-			distmax[3] = distmax[2];
-			distmaxindx[3] = distmaxindx[2];
-			distmax[2] = dist;
-			distmaxindx[2] = jj;
-		}
-		if (  dist < distmax[1]) {
-			distmax[2] = distmax[1];
-			distmaxindx[2] = distmaxindx[1];
-			distmax[1] = dist;
-			distmaxindx[1] = jj;
-		}
-		if (  dist < distmax[0]) {
-			distmax[1] = distmax[0];
-			distmaxindx[1] = distmaxindx[0];
-			distmax[0] = dist;
-			distmaxindx[0] = jj;
-		}
-	}
-	return distmaxindx;
-
+	return nearestn(4,dirext);
 }
 
 vector<int>	HemiSphiral::nearestn(int nnear, BGL::vector3 dirext)
 {
+	vector<int> distminindx(nnear,0);
 	vector<Double> distmin(nnear,+INFINITY);
-	vector<int> distminindx(nnear);
-
-	Double dist;
-	for (int jj=0; jj < size(); jj++) {
-	// searches entire dataset - ugh!
-		dist = arcdist(dirext,dir(jj));
-		//	do sorted insertion
-		for (int kk=nnear-1; kk>=0; kk--) {
-			if (  dist < distmin[kk]) {
-				if (kk < nnear - 1) {
-				//	move old stuff down the array
-					distmin[kk+1] = distmin[kk];
-					distminindx[kk+1] = distminindx[kk];
+
+	if (nnear > 0) nearestk(dirext,nnear,PI,&distminindx[0],&distmin[0]);
+	return distminindx;
+
+}
+
+int	HemiSphiral::nearestk(BGL::vector3 dirext, int nnear, Double admax, int* indx, Double* adist)
+//	finds the (up to) nnear points nearest to dirext with arcdist < admax,
+//	using the grid-bucket index of the shared basis; no heap allocation.
+//	returns the number found, in indx[] and adist[] sorted by increasing arcdist
+{
+	const Double	tol = 1.e-9;	//	search margin for band and sector edges
+	int		nfound = 0;
+	int		ib, ib0, ib1, is, is0, is1, nphi, icell, kk, jj, ins;
+	Double	rad, dotmin, dphi, dotjj;
+	bool	allphi;
+
+	if ((N <= 0) || (nnear <= 0) || !pbasis || (pbasis->nBands <= 0)) return 0;
+	const HSBasis&	hsb = *pbasis;
+
+	Double	thetaext = acos(max(min(dirext[2],1.),-1.));
+	Double	phiext = atan2(dirext[1],dirext[0]);
+	if (phiext < 0) phiext += 2*PI;
+	if (admax > PI) admax = PI;
+
+	//	search a cap around dirext, doubling its radius until nnear points are found
+	rad = min(admax,2*DA);
+	while (1) {
+		nfound = 0;
+		dotmin = (rad >= PI) ? -2. : cos(rad);
+		ib0 = (int)floor((thetaext - rad - tol)/hsb.bandDTheta);
+		ib1 = (int)floor((thetaext + rad + tol)/hsb.bandDTheta);
+		if (ib0 < 0) ib0 = 0;
+		if (ib1 >= hsb.nBands) ib1 = hsb.nBands - 1;
+		//	half-width in phi of the cap, unless it contains a pole
+		allphi = ((thetaext - rad) <= tol) || ((thetaext + rad) >= PI - tol);
+		dphi = allphi ? PI : asin(min(sin(rad)/sin(thetaext),1.)) + tol;
+		for (ib=ib0; ib<=ib1; ib++) {
+			nphi = hsb.bandNPhi[ib];
+			is0 = (int)floor((phiext - dphi)*nphi/(2*PI));
+			is1 = (int)floor((phiext + dphi)*nphi/(2*PI));
+			if (allphi || (is1 - is0 + 1 >= nphi)) {
+				is0 = 0;
+				is1 = nphi - 1;
+			}
+			for (is=is0; is<=is1; is++) {
+				icell = hsb.bandCell0[ib] + ((is % nphi) + nphi) % nphi;
+				for (kk=hsb.cellStart[icell]; kk<hsb.cellStart[icell+1]; kk++) {
+					jj = hsb.cellIndx[kk];
+					if (jj >= N) continue;
+					dotjj = BGL::dot(dirext,hsb.dirList[jj]);
+					if (dotjj <= dotmin) continue;
+					if ((nfound == nnear) && (dotjj <= adist[nnear-1])) continue;
+					//	sorted insertion by decreasing dot (i.e. increasing arcdist)
+					ins = (nfound < nnear) ? nfound++ : nnear - 1;
+					while ((ins > 0) && (adist[ins-1] < dotjj)) {
+						adist[ins] = adist[ins-1];
+						indx[ins] = indx[ins-1];
+						ins--;
+					}
+					adist[ins] = dotjj;
+					indx[ins] = jj;
 				}
-				//	then insert new stuff in array at position kk
-				distmin[kk] = dist;
-				distminindx[kk] = jj;
 			}
 		}
+		if ((nfound == nnear) || (rad >= admax)) break;
+		rad = min(admax,2*rad);
 	}
-	return distminindx;
 
+	//	convert dot products to arcdist (as arcdist() does)
+	for (kk=0; kk<nfound; kk++) adist[kk] = acos(max(min(adist[kk],1.),-1.));
+
+	return nfound;
 }
 
 int	HemiSphiral::nearestc(Double admax, BGL::vector3 dirext, vector<struct nearestdata>& nd)
@@ -555,26 +703,33 @@ Double	HemiSphiral::interp(Double phiext, Double thetaext)
 
 Double	HemiSphiral::interp(BGL::vector3 dirext)
 {
-
-	vector<int>		nearestindx;
-	vector<struct nearestdata> nd;
+	int		indx[HS_MAX_INTERP];
+	Double	weights[HS_MAX_INTERP];
 
 	//	1.5*DA will always generate about 8 positions (????),
 	//	independent of N
 //	nearestindx = nearestc(2.0*DA,dirext);
-	int	nnsize = nearestc(2.0*DA,dirext, nd);
-	if (nnsize == 0) return 0;
-
-	vector<Double> weights = ::interpwgts(dirext,nd);
+	int	nwgts = interpwgts(dirext,2.0*DA,indx,weights);
+	if (nwgts == 0) return 0;
 
 	Double interpval = 0;
-	for (int ii=0; ii<(int)weights.size(); ii++) {
-		interpval += weights[ii]*valList[nd[ii].indx];
+	for (int ii=0; ii<nwgts; ii++) {
+		interpval += weights[ii]*valList[indx[ii]];
 	}
 
 	return interpval;
 }
 
+int	HemiSphiral::interpwgts(BGL::vector3 dirext, Double admax, int indx[HS_MAX_INTERP], Double wgts[HS_MAX_INTERP])
+//	inverse arcdist interpolation weights of the (up to HS_MAX_INTERP) nearest points
+//	with arcdist < admax; no heap allocation.  returns the number of weights
+{
+	Double	adist[HS_MAX_INTERP];
+
+	int	nsize = nearestk(dirext,HS_MAX_INTERP,admax,indx,adist);
+	return ::interpwgts(nsize,adist,wgts);
+}
+
 //vector<Double>	HemiSphiral::interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd)
 vector<Double>	interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd)
 {
@@ -589,7 +744,7 @@ vector<Double>	interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd)
 		weights.push_back(1);
 		return weights;
 	}
-	if (size > 4) size = 4;	//	max of 4 nearest points used for interpolation
+	if (size > HS_MAX_INTERP) size = HS_MAX_INTERP;	//	max of 4 nearest points used for interpolation
 	weights.resize(size,0);
 	vector<Double> adist(size,0);
 	vector<Double> adistinverse(size,0);
@@ -607,13 +762,40 @@ vector<Double>	interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd)
 	return weights;
 }
 
+//	NOTE:  NOT member of HemiSphiral::
+//	array version of interpwgts() for the (up to HS_MAX_INTERP) sorted arcdists in adist[]
+int	interpwgts(int nsize, Double* adist, Double wgts[HS_MAX_INTERP])
+{
+	//	avoids singularity if dirext == dir(ii)
+	Double epsilon = MAXPointTol;	//	tunable parameter
+
+	if (nsize <= 0) return 0;
+	if (nsize == 1) {
+		wgts[0] = 1;
+		return 1;
+	}
+	if (nsize > HS_MAX_INTERP) nsize = HS_MAX_INTERP;	//	max of 4 nearest points used for interpolation
+	Double	sum = 0;
+	int ii;
+	for (ii=0; ii<nsize; ii++) {
+		wgts[ii] = 1/max(epsilon,adist[ii]);
+		sum += wgts[ii];
+	}
+	for (ii=0; ii<nsize; ii++) {
+		wgts[ii] = wgts[ii] / sum;
+	}
+
+	return nsize;
+}
+
 vector<Double>	HemiSphiral::interpwgts(BGL::vector3 dirext)
 {
-	vector<struct nearestdata> nd;
-	int	nnsize = nearestc(1.5*DA,dirext, nd);
+	int		indx[HS_MAX_INTERP];
+	Double	wgts[HS_MAX_INTERP];
 
 //	return interpwgts(dirext,nearestc(1.5*DA,dirext));	
-	return ::interpwgts(dirext,nd);	
+	int	nwgts = interpwgts(dirext,1.5*DA,indx,wgts);
+	return vector<Double>(wgts,wgts+nwgts);
 }
 
 Double		HemiSphiral::TotIllum()
@@ -744,7 +926,7 @@ ifstream&	HemiSphiral::load(ifstream& infile)
 {
     HemiSphiral    result;
     Char    c;
-	ostrstream osstream;
+	ostringstream osstream;
 
 	// Expected format: {double0 double1 ... doubleN}
 	
@@ -752,7 +934,7 @@ ifstream&	HemiSphiral::load(ifstream& infile)
 	if (infile.eof()) return(infile);
 	if (infile.fail()) {
 		osstream << "HemiSphiral:ReadError1: unrecoverable failbit\n";
-	    writewndo(osstream.str(),"e");
+	    writewndo(osstream.str().c_str(),"e");
 		return(infile);
 	}
 		
@@ -760,12 +942,13 @@ ifstream&	HemiSphiral::load(ifstream& infile)
 		infile.putback(c);
 	    infile.clear(ios::failbit);
 		osstream << "HemiSphiral:ReadError2: Expected '{' - got \'" << c << "\'" << "\n";
-	    writewndo(osstream.str(),"e");
+	    writewndo(osstream.str().c_str(),"e");
 	    return(infile);
 	}
 	//	else ...
 	Double data;
 	vector<Double> dataList;
+	dataList.reserve(N);	//	datasets of a file usually all have the size of the one loaded before
 	while (infile >> data) dataList.push_back(data);
 	infile.clear();
 
@@ -774,14 +957,14 @@ ifstream&	HemiSphiral::load(ifstream& infile)
 		infile.putback(c);
     	infile.clear(ios::failbit);
 	    osstream << "HemiSphiral:ReadError3: Expected '}' - got \'" << c << "\'" << "\n";
-	    writewndo(osstream.str(),"e");
+	    writewndo(osstream.str().c_str(),"e");
 	    return(infile);
     }
 
 	if (dataList.size() == 0) {
     	infile.clear(ios::failbit);
 	    osstream << "HemiSphiral:ReadError4: dataList empty" << "\n";
-	    writewndo(osstream.str(),"e");
+	    writewndo(osstream.str().c_str(),"e");
 	    return(infile);
 	}
 
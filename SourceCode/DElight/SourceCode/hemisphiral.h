@@ -28,6 +28,10 @@ LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
 INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE 
 WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
 */
+#include <memory>
+
+#define	HS_MAX_INTERP	4	//	max # of nearest points used for interpolation
+
 struct	nearestdata
 {
 	int		indx;	//	index
@@ -35,6 +39,37 @@ struct	nearestdata
 
 };
 
+//	immutable per-point tables of one (N, zMin) spiral, shared by reference by
+//	every HemiSphiral of that resolution; get them from HSBasisGet()
+struct HSBasis
+{
+	int		N;
+	Double	zMin;
+	Double	deltaz;
+	Double	omega;	//	solid angle of each point (all points are equal area)
+	Double	DA;
+	Double	pitch;
+
+	vector<BGL::vector3>	dirList;	//	dir(ii) of each point
+	vector<Double>	cosList;	//	costheta(ii) of each point
+	vector<Double>	thetaList;	//	theta(ii) of each point
+
+	//	grid-bucket index for nearest point searches:
+	//	bands of equal theta, each split into phi sectors of about DA x DA
+	int		nBands;			//	number of theta bands
+	Double	bandDTheta;		//	theta band width
+	vector<int>	bandNPhi;	//	number of phi sectors in each band
+	vector<int>	bandCell0;	//	index of first cell of each band (nBands+1 entries)
+	vector<int>	cellStart;	//	start of each cell in cellIndx (ncells+1 entries)
+	vector<int>	cellIndx;	//	point indexes sorted by cell
+
+	HSBasis(int, Double);
+	void	initIndex();
+	int		cellOfDir(BGL::vector3) const;
+};
+
+std::shared_ptr<const HSBasis>	HSBasisGet(int N, Double zMin);
+
 struct HemiSphiral
 {
 	vector<Double>	valList;
@@ -45,12 +80,15 @@ struct HemiSphiral
 	Double	DA;
 	Double	pitch;
 
+	std::shared_ptr<const HSBasis>	pbasis;	//	shared direction tables and index, set by init()
+
 	HemiSphiral();
 	HemiSphiral(Double);
 	HemiSphiral(int);
 	HemiSphiral(Double, int);
 	HemiSphiral(Double, vector<Double>&);
 	void	init();
+	bool	hasBasis(int ii) const {return pbasis && (ii>=0) && (ii<N) && (ii<pbasis->N);}
 
     Double&        operator [] (int ii);
     const Double&  operator [] (int ii) const;
@@ -71,6 +109,7 @@ struct HemiSphiral
 	Double	x2D(int);
 	Double	y2D(int);
 	BGL::vector3	dir(int);
+	BGL::vector3	dirCalc(int);
 
     HemiSphiral&	operator += (const HemiSphiral&	hs);
     HemiSphiral&	operator -= (const HemiSphiral&	hs);
@@ -89,6 +128,8 @@ struct HemiSphiral
 	vector<int>		nearestn(int,BGL::vector3);
 	int				nearestc(Double admax, BGL::vector3 dirext, vector<struct nearestdata>& nd);
 	int				rowsearch(int jjstart, Double admax, BGL::vector3 dirext, vector<int>&, vector<Double>&);
+	int				nearestk(BGL::vector3 dirext, int nnear, Double admax, int* indx, Double* adist);
+	int				interpwgts(BGL::vector3 dirext, Double admax, int indx[HS_MAX_INTERP], Double wgts[HS_MAX_INTERP]);
 //	vector<Double>	interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd);
 	vector<Double>	interpwgts(BGL::vector3);
 	Double			interp(BGL::vector3);
@@ -121,4 +162,5 @@ inline const Double& HemiSphiral::operator [] (int ii) const
 Double	arcdist(BGL::vector3 dir1, BGL::vector3 dir2);
 
 vector<Double>	interpwgts(BGL::vector3 dirext, vector<struct nearestdata>& nd);
+int				interpwgts(int nsize, Double* adist, Double wgts[HS_MAX_INTERP]);
 //vector<Double>	interpwgts(BGL::vector3);
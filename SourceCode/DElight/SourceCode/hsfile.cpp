@@ -0,0 +1,381 @@
+// hsfile.cpp
+//
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+/**************************************************************
+ * C Language Implementation of DOE2.1d and Superlite 3.0
+ * Daylighting Algorithms with new Complex Fenestration System
+ * analysis algorithms.
+ *
+ * The original DOE2 daylighting algorithms and implementation
+ * in FORTRAN were developed by F.C. Winkelmann at the
+ * Lawrence Berkeley National Laboratory.
+ *
+ * The original Superlite algorithms and implementation in FORTRAN
+ * were developed by Michael Modest and Jong-Jin Kim
+ * under contract with Lawrence Berkeley National Laboratory.
+ **************************************************************/
+
+// This work was supported by the Assistant Secretary for Energy Efficiency 
+// and Renewable Energy, Office of Building Technologies, 
+// Building Systems and Materials Division of the 
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf 
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce, 
+prepare derivative works, and perform publicly and display publicly. 
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself 
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to 
+the public, perform publicly and display publicly, and to permit others to do so. 
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL 
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY 
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE 
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+#pragma warning(disable:4786)
+
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sys/stat.h>
+#ifdef _WIN32
+#define	NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+using namespace std;
+
+// BGLincludes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "hsfile.h"
+
+// writewndo() Error handler include
+#include "DElightManagerC.h"
+
+//	read-only view of a whole file: memory mapped where possible, else read into a buffer
+struct HSFileView
+{
+	const char*	pdata;
+	size_t		nbytes;
+	vector<char>	buf;
+#ifdef _WIN32
+	HANDLE	hFile;
+	HANDLE	hMap;
+#else
+	void*	pmap;
+#endif
+
+	HSFileView();
+	~HSFileView();
+	bool	open(const string& filename);
+};
+
+HSFileView::HSFileView()
+: pdata(0), nbytes(0)
+#ifdef _WIN32
+, hFile(INVALID_HANDLE_VALUE), hMap(NULL)
+#else
+, pmap(MAP_FAILED)
+#endif
+{ }
+
+HSFileView::~HSFileView()
+{
+#ifdef _WIN32
+	if (pdata && buf.empty()) UnmapViewOfFile(pdata);
+	if (hMap != NULL) CloseHandle(hMap);
+	if (hFile != INVALID_HANDLE_VALUE) CloseHandle(hFile);
+#else
+	if (pmap != MAP_FAILED) munmap(pmap,nbytes);
+#endif
+}
+
+bool	HSFileView::open(const string& filename)
+{
+	struct stat	statFile;
+	if ((stat(filename.c_str(),&statFile) != 0) || (statFile.st_size <= 0)) return false;
+	nbytes = (size_t)statFile.st_size;
+
+#ifdef _WIN32
+	hFile = CreateFileA(filename.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,NULL);
+	if (hFile != INVALID_HANDLE_VALUE) hMap = CreateFileMappingA(hFile,NULL,PAGE_READONLY,0,0,NULL);
+	if (hMap != NULL) pdata = (const char*)MapViewOfFile(hMap,FILE_MAP_READ,0,0,0);
+#else
+	int	fd = ::open(filename.c_str(),O_RDONLY);
+	if (fd >= 0) {
+		pmap = mmap(0,nbytes,PROT_READ,MAP_PRIVATE,fd,0);
+		close(fd);
+		if (pmap != MAP_FAILED) pdata = (const char*)pmap;
+	}
+#endif
+	if (pdata) return true;
+
+	//	mapping not available: read the file
+	ifstream	infile(filename.c_str(), ios::in | ios::binary);
+	buf.resize(nbytes);
+	if (!infile.read(&buf[0],nbytes)) return false;
+	pdata = &buf[0];
+	return true;
+}
+
+//	64 bit FNV-1a hash of nbytes bytes, continued from hash
+static unsigned long long	HSBinHash(unsigned long long hash, const char* pbytes, size_t nbytes)
+{
+	for (size_t ic=0; ic<nbytes; ic++) {
+		hash ^= (unsigned char)pbytes[ic];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+static size_t	HSBinIndxBytes(int nIndx)
+{
+	return (((size_t)nIndx*sizeof(int) + 7)/8)*8;
+}
+
+//	checks a mapped binary file; on success points pindx and pvals at its DataIndx and values
+static bool	HSBinCheck(const HSFileView& view, const string& filename, HSBinHeader& hdr, const int*& pindx, const double*& pvals)
+{
+	string	errmsg;
+
+	if (view.nbytes < sizeof(HSBinHeader)) errmsg = "truncated header";
+	else {
+		memcpy(&hdr,view.pdata,sizeof(HSBinHeader));
+		if (memcmp(hdr.magic,HSBIN_MAGIC,sizeof(hdr.magic)) != 0) errmsg = "bad magic number";
+		else if (hdr.version != HSBIN_VERSION) errmsg = "unsupported version or byte order";
+		else if ((hdr.nrows <= 0) || (hdr.N <= 0) || (hdr.nIndx < 0)) errmsg = "bad sizes";
+		else if (view.nbytes != sizeof(HSBinHeader) + HSBinIndxBytes(hdr.nIndx) + (size_t)hdr.nrows*hdr.N*sizeof(double)) errmsg = "file size does not match header";
+		else if (HSBinHash(14695981039346656037ULL,view.pdata + sizeof(HSBinHeader),view.nbytes - sizeof(HSBinHeader)) != hdr.checksum) errmsg = "checksum mismatch";
+	}
+	if (!errmsg.empty()) {
+		errmsg = "HSBinary: " + filename + ": " + errmsg + "\n";
+		writewndo(errmsg.c_str(),"e");
+		return false;
+	}
+	pindx = (const int*)(view.pdata + sizeof(HSBinHeader));
+	pvals = (const double*)(view.pdata + sizeof(HSBinHeader) + HSBinIndxBytes(hdr.nIndx));
+	return true;
+}
+
+//	fills rows from nrows*N mapped values
+static void	HSBinRows(const HSBinHeader& hdr, const double* pvals, vector<HemiSphiral>& rows)
+{
+	rows.assign(hdr.nrows,HemiSphiral(hdr.zMin));
+	for (int ii=0; ii<hdr.nrows; ii++) {
+		rows[ii].valList.assign(pvals + (size_t)ii*hdr.N,pvals + (size_t)(ii+1)*hdr.N);
+		rows[ii].N = hdr.N;
+		rows[ii].init();
+	}
+}
+
+//	writes a binary file from rows and DataIndx
+static bool	HSBinSave(const string& filename, int kind, int Isym, const vector<int>& indx, vector<HemiSphiral>& rows)
+{
+	HSBinHeader	hdr;
+	int		ii;
+
+	if (rows.empty()) return false;
+	memset(&hdr,0,sizeof(hdr));
+	memcpy(hdr.magic,HSBIN_MAGIC,sizeof(hdr.magic));
+	hdr.version = HSBIN_VERSION;
+	hdr.kind = kind;
+	hdr.nrows = (int)rows.size();
+	hdr.N = rows[0].size();
+	hdr.Isym = Isym;
+	hdr.nIndx = (int)indx.size();
+	hdr.zMin = rows[0].zMin;
+	for (ii=0; ii<hdr.nrows; ii++) {
+		if (rows[ii].size() != hdr.N) return false;
+	}
+
+	vector<char>	vIndx(HSBinIndxBytes(hdr.nIndx),0);
+	if (hdr.nIndx > 0) memcpy(&vIndx[0],&indx[0],hdr.nIndx*sizeof(int));
+	hdr.checksum = HSBinHash(14695981039346656037ULL,vIndx.empty() ? 0 : &vIndx[0],vIndx.size());
+	for (ii=0; ii<hdr.nrows; ii++) {
+		hdr.checksum = HSBinHash(hdr.checksum,(const char*)&rows[ii].valList[0],hdr.N*sizeof(double));
+	}
+
+	ofstream	outfile(filename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (!outfile) return false;
+	outfile.write((const char*)&hdr,sizeof(hdr));
+	if (!vIndx.empty()) outfile.write(&vIndx[0],vIndx.size());
+	for (ii=0; ii<hdr.nrows; ii++) {
+		outfile.write((const char*)&rows[ii].valList[0],hdr.N*sizeof(double));
+	}
+	return !outfile.fail();
+}
+
+bool	HSFileIsBinary(const string& filename)
+{
+	char	magic[8];
+	ifstream	infile(filename.c_str(), ios::in | ios::binary);
+	return (infile.read(magic,sizeof(magic)) && (memcmp(magic,HSBIN_MAGIC,sizeof(magic)) == 0));
+}
+
+btdf*	btdfLoadFile(const string& filename)
+{
+	if (!HSFileIsBinary(filename)) {
+		ifstream	infile(filename.c_str());
+		if (!infile) return 0;
+		return btdfLoad(infile);
+	}
+
+	HSFileView	view;
+	HSBinHeader	hdr;
+	const int*	pindx;
+	const double*	pvals;
+	if (!view.open(filename) || !HSBinCheck(view,filename,hdr,pindx,pvals)) return 0;
+
+	if (hdr.kind == HSBIN_BTDFHS)	{
+		btdfHS*	pbtdf0 = new btdfHS;
+		pbtdf0->btdftype = "HS";
+		HSBinRows(hdr,pvals,pbtdf0->HSoutList);
+		//	init HSin
+		pbtdf0->HSin = HemiSphiral(pbtdf0->size());
+		pbtdf0->HSin.init();
+		pbtdf0->packMatrix();
+		return pbtdf0;
+	}
+	else if (hdr.kind == HSBIN_BTDFTRGZ)	{
+		btdfTrgz*	pbtdf0 = new btdfTrgz;
+		pbtdf0->btdftype = "TRGZ";
+		if (hdr.nIndx != pbtdf0->Trgz0.NTrgz()) {
+			delete pbtdf0;
+			string errmsg = "btdf::load: infile nTrgz <-> pbtdf0->NTrgz() mismatch\n";
+			writewndo(errmsg.c_str(),"e");
+			return 0;
+		}
+		pbtdf0->Isym = hdr.Isym;
+		pbtdf0->DataIndx.assign(pindx,pindx + hdr.nIndx);
+		HSBinRows(hdr,pvals,pbtdf0->HSoutList);
+		pbtdf0->packMatrix();
+		return pbtdf0;
+	}
+	string errmsg = "btdf::load: " + filename + " is not a btdf data file\n";
+	writewndo(errmsg.c_str(),"e");
+	return 0;
+}
+
+bool	HemiSphiralLoadFile(const string& filename, HemiSphiral& hs)
+{
+	if (!HSFileIsBinary(filename)) {
+		ifstream	infile(filename.c_str());
+		if (!infile) return false;
+		return !hs.load(infile).fail();
+	}
+
+	HSFileView	view;
+	HSBinHeader	hdr;
+	const int*	pindx;
+	const double*	pvals;
+	if (!view.open(filename) || !HSBinCheck(view,filename,hdr,pindx,pvals)) return false;
+	if ((hdr.kind != HSBIN_LUMMAP) || (hdr.nrows != 1)) {
+		string errmsg = "HemiSphiral: " + filename + " is not a luminance map data file\n";
+		writewndo(errmsg.c_str(),"e");
+		return false;
+	}
+	vector<HemiSphiral>	rows;
+	HSBinRows(hdr,pvals,rows);
+	hs = rows[0];
+	return true;
+}
+
+bool	btdfSaveBinary(const string& filename, btdf* pbtdf0)
+{
+	if (pbtdf0 == 0) return false;
+	if (pbtdf0->type() == "TRGZ") {
+		btdfTrgz*	pbtdfTrgz = (btdfTrgz*)pbtdf0;
+		return HSBinSave(filename,HSBIN_BTDFTRGZ,pbtdfTrgz->Isym,pbtdfTrgz->DataIndx,pbtdf0->HSoutList);
+	}
+	return HSBinSave(filename,HSBIN_BTDFHS,0,vector<int>(),pbtdf0->HSoutList);
+}
+
+bool	HemiSphiralSaveBinary(const string& filename, HemiSphiral& hs)
+{
+	vector<HemiSphiral>	rows(1,hs);
+	return HSBinSave(filename,HSBIN_LUMMAP,0,vector<int>(),rows);
+}
+
+//	process-wide file cache: an entry is reused while the file keeps its size and modification time
+template <class T>
+struct HSFileCache
+{
+	struct Entry
+	{
+		long long	size;
+		long long	mtime;
+		shared_ptr<T>	pdata;
+	};
+	mutex	mtx;
+	map<string,Entry>	mapEntry;
+
+	template <class LoadFn>
+	shared_ptr<T>	get(const string& filename, LoadFn load)
+	{
+		struct stat	statFile;
+		if (stat(filename.c_str(),&statFile) != 0) return shared_ptr<T>();
+		{
+			lock_guard<mutex> lock(mtx);
+			typename map<string,Entry>::iterator	it = mapEntry.find(filename);
+			if ((it != mapEntry.end()) && (it->second.size == (long long)statFile.st_size) && (it->second.mtime == (long long)statFile.st_mtime))
+				return it->second.pdata;
+		}
+		//	load outside the lock; a replaced entry stays alive for the systems still using it
+		Entry	entry;
+		entry.size = (long long)statFile.st_size;
+		entry.mtime = (long long)statFile.st_mtime;
+		entry.pdata = load(filename);
+		if (!entry.pdata) return entry.pdata;
+		lock_guard<mutex> lock(mtx);
+		mapEntry[filename] = entry;
+		return entry.pdata;
+	}
+};
+
+static shared_ptr<btdf>	btdfCacheLoad(const string& filename)
+{
+	return shared_ptr<btdf>(btdfLoadFile(filename));
+}
+
+static shared_ptr<const HemiSphiral>	HemiSphiralCacheLoad(const string& filename)
+{
+	shared_ptr<HemiSphiral>	phs(new HemiSphiral);
+	if (!HemiSphiralLoadFile(filename,*phs)) return shared_ptr<const HemiSphiral>();
+	return phs;
+}
+
+shared_ptr<btdf>	btdfCacheGet(const string& filename)
+{
+	static HSFileCache<btdf>	cache;
+	return cache.get(filename,btdfCacheLoad);
+}
+
+shared_ptr<const HemiSphiral>	HemiSphiralCacheGet(const string& filename)
+{
+	static HSFileCache<const HemiSphiral>	cache;
+	return cache.get(filename,HemiSphiralCacheLoad);
+}
@@ -0,0 +1,70 @@
+//	hsfile.h
+// =================================================================================
+// Copyright 1992-2009	Regents of University of California
+//						Lawrence Berkeley National Laboratory
+
+//  Authors: W.L. Carroll and R.J. Hitchcock
+//           Building Technologies Department
+//           Lawrence Berkeley National Laboratory
+
+// This work was supported by the Assistant Secretary for Energy Efficiency 
+// and Renewable Energy, Office of Building Technologies, 
+// Building Systems and Materials Division of the 
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+// NOTICE: The Government is granted for itself and others acting on its behalf 
+// a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce, 
+// prepare derivative works, and perform publicly and display publicly. 
+// Beginning five (5) years after (date permission to assert copyright was obtained),
+// subject to two possible five year renewals, the Government is granted for itself 
+// and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+// license in this data to reproduce, prepare derivative works, distribute copies to 
+// the public, perform publicly and display publicly, and to permit others to do so. 
+// NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+// THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL 
+// LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY 
+// INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE 
+// WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+// =================================================================================
+
+//	HemiSphiral and btdf data files: the brace-delimited text format read by HemiSphiral::load()
+//	and btdfLoad(), and a binary format with the same content that is memory mapped for loading.
+//
+//	binary file layout (native byte order; version HSBIN_VERSION):
+//		HSBinHeader
+//		nIndx ints of btdfTrgz DataIndx, padded with zeros to a multiple of 8 bytes
+//		nrows*N doubles, the values of each HemiSphiral in turn
+//	checksum is the 64 bit FNV-1a hash of everything after the header
+
+#define	HSBIN_MAGIC		"DLHSBIN"
+#define	HSBIN_VERSION	1
+
+enum {HSBIN_LUMMAP = 0, HSBIN_BTDFHS = 1, HSBIN_BTDFTRGZ = 2};	//	HSBinHeader kinds
+
+struct HSBinHeader
+{
+	char	magic[8];	//	HSBIN_MAGIC
+	int		version;	//	HSBIN_VERSION
+	int		kind;		//	HSBIN_LUMMAP, HSBIN_BTDFHS or HSBIN_BTDFTRGZ
+	int		nrows;		//	# of HemiSphirals (1 for a luminance map, else # of btdf input dirs)
+	int		N;			//	# of values of each HemiSphiral
+	int		Isym;		//	btdfTrgz symmetry (0 otherwise)
+	int		nIndx;		//	# of btdfTrgz DataIndx entries (0 otherwise)
+	double	zMin;		//	HemiSphiral zMin
+	unsigned long long	checksum;
+};
+
+bool	HSFileIsBinary(const string& filename);
+
+//	file loads: binary or text format, by content; errors go to writewndo()
+btdf*	btdfLoadFile(const string& filename);
+bool	HemiSphiralLoadFile(const string& filename, HemiSphiral& hs);
+
+//	binary file saves; return false if the file cannot be written
+bool	btdfSaveBinary(const string& filename, btdf* pbtdf0);
+bool	HemiSphiralSaveBinary(const string& filename, HemiSphiral& hs);
+
+//	process-wide caches of loaded files, keyed by path, size and modification time,
+//	so every CFS system using a data file shares one read-only copy; NULL if the file cannot be loaded
+std::shared_ptr<btdf>	btdfCacheGet(const string& filename);
+std::shared_ptr<const HemiSphiral>	HemiSphiralCacheGet(const string& filename);
@@ -0,0 +1,121 @@
+// hsfile_convert.cpp
+//
+/* Copyright 1992-2009	Regents of University of California
+ *						Lawrence Berkeley National Laboratory
+ *
+ *  Authors: R.J. Hitchcock and W.L. Carroll
+ *           Building Technologies Department
+ *           Lawrence Berkeley National Laboratory
+ */
+
+// This work was supported by the Assistant Secretary for Energy Efficiency
+// and Renewable Energy, Office of Building Technologies,
+// Building Systems and Materials Division of the
+// U.S. Department of Energy under Contract No. DE-AC03-76SF00098.
+
+/*
+NOTICE: The Government is granted for itself and others acting on its behalf
+a paid-up, nonexclusive, irrevocable worldwide license in this data to reproduce,
+prepare derivative works, and perform publicly and display publicly.
+Beginning five (5) years after (date permission to assert copyright was obtained),
+subject to two possible five year renewals, the Government is granted for itself
+and others acting on its behalf a paid-up, nonexclusive, irrevocable worldwide
+license in this data to reproduce, prepare derivative works, distribute copies to
+the public, perform publicly and display publicly, and to permit others to do so.
+NEITHER THE UNITED STATES NOR THE UNITED STATES DEPARTMENT OF ENERGY, NOR ANY OF
+THEIR EMPLOYEES, MAKES ANY WARRANTY, EXPRESS OR IMPLIED, OR ASSUMES ANY LEGAL
+LIABILITY OR RESPONSIBILITY FOR THE ACCURACY, COMPLETENESS, OR USEFULNESS OF ANY
+INFORMATION, APPARATUS, PRODUCT, OR PROCESS DISCLOSED, OR REPRESENTS THAT ITS USE
+WOULD NOT INFRINGE PRIVATELY OWNED RIGHTS.
+*/
+
+
+//	Converts CFS btdf and luminance map data files between the brace-delimited text format
+//	and the memory mapped binary format of hsfile.h. Build against the DElight sources, e.g.
+//		g++ -O2 -DHAS_ISNAN -I../SourceCode hsfile_convert.cpp ../SourceCode/*.cpp ../SourceCode/*.CPP -lpthread
+//	then run
+//		hsfile_convert btdf|lummap infile outfile
+//	A text infile is written as binary, a binary infile as text.
+
+#pragma warning(disable:4786)
+
+#include <stdlib.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+using namespace std;
+
+// BGLincludes
+#include "BGL.h"
+namespace BGL = BldgGeomLib;
+
+#include "helpers.h"
+#include "hemisphiral.h"
+#include "btdf.h"
+#include "hsfile.h"
+
+//	text btdf file: 1st line "HS" or "TRGZ,nTrgz,Isym", 2nd line DataIndx for TRGZ, then the output HemiSphirals
+static bool	btdfSaveText(const string& filename, btdf* pbtdf0)
+{
+	ofstream	outfile(filename.c_str());
+	if (!outfile) return false;
+	outfile.precision(17);
+	if (pbtdf0->type() == "TRGZ") {
+		btdfTrgz*	pbtdfTrgz = (btdfTrgz*)pbtdf0;
+		outfile << "TRGZ," << pbtdfTrgz->Trgz0.NTrgz() << "," << pbtdfTrgz->Isym << "\n";
+		for (int ii=0; ii<(int)pbtdfTrgz->DataIndx.size(); ii++) outfile << (ii ? "," : "") << pbtdfTrgz->DataIndx[ii];
+		outfile << "\n";
+	}
+	else outfile << "HS\n";
+	pbtdf0->btdf::save(outfile);
+	return !outfile.fail();
+}
+
+int	main(int argc, char** argv)
+{
+	if ((argc != 4) || ((string(argv[1]) != "btdf") && (string(argv[1]) != "lummap"))) {
+		cerr << "usage: hsfile_convert btdf|lummap infile outfile\n";
+		return 1;
+	}
+	string	sKind = argv[1];
+	string	sIn = argv[2];
+	string	sOut = argv[3];
+	bool	bToBinary = !HSFileIsBinary(sIn);
+	bool	bOk = false;
+
+	try {
+		if (sKind == "btdf") {
+			unique_ptr<btdf>	pbtdf0(btdfLoadFile(sIn));
+			if (!pbtdf0) {
+				cerr << "hsfile_convert: cannot load " << sIn << "\n";
+				return 1;
+			}
+			bOk = bToBinary ? btdfSaveBinary(sOut,pbtdf0.get()) : btdfSaveText(sOut,pbtdf0.get());
+		}
+		else {
+			HemiSphiral	hs;
+			if (!HemiSphiralLoadFile(sIn,hs)) {
+				cerr << "hsfile_convert: cannot load " << sIn << "\n";
+				return 1;
+			}
+			if (bToBinary) bOk = HemiSphiralSaveBinary(sOut,hs);
+			else {
+				ofstream	outfile(sOut.c_str());
+				outfile.precision(17);
+				bOk = !hs.save(outfile).fail();
+			}
+		}
+	}
+	catch (...) {
+		cerr << "hsfile_convert: cannot load " << sIn << " (see the DElight error file)\n";
+		return 1;
+	}
+	if (!bOk) {
+		cerr << "hsfile_convert: cannot write " << sOut << "\n";
+		return 1;
+	}
+	cout << sIn << " -> " << sOut << (bToBinary ? " (binary)\n" : " (text)\n");
+	return 0;
+}
@@ -143,6 +143,84 @@ INTERFACE
     END SUBROUTINE
 END INTERFACE
 
+INTERFACE
+    SUBROUTINE DElightZoneIndex (iNameLength, cZoneName, iZoneIndex, iErrorFlag)
+
+        ! SUBROUTINE INFORMATION:
+        !       AUTHOR         na
+        !       DATE WRITTEN   October 2026
+        !       MODIFIED       na
+        !       RE-ENGINEERED  na
+
+        ! PURPOSE OF THIS SUBROUTINE:
+        !       Interface to DElight DLL for routine that
+        !       Resolves a Zone name to the DElight zone index passed to DElightElecLtgCtrlZone.
+
+        ! METHODOLOGY EMPLOYED:
+        ! Called once per zone so the timestep call does no name lookup.
+
+        !DEC$ ATTRIBUTES C :: DElightZoneIndex
+        ! parameters have the VALUE attribute by default because
+        ! the subroutine has the C attribute
+        INTEGER iNameLength
+        CHARACTER(len=*) cZoneName
+        !DEC$ ATTRIBUTES REFERENCE :: cZoneName
+        ! pass character strings by reference
+        INTEGER iZoneIndex
+        !DEC$ ATTRIBUTES REFERENCE :: iZoneIndex
+        ! pass return value for iZoneIndex by reference
+        INTEGER iErrorFlag
+        !DEC$ ATTRIBUTES REFERENCE :: iErrorFlag
+        ! pass return value for iErrorFlag by reference
+    END SUBROUTINE
+END INTERFACE
+
+INTERFACE
+    SUBROUTINE DElightElecLtgCtrlZone (iZoneIndex, dBldgLat, &
+                                dHISKF, dHISUNF, dCloudFraction, dSOLCOSX, dSOLCOSY, dSOLCOSZ, &
+                                pdPowerReducFac, pdRefPtIllum, iMaxRefPts, iErrorFlag)
+
+        ! SUBROUTINE INFORMATION:
+        !       AUTHOR         na
+        !       DATE WRITTEN   October 2026
+        !       MODIFIED       na
+        !       RE-ENGINEERED  na
+
+        ! PURPOSE OF THIS SUBROUTINE:
+        !       Interface to DElight DLL for routine that
+        !       Calculates Interior Daylight Illuminance at each reference point in the zone for given time step,
+        !       and Power Reduction Factor for electric lighting in response to Interior Daylight Illuminance.
+
+        ! METHODOLOGY EMPLOYED:
+        ! Same as DElightElecLtgCtrl, but the zone is given by its DElightZoneIndex handle and reference point
+        ! illuminances (lux) are returned in pdRefPtIllum. eplusout.delighteldmp is only written when
+        ! iErrorFlag is returned nonzero.
+        USE DataPrecisionGlobals
+
+        !DEC$ ATTRIBUTES C :: DElightElecLtgCtrlZone
+        ! parameters have the VALUE attribute by default because
+        ! the subroutine has the C attribute
+        INTEGER iZoneIndex
+        REAL(r64) :: dBldgLat
+        REAL(r64) :: dHISKF
+        REAL(r64) :: dHISUNF
+        REAL(r64) :: dCloudFraction
+        REAL(r64) :: dSOLCOSX
+        REAL(r64) :: dSOLCOSY
+        REAL(r64) :: dSOLCOSZ
+        REAL(r64) :: pdPowerReducFac
+        !DEC$ ATTRIBUTES REFERENCE :: pdPowerReducFac
+        ! pass return value for pdPowerReducFac by reference
+        REAL(r64), DIMENSION(*) :: pdRefPtIllum
+        !DEC$ ATTRIBUTES REFERENCE :: pdRefPtIllum
+        ! pass return values for pdRefPtIllum by reference
+        INTEGER iMaxRefPts
+        INTEGER iErrorFlag
+        !DEC$ ATTRIBUTES REFERENCE :: iErrorFlag
+        ! pass return value for iErrorFlag by reference
+    END SUBROUTINE
+END INTERFACE
+
 INTERFACE
     SUBROUTINE DElightFreeMemory ()
 
@@ -32,6 +32,8 @@ MODULE DELIGHTMANAGERF
     PUBLIC GenerateDElightDaylightCoefficients
     PUBLIC DElightDaylightCoefficients
     PUBLIC DElightElecLtgCtrl
+    PUBLIC DElightZoneIndex
+    PUBLIC DElightElecLtgCtrlZone
     PUBLIC DElightFreeMemory
     PUBLIC DElightOutputGenerator
     PUBLIC DElightInputGenerator
@@ -187,6 +189,94 @@ SUBROUTINE DElightElecLtgCtrl (iNameLength, cZoneName, dBldgLat, &
 
 END SUBROUTINE DElightElecLtgCtrl
 
+SUBROUTINE DElightZoneIndex (iNameLength, cZoneName, iZoneIndex, iErrorFlag)
+
+    ! SUBROUTINE INFORMATION:
+    !       AUTHOR         na
+    !       DATE WRITTEN   October 2026
+    !       MODIFIED       na
+    !       RE-ENGINEERED  na
+
+    ! PURPOSE OF THIS SUBROUTINE:
+    ! This subroutine does nothing but generate an error message when calls are made.
+
+    ! METHODOLOGY EMPLOYED:
+    ! na
+
+    ! REFERENCES:
+    ! na
+
+    ! USE STATEMENTS:
+    USE DataInterfaces, ONLY: ShowFatalError
+
+    IMPLICIT NONE    ! Enforce explicit typing of all variables in this routine
+
+    ! SUBROUTINE ARGUMENT DEFINITIONS:
+    ! na
+
+    ! SUBROUTINE PARAMETER DEFINITIONS:
+    INTEGER iNameLength
+    CHARACTER(len=*) cZoneName
+    INTEGER iZoneIndex
+    INTEGER iErrorFlag
+
+    ! SUBROUTINE LOCAL VARIABLE DECLARATIONS:
+
+    CALL ShowFatalError('DElight is not available in this version')
+
+    return
+
+END SUBROUTINE DElightZoneIndex
+
+SUBROUTINE DElightElecLtgCtrlZone (iZoneIndex, dBldgLat, &
+                            dHISKF, dHISUNF, dCloudFraction, dSOLCOSX, dSOLCOSY, dSOLCOSZ, &
+                            pdPowerReducFac, pdRefPtIllum, iMaxRefPts, iErrorFlag)
+
+    ! SUBROUTINE INFORMATION:
+    !       AUTHOR         na
+    !       DATE WRITTEN   October 2026
+    !       MODIFIED       na
+    !       RE-ENGINEERED  na
+
+    ! PURPOSE OF THIS SUBROUTINE:
+    ! This subroutine does nothing but generate an error message when calls are made.
+
+    ! METHODOLOGY EMPLOYED:
+    ! na
+
+    ! REFERENCES:
+    ! na
+
+    ! USE STATEMENTS:
+    USE DataInterfaces, ONLY: ShowFatalError
+
+    IMPLICIT NONE    ! Enforce explicit typing of all variables in this routine
+
+    ! SUBROUTINE ARGUMENT DEFINITIONS:
+    ! na
+
+    ! SUBROUTINE PARAMETER DEFINITIONS:
+    INTEGER iZoneIndex
+    REAL(r64) :: dBldgLat
+    REAL(r64) :: dHISKF
+    REAL(r64) :: dHISUNF
+    REAL(r64) :: dCloudFraction
+    REAL(r64) :: dSOLCOSX
+    REAL(r64) :: dSOLCOSY
+    REAL(r64) :: dSOLCOSZ
+    REAL(r64) :: pdPowerReducFac
+    REAL(r64), DIMENSION(*) :: pdRefPtIllum
+    INTEGER iMaxRefPts
+    INTEGER iErrorFlag
+
+    ! SUBROUTINE LOCAL VARIABLE DECLARATIONS:
+
+    CALL ShowFatalError('DElight is not available in this version')
+
+    return
+
+END SUBROUTINE DElightElecLtgCtrlZone
+
 SUBROUTINE DElightFreeMemory ()
 
     ! SUBROUTINE INFORMATION:
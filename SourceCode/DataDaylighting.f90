@@ -64,6 +64,7 @@ TYPE ZoneDaylightCalc
   INTEGER  :: AvailSchedNum             = 0    ! pointer to availability schedule if present
   INTEGER  :: TotalDaylRefPoints        = 0   ! Number of detailed daylighting reference points in a zone (0,1 or 2)
   INTEGER  :: TotalDElightRefPts        = 0   ! Number of DElight daylighting reference points in a zone (0,1 or 2) - RJH
+  INTEGER  :: DElightZoneIndex          = -1  ! DElight zone handle from DElightZoneIndex (-1 = not yet resolved)
   REAL(r64), ALLOCATABLE, DIMENSION(:,:) :: DaylRefPtAbsCoord ! =0.0 ! X,Y,Z coordinates of all daylighting reference points
                                                         ! in absolute coordinate system (m)
                                                         ! Points 1 and 2 are the control reference points
@@ -57,6 +57,8 @@ PUBLIC          ! By definition, all variables which are placed in this data
   CHARACTER(len=*),  PARAMETER :: cMinimalShadowing='MinimalShadowing'
   CHARACTER(len=*),  PARAMETER :: cNumThreads='OMP_NUM_THREADS'
   CHARACTER(len=*),  PARAMETER :: cepNumThreads='EP_OMP_NUM_THREADS'
+  CHARACTER(len=*),  PARAMETER :: cFMUNumThreads='EP_FMU_NUM_THREADS'  ! Threads to step FMU instances concurrently
+  CHARACTER(len=*),  PARAMETER :: cFMUCacheFolder='EP_FMU_CACHE'  ! Folder of the cache of unpacked FMUs
   CHARACTER(len=*),  PARAMETER :: cNumActiveSims='cntActv'
   CHARACTER(len=*),  PARAMETER :: cInputPath1='epin'  ! EP-Launch setting.  Full path + project name
   CHARACTER(len=*),  PARAMETER :: cInputPath2='input_path'  ! RunEplus.bat setting.  Full path
@@ -45,6 +45,7 @@
     LOGICAL, PUBLIC :: FlagReIni = .FALSE.                         ! Flag for reinitialization of states in GetSetAndDoStep
     CHARACTER(len=10*MaxNameLength) :: FMURootWorkingFolder = ' '  ! FMU root working folder
     INTEGER ::LEN_FMU_ROOT_DIR
+    INTEGER :: NumFMUThreads = 1   ! Number of threads to step FMU instances, instances are stepped concurrently if > 1
 
     PRIVATE ! Everything private unless explicitly made public
 
@@ -141,6 +142,10 @@
         TYPE (C_PTR)                       :: fmiComponent                     ! FMU instance
         INTEGER                            :: fmiStatus  ! Status of fmi
         INTEGER                            :: Index      ! Index of FMU
+        ! Values exchanged with fmiEPlusExchange: the inputs in the order of fmuInputVariable, the outputs
+        ! in the order of fmuOutputVariableSchedule, fmuOutputVariableVariable and fmuOutputVariableActuator
+        REAL(r64), DIMENSION(:), ALLOCATABLE  :: fmuInputValue
+        REAL(r64), DIMENSION(:), ALLOCATABLE  :: fmuOutputValue
         ! Variable Types structure for fmu input variables
         TYPE (fmuInputVariableType), &
         DIMENSION(:), ALLOCATABLE  :: fmuInputVariable
@@ -1013,47 +1018,57 @@
 
     ! SUBROUTINE LOCAL VARIABLE DECLARATIONS:
 
-    INTEGER :: i, j, k       ! Loop counter
+    INTEGER :: i, j, k, l    ! Loop counter
+    INTEGER :: setInputs     ! Flag to set the FMU inputs before the step
+    INTEGER :: retVal        ! Return value of function call
 
 
     INTERFACE
-    INTEGER FUNCTION fmiGetReal(fmiComponent, valRef, &
-    fmuVariableValue, numOutputs, index) BIND (C, NAME="fmiEPlusGetReal")
-    ! Function called to get real values from FMU outputs
+    INTEGER FUNCTION fmiExchange(fmiComponent, fmuInputValue, setInputs, curCommPoint, &
+    commStepSize, newStep, fmuOutputValue, index) BIND (C, NAME="fmiEPlusExchange")
+    ! Function called to set the FMU inputs, do one step of the co-simulation and get the FMU outputs
     USE ISO_C_BINDING, ONLY: C_INT, C_PTR, C_DOUBLE
-    TYPE (C_PTR)                         :: fmiComponent                 ! Pointer to FMU instance
-    INTEGER(kind=C_INT), DIMENSION(*)    :: valRef                       ! Parameter fmiValueReference
-    REAL (kind=C_DOUBLE), DIMENSION(*)   :: fmuVariableValue             ! FMU output variables
-    INTEGER(kind=C_INT)                  :: numOutputs                   ! Number of input variables
-    INTEGER(kind=C_INT)                  :: index                        ! Index of the FMU
-    END FUNCTION fmiGetReal
-    END INTERFACE
-
-
-    INTERFACE
-    INTEGER FUNCTION fmiSetReal(fmiComponent, valRef, &
-    fmuVariableValue, numInputs, index) BIND (C, NAME="fmiEPlusSetReal")
-    ! Function called to set real values to FMU inputs
-    USE ISO_C_BINDING, ONLY: C_INT, C_DOUBLE, C_PTR
-    TYPE (C_PTR)                              :: fmiComponent                ! Pointer to FMU instance
-    INTEGER(kind=C_INT) , DIMENSION(*)        :: valRef                      ! Parameter fmiValueReference
-    REAL (kind=C_DOUBLE), DIMENSION(*)        :: fmuVariableValue            ! FMU input variables
-    INTEGER(kind=C_INT)                       :: numInputs                   ! Number of input variables
-    INTEGER(kind=C_INT)                       :: index                        ! Index of the FMU
-    END FUNCTION fmiSetReal
+    TYPE (C_PTR)                               :: fmiComponent               ! Pointer to FMU instance
+    REAL (kind=C_DOUBLE), DIMENSION(*)         :: fmuInputValue              ! FMU input variables
+    INTEGER (C_INT)                            :: setInputs                  ! Flag to set the FMU inputs before the step
+    REAL(kind=C_DOUBLE)                        :: curCommPoint               ! Current communication point
+    REAL(kind=C_DOUBLE)                        :: commStepSize               ! Communication step size
+    INTEGER (C_INT)                            :: newStep
+    REAL (kind=C_DOUBLE), DIMENSION(*)         :: fmuOutputValue             ! FMU output variables at the end of the step
+    INTEGER(kind=C_INT)                        :: index                      ! Index of the FMU
+    END FUNCTION fmiExchange
     END INTERFACE
 
     INTERFACE
-    INTEGER FUNCTION fmiDoStep(fmiComponent, curCommPoint, &
-    commStepSize, newStep, index) BIND (C, NAME="fmiEPlusDoStep")
-    !  Function called to do one step of the co-simulation
+    INTEGER FUNCTION fmiPostExchange(fmiComponent, fmuInputValue, setInputs, curCommPoint, &
+    commStepSize, newStep, index) BIND (C, NAME="fmiEPlusPostExchange")
+    ! Function called to post the exchange of one step with the FMU, to be run by fmiRunExchanges
     USE ISO_C_BINDING, ONLY: C_INT, C_PTR, C_DOUBLE
     TYPE (C_PTR)                               :: fmiComponent               ! Pointer to FMU instance
+    REAL (kind=C_DOUBLE), DIMENSION(*)         :: fmuInputValue              ! FMU input variables
+    INTEGER (C_INT)                            :: setInputs                  ! Flag to set the FMU inputs before the step
     REAL(kind=C_DOUBLE)                        :: curCommPoint               ! Current communication point
     REAL(kind=C_DOUBLE)                        :: commStepSize               ! Communication step size
     INTEGER (C_INT)                            :: newStep
-    INTEGER(kind=C_INT)                        :: index                        ! Index of the FMU
-    END FUNCTION fmiDoStep
+    INTEGER(kind=C_INT)                        :: index                      ! Index of the FMU
+    END FUNCTION fmiPostExchange
+    END INTERFACE
+
+    INTERFACE
+    INTEGER FUNCTION fmiRunExchanges(numThreads) BIND (C, NAME="fmiEPlusRunExchanges")
+    ! Function called to run the posted exchanges, concurrently for independent FMU instances
+    USE ISO_C_BINDING, ONLY: C_INT
+    INTEGER(kind=C_INT)                        :: numThreads                 ! Number of threads
+    END FUNCTION fmiRunExchanges
+    END INTERFACE
+
+    INTERFACE
+    INTEGER FUNCTION fmiCollectExchange(fmuOutputValue, index) BIND (C, NAME="fmiEPlusCollectExchange")
+    ! Function called to get the FMU outputs at the end of the step of an exchange run by fmiRunExchanges
+    USE ISO_C_BINDING, ONLY: C_INT, C_DOUBLE
+    REAL (kind=C_DOUBLE), DIMENSION(*)         :: fmuOutputValue             ! FMU output variables at the end of the step
+    INTEGER(kind=C_INT)                        :: index                      ! Index of the FMU
+    END FUNCTION fmiCollectExchange
     END INTERFACE
 
     DO i = 1, NumFMUObjects
@@ -1077,58 +1092,21 @@
                     FMUTemp(i)%Instance(j)%fmuOutputVariableActuator(k)%RealVarValue
                 END DO
             ELSE
-                ! Get from FMUs, values that will be set in EnergyPlus (Schedule)
-
-                FMU(i)%Instance(j)%fmiStatus = &
-                fmiGetReal (FMU(i)%Instance(j)%fmiComponent, &
-                FMU(i)%Instance(j)%fmuOutputVariableSchedule%ValueReference, &
-                FMU(i)%Instance(j)%fmuOutputVariableSchedule%RealVarValue, &
-                FMU(i)%Instance(j)%NumOutputVariablesSchedule, &
-                FMU(i)%Instance(j)%Index)
-
-                IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
-                    CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to get outputs')
-                    CALL ShowContinueError ('in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
-                    CALL ShowContinueError ('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
-                    ErrorsFound = .true.
-                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-                    CALL StopExternalInterfaceIfError
-                END IF
-
-
-                ! Get from FMUs, values that will be set in EnergyPlus (Variable)
-                FMU(i)%Instance(j)%fmiStatus = &
-                fmiGetReal (FMU(i)%Instance(j)%fmiComponent, &
-                FMU(i)%Instance(j)%fmuOutputVariableVariable%ValueReference, &
-                FMU(i)%Instance(j)%fmuOutputVariableVariable%RealVarValue, &
-                FMU(i)%Instance(j)%NumOutputVariablesVariable, &
-                FMU(i)%Instance(j)%Index)
-
-                IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
-                    CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to get outputs')
-                    CALL ShowContinueError ('in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
-                    CALL ShowContinueError ('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
-                    ErrorsFound = .true.
-                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-                    CALL StopExternalInterfaceIfError
-                END IF
-
-                ! Get from FMUs, values that will be set in EnergyPlus (Actuator)
-                FMU(i)%Instance(j)%fmiStatus = &
-                fmiGetReal (FMU(i)%Instance(j)%fmiComponent, &
-                FMU(i)%Instance(j)%fmuOutputVariableActuator%ValueReference, &
-                FMU(i)%Instance(j)%fmuOutputVariableActuator%RealVarValue, &
-                FMU(i)%Instance(j)%NumOutputVariablesActuator, &
-                FMU(i)%Instance(j)%Index)
-
-                IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
-                    CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to get outputs')
-                    CALL ShowContinueError ('in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
-                    CALL ShowContinueError ('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
-                    ErrorsFound = .true.
-                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-                    CALL StopExternalInterfaceIfError
-                END IF
+                ! Get from FMUs, values that will be set in EnergyPlus. These are the outputs
+                ! at the end of the previous step, or after the initialization for the first step.
+                l = 0
+                DO k = 1, FMU(i)%Instance(j)%NumOutputVariablesSchedule
+                    l = l + 1
+                    FMU(i)%Instance(j)%fmuOutputVariableSchedule(k)%RealVarValue = FMU(i)%Instance(j)%fmuOutputValue(l)
+                END DO
+                DO k = 1, FMU(i)%Instance(j)%NumOutputVariablesVariable
+                    l = l + 1
+                    FMU(i)%Instance(j)%fmuOutputVariableVariable(k)%RealVarValue = FMU(i)%Instance(j)%fmuOutputValue(l)
+                END DO
+                DO k = 1, FMU(i)%Instance(j)%NumOutputVariablesActuator
+                    l = l + 1
+                    FMU(i)%Instance(j)%fmuOutputVariableActuator(k)%RealVarValue = FMU(i)%Instance(j)%fmuOutputValue(l)
+                END DO
             END IF
 
             ! Set in EnergyPlus the values of the schedules
@@ -1167,31 +1145,31 @@
                 END DO
             END IF
 
-            IF (.NOT.FlagReIni) THEN
-                FMU(i)%Instance(j)%fmiStatus = &
-                fmiSetReal(FMU(i)%Instance(j)%fmiComponent, &
-                FMU(i)%Instance(j)%fmuInputVariable%ValueReference, &
-                FMU(i)%Instance(j)%eplusOutputVariable%RTSValue, FMU(i)%Instance(j)%NumInputVariablesInIDF, &
-                FMU(i)%Instance(j)%Index)
-                IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
-                    CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to set inputs')
-                    CALL ShowContinueError ('in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
-                    CALL ShowContinueError ('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
-                    ErrorsFound = .true.
-                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
-                    CALL StopExternalInterfaceIfError
-                END IF
+            DO k = 1, FMU(i)%Instance(j)%NumInputVariablesInIDF
+                FMU(i)%Instance(j)%fmuInputValue(k) = FMU(i)%Instance(j)%eplusOutputVariable(k)%RTSValue
+            END DO
+            IF (FlagReIni) THEN
+                setInputs = 0
+            ELSE
+                setInputs = 1
             END IF
-            !   END IF
-            ! END DO
 
-            ! Call and simulate the FMUs to get values at the corresponding timestep.
-            FMU(i)%Instance(j)%fmiStatus = &
-            fmiDoStep(FMU(i)%Instance(j)%fmiComponent, &
-            tComm, hStep, fmiTrue, FMU(i)%Instance(j)%Index)
+            ! Set the inputs and call and simulate the FMUs to get values at the corresponding timestep.
+            ! The outputs at the end of the step are kept in fmuOutputValue for the next call.
+            IF (NumFMUThreads > 1) THEN
+                ! The instances only exchange data with EnergyPlus at the step boundary,
+                ! so their steps are run together below
+                FMU(i)%Instance(j)%fmiStatus = &
+                fmiPostExchange(FMU(i)%Instance(j)%fmiComponent, FMU(i)%Instance(j)%fmuInputValue, setInputs, &
+                tComm, hStep, fmiTrue, FMU(i)%Instance(j)%Index)
+            ELSE
+                FMU(i)%Instance(j)%fmiStatus = &
+                fmiExchange(FMU(i)%Instance(j)%fmiComponent, FMU(i)%Instance(j)%fmuInputValue, setInputs, &
+                tComm, hStep, fmiTrue, FMU(i)%Instance(j)%fmuOutputValue, FMU(i)%Instance(j)%Index)
+            END IF
             IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
-                CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to')
-                CALL ShowContinueError('do the coSimulation with instance "'//TRIM(FMU(i)%Instance(j)%Name)//'"')
+                CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to set inputs,')
+                CALL ShowContinueError('do the coSimulation or get outputs with instance "'//TRIM(FMU(i)%Instance(j)%Name)//'"')
                 CALL ShowContinueError('of FMU "'//TRIM(FMU(i)%Name)//'".')
                 CALL ShowContinueError('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
                 ErrorsFound = .true.
@@ -1200,6 +1178,34 @@
             END IF
         END DO
     END DO
+
+    IF (NumFMUThreads > 1) THEN
+        ! Run the steps of all instances and collect their outputs before EnergyPlus continues
+        retVal = fmiRunExchanges(NumFMUThreads)
+        IF (retVal .NE. 0) THEN
+            CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to run the')
+            CALL ShowContinueError('coSimulation steps of the FMU instances on '//TrimSigDigits(NumFMUThreads)//' threads.')
+            CALL ShowContinueError('Error Code = "'//TrimSigDigits(retVal)//'".')
+            ErrorsFound = .true.
+            !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+            CALL StopExternalInterfaceIfError
+        END IF
+        DO i = 1, NumFMUObjects
+            DO j = 1, FMU(i)%NumInstances
+                FMU(i)%Instance(j)%fmiStatus = &
+                fmiCollectExchange(FMU(i)%Instance(j)%fmuOutputValue, FMU(i)%Instance(j)%Index)
+                IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus.EQ. fmiOK)) THEN
+                    CALL ShowSevereError('ExternalInterface/GetSetVariablesAndDoStepFMUImport: Error when trying to set inputs,')
+                    CALL ShowContinueError('do the coSimulation or get outputs with instance "'//TRIM(FMU(i)%Instance(j)%Name)//'"')
+                    CALL ShowContinueError('of FMU "'//TRIM(FMU(i)%Name)//'".')
+                    CALL ShowContinueError('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
+                    ErrorsFound = .true.
+                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+                    CALL StopExternalInterfaceIfError
+                END IF
+            END DO
+        END DO
+    END IF
     ! If we have Erl variables, we need to call ManageEMS so that they get updated in the Erl data structure
     IF (useEMS) THEN
         CALL ManageEMS(emsCallFromExternalInterface)
@@ -1273,6 +1279,17 @@
     END FUNCTION fmiInitializeSlave
     END INTERFACE
 
+    INTERFACE
+    INTEGER FUNCTION fmiGetExchangeOutputs(fmiComponent, fmuOutputValue, index) &
+    BIND (C, NAME="fmiEPlusGetExchangeOutputs")
+    ! Function called to get the FMU outputs registered for the exchange
+    USE ISO_C_BINDING, ONLY: C_INT, C_PTR, C_DOUBLE
+    TYPE (C_PTR)                         :: fmiComponent                 ! Pointer to FMU instance
+    REAL (kind=C_DOUBLE), DIMENSION(*)   :: fmuOutputValue               ! FMU output variables
+    INTEGER(kind=C_INT)                  :: index                        ! Index of FMU
+    END FUNCTION fmiGetExchangeOutputs
+    END INTERFACE
+
     !Instantiate FMUs
     DO i = 1, NumFMUObjects
         DO j = 1, FMU(i)%NumInstances
@@ -1303,6 +1320,18 @@
                 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
                 CALL StopExternalInterfaceIfError
             END IF
+
+            ! Get the outputs after the initialization, they are set in EnergyPlus at the first step
+            FMU(i)%Instance(j)%fmiStatus = fmiGetExchangeOutputs(FMU(i)%Instance(j)%fmiComponent, &
+            FMU(i)%Instance(j)%fmuOutputValue, FMU(i)%Instance(j)%Index)
+            IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus .EQ. fmiOK )) THEN
+                CALL ShowSevereError('ExternalInterface/CalcExternalInterfaceFMUImport: Error when trying to get outputs')
+                CALL ShowContinueError('of instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
+                CALL ShowContinueError('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
+                ErrorsFound = .true.
+                !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+                CALL StopExternalInterfaceIfError
+            END IF
         END DO
     END DO
     END SUBROUTINE InstantiateInitializeFMUImport
@@ -1356,6 +1385,17 @@
     END FUNCTION fmiInitializeSlave
     END INTERFACE
 
+    INTERFACE
+    INTEGER FUNCTION fmiGetExchangeOutputs(fmiComponent, fmuOutputValue, index) &
+    BIND (C, NAME="fmiEPlusGetExchangeOutputs")
+    ! Function called to get the FMU outputs registered for the exchange
+    USE ISO_C_BINDING, ONLY: C_INT, C_PTR, C_DOUBLE
+    TYPE (C_PTR)                         :: fmiComponent                 ! Pointer to FMU instance
+    REAL (kind=C_DOUBLE), DIMENSION(*)   :: fmuOutputValue               ! FMU output variables
+    INTEGER(kind=C_INT)                  :: index                        ! Index of FMU
+    END FUNCTION fmiGetExchangeOutputs
+    END INTERFACE
+
     ! Initialize FMUs
     DO i = 1, NumFMUObjects
         DO j = 1, FMU(i)%NumInstances
@@ -1370,6 +1410,18 @@
                 !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
                 CALL StopExternalInterfaceIfError
             END IF
+
+            ! Get the outputs after the initialization, they are set in EnergyPlus at the first step
+            FMU(i)%Instance(j)%fmiStatus = fmiGetExchangeOutputs(FMU(i)%Instance(j)%fmiComponent, &
+            FMU(i)%Instance(j)%fmuOutputValue, FMU(i)%Instance(j)%Index)
+            IF ( .NOT. (FMU(i)%Instance(j)%fmiStatus .EQ. fmiOK )) THEN
+                CALL ShowSevereError('ExternalInterface/CalcExternalInterfaceFMUImport: Error when trying to get outputs')
+                CALL ShowContinueError('of instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
+                CALL ShowContinueError('Error Code = "'//TrimSigDigits(FMU(i)%Instance(j)%fmiStatus)//'".')
+                ErrorsFound = .true.
+                !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+                CALL StopExternalInterfaceIfError
+            END IF
         END DO
     END DO
     END SUBROUTINE InitializeFMU
@@ -1462,7 +1514,7 @@
     USE RuntimeLanguageProcessor, ONLY: isExternalInterfaceErlVariable, FindEMSVariable
     USE DataIPShortCuts
     USE ISO_C_BINDING, ONLY : C_PTR
-    USE DataSystemVariables, ONLY: CheckForActualFileName
+    USE DataSystemVariables, ONLY: CheckForActualFileName, cFMUNumThreads, cFMUCacheFolder
 
     IMPLICIT NONE ! Enforce explicit typing of all variables in this routine
 
@@ -1557,8 +1609,31 @@
     END FUNCTION addLibPathCurrentWorkingFolder
     END INTERFACE
 
+    INTERFACE
+    INTEGER(C_INT) FUNCTION fmiSetExchangeVariables(inpValRef, numInputs, outValRef, numOutputs, index) &
+    BIND (C, NAME="fmiEPlusSetExchangeVariables")
+    ! Function called to register the variables exchanged with the FMU at every communication step
+    USE ISO_C_BINDING, ONLY: C_INT
+    INTEGER(kind=C_INT), DIMENSION(*)    :: inpValRef                ! Value references of FMU inputs
+    INTEGER(kind=C_INT)                  :: numInputs                ! Number of FMU inputs
+    INTEGER(kind=C_INT), DIMENSION(*)    :: outValRef                ! Value references of FMU outputs
+    INTEGER(kind=C_INT)                  :: numOutputs               ! Number of FMU outputs
+    INTEGER(kind=C_INT)                  :: index                    ! Index of fmu
+    END FUNCTION fmiSetExchangeVariables
+    END INTERFACE
+
+    INTERFACE
+    INTEGER(C_INT) FUNCTION fmiSetCacheFolder(cacheFolder, sizeCacheFolder) BIND (C, NAME="fmiEPlusSetCacheFolder")
+    ! Function called to set the folder of the cache of unpacked FMUs
+    USE ISO_C_BINDING, ONLY: C_CHAR, C_INT
+    CHARACTER(kind=C_CHAR), DIMENSION(*) :: cacheFolder              ! Cache folder
+    INTEGER(kind=C_INT)                  :: sizeCacheFolder          ! Size of the cacheFolder trimmed
+    END FUNCTION fmiSetCacheFolder
+    END INTERFACE
+
     ! SUBROUTINE LOCAL VARIABLE DECLARATIONS:
     INTEGER :: i, j, k, l, Loop         ! Loop counter
+    INTEGER, DIMENSION(:), ALLOCATABLE :: outputValueReference  ! Value references of all FMU outputs of an instance
     INTEGER                        :: retVal              ! Return value of function call, used for error handling
     INTEGER                        :: NumAlphas  = 0      ! Number of Alphas for each GetObjectItem call
     INTEGER                        :: NumNumbers = 0      ! Number of Numbers for each GetObjectItem call
@@ -1589,6 +1664,9 @@
     CHARACTER(len=300),ALLOCATABLE,DIMENSION(:) :: fullFileName   ! entered file name/found
     INTEGER :: pos
     INTEGER :: FOUND
+    CHARACTER(len=120) :: cEnvValue       ! Value of environment variable
+    CHARACTER(len=300) :: cacheFolder     ! Folder of the cache of unpacked FMUs
+    INTEGER :: ios                        ! IOSTAT of reading the environment variable
 
     IF (FirstCallIni) THEN
         CALL DisplayString('Initializing FunctionalMockupUnitImport interface')
@@ -1596,6 +1674,29 @@
         CALL ValidateRunControl
         ALLOCATE(FMU(NumFMUObjects))
 
+        ! Number of threads to step the FMU instances concurrently
+        cEnvValue=' '
+        CALL Get_Environment_Variable(cFMUNumThreads,cEnvValue)
+        IF (cEnvValue /= BlankString) THEN
+            READ(cEnvValue,*,IOSTAT=ios) NumFMUThreads
+            IF (ios /= 0 .OR. NumFMUThreads < 1) NumFMUThreads=1
+            IF (NumFMUThreads > 1) CALL DisplayString('FMU instances are stepped on up to '// &
+            TRIM(TrimSigDigits(NumFMUThreads))//' threads.')
+        END IF
+
+        ! Folder of the cache of unpacked FMUs, the FMUs are unpacked on every run if it is not set
+        cacheFolder=' '
+        CALL Get_Environment_Variable(cFMUCacheFolder,cacheFolder)
+        IF (cacheFolder /= BlankString) THEN
+            retValue = fmiSetCacheFolder(TRIM(cacheFolder), LEN_TRIM(cacheFolder))
+            IF (retValue .NE. 0) THEN
+                CALL ShowWarningError('ExternalInterface/InitExternalInterfaceFMUImport: FMU cache folder')
+                CALL ShowContinueError('"'//TRIM(cacheFolder)//'" could not be created. FMUs are unpacked without cache.')
+            ELSE
+                CALL DisplayString('FMUs are unpacked using the cache in '//TRIM(cacheFolder))
+            END IF
+        END IF
+
         !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
         ! Add the fmus root folder name to the current working folder /currentWorkingFolder/tmp-fmus/... (9-characters)
         LEN_FMU_ROOT_DIR = LEN_TRIM(CurrentWorkingFolder) + 9
@@ -2182,6 +2283,30 @@
                     CALL StopExternalInterfaceIfError
                 END IF
 
+                ! register the variables exchanged with the FMU at every communication step
+                ALLOCATE(FMU(i)%Instance(j)%fmuInputValue(FMU(i)%Instance(j)%NumInputVariablesInIDF))
+                ALLOCATE(FMU(i)%Instance(j)%fmuOutputValue(FMU(i)%Instance(j)%NumOutputVariablesInIDF))
+                FMU(i)%Instance(j)%fmuInputValue = 0.0d0
+                FMU(i)%Instance(j)%fmuOutputValue = 0.0d0
+                ALLOCATE(outputValueReference(FMU(i)%Instance(j)%NumOutputVariablesInIDF))
+                outputValueReference = (/ &
+                FMU(i)%Instance(j)%fmuOutputVariableSchedule(1:FMU(i)%Instance(j)%NumOutputVariablesSchedule)%ValueReference, &
+                FMU(i)%Instance(j)%fmuOutputVariableVariable(1:FMU(i)%Instance(j)%NumOutputVariablesVariable)%ValueReference, &
+                FMU(i)%Instance(j)%fmuOutputVariableActuator(1:FMU(i)%Instance(j)%NumOutputVariablesActuator)%ValueReference /)
+                retVal = fmiSetExchangeVariables( &
+                FMU(i)%Instance(j)%fmuInputVariable(1:FMU(i)%Instance(j)%NumInputVariablesInIDF)%ValueReference, &
+                FMU(i)%Instance(j)%NumInputVariablesInIDF, outputValueReference, &
+                FMU(i)%Instance(j)%NumOutputVariablesInIDF, FMU(i)%Instance(j)%Index)
+                DEALLOCATE(outputValueReference)
+                IF (retVal .NE. fmiOK) THEN
+                    CALL ShowSevereError('InitExternalInterfaceFMUImport: Error when trying to register the variables exchanged')
+                    CALL ShowContinueError('with instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" of FMU "'//TRIM(FMU(i)%Name)//'".')
+                    CALL ShowContinueError('Check the input file and the modelDescription file again.')
+                    ErrorsFound=.true.
+                    !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
+                    CALL StopExternalInterfaceIfError
+                END IF
+
                 CALL DisplayString('Number of inputs in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" &
                 &of FMU "'//TRIM(FMU(i)%Name)//'" = "'//TRIM(TrimSigDigits(FMU(i)%Instance(j)%NumInputVariablesInIDF))//'".')
                 CALL DisplayString('Number of outputs in instance "'//TRIM(FMU(i)%Instance(j)%Name)//'" &
@@ -3126,7 +3251,7 @@
 
     !     NOTICE
     !
-    !     Copyright  1996-2013 The Board of Trustees of the University of Illinois
+    !     Copyright � 1996-2013 The Board of Trustees of the University of Illinois
     !     and The Regents of the University of California through Ernest Orlando Lawrence
     !     Berkeley National Laboratory.  All rights reserved.
     !
@@ -48,39 +48,54 @@ EnergyPlus Functions for FMI for Co-Simulation
 ****************************************************/
 
   DllExport fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder, 
-         fmiReal *timeOut, fmiInteger *visible, fmiInteger *interactive, fmiInteger *loggingOn,
-		 fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID, fmiString modelGUID,	 
-		 fmiInteger *sizemodelGUID);
+	  fmiInteger *sizefmuWorkingFolder, fmiReal *timeOut, fmiInteger *visible, 
+	  fmiInteger *interactive, fmiInteger *loggingOn, fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusInitializeSlave(fmiString fmuWorkingFolder, 
-	  fmiComponent *fmuInstance, fmiReal *tStart, fmiInteger *newStep, fmiReal *tStop, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusInitializeSlave(fmiComponent *fmuInstance, 
+	  fmiReal *tStart, fmiInteger *newStep, fmiReal *tStop, fmiInteger *index);
 
-  DllExport fmiReal fmiEPlusGetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	  fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusGetReal(fmiComponent *fmuInstance, 
+	  const fmiValueReference *valRef, fmiReal *outVal, fmiInteger *numOutputs, 
+	  fmiInteger *index);
 
-  DllExport fmiInteger fmiEPlusGetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	  fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusGetInteger(fmiComponent *fmuInstance, 
+	  const fmiValueReference *valRef, fmiInteger *outVal, fmiInteger *numOutputs, 
+	  fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusSetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiReal *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusSetReal(fmiComponent *fmuInstance, 
+	  const fmiValueReference *valRef, fmiReal *inpVal, fmiInteger *numInputs, 
+	  fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusSetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiInteger *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusSetInteger(fmiComponent *fmuInstance, 
+	  const fmiValueReference *valRef, fmiInteger *inpVal, fmiInteger *numInputs, 
+	  fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusDoStep(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
+  DllExport fmiStatus fmiEPlusDoStep(fmiComponent *fmuInstance, 
 	  fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID);
+	  fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusFreeSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance,
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID);
+  DllExport fmiStatus fmiEPlusSetExchangeVariables(const fmiValueReference *inpValRef, 
+	  fmiInteger *numInputs, const fmiValueReference *outValRef, fmiInteger *numOutputs, 
+	  fmiInteger *index);
 
-  DllExport fmiStatus fmiEPlusResetSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID); 
+  DllExport fmiStatus fmiEPlusGetExchangeOutputs(fmiComponent *fmuInstance, 
+	  fmiReal *outVal, fmiInteger *index);
+
+  DllExport fmiStatus fmiEPlusExchange(fmiComponent *fmuInstance, 
+	  const fmiReal *inpVal, fmiInteger *setInputs, fmiReal *curCommPoint, 
+	  fmiReal *commStepSize, fmiInteger *newStep, fmiReal *outVal, fmiInteger *index);
+
+  DllExport fmiStatus fmiEPlusPostExchange(fmiComponent *fmuInstance,
+	  const fmiReal *inpVal, fmiInteger *setInputs, fmiReal *curCommPoint,
+	  fmiReal *commStepSize, fmiInteger *newStep, fmiInteger *index);
+
+  DllExport fmiInteger fmiEPlusRunExchanges(fmiInteger *numThreads);
+
+  DllExport fmiStatus fmiEPlusCollectExchange(fmiReal *outVal, fmiInteger *index);
+
+  DllExport fmiStatus fmiEPlusFreeSlave(fmiComponent *fmuInstance, fmiInteger *index);
+
+  DllExport fmiStatus fmiEPlusResetSlave(fmiComponent *fmuInstance, fmiInteger *index); 
 
   DllExport fmiInteger fmiEPlusUnpack(fmiString fmuName, fmiString fmuOutputWorkingFolder, 
 	  fmiInteger *sizefmuName, fmiInteger *sizefmuOutputWorkingFolder); 
@@ -88,14 +103,17 @@ EnergyPlus Functions for FMI for Co-Simulation
   DllExport fmiInteger fmiEPlusDelete(fmiString fmuOutputWorkingFolder, 
 	  fmiInteger *sizefmuOutputWorkingFolder); 
 
-  DllExport fmiInteger getValueReferenceByNameFMUInputVariables(fmiString fmuWorkingFolder, 
-	  fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName);
+  DllExport fmiInteger fmiEPlusSetCacheFolder(fmiString cacheFolder, 
+	  fmiInteger *sizeCacheFolder);
+
+  DllExport fmiInteger getValueReferenceByNameFMUInputVariables(fmiString variableName, 
+	  fmiInteger *sizeVariableName, fmiInteger *index);
 
-  DllExport fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString fmuWorkingFolder, 
-	  fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName);
+  DllExport fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString variableName, 
+	  fmiInteger *sizeVariableName, fmiInteger *index);
 
   DllExport fmiInteger model_ID_GUID(fmiString fmuWorkingFolder, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiString modelGUID);
+	  fmiInteger *sizefmuWorkingFolder, fmiInteger *numInputs, fmiInteger *numOutputs);
 
   DllExport fmiInteger addFMURootFolderName(fmiString fmuOutputWorkingFolder, 
 	  fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder);
@@ -107,11 +125,10 @@ EnergyPlus Functions for FMI for Co-Simulation
 	  fmiInteger *sizefmuWorkingFolder);
 
   DllExport fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	  fmiInteger *sizemodelID, fmiString fmiVersionNumber);
+	  fmiInteger *sizefmuWorkingFolder, fmiString fmiVersionNumber, fmiInteger *index);
 
   DllExport fmiInteger addLibPathCurrentWorkingFolder(fmiString trimfmuOutputWorkingFolder_wLiB, 
-	  fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiString fmumodelID, fmiInteger *sizefmumodelID);
+	  fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiInteger *index);
 
   DllExport fmiInteger checkOperatingSystem(fmiString errorMessage);
 
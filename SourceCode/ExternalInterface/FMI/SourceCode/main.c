@@ -41,6 +41,7 @@
 #define LIB_PATH  "%s%s%s.dll"
 #define FMU_ROOT_DIR "tmp-fmus\\"
 #define XML_FILE "\\modelDescription.xml"
+#define MD_BIN_FILE "\\modelDescription.bin"
 #define BIN_WIN "\\binaries\\winxx\\"
 #define BIN_WIN32 "\\binaries\\win32\\"
 #define BIN_WIN64 "\\binaries\\win64\\"
@@ -58,6 +59,7 @@
 #define LIB_PATH  "%s%s%s.so"
 #define FMU_ROOT_DIR "tmp-fmus//"
 #define XML_FILE "//modelDescription.xml"
+#define MD_BIN_FILE "//modelDescription.bin"
 #define BIN_LIN "//binaries//linuxxx//"
 #define BIN_LIN32 "//binaries//linux32//"
 #define BIN_LIN64 "//binaries//linux64//"
@@ -73,6 +75,7 @@
 #define LIB_PATH  "%s%s%s.dylib"
 #define FMU_ROOT_DIR "tmp-fmus//"
 #define XML_FILE "//modelDescription.xml"
+#define MD_BIN_FILE "//modelDescription.bin"
 #define BIN_MAC "//binaries//macxx//"
 #define BIN_MAC32 "//binaries//mac32//"
 #define BIN_MAC64 "//binaries//mac64//"
@@ -85,10 +88,6 @@
 
 
 
-//static FMU fmu; 
-FMU fmu; // the fmu to simulate
-
-
 ///////////////////////////////////////////////////////////////////////////////
 /// This function checks the operating system and returns an error message 
 /// if the operating system is not supported
@@ -260,6 +259,105 @@ static int loadLib(const char* libPath, const char* modelID, FMU *fmu) {
 	
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Unload the FMI functions library of an FMU instance.
+///
+///\param fmu FMU instance.
+///////////////////////////////////////////////////////////////////////////////
+static void unloadLib(FMU *fmu) {
+	if (!fmu->dllHandle) return;
+    #ifdef _MSC_VER
+	  FreeLibrary((HMODULE)fmu->dllHandle);
+    #else
+	  dlclose(fmu->dllHandle);
+    #endif
+	fmu->dllHandle = NULL;
+}
+
+// FMU instances, indexed by the index that model_ID_GUID() returns
+// to ExternalInterface.f90 and that is passed back with every call.
+static FMU** fmuInstances = NULL;
+static int numFMUInstances = 0;
+static int numFMUInstancesAllocated = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Add an FMU instance to the instance table.
+///
+///\param fmu FMU instance.
+///\return The index of the FMU instance, or -1 if out of memory.
+///////////////////////////////////////////////////////////////////////////////
+static int addFMUInstance(FMU *fmu) {
+	FMU** tmp;
+	if (numFMUInstances == numFMUInstancesAllocated) {
+		int numAllocated = numFMUInstancesAllocated ? 2*numFMUInstancesAllocated : 8;
+		tmp = (FMU**)realloc(fmuInstances, numAllocated*sizeof(FMU*));
+		if (!tmp) {
+			printf("Error: failed to allocate memory for FMU instances!\n");
+			return -1;
+		}
+		fmuInstances = tmp;
+		numFMUInstancesAllocated = numAllocated;
+	}
+	fmuInstances[numFMUInstances] = fmu;
+	return numFMUInstances++;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Get the FMU instance with the given index.
+///
+///\param index Index of the FMU instance.
+///\return The FMU instance, or NULL if the index is invalid 
+///        or the instance has been freed.
+///////////////////////////////////////////////////////////////////////////////
+static FMU* getFMUInstance(const fmiInteger *index) {
+	if (*index < 0 || *index >= numFMUInstances || !fmuInstances[*index]) {
+		printf("Error: invalid FMU instance index %d\n", *index);
+		return NULL;
+	}
+	return fmuInstances[*index];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Load the FMI functions library of an FMU instance, unless it is loaded 
+/// already. The library stays loaded until the slave is freed, 
+/// so that the function pointers are resolved only once per slave.
+///
+///\param fmu FMU instance.
+///\return 0 if there is no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int loadFMULib(FMU *fmu) {
+	if (fmu->dllHandle) return 0;
+	if (!fmu->libPath) {
+		printf("Error: path to FMI functions library of %s is unknown\n", fmu->modelID);
+		return -1;
+	}
+	if (loadLib(fmu->libPath, fmu->modelID, fmu)) {
+		unloadLib(fmu);
+		return -1;
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Free an FMU instance whose setup failed: unload its library, free its 
+/// model description and remove it from the instance table.
+///
+///\param index Index of the FMU instance.
+///////////////////////////////////////////////////////////////////////////////
+static void freeFMUInstance(fmiInteger index) {
+	FMU* fmu = fmuInstances[index];
+	unloadLib(fmu);
+	if (fmu->modelDescription) freeElement(fmu->modelDescription);
+	free(fmu->fmuWorkingFolder);
+	free(fmu->modelID);
+	free(fmu->modelGUID);
+	free(fmu->libPath);
+	free(fmu->exchangeValRef);
+	free(fmu->exchangeVal);
+	free(fmu);
+	fmuInstances[index] = NULL;
+}
+
 static const char* fmiStatusToString(fmiStatus status){
     switch (status){
         case fmiOK:      return "ok";
@@ -275,28 +373,22 @@ static const char* fmiStatusToString(fmiStatus status){
 ///////////////////////////////////////////////////////////////////////////////
 /// Search a fmu for the given variable.
 ///
-///\param fmu FMU.
+///\param fmu FMU, NULL if unknown.
 ///\param type Type of FMU variable.
 ///\param vr FMI value reference.
 ///\return NULL if not found or vr = fmiUndefinedValueReference
 ///////////////////////////////////////////////////////////////////////////////
 static ScalarVariable* getSV(FMU* fmu, char type, fmiValueReference vr) {
-  int i;
   Elm tp;
-  ScalarVariable** vars = fmu->modelDescription->modelVariables;
-  if (vr==fmiUndefinedValueReference) return NULL;
+  if (!fmu || !fmu->modelDescription) return NULL;
   switch (type) {
     case 'r': tp = elm_Real;    break;
     case 'i': tp = elm_Integer; break;
     case 'b': tp = elm_Boolean; break;
     case 's': tp = elm_String;  break;                
+    default: return NULL;
   }
-  for (i=0; vars[i]; i++) {
-    ScalarVariable* sv = vars[i];
-    if (vr==getValueReference(sv) && tp==sv->typeSpec->type) 
-      return sv;
-  }
-  return NULL;
+  return getVariable(fmu->modelDescription, vr, tp);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -359,6 +451,20 @@ static void replaceRefsInMessage(const char* msg, char* buffer, int nBuffer, FMU
   buffer[k] = '\0';
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Get the FMU instance of a slave.
+///
+///\param c FMI component.
+///\return The FMU instance, or NULL if not found.
+///////////////////////////////////////////////////////////////////////////////
+static FMU* getFMUByComponent(fmiComponent c) {
+  int i;
+  for (i=0; i<numFMUInstances; i++) {
+    if (fmuInstances[i] && fmuInstances[i]->instance == c) return fmuInstances[i];
+  }
+  return NULL;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// FMU logger
 ///
@@ -380,7 +486,7 @@ static void fmuLogger(fmiComponent c, fmiString instanceName, fmiStatus status,
 
   // Replace e.g. ## and #r12#  
   copy = strdup(msg);
-  replaceRefsInMessage(copy, msg, MAX_MSG_SIZE, &fmu);
+  replaceRefsInMessage(copy, msg, MAX_MSG_SIZE, getFMUByComponent(c));
   free(copy);
   
   // Print the final message
@@ -397,33 +503,30 @@ static int error(const char* message){
 
 ////////////////////////////////////////////////////////////////
 ///  This method returns the fmi version number
-///\param fmuWorkingFolder path to the FMU-working directory
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID  sizeFMU modelID
+///\param fmuWorkingFolder path to the FMU-binaries 
+///\param sizefmuWorkingFolder size of FMU-binaries path
 ///\param fmiVersionNumber FMI version number
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID, fmiString fmiVersionNumber){
+	fmiInteger *sizefmuWorkingFolder, fmiString fmiVersionNumber, 
+	fmiInteger *index){
 	
-	char *trimfmuWorkingFolder;
+	FMU* fmu;
 	fmiString verID;
-	fmiString trimmodelID;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-    
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
+	fmu = getFMUInstance(index);
+	if (!fmu) return -1;
+
+	// use the path to the binaries of this call if addLibPathCurrentWorkingFolder() 
+	// has not set it
+	if (!fmu->libPath) {
+		fmu->libPath = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
+		strncpy(fmu->libPath, fmuWorkingFolder, *sizefmuWorkingFolder);
+	}
 
-        //load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) {
+    //load lib by specifying path to the binaries
+	if (loadFMULib(fmu)) {
 		sprintf(fmiVersionNumber, "%s", "Check FMU binaries folder and see whether libraries "
 			"exist for the system architecture of the EnergyPlus version used. Also check whether the FMU has "
 			"been exported for Co-Simulation. FMU for Model Exchange is not suported yet");
@@ -431,13 +534,8 @@ fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder,
 	}		
 
 	// gets the modelID of the FMU
-	verID = fmu.getVersion();
+	verID = fmu->getVersion();
 	strncpy(fmiVersionNumber, verID, strlen (verID)+ 1);
-
-	// free trimmed working folder
-	free (trimfmuWorkingFolder);
-	// free trimmed modelID
-	free (trimmodelID);
 	return 0;	
 }
 
@@ -448,26 +546,19 @@ fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder,
 ///  instantiate FMU
 ///
 ///\param fmuWorkingFolder path to the FMU-working directory
+///\param sizefmuWorkingFolder size of FMU-working directory
 ///\param timeOut communication timeout value in milli-seconds 
 ///\param visible flag to executes the FMU in windowless mode 
 ///\param interactive flag to execute the FMU in interactive mode
 ///\param loggingOn flag to enable or disable debug 
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID  sizeFMU modelID
-///\param modelGUID FMU modelGUID
-///\param sizemodelGUID size FMU modelGUID
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder, 
-         fmiReal *timeOut, fmiInteger *visible, 
-		 fmiInteger *interactive, fmiInteger *loggingOn, 
-		 fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-		 fmiInteger *sizemodelID, fmiString modelGUID, 
-		 fmiInteger *sizemodelGUID) {
+	fmiInteger *sizefmuWorkingFolder, fmiReal *timeOut, 
+	fmiInteger *visible, fmiInteger *interactive, 
+	fmiInteger *loggingOn, fmiInteger *index) {
 	
-	char* trimfmuWorkingFolder;		 
-    fmiString trimmodelID;
-	fmiString trimmodelGUID;
+	FMU* fmu;
 
 	fmiBoolean visiBoolean;
 	fmiBoolean interactBoolean;
@@ -479,21 +570,9 @@ fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder,
     callbacks.allocateMemory = calloc;
     callbacks.freeMemory = free;
 	callbacks.logger = fmuLogger;
-	 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
 
-	// allocate memory for the FMU-modelGUID withouth blanks
-	trimmodelGUID = calloc(sizeof(char),*sizemodelGUID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelGUID, modelGUID, *sizemodelGUID);
+	fmu = getFMUInstance(index);
+	if (!fmu) return NULL;
 
 	//map input to fmiBoolean variables
     if (*visible == 0)
@@ -511,22 +590,20 @@ fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder,
 	else
 		loggOnBoolean = fmiTrue;
 
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE);
+	//load lib by specifying path to the binaries, unless getfmiEPlusVersion() did
+	if (loadFMULib(fmu)) {
+		printf("Error: failed to load FMI functions library in fmiEPlusInstantiateSlave!\n");
+		return NULL;
+	}
 
 	// instantiate FMU
-    fmuInstance = fmu.instantiateSlave(trimmodelID, trimmodelGUID, "", "", *timeOut, visiBoolean, 
+    fmuInstance = fmu->instantiateSlave(fmu->modelID, fmu->modelGUID, "", "", *timeOut, visiBoolean, 
 		interactBoolean, callbacks, loggOnBoolean); 
     if (!fmuInstance) {
 		printf("Error: failed to instantiate slave in fmiEPlusInstantiateSlave!\n");
 		return NULL;
 	}
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-    // deallocate memory for trimmed modelID
-	free(trimmodelID);
-	//deallocate memory for trimmed modelGUID
-	free(trimmodelGUID);
+	fmu->instance = fmuInstance;
     return fmuInstance;
 }
 
@@ -537,40 +614,23 @@ fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder,
 ///  which indicates whether the initialization was successful 
 ///  or not
 ///
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance 
 ///\param tStart simulation starttime
 ///\param newStep flag to accept or reject timestep
 ///\param tStop simulation endtime 
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID size FMU modelID
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiStatus fmiEPlusInitializeSlave(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, fmiReal *tStart, 
-	fmiInteger *newStep, fmiReal *tStop, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID) {
-
-    char* trimfmuWorkingFolder;
-	fmiString trimmodelID;
+fmiStatus fmiEPlusInitializeSlave(fmiComponent *fmuInstance, 
+	fmiReal *tStart, fmiInteger *newStep, fmiReal *tStop, 
+	fmiInteger *index) {
 
+	FMU* fmu;
     fmiStatus fmiFlag;              
 	fmiBoolean newStepBoolean;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
 
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
-	
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE);
-	
 	//map the newStep to fmiBoolean value
 	if (*newStep == 0)
 		newStepBoolean = fmiFalse;
@@ -578,274 +638,156 @@ fmiStatus fmiEPlusInitializeSlave(fmiString fmuWorkingFolder,
 		newStepBoolean = fmiTrue;
 
     //initialize fmu; 
-	fmiFlag = fmu.initializeSlave(*fmuInstance, *tStart, newStepBoolean, *tStop);
+	fmiFlag = fmu->initializeSlave(*fmuInstance, *tStart, newStepBoolean, *tStop);
 	if (fmiFlag > fmiWarning) {
       printf("Error: failed to initialize slave in fmiEPlusInitializeSlave!\n");
     return -1;
     }
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
 	return fmiFlag;
 }
 
 
+////////////////////////////////////////////////////////////////
+///  Check that all value references are those of 
+///  non-alias variables of the given type and causality.
+///  
+///\param fmu FMU instance
+///\param valRef value references
+///\param num number of value references
+///\param type type of the variables
+///\param causality causality of the variables
+////////////////////////////////////////////////////////////////
+static int checkValueReferences(FMU* fmu, const fmiValueReference *valRef, 
+	fmiInteger num, Elm type, Enu causality) {
+
+	int i;
+
+	for (i=0; i<num; i++) {
+		// the value reference index returns the non-alias variable if there is one
+		ScalarVariable* sv = getVariable(fmu->modelDescription, valRef[i], type);
+		if (!sv || getAlias(sv)!=enu_noAlias || getCausality(sv) != causality) {
+			printf("Error: value reference %u is not an FMU %s variable of %s\n", valRef[i], 
+				causality == enu_input ? "input" : "output", fmu->modelID);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to get real variables from the FMU. It returns  
-///  the output variable from FMU 
+///  an integer which indicates whether the outputs have 
+///  been got or not
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance 
-///\param valRef value reference
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID size FMU modelID
+///\param valRef value references
+///\param outVal output values
+///\param numOutputs number of output variables
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-
-fmiReal fmiEPlusGetReal(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, const fmiValueReference *valRef, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusGetReal(fmiComponent *fmuInstance, 
+	const fmiValueReference *valRef, fmiReal *outVal, 
+	fmiInteger *numOutputs, fmiInteger *index) {
     
-	char *trimfmuWorkingFolder;
-	fmiString trimmodelID;
+	FMU* fmu;
 
-    fmiReal ry;					    
-	int k;							
-	fmiValueReference vr;
-	ScalarVariable** vars; 
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+	if (*numOutputs <= 0) return fmiOK;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
+	// only get output variables
+	if (checkValueReferences(fmu, valRef, *numOutputs, elm_Real, enu_output)) return fmiError;
 
-    //load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder,trimmodelID, &fmu)) exit(EXIT_FAILURE); 
-    
-	// loading the model variables
-	vars = fmu.modelDescription->modelVariables;
-
-	// get real value from fmu
-	for (k=0; vars[k]; k++) {	
-		 ScalarVariable* sv = vars[k];
-		 ScalarVariable* svTemp = vars [k];
-		 if (getAlias(sv)!=enu_noAlias) continue;
-	     if (getCausality(sv) != enu_output) continue; // only get output variable
-		 vr = getValueReference(sv);
-		 if (vr == *valRef){	
-		   svTemp = vars[k];
-		   vr = getValueReference(svTemp);
-		   fmu.getReal(*fmuInstance, &vr, 1, &ry);
-		 }
-	 }
-	//// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-	return ry;
-	
+	// get real values from fmu
+	return fmu->getReal(*fmuInstance, valRef, *numOutputs, outVal);
 }
 
 
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to get integer variables from the FMU. It returns  
-///  the output variable from FMU 
+///  an integer which indicates whether the outputs have 
+///  been got or not
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance 
-///\param valRef value reference
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID size FMU modelID
+///\param valRef value references
+///\param outVal output values
+///\param numOutputs number of output variables
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiInteger fmiEPlusGetInteger(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, const fmiValueReference *valRef, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusGetInteger(fmiComponent *fmuInstance, 
+	const fmiValueReference *valRef, fmiInteger *outVal, 
+	fmiInteger *numOutputs, fmiInteger *index) {
 
-    char *trimfmuWorkingFolder;
-    fmiString trimmodelID;
-    
-	fmiInteger iy;					// add integer variables output
-	int k;							// add a counter for variables
-	fmiValueReference vr;			// Zuo: add it to get value reference for variables
-	ScalarVariable** vars;
+	FMU* fmu;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+	if (*numOutputs <= 0) return fmiOK;
 
-    // allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
-
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE); 
-
-	// loading the model variables
-	vars = fmu.modelDescription->modelVariables;
-
-	//get integer value from fmu
-	for (k=0; vars[k]; k++) {
-		 ScalarVariable* sv = vars[k];
-		 ScalarVariable* svTemp = vars [k];
-		 if (getAlias(sv)!=enu_noAlias) continue;
-	     if (getCausality(sv) != enu_output) continue; // only get output variable
-		 vr = getValueReference(sv);
-		 if (vr == *valRef){
-		   svTemp = vars[k];
-		   vr = getValueReference(svTemp);
-		   fmu.getInteger(*fmuInstance, &vr, 1, &iy); 
-		 }
-	 }
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
+	// only get output variables
+	if (checkValueReferences(fmu, valRef, *numOutputs, elm_Integer, enu_output)) return fmiError;
 
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-	return iy;
+	//get integer values from fmu
+	return fmu->getInteger(*fmuInstance, valRef, *numOutputs, outVal);
 }
 
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to set real variables to the FMU. It returns an  
-///  integer which indicates whether input has been set or not 
+///  integer which indicates whether inputs have been set or not 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance 
-///\param valRef value reference
-///\param inpVal input value
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID size FMU modelID
+///\param valRef value references
+///\param inpVal input values
+///\param numInputs number of input variables
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiStatus fmiEPlusSetReal(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, const fmiValueReference *valRef, 
-	fmiReal *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusSetReal(fmiComponent *fmuInstance, 
+	const fmiValueReference *valRef, fmiReal *inpVal, 
+	fmiInteger *numInputs, fmiInteger *index) {
     
-	char *trimfmuWorkingFolder;
-	fmiString trimmodelID;
-
-    fmiStatus fmiFlag;              
-    fmiReal rx;					
-	int k;							
-	ScalarVariable** vars; 
-	fmiValueReference vr;			
-
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-	
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
+	FMU* fmu;
 
-	// loading the model variables
-	vars = fmu.modelDescription->modelVariables;
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+	if (*numInputs <= 0) return fmiOK;
 
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE);
-	
-	//set real value in fmu
-	for (k=0; vars[k]; k++) {
-		 ScalarVariable* sv = vars[k];
-		 ScalarVariable* svTemp = vars [k];
-         if (getAlias(sv)!=enu_noAlias) continue;
-	     if (getCausality(sv) != enu_input) continue; // only set input variable
-		 vr = getValueReference(sv);
-		 if (vr == *valRef){
-		   svTemp = vars[k];
-		   vr = getValueReference(svTemp);
-		   rx = *inpVal;
-		   fmiFlag = fmu.setReal(*fmuInstance, &vr, 1, &rx); 
-		 }
-	 }
+	// only set input variables
+	if (checkValueReferences(fmu, valRef, *numInputs, elm_Real, enu_input)) return fmiError;
 
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-    return fmiFlag;
-	
+	//set real values in fmu
+	return fmu->setReal(*fmuInstance, valRef, *numInputs, inpVal);
 }
 
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to set integer variables to the FMU. It returns an  
-///  integer which indicates whether input has been set or not 
+///  integer which indicates whether inputs have been set or not 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance 
-///\param valRef value reference
-///\param inpVal input value
-///\param sizefmuWorkingFolder size of FMU-working directory
-///\param modelID FMU modelID
-///\param sizemodelID  size FMU modelID
+///\param valRef value references
+///\param inpVal input values
+///\param numInputs number of input variables
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiStatus fmiEPlusSetInteger(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, const fmiValueReference *valRef, 
-	fmiInteger *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusSetInteger(fmiComponent *fmuInstance, 
+	const fmiValueReference *valRef, fmiInteger *inpVal, 
+	fmiInteger *numInputs, fmiInteger *index) {
     
-	char *trimfmuWorkingFolder;
-	fmiString trimmodelID;
-
-    fmiStatus fmiFlag;               
-    fmiInteger ix;
-	int k;							
+	FMU* fmu;
 
-	ScalarVariable** vars;
-	fmiValueReference vr;			
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+	if (*numInputs <= 0) return fmiOK;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
+	// only set input variables
+	if (checkValueReferences(fmu, valRef, *numInputs, elm_Integer, enu_input)) return fmiError;
 
-    // allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
-
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE);
-
-	// loading the model variables
-	vars = fmu.modelDescription->modelVariables;
-
-	//set integer value in fmu
-	for (k=0; vars[k]; k++) {
-		 ScalarVariable* sv = vars[k];
-		 ScalarVariable* svTemp = vars [k];
-		 if (getAlias(sv)!=enu_noAlias) continue;
-	     if (getCausality(sv) != enu_input) continue; // only set input variable
-		 vr = getValueReference(sv);
-		 if (vr == *valRef){
-		   svTemp = vars[k];
-		   vr = getValueReference(svTemp);
-		   ix = *inpVal;
-		   fmiFlag = fmu.setInteger(*fmuInstance, &vr, 1, &ix);
-		 }
-	 }
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-    return fmiFlag;
+	//set integer values in fmu
+	return fmu->setInteger(*fmuInstance, valRef, *numInputs, inpVal);
 }
 
 
@@ -854,72 +796,50 @@ fmiStatus fmiEPlusSetInteger(fmiString fmuWorkingFolder,
 ///  needed to get value reference of FMU- input variable by Name.  
 ///  It returns the value reference of the given variable 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param variableName FMU-variable name 
-///\param sizefmuWorkingFolder size of FMU-working directory
 ///\param sizeVariableName size of FMU-variable name
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 fmiInteger getValueReferenceByNameFMUInputVariables(
-	fmiString fmuWorkingFolder, fmiString variableName, 
-	fmiInteger *sizefmuWorkingFolder, 
-fmiInteger *sizeVariableName) {
+	fmiString variableName, fmiInteger *sizeVariableName, 
+	fmiInteger *index) {
     
-	char* xmlPath;  
-	char *trimfmuWorkingFolder;
+	FMU* fmu;
 	char *trimVariableName;
-
-	ModelDescription* md;                
+	ScalarVariable* sv;
 	fmiInteger valueRef; 
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
+	fmu = getFMUInstance(index);
+	if (!fmu) return -1;
+
 	// allocate memory for the FMU-variable trimmed
 	trimVariableName = calloc(sizeof(char),*sizeVariableName +1 );
 
-    //write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
 	//write FMU-variable withouth blanks
 	strncpy(trimVariableName, variableName, *sizeVariableName);
 
-   	// allocate memory for xml-path to FMU, NULL if not found
-    xmlPath = calloc(sizeof(char), *sizefmuWorkingFolder + strlen(XML_FILE) + 1);
-	
-	// write path to the FMU
-    sprintf(xmlPath, "%s%s", trimfmuWorkingFolder, XML_FILE);
-
-	// get the model description of the FMU
-	md = parse(xmlPath);
-	if (!md) {
-		printf("Error: failed to get the modelDescription in fmigetValueReferenceByName!\n");
-		return -1;
-	}
+	// look the variable up in the model description that model_ID_GUID() parsed
+	sv = getVariableByName(fmu->modelDescription, trimVariableName);
+	// deallocate memory FMU-variable name trimmed
+	free(trimVariableName);
 
 	// check whether the variable exists in the FMU
-	if (getVariableByName(md, trimVariableName)== NULL){
+	if (sv == NULL){
 		printf("Error: get variable by name failed in fmigetValueReferenceByName. "
 			"Please check input variables and modelDescription file again.");
 		return -1;
 	}
-	else
-	{
-		valueRef = getValueReference(getVariableByName(md, trimVariableName));
-		if (!valueRef) {
-			printf("Error: could not get value by reference in fmigetValueReferenceByName. "
-				"Please check input variables and modelDescription file again");
-			return -999;
-		}
-		if (getCausality(getVariableByName(md, trimVariableName)) != enu_input) {
-			printf("Error: This is not an FMU input variable. "
-				"Please check input variables and modelDescription file again");
-			return -1;
-		}
+	valueRef = getValueReference(sv);
+	if (!valueRef) {
+		printf("Error: could not get value by reference in fmigetValueReferenceByName. "
+			"Please check input variables and modelDescription file again");
+		return -999;
+	}
+	if (getCausality(sv) != enu_input) {
+		printf("Error: This is not an FMU input variable. "
+			"Please check input variables and modelDescription file again");
+		return -1;
 	}
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory FMU-variable name trimmed
-	free(trimVariableName);
-	// deallocate xmlPath
-	free(xmlPath);
     return valueRef;
 }
 
@@ -928,72 +848,50 @@ fmiInteger *sizeVariableName) {
 ///  needed to get value reference of FMU- output variable by Name.  
 ///  It returns the value reference of the given variable 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param variableName FMU-variable name 
-///\param sizefmuWorkingFolder size of FMU-working directory
 ///\param sizeVariableName size of FMU-variable name
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 fmiInteger getValueReferenceByNameFMUOutputVariables(
-	fmiString fmuWorkingFolder, fmiString variableName, 
-	fmiInteger *sizefmuWorkingFolder, 
-	fmiInteger *sizeVariableName) {
+	fmiString variableName, fmiInteger *sizeVariableName, 
+	fmiInteger *index) {
     
-	char* xmlPath;  
-	char *trimfmuWorkingFolder;
+	FMU* fmu;
 	char *trimVariableName;
-
-	ModelDescription* md;                
+	ScalarVariable* sv;
 	fmiInteger valueRef; 
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
+	fmu = getFMUInstance(index);
+	if (!fmu) return -1;
+
 	// allocate memory for the FMU-variable trimmed
 	trimVariableName = calloc(sizeof(char),*sizeVariableName +1 );
 
-    //write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
 	//write FMU-variable withouth blanks
 	strncpy(trimVariableName, variableName, *sizeVariableName);
 
-   	// allocate memory for xml-path to FMU, NULL if not found
-    xmlPath = calloc(sizeof(char), *sizefmuWorkingFolder + strlen(XML_FILE) + 1);
-	
-	// write path to the FMU
-    sprintf(xmlPath, "%s%s", trimfmuWorkingFolder, XML_FILE);
-
-	// get the model description of the FMU
-	md = parse(xmlPath);
-	if (!md) {
-		printf("Error: failed to get the modelDescription in fmigetValueReferenceByName!\n");
-		return -1;
-	}
+	// look the variable up in the model description that model_ID_GUID() parsed
+	sv = getVariableByName(fmu->modelDescription, trimVariableName);
+	// deallocate memory FMU-variable name trimmed
+	free(trimVariableName);
 
 	// check whether the variable exists in the FMU
-	if (getVariableByName(md, trimVariableName)== NULL){
+	if (sv == NULL){
 		printf("Error: get variable by name failed in fmigetValueReferenceByName. "
 			"Please check output variables and modelDescription file again.");
 		return -1;
 	}
-	else
-	{
-		valueRef = getValueReference(getVariableByName(md, trimVariableName));
-		if (!valueRef) {
-			printf("Error: could not get value by reference in fmigetValueReferenceByName. "
-				"Please check output variables and modelDescription file again");
-			return -999;
-		}
-		if (getCausality(getVariableByName(md, trimVariableName)) != enu_output) {
-			printf("Error: This is not an FMU output variable. "
-				"Please check output variables and modelDescription file again");
-			return -1;
-		}
+	valueRef = getValueReference(sv);
+	if (!valueRef) {
+		printf("Error: could not get value by reference in fmigetValueReferenceByName. "
+			"Please check output variables and modelDescription file again");
+		return -999;
+	}
+	if (getCausality(sv) != enu_output) {
+		printf("Error: This is not an FMU output variable. "
+			"Please check output variables and modelDescription file again");
+		return -1;
 	}
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory FMU-variable name trimmed
-	free(trimVariableName);
-	// deallocate xmlPath
-	free(xmlPath);
     return valueRef;
 }
 
@@ -1002,32 +900,21 @@ fmiInteger getValueReferenceByNameFMUOutputVariables(
 ///  needed to do the step in FMU. It returns an integer  
 ///  which indicates whether the step was successfully done 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance
 ///\param curCommPoint current communication intervall 
-///\param newStep flag to accept or reject step
 ///\param commStepSize size communication timestep
-///\param sizefmuWorkingFolder size of FMU-working folder
-///\param modelID FMU modelID
-///\param sizemodelID size FMU modelID
+///\param newStep flag to accept or reject step
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiStatus fmiEPlusDoStep(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, fmiReal *curCommPoint, 
-	fmiReal *commStepSize, fmiInteger *newStep, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusDoStep(fmiComponent *fmuInstance, 
+	fmiReal *curCommPoint, fmiReal *commStepSize, 
+	fmiInteger *newStep, fmiInteger *index) {
 	
-	char *trimfmuWorkingFolder;
-	fmiString trimmodelID; 
-
+	FMU* fmu;
 	fmiBoolean newStepBoolean;
-    fmiStatus fmiFlag;              
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-    
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
 
 	// map the newStep to the fmiBoolean value
 	if (*newStep == 0)
@@ -1035,68 +922,435 @@ fmiStatus fmiEPlusDoStep(fmiString fmuWorkingFolder,
 	else
 		newStepBoolean = fmiTrue;
 
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
+	return fmu->doStep(*fmuInstance, *curCommPoint, *commStepSize, newStepBoolean);
+}
 
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE); 
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to set the variables that are exchanged with the 
+///  FMU at every communication step. The value references 
+///  are checked once and kept in one contiguous buffer, 
+///  so that fmiEPlusExchange() does not check them again.
+///  
+///\param inpValRef value references of the FMU inputs
+///\param numInputs number of FMU inputs
+///\param outValRef value references of the FMU outputs
+///\param numOutputs number of FMU outputs
+///\param index index of the FMU instance
+////////////////////////////////////////////////////////////////
+fmiStatus fmiEPlusSetExchangeVariables(const fmiValueReference *inpValRef, 
+	fmiInteger *numInputs, const fmiValueReference *outValRef, 
+	fmiInteger *numOutputs, fmiInteger *index) {
 
-	fmiFlag = fmu.doStep(*fmuInstance, *curCommPoint, *commStepSize, newStepBoolean);
+	FMU* fmu;
+	int numValRef;
 
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-	return fmiFlag;
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+
+	if (*numInputs < 0 || *numOutputs < 0) return fmiError;
+	if (fmu->exchangePending) {
+		printf("Error: exchange variables of %s are changed while an exchange is pending!\n", fmu->modelID);
+		return fmiError;
+	}
+	if (checkValueReferences(fmu, inpValRef, *numInputs, elm_Real, enu_input)) return fmiError;
+	if (checkValueReferences(fmu, outValRef, *numOutputs, elm_Real, enu_output)) return fmiError;
+
+	// inputs first, then outputs, in both the value references and the values
+	// of fmiEPlusPostExchange(), so that both are sized from the same counts
+	free(fmu->exchangeValRef);
+	free(fmu->exchangeVal);
+	numValRef = *numInputs + *numOutputs;
+	fmu->exchangeValRef = calloc(sizeof(fmiValueReference), numValRef > 0 ? numValRef : 1);
+	fmu->exchangeVal = (fmiReal*)calloc(sizeof(fmiReal), numValRef > 0 ? numValRef : 1);
+	if (!fmu->exchangeValRef || !fmu->exchangeVal) {
+		free(fmu->exchangeValRef);
+		free(fmu->exchangeVal);
+		fmu->exchangeValRef = NULL;
+		fmu->exchangeVal = NULL;
+		printf("Error: failed to allocate memory for exchange variables of %s\n", fmu->modelID);
+		fmu->numExchangeInputs = fmu->numExchangeOutputs = 0;
+		return fmiError;
+	}
+	memcpy(fmu->exchangeValRef, inpValRef, *numInputs*sizeof(fmiValueReference));
+	memcpy(fmu->exchangeValRef + *numInputs, outValRef, *numOutputs*sizeof(fmiValueReference));
+	fmu->numExchangeInputs = *numInputs;
+	fmu->numExchangeOutputs = *numOutputs;
+	return fmiOK;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to get the outputs that are exchanged with the 
+///  FMU, as set by fmiEPlusSetExchangeVariables(). 
+///  It is only needed before the first fmiEPlusExchange() 
+///  after the FMU has been initialized.
+///  
+///\param fmuInstance FMU-instance
+///\param outVal output values
+///\param index index of the FMU instance
+////////////////////////////////////////////////////////////////
+fmiStatus fmiEPlusGetExchangeOutputs(fmiComponent *fmuInstance, 
+	fmiReal *outVal, fmiInteger *index) {
+
+	FMU* fmu;
+
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+
+	if (fmu->numExchangeOutputs == 0) return fmiOK;
+	return fmu->getReal(*fmuInstance, fmu->exchangeValRef + fmu->numExchangeInputs, 
+		fmu->numExchangeOutputs, outVal);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Exchange data with an FMU instance for one communication step: 
+/// set the inputs, do the step and get the outputs at the end of the step, 
+/// using the variables set by fmiEPlusSetExchangeVariables().
+///
+///\param fmu FMU instance.
+///\param c FMU component.
+///\param inpVal input values.
+///\param setInputs flag to set the inputs before the step.
+///\param curCommPoint current communication point.
+///\param commStepSize communication step size.
+///\param newStep flag to accept or reject step.
+///\param outVal output values at the end of the step.
+///\return The status of the first call to the FMU that did not return fmiOK.
+///////////////////////////////////////////////////////////////////////////////
+static fmiStatus exchange(FMU* fmu, fmiComponent c, const fmiReal *inpVal, 
+	int setInputs, fmiReal curCommPoint, fmiReal commStepSize, 
+	fmiBoolean newStep, fmiReal *outVal) {
+
+	fmiStatus fmiFlag;
+
+	// set real values in fmu
+	if (setInputs && fmu->numExchangeInputs > 0) {
+		fmiFlag = fmu->setReal(c, fmu->exchangeValRef, fmu->numExchangeInputs, inpVal);
+		if (fmiFlag != fmiOK) {
+			printf("Error: failed to set inputs of %s in fmiEPlusExchange!\n", fmu->modelID);
+			return fmiFlag;
+		}
+	}
+
+	// do the step
+	fmiFlag = fmu->doStep(c, curCommPoint, commStepSize, newStep);
+	if (fmiFlag != fmiOK) {
+		printf("Error: failed to do the step of %s in fmiEPlusExchange!\n", fmu->modelID);
+		return fmiFlag;
+	}
+
+	// get real values from fmu
+	if (fmu->numExchangeOutputs > 0) {
+		fmiFlag = fmu->getReal(c, fmu->exchangeValRef + fmu->numExchangeInputs, 
+			fmu->numExchangeOutputs, outVal);
+		if (fmiFlag != fmiOK) {
+			printf("Error: failed to get outputs of %s in fmiEPlusExchange!\n", fmu->modelID);
+			return fmiFlag;
+		}
+	}
+	return fmiOK;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to exchange data with the FMU for one communication 
+///  step in a single call: it sets the inputs, does the step 
+///  and gets the outputs at the end of the step, using the 
+///  variables set by fmiEPlusSetExchangeVariables(). 
+///  It returns the status of the first call to the FMU 
+///  that did not return fmiOK.
+///  
+///\param fmuInstance FMU-instance
+///\param inpVal input values
+///\param setInputs flag to set the inputs before the step
+///\param curCommPoint current communication intervall 
+///\param commStepSize size communication timestep
+///\param newStep flag to accept or reject step
+///\param outVal output values at the end of the step
+///\param index index of the FMU instance
+////////////////////////////////////////////////////////////////
+fmiStatus fmiEPlusExchange(fmiComponent *fmuInstance, 
+	const fmiReal *inpVal, fmiInteger *setInputs, 
+	fmiReal *curCommPoint, fmiReal *commStepSize, 
+	fmiInteger *newStep, fmiReal *outVal, fmiInteger *index) {
+
+	FMU* fmu;
+
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+
+	return exchange(fmu, *fmuInstance, inpVal, *setInputs != 0, *curCommPoint, 
+		*commStepSize, *newStep == 0 ? fmiFalse : fmiTrue, outVal);
+}
+
+// Worker threads that run the exchanges posted with fmiEPlusPostExchange(). 
+// The exchanges are grouped into tasks by FMI functions library: instances 
+// that share a library may share its global data, so they are stepped one 
+// after the other in one task, while the tasks run concurrently.
+static HANDLE* exchangeThreads = NULL;
+static int numExchangeThreads = 0;
+static HANDLE exchangeStart = NULL;     // semaphore released once per worker and run
+static HANDLE exchangeDone = NULL;      // event set when the last worker is done
+static volatile LONG numExchangeWorkersBusy = 0;
+static volatile LONG nextExchangeTask = 0;
+static volatile LONG stopExchangeThreads = 0;
+static HANDLE* exchangeTasks = NULL;    // library of each task
+static int numExchangeTasks = 0;
+static int numExchangeTasksAllocated = 0;
+
+///////////////////////////////////////////////////////////////////////////////
+/// Run the exchanges of one task, that is of all pending FMU instances 
+/// that use the library of the task, in the order of their index.
+///
+///\param task Index of the task.
+///////////////////////////////////////////////////////////////////////////////
+static void runExchangeTask(int task) {
+	int i;
+	FMU* fmu;
+
+	for (i = 0; i < numFMUInstances; i++) {
+		fmu = fmuInstances[i];
+		// check the library first: the other tasks update their own instances only
+		if (!fmu || fmu->dllHandle != exchangeTasks[task] || !fmu->exchangePending) continue;
+		fmu->exchangeStatus = exchange(fmu, fmu->exchangeInstance, fmu->exchangeVal, 
+			fmu->exchangeSetInputs, fmu->exchangeCommPoint, fmu->exchangeStepSize, 
+			fmu->exchangeNewStep, fmu->exchangeVal + fmu->numExchangeInputs);
+		fmu->exchangePending = 0;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Run tasks until there are none left.
+///////////////////////////////////////////////////////////////////////////////
+static void runExchangeTasks() {
+	LONG task;
+
+	while ((task = InterlockedIncrement(&nextExchangeTask) - 1) < numExchangeTasks)
+		runExchangeTask((int)task);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Main function of the worker threads.
+///
+///\param arg Not used.
+///\return 0.
+///////////////////////////////////////////////////////////////////////////////
+static DWORD WINAPI exchangeThreadMain(LPVOID arg) {
+	for (;;) {
+		WaitForSingleObject(exchangeStart, INFINITE);
+		if (stopExchangeThreads) break;
+		runExchangeTasks();
+		if (InterlockedDecrement(&numExchangeWorkersBusy) == 0) SetEvent(exchangeDone);
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Stop the worker threads.
+///////////////////////////////////////////////////////////////////////////////
+static void stopExchangeThreadPool() {
+	if (numExchangeThreads > 0) {
+		stopExchangeThreads = 1;
+		ReleaseSemaphore(exchangeStart, numExchangeThreads, NULL);
+		WaitForMultipleObjects(numExchangeThreads, exchangeThreads, TRUE, INFINITE);
+		while (numExchangeThreads > 0) CloseHandle(exchangeThreads[--numExchangeThreads]);
+	}
+	if (exchangeStart) CloseHandle(exchangeStart);
+	if (exchangeDone) CloseHandle(exchangeDone);
+	free(exchangeThreads);
+	exchangeThreads = NULL;
+	exchangeStart = exchangeDone = NULL;
+	stopExchangeThreads = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Start the worker threads, unless they run already.
+///
+///\param numThreads Number of worker threads.
+///\return 0 if there is no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int startExchangeThreadPool(int numThreads) {
+	if (numExchangeThreads == numThreads) return 0;
+	stopExchangeThreadPool();
+	// MAXIMUM_WAIT_OBJECTS limits the threads that can be waited for at once
+	if (numThreads > MAXIMUM_WAIT_OBJECTS) numThreads = MAXIMUM_WAIT_OBJECTS;
+
+	exchangeThreads = (HANDLE*)calloc(numThreads, sizeof(HANDLE));
+	exchangeStart = CreateSemaphore(NULL, 0, numThreads, NULL);
+	exchangeDone = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (!exchangeThreads || !exchangeStart || !exchangeDone) {
+		printf("Error: failed to create the threads to exchange data with FMUs!\n");
+		stopExchangeThreadPool();
+		return -1;
+	}
+	while (numExchangeThreads < numThreads) {
+		exchangeThreads[numExchangeThreads] = CreateThread(NULL, 0, exchangeThreadMain, NULL, 0, NULL);
+		if (!exchangeThreads[numExchangeThreads]) {
+			printf("Error: failed to create the threads to exchange data with FMUs!\n");
+			stopExchangeThreadPool();
+			return -1;
+		}
+		numExchangeThreads++;
+	}
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to post the data exchange with the FMU for one 
+///  communication step. The inputs are copied, and the exchange 
+///  is done, as in fmiEPlusExchange(), by the next call to 
+///  fmiEPlusRunExchanges(), concurrently with the exchanges 
+///  of the other FMU instances. 
+///  
+///\param fmuInstance FMU-instance
+///\param inpVal input values
+///\param setInputs flag to set the inputs before the step
+///\param curCommPoint current communication intervall 
+///\param commStepSize size communication timestep
+///\param newStep flag to accept or reject step
+///\param index index of the FMU instance
+////////////////////////////////////////////////////////////////
+fmiStatus fmiEPlusPostExchange(fmiComponent *fmuInstance, 
+	const fmiReal *inpVal, fmiInteger *setInputs, 
+	fmiReal *curCommPoint, fmiReal *commStepSize, 
+	fmiInteger *newStep, fmiInteger *index) {
+
+	FMU* fmu;
+
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+
+	if (!fmu->exchangeVal) {
+		printf("Error: no exchange variables of %s are set in fmiEPlusPostExchange!\n", fmu->modelID);
+		return fmiError;
+	}
+	memcpy(fmu->exchangeVal, inpVal, fmu->numExchangeInputs*sizeof(fmiReal));
+	fmu->exchangeInstance = *fmuInstance;
+	fmu->exchangeSetInputs = *setInputs != 0;
+	fmu->exchangeCommPoint = *curCommPoint;
+	fmu->exchangeStepSize = *commStepSize;
+	fmu->exchangeNewStep = *newStep == 0 ? fmiFalse : fmiTrue;
+	fmu->exchangeStatus = fmiOK;
+	fmu->exchangePending = 1;
+	return fmiOK;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to run the exchanges posted with fmiEPlusPostExchange(). 
+///  Instances that use different FMI functions libraries are 
+///  stepped concurrently on up to numThreads threads, the calling 
+///  thread included. It returns when all exchanges are done; 
+///  their status is returned by fmiEPlusCollectExchange().
+///  
+///\param numThreads number of threads
+///\return 0 if there is no error occurred.
+////////////////////////////////////////////////////////////////
+fmiInteger fmiEPlusRunExchanges(fmiInteger *numThreads) {
+
+	int i, j, numWorkers;
+	HANDLE* tmp;
+
+	// one task per library of the pending instances
+	numExchangeTasks = 0;
+	for (i = 0; i < numFMUInstances; i++) {
+		if (!fmuInstances[i] || !fmuInstances[i]->exchangePending) continue;
+		for (j = 0; j < numExchangeTasks; j++) 
+			if (exchangeTasks[j] == fmuInstances[i]->dllHandle) break;
+		if (j < numExchangeTasks) continue;
+		if (numExchangeTasks == numExchangeTasksAllocated) {
+			int numAllocated = numExchangeTasksAllocated ? 2*numExchangeTasksAllocated : 8;
+			tmp = (HANDLE*)realloc(exchangeTasks, numAllocated*sizeof(HANDLE));
+			if (!tmp) {
+				printf("Error: failed to allocate memory for FMU exchange tasks!\n");
+				return -1;
+			}
+			exchangeTasks = tmp;
+			numExchangeTasksAllocated = numAllocated;
+		}
+		exchangeTasks[numExchangeTasks++] = fmuInstances[i]->dllHandle;
+	}
+
+	// the calling thread runs tasks too
+	numWorkers = *numThreads - 1;
+	if (numWorkers > numExchangeTasks - 1) numWorkers = numExchangeTasks - 1;
+	if (numWorkers > 0 && startExchangeThreadPool(numWorkers)) numWorkers = 0;
+	if (numWorkers > numExchangeThreads) numWorkers = numExchangeThreads;
+
+	nextExchangeTask = 0;
+	if (numWorkers > 0) {
+		numExchangeWorkersBusy = numWorkers;
+		ReleaseSemaphore(exchangeStart, numWorkers, NULL);
+	}
+	runExchangeTasks();
+	if (numWorkers > 0) WaitForSingleObject(exchangeDone, INFINITE);
+	return 0;
+}
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to collect the outputs at the end of the step of 
+///  an exchange run by fmiEPlusRunExchanges(). It returns 
+///  the status of the exchange, as fmiEPlusExchange() does.
+///  
+///\param outVal output values at the end of the step
+///\param index index of the FMU instance
+////////////////////////////////////////////////////////////////
+fmiStatus fmiEPlusCollectExchange(fmiReal *outVal, fmiInteger *index) {
+
+	FMU* fmu;
+
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
+
+	if (!fmu->exchangeVal || fmu->exchangePending) {
+		printf("Error: no exchange of %s has been run in fmiEPlusCollectExchange!\n", fmu->modelID);
+		return fmiError;
+	}
+	if (fmu->exchangeStatus == fmiOK) 
+		memcpy(outVal, fmu->exchangeVal + fmu->numExchangeInputs, fmu->numExchangeOutputs*sizeof(fmiReal));
+	return fmu->exchangeStatus;
 }
 
 // This function is an interface to the function in Fortran that is needed to free the FMU.
-// It is called at the end of the co-simulaton and should also free the dll used for the
+// It is called at the end of the co-simulaton and also frees the dll used for the
 // co-simulation.
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to free FMU. It returns an integer  
 ///  which indicates whether the FMU was successfully free 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance
-///\param sizefmuWorkingFolder size of FMU-working folder
-///\param modelID FMU modelID
-///\param sizemodelID  size FMU modelID
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 
-fmiStatus fmiEPlusFreeSlave(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID) {
+fmiStatus fmiEPlusFreeSlave(fmiComponent *fmuInstance, fmiInteger *index) {
 	
-	char *trimfmuWorkingFolder;
-    fmiString trimmodelID;
+	FMU* fmu;
+	int i;
 
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
-
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE); 
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
 
     // free slave in fmu
-	fmu.freeSlaveInstance (*fmuInstance);
-
-    // deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-    // free modelDescription
-	freeElement (fmu.modelDescription);
+	if (fmu->dllHandle) fmu->freeSlaveInstance (*fmuInstance);
+	fmu->instance = NULL;
+
+	// unload the dll, but keep the modelDescription and paths since 
+	// ExternalInterface instantiates the FMU again after the warmup
+	unloadLib(fmu);
+
+	// stop the exchange threads once all slaves are freed
+	for (i = 0; i < numFMUInstances; i++) 
+		if (fmuInstances[i] && fmuInstances[i]->instance) break;
+	if (i == numFMUInstances) {
+		stopExchangeThreadPool();
+		free(exchangeTasks);
+		exchangeTasks = NULL;
+		numExchangeTasks = numExchangeTasksAllocated = 0;
+	}
 	return 0;
 }
 
@@ -1107,41 +1361,18 @@ fmiStatus fmiEPlusFreeSlave(fmiString fmuWorkingFolder,
 ///  needed to reset FMU. It returns an integer  
 ///  which indicates whether the FMU was successfully reset 
 ///  
-///\param fmuWorkingFolder path to the FMU-working directory
 ///\param fmuInstance FMU-instance
-///\param sizefmuWorkingFolder size of FMU-working folder
-///\param modelID FMU modelID
-///\param sizemodelID  sizeFMU modelID
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
-fmiStatus fmiEPlusResetSlave(fmiString fmuWorkingFolder, 
-	fmiComponent *fmuInstance, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID) {
-	
-	char *trimfmuWorkingFolder;
-    fmiString trimmodelID;
-	fmiStatus fmiFlag;
+fmiStatus fmiEPlusResetSlave(fmiComponent *fmuInstance, fmiInteger *index) {
 	
-	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
-	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
+	FMU* fmu;
 
-	// allocate memory for the FMU-modelId withouth blanks
-	trimmodelID = calloc(sizeof(char),*sizemodelID + 1);
-	//write modelID withouth blanks
-	strncpy(trimmodelID, modelID, *sizemodelID);
-
-	//load lib by specifying path to the binaries
-	if (loadLib(trimfmuWorkingFolder, trimmodelID, &fmu)) exit(EXIT_FAILURE); 
+	fmu = getFMUInstance(index);
+	if (!fmu) return fmiError;
 
 	// reset slave in fmu
-	fmiFlag = fmu.resetSlaveInstance (*fmuInstance);
-	
-	// deallocate memory FMU-working folder trimmed
-	free(trimfmuWorkingFolder);
-	// deallocate memory for trimmed modelID
-	free(trimmodelID);
-	return fmiFlag;
+	return fmu->resetSlaveInstance (*fmuInstance);
 }
 
 
@@ -1190,16 +1421,16 @@ fmiInteger addFMURootFolderName(fmiString fmuOutputWorkingFolder,
 /// with path to binaries
 ///\param fmuWorkingFolder FMU-working folder
 ///\param sizefmuWorkingFolder size of FMU-working folder
-///\param fmumodelID FMU-modelID
-///\param sizefmumodelID size of FMU-modelID
+///\param index index of the FMU instance
 ////////////////////////////////////////////////////////////////
 
 fmiInteger addLibPathCurrentWorkingFolder(
 	fmiString trimfmuOutputWorkingFolder_wLiB, 
 	fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, 
-	fmiString fmumodelID, fmiInteger *sizefmumodelID) {
+	fmiInteger *index) {
+	FMU* fmu;
 	char *trimfmuWorkingFolder;
-	char *trimfmumodelID;
+	const char *trimfmumodelID;
 	char * librPath_w32;
 	char * librPath_w64;
 	struct stat st;
@@ -1212,17 +1443,17 @@ fmiInteger addLibPathCurrentWorkingFolder(
 	fmiBoolean bRes_l32;
 	fmiBoolean bRes_l64;
 	 
+	fmu = getFMUInstance(index);
+	if (!fmu) return -1;
+
 	// allocate memory for the FMU-working folder trimmed
 	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
     
 	//write fmuWorkingFolder withouth blanks
 	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
 
-	// allocate memory for the FMU-modelID trimmed
-	trimfmumodelID = calloc(sizeof(char),*sizefmumodelID + 1);
-    
-	//write FMU-modelID withouth blanks
-	strncpy(trimfmumodelID, fmumodelID, *sizefmumodelID);
+	// the modelID was stored by model_ID_GUID()
+	trimfmumodelID = fmu->modelID;
 
 	#ifdef _MSC_VER
 		len_LibPath = strlen(trimfmuWorkingFolder) + strlen(BIN_WIN) + strlen (trimfmumodelID) + strlen (LIB_EXT);
@@ -1302,10 +1533,12 @@ fmiInteger addLibPathCurrentWorkingFolder(
 			}
 	#endif
 	
+	// keep the path to the binaries so that the library is loaded once per FMU instance
+	free(fmu->libPath);
+	fmu->libPath = strdup(trimfmuOutputWorkingFolder_wLiB);
+
 	// deallocate memory FMU-working folder trimmed
 	free(trimfmuWorkingFolder);
-	// deallocate memory FMU-modelID
-	free(trimfmumodelID);
 	
 	if (WINDOWS) {
 	  // deallocate memory for path for binaries for windows 32 bit
@@ -1324,65 +1557,260 @@ fmiInteger addLibPathCurrentWorkingFolder(
 	return 0;	
 }
 
+// Folder of the extraction cache, or NULL if the FMUs are unpacked 
+// on every run. An entry of the cache is a folder, named by the key 
+// of the FMU file, with the unpacked FMU and its model description 
+// in binary form. Entries are never changed once they are published.
+static char* fmuCacheFolder = NULL;
+
+// Working folders that were copied from the cache, with the path 
+// of the model description in binary form that model_ID_GUID() reads.
+static char** cachedWorkingFolders = NULL;
+static char** cachedBinPaths = NULL;
+static int numCachedWorkingFolders = 0;
+
+////////////////////////////////////////////////////////////////
+///  This method is an interface to the function in Fortran 
+///  needed to set the folder of the extraction cache. It 
+///  creates the folder if it does not exist and returns 
+///  an integer which indicates whether it was successful.
+///  
+///\param cacheFolder folder of the extraction cache
+///\param sizeCacheFolder size of the folder trimmed
+////////////////////////////////////////////////////////////////
+fmiInteger fmiEPlusSetCacheFolder(fmiString cacheFolder, 
+	fmiInteger *sizeCacheFolder) {
+	char* trimCacheFolder;
+	char* cmd;
+	struct stat st;
+
+	free(fmuCacheFolder);
+	fmuCacheFolder = NULL;
+
+	// allocate memory for the cache folder trimmed
+	trimCacheFolder = calloc(sizeof(char), *sizeCacheFolder + 1);
+	strncpy(trimCacheFolder, cacheFolder, *sizeCacheFolder);
+	if (stat(trimCacheFolder, &st) != 0) {
+		cmd = calloc(sizeof(char), strlen(trimCacheFolder) + 9);
+		sprintf(cmd, "mkdir \"%s\"", trimCacheFolder);
+		// a concurrent simulation may create the folder as well
+		if (system(cmd) != 0 && stat(trimCacheFolder, &st) != 0) {
+			printf("Error: failed to create FMU cache folder %s!\n", trimCacheFolder);
+			free(cmd);
+			free(trimCacheFolder);
+			return -1;
+		}
+		free(cmd);
+	}
+	// keep a path separator at the end for the entries
+	fmuCacheFolder = getTmpPath(trimCacheFolder, *sizeCacheFolder);
+	free(trimCacheFolder);
+	return fmuCacheFolder ? 0 : -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Get the entry of an FMU in the extraction cache. If the FMU is not in 
+/// the cache, it is unpacked and its model description is parsed and written 
+/// in binary form into a folder that no other simulation uses. This folder is 
+/// then renamed to the entry, which publishes the complete entry at once. 
+/// If a concurrent simulation published the entry first, the rename fails 
+/// and that entry is used.
+///
+///\param fmuName FMU-fileName.
+///\return The path of the entry, or NULL if the FMU cannot be cached.
+///////////////////////////////////////////////////////////////////////////////
+static char* getCacheEntry(char* fmuName) {
+	static int numTmpFolders = 0;
+	char key[84];
+	char* entry;
+	char* tmpFolder;
+	char* xmlPath;
+	char* binPath;
+	ModelDescription* md;
+	struct stat st;
+	int ok;
+
+	if (hashFile(fmuName, key)) return NULL;
+	entry = calloc(sizeof(char), strlen(fmuCacheFolder) + strlen(key) + 1);
+	sprintf(entry, "%s%s", fmuCacheFolder, key);
+	binPath = calloc(sizeof(char), strlen(entry) + strlen(MD_BIN_FILE) + 1);
+	sprintf(binPath, "%s%s", entry, MD_BIN_FILE);
+	if (stat(binPath, &st) == 0) {
+		free(binPath);
+		return entry;
+	}
+	free(binPath);
+
+	tmpFolder = calloc(sizeof(char), strlen(entry) + 32);
+	sprintf(tmpFolder, "%s.%lu.%d.tmp", entry, (unsigned long)GetCurrentProcessId(), numTmpFolders++);
+	xmlPath = calloc(sizeof(char), strlen(tmpFolder) + strlen(XML_FILE) + 1);
+	sprintf(xmlPath, "%s%s", tmpFolder, XML_FILE);
+	binPath = calloc(sizeof(char), strlen(tmpFolder) + strlen(MD_BIN_FILE) + 1);
+	sprintf(binPath, "%s%s", tmpFolder, MD_BIN_FILE);
+
+	ok = unpackminizip(fmuName, tmpFolder) == 0;
+	if (ok) {
+		md = parse(xmlPath);
+		ok = md && writeModelDescription(md, binPath) == 0;
+		if (md) freeElement(md);
+	}
+	if (ok && rename(tmpFolder, entry) == 0) {
+		free(tmpFolder);
+		free(xmlPath);
+		free(binPath);
+		return entry;
+	}
+	if (stat(tmpFolder, &st) == 0) delete(tmpFolder);
+	free(tmpFolder);
+	free(xmlPath);
+	free(binPath);
+
+	// the entry may have been published by a concurrent simulation
+	binPath = calloc(sizeof(char), strlen(entry) + strlen(MD_BIN_FILE) + 1);
+	sprintf(binPath, "%s%s", entry, MD_BIN_FILE);
+	ok = ok && stat(binPath, &st) == 0;
+	free(binPath);
+	if (ok) return entry;
+	free(entry);
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Set the model description in binary form of a working folder, 
+/// or remove it if \c binPath is NULL.
+///
+///\param workingFolder The working folder.
+///\param binPath The model description in binary form, or NULL.
+///\return 0 if there is no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int setCachedBinPath(const char* workingFolder, const char* binPath) {
+	char** tmp;
+	int i;
+	for (i=0; i<numCachedWorkingFolders; i++)
+		if (!strcmp(cachedWorkingFolders[i], workingFolder)) break;
+	if (i == numCachedWorkingFolders) {
+		if (!binPath) return 0;
+		tmp = (char**)realloc(cachedWorkingFolders, (i + 1)*sizeof(char*));
+		if (!tmp) return -1;
+		cachedWorkingFolders = tmp;
+		tmp = (char**)realloc(cachedBinPaths, (i + 1)*sizeof(char*));
+		if (!tmp) return -1;
+		cachedBinPaths = tmp;
+		cachedWorkingFolders[i] = strdup(workingFolder);
+		cachedBinPaths[i] = NULL;
+		numCachedWorkingFolders++;
+	}
+	free(cachedBinPaths[i]);
+	cachedBinPaths[i] = binPath ? strdup(binPath) : NULL;
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Get the model description in binary form of a working folder.
+///
+///\param workingFolder The working folder.
+///\return The path of the model description in binary form, or NULL 
+///        if the working folder was not copied from the extraction cache.
+///////////////////////////////////////////////////////////////////////////////
+static const char* getCachedBinPath(const char* workingFolder) {
+	int i;
+	for (i=0; i<numCachedWorkingFolders; i++)
+		if (!strcmp(cachedWorkingFolders[i], workingFolder)) return cachedBinPaths[i];
+	return NULL;
+}
+
 ////////////////////////////////////////////////////////////////
 ///  This method is an interface to the function in Fortran 
 ///  needed to get the modelID and the modelGUID of the FMU.
-///  It returns an integer  
-///  which indicates whether the routine was successfully
+///  It parses the model description, keeps it with the 
+///  modelID and modelGUID in a new FMU instance, and returns 
+///  the index of that instance which is passed to all 
+///  later calls, or -1 if an error occurred.
 ///  
 ///\param fmuWorkingFolder FMU output working folder
 ///\param sizefmuWorkingFolder size of FMU-working folder
-///\param modelID FMU-modelID
-///\param modelGUID FMU-modelGUID
+///\param numInputs number of FMU input variables
+///\param numOutputs number of FMU output variables
 ////////////////////////////////////////////////////////////////
 
 fmiInteger model_ID_GUID(fmiString fmuWorkingFolder, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiString modelGUID) {
+	fmiInteger *sizefmuWorkingFolder, fmiInteger *numInputs, 
+	fmiInteger *numOutputs) {
 	
+	FMU* fmu;
 	char* xmlPath;
-	char * trimfmuWorkingFolder;
+	const char* binPath;
 	fmiString mID;
 	fmiString mGUID;
+	ScalarVariable** vars;
+	fmiInteger index;
+	int k;
+
+	// allocate the FMU instance
+	fmu = calloc(sizeof(FMU), 1);
+	if (!fmu) {
+		printf("Error: failed to allocate memory for FMU instance in fmiGetModelID!\n");
+		return -1;
+	}
+	index = addFMUInstance(fmu);
+	if (index < 0) {
+		free(fmu);
+		return -1;
+	}
 
 	// allocate memory for the FMU-working folder trimmed
-	trimfmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
+	fmu->fmuWorkingFolder = calloc(sizeof(char),*sizefmuWorkingFolder + 1);
 	//write fmuWorkingFolder withouth blanks
-	strncpy(trimfmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
-    
-    xmlPath = calloc(sizeof(char), strlen(trimfmuWorkingFolder) + strlen(XML_FILE) + 1);
-	// write path to the FMU
-    sprintf(xmlPath, "%s%s", trimfmuWorkingFolder, XML_FILE);
+	strncpy(fmu->fmuWorkingFolder, fmuWorkingFolder, *sizefmuWorkingFolder);
     
-	// parse the xml-file and getModelDescription
-    fmu.modelDescription = parse(xmlPath); 
+	// read the model description that was parsed when the FMU was added 
+	// to the extraction cache, or parse the xml-file
+	binPath = getCachedBinPath(fmu->fmuWorkingFolder);
+	if (binPath) fmu->modelDescription = readModelDescription(binPath);
+	if (!fmu->modelDescription) {
+		xmlPath = calloc(sizeof(char), strlen(fmu->fmuWorkingFolder) + strlen(XML_FILE) + 1);
+		// write path to the FMU
+		sprintf(xmlPath, "%s%s", fmu->fmuWorkingFolder, XML_FILE);
+		fmu->modelDescription = parse(xmlPath); 
+		// deallocate xmlPath
+		free (xmlPath);
+	}
     // check whether modelDescription exists or not
-	if (!fmu.modelDescription) {
+	if (!fmu->modelDescription) {
 		printf("Error: failed to get the modelDescription in fmiGetModelID!\n");
+		freeFMUInstance(index);
 		return -1;
 	}
-	// gets the modelID of the FMU
-	mID = getModelIdentifier(fmu.modelDescription);
-	strncpy(modelID, mID, strlen (mID)+ 1);
 
-	if (!modelID) {
+	// gets the modelID of the FMU
+	mID = getModelIdentifier(fmu->modelDescription);
+	if (!mID) {
 		printf("Error: failed to get modelID in fmiGetModelID!\n");
+		freeFMUInstance(index);
 		return -1;
 	}
+	fmu->modelID = strdup(mID);
 
     // get the model GUID of the FMU
-	mGUID = getString(fmu.modelDescription, att_guid);
-	strncpy(modelGUID, mGUID, strlen (mGUID)+ 1);
-	 
-	if (!modelGUID) {
+	mGUID = getString(fmu->modelDescription, att_guid);
+	if (!mGUID) {
 		printf("Error: failed to get modelGUID in fmiGetModelGUID!\n");
+		freeFMUInstance(index);
 		return -1;
 	}
-	// deallocate xmlPath
-	free (xmlPath);
-	// free trimmed working folder
-	free (trimfmuWorkingFolder);
-	return 0;	
+	fmu->modelGUID = strdup(mGUID);
+
+	// get number of input and output variables
+	*numInputs = 0;
+	*numOutputs = 0;
+	vars = fmu->modelDescription->modelVariables;
+	if (vars)
+		for (k=0; vars[k]; k++) {
+			Enu causality = getCausality(vars[k]);
+			if (causality == enu_input) *numInputs = *numInputs + 1;
+			else if (causality == enu_output) *numOutputs = *numOutputs + 1;
+		}
+	return index;	
 }
 
 
@@ -1403,6 +1831,8 @@ fmiInteger fmiEPlusUnpack(fmiString fmuName,
 	
 	char * trimfmuOutputWorkingFolder;
 	char * trimfmuName;
+	char * entry;
+	char * binPath;
 	int retVal;
  
     // allocate memory for the FMU-Name trimmed
@@ -1417,8 +1847,20 @@ fmiInteger fmiEPlusUnpack(fmiString fmuName,
 	//write fmuWorkingFolder withouth blanks
 	strncpy(trimfmuOutputWorkingFolder, fmuOutputWorkingFolder, *sizefmuOutputWorkingFolder);
 
-	// unpack FMU in the working folder
-	retVal = unpackminizip (trimfmuName, trimfmuOutputWorkingFolder);
+	// copy the FMU from the extraction cache, or unpack FMU in the working folder.
+	// The working folders are not shared, so that every instance loads its own copy of the library.
+	setCachedBinPath(trimfmuOutputWorkingFolder, NULL);
+	entry = fmuCacheFolder ? getCacheEntry(trimfmuName) : NULL;
+	if (entry && copyFolder(entry, trimfmuOutputWorkingFolder) == 0) {
+		binPath = calloc(sizeof(char), strlen(entry) + strlen(MD_BIN_FILE) + 1);
+		sprintf(binPath, "%s%s", entry, MD_BIN_FILE);
+		setCachedBinPath(trimfmuOutputWorkingFolder, binPath);
+		free(binPath);
+		retVal = 0;
+	}
+	else
+		retVal = unpackminizip (trimfmuName, trimfmuOutputWorkingFolder);
+	free(entry);
 
 	if (retVal != 0) {
 		printf("Error: failed to unpack FMU in fmiEPlusUnpack!\n");
@@ -1599,93 +2041,121 @@ fmiInteger getNumOutputVariablesInFMU(fmiString fmuWorkingFolder,
 
 #else
   fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder, 
-         fmiReal *timeOut, fmiInteger *visible, fmiInteger *interactive, 
-		 fmiInteger *loggingOn, fmiInteger *sizefmuWorkingFolder, 
-		 fmiString modelID, fmiInteger *sizemodelID, fmiString modelGUID, 
-		 fmiInteger *sizemodelGUID) {
+	  fmiInteger *sizefmuWorkingFolder, fmiReal *timeOut, fmiInteger *visible, 
+	  fmiInteger *interactive, fmiInteger *loggingOn, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusInitializeSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  fmiReal *tStart, fmiInteger *newStep, fmiReal *tStop, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusInitializeSlave(fmiComponent *fmuInstance, fmiReal *tStart, 
+	  fmiInteger *newStep, fmiReal *tStop, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiReal fmiEPlusGetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusGetReal(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	  fmiReal *outVal, fmiInteger *numOutputs, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiInteger fmiEPlusGetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance,
-	  const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusGetInteger(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	  fmiInteger *outVal, fmiInteger *numOutputs, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusSetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiReal *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusSetReal(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	  fmiReal *inpVal, fmiInteger *numInputs, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusSetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  const fmiValueReference *valRef, fmiInteger *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusSetInteger(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	  fmiInteger *inpVal, fmiInteger *numInputs, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusDoStep(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusDoStep(fmiComponent *fmuInstance, fmiReal *curCommPoint, 
+	  fmiReal *commStepSize, fmiInteger *newStep, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusFreeSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusSetExchangeVariables(const fmiValueReference *inpValRef, fmiInteger *numInputs, 
+	  const fmiValueReference *outValRef, fmiInteger *numOutputs, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiStatus fmiEPlusResetSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	  fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID){
+  fmiStatus fmiEPlusGetExchangeOutputs(fmiComponent *fmuInstance, fmiReal *outVal, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
-  } 
+  }
+
+  fmiStatus fmiEPlusExchange(fmiComponent *fmuInstance, const fmiReal *inpVal, fmiInteger *setInputs, 
+	  fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, fmiReal *outVal, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiStatus fmiEPlusPostExchange(fmiComponent *fmuInstance, const fmiReal *inpVal, fmiInteger *setInputs, 
+	  fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiInteger fmiEPlusRunExchanges(fmiInteger *numThreads){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiStatus fmiEPlusCollectExchange(fmiReal *outVal, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiStatus fmiEPlusFreeSlave(fmiComponent *fmuInstance, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiStatus fmiEPlusResetSlave(fmiComponent *fmuInstance, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
 
   fmiInteger fmiEPlusUnpack(fmiString fmuName, fmiString fmuOutputWorkingFolder, 
 	  fmiInteger *sizefmuName, fmiInteger *sizefmuOutputWorkingFolder){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
-  } 
+  }
 
   fmiInteger fmiEPlusDelete(fmiString fmuOutputWorkingFolder, fmiInteger *sizefmuOutputWorkingFolder){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
-  } 
+  }
 
-  fmiInteger getValueReferenceByNameFMUInputVariables(fmiString fmuWorkingFolder, 
-	  fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName){
+  fmiInteger fmiEPlusSetCacheFolder(fmiString cacheFolder, fmiInteger *sizeCacheFolder){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-  fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString fmuWorkingFolder, 
-	  fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName){
+  fmiInteger getValueReferenceByNameFMUInputVariables(fmiString variableName, 
+	  fmiInteger *sizeVariableName, fmiInteger *index){
+			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
+			 exit(EXIT_FAILURE);
+  }
+
+  fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString variableName, 
+	  fmiInteger *sizeVariableName, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
   fmiInteger model_ID_GUID(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiString modelGUID){
+	  fmiInteger *numInputs, fmiInteger *numOutputs){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
@@ -1695,25 +2165,25 @@ fmiInteger getNumOutputVariablesInFMU(fmiString fmuWorkingFolder,
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
-  
+
   fmiInteger getNumInputVariablesInFMU(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
-   fmiInteger getNumOutputVariablesInFMU(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder){
+  fmiInteger getNumOutputVariablesInFMU(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
   fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, 
-	  fmiString modelID, fmiInteger *sizemodelID, fmiString fmiVersionNumber){
+	  fmiString fmiVersionNumber, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
 
   fmiInteger addLibPathCurrentWorkingFolder(fmiString trimfmuOutputWorkingFolder_wLiB, 
-	  fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiString fmumodelID, fmiInteger *sizefmumodelID){
+	  fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiInteger *index){
 			 printf("Error: FunctionalMock-up Unit for co-simulation is currently only supported on Windows");
 			 exit(EXIT_FAILURE);
   }
@@ -81,60 +81,88 @@ typedef struct {
     fGetString getString;
 	fDoStep doStep;	
 
+    // data of the FMU instance, kept from model_ID_GUID() to the end of the simulation
+    char* fmuWorkingFolder;
+    char* modelID;
+    char* modelGUID;
+    char* libPath;
+    fmiComponent instance;
+    // value references exchanged by fmiEPlusExchange(), inputs first, then outputs
+    int numExchangeInputs;
+    int numExchangeOutputs;
+    fmiValueReference* exchangeValRef;
+    // exchange posted by fmiEPlusPostExchange() and run by fmiEPlusRunExchanges(),
+    // exchangeVal holds the inputs first, then the outputs at the end of the step
+    fmiReal* exchangeVal;
+    fmiComponent exchangeInstance;
+    int exchangeSetInputs;
+    fmiReal exchangeCommPoint;
+    fmiReal exchangeStepSize;
+    fmiBoolean exchangeNewStep;
+    int exchangePending;
+    fmiStatus exchangeStatus;
 } FMU;
 
 fmiComponent fmiEPlusInstantiateSlave(fmiString fmuWorkingFolder, 
-         fmiReal *timeOut, fmiInteger *visible, fmiInteger *interactive, fmiInteger *loggingOn, 
-		 fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID, 
-		 fmiString modelGUID,	fmiInteger *sizemodelGUID);
+	fmiInteger *sizefmuWorkingFolder, fmiReal *timeOut, fmiInteger *visible, 
+	fmiInteger *interactive, fmiInteger *loggingOn, fmiInteger *index);
 
-fmiStatus fmiEPlusInitializeSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	fmiReal *tStart, fmiInteger *newStep, fmiReal *tStop, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID);
+fmiStatus fmiEPlusInitializeSlave(fmiComponent *fmuInstance, fmiReal *tStart, 
+	fmiInteger *newStep, fmiReal *tStop, fmiInteger *index);
 
-fmiReal fmiEPlusGetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID);
+fmiStatus fmiEPlusGetReal(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	fmiReal *outVal, fmiInteger *numOutputs, fmiInteger *index);
 
-fmiInteger fmiEPlusGetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	const fmiValueReference *valRef, fmiInteger *sizefmuWorkingFolder, fmiString modelID, 
-	fmiInteger *sizemodelID);
+fmiStatus fmiEPlusGetInteger(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	fmiInteger *outVal, fmiInteger *numOutputs, fmiInteger *index);
 
-fmiStatus fmiEPlusSetReal(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	const fmiValueReference *valRef, fmiReal *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID);
+fmiStatus fmiEPlusSetReal(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	fmiReal *inpVal, fmiInteger *numInputs, fmiInteger *index);
 
-fmiStatus fmiEPlusSetInteger(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	const fmiValueReference *valRef, fmiInteger *inpVal, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID);
+fmiStatus fmiEPlusSetInteger(fmiComponent *fmuInstance, const fmiValueReference *valRef, 
+	fmiInteger *inpVal, fmiInteger *numInputs, fmiInteger *index);
 
-fmiStatus fmiEPlusDoStep(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID);
+fmiStatus fmiEPlusDoStep(fmiComponent *fmuInstance, fmiReal *curCommPoint, 
+	fmiReal *commStepSize, fmiInteger *newStep, fmiInteger *index);
 
-fmiStatus fmiEPlusFreeSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID);
+fmiStatus fmiEPlusSetExchangeVariables(const fmiValueReference *inpValRef, fmiInteger *numInputs, 
+	const fmiValueReference *outValRef, fmiInteger *numOutputs, fmiInteger *index);
 
-fmiStatus fmiEPlusResetSlave(fmiString fmuWorkingFolder, fmiComponent *fmuInstance, 
-	fmiInteger *sizefmuWorkingFolder, fmiString modelID, fmiInteger *sizemodelID); 
+fmiStatus fmiEPlusGetExchangeOutputs(fmiComponent *fmuInstance, fmiReal *outVal, fmiInteger *index);
+
+fmiStatus fmiEPlusExchange(fmiComponent *fmuInstance, const fmiReal *inpVal, fmiInteger *setInputs, 
+	fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, fmiReal *outVal, 
+	fmiInteger *index);
+
+fmiStatus fmiEPlusPostExchange(fmiComponent *fmuInstance, const fmiReal *inpVal, fmiInteger *setInputs, 
+	fmiReal *curCommPoint, fmiReal *commStepSize, fmiInteger *newStep, fmiInteger *index);
+
+fmiInteger fmiEPlusRunExchanges(fmiInteger *numThreads);
+
+fmiStatus fmiEPlusCollectExchange(fmiReal *outVal, fmiInteger *index);
+
+fmiStatus fmiEPlusFreeSlave(fmiComponent *fmuInstance, fmiInteger *index);
+
+fmiStatus fmiEPlusResetSlave(fmiComponent *fmuInstance, fmiInteger *index); 
 
 fmiInteger fmiEPlusUnpack(fmiString fmuName, fmiString fmuOutputWorkingFolder, 
 	fmiInteger *sizefmuName, fmiInteger *sizefmuOutputWorkingFolder); 
 
 fmiInteger addLibPathCurrentWorkingFolder(fmiString trimfmuOutputWorkingFolder_wLiB, 
-	fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiString fmumodelID, 
-	fmiInteger *sizefmumodelID);
+	fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, fmiInteger *index);
 
 fmiInteger fmiEPlusDelete(fmiString fmuOutputWorkingFolder, fmiInteger *sizefmuOutputWorkingFolder); 
 
-fmiInteger getValueReferenceByNameFMUInputVariables(fmiString fmuWorkingFolder, 
-	fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName);
+fmiInteger fmiEPlusSetCacheFolder(fmiString cacheFolder, fmiInteger *sizeCacheFolder);
+
+fmiInteger getValueReferenceByNameFMUInputVariables(fmiString variableName, 
+	fmiInteger *sizeVariableName, fmiInteger *index);
 
-fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString fmuWorkingFolder, 
-	fmiString variableName, fmiInteger *sizefmuWorkingFolder, fmiInteger *sizeVariableName);
+fmiInteger getValueReferenceByNameFMUOutputVariables(fmiString variableName, 
+	fmiInteger *sizeVariableName, fmiInteger *index);
 
 fmiInteger model_ID_GUID(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiString modelGUID);
+	fmiInteger *numInputs, fmiInteger *numOutputs);
 
 fmiInteger addFMURootFolderName(fmiString fmuOutputWorkingFolder, fmiString fmuWorkingFolder, 
 	fmiInteger *sizefmuWorkingFolder);
@@ -144,7 +172,7 @@ fmiInteger getNumInputVariablesInFMU(fmiString fmuWorkingFolder, fmiInteger *siz
 fmiInteger getNumOutputVariablesInFMU(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder);
 
 fmiInteger getfmiEPlusVersion(fmiString fmuWorkingFolder, fmiInteger *sizefmuWorkingFolder, 
-	fmiString modelID, fmiInteger *sizemodelID, fmiString fmiVersionNumber);
+	fmiString fmiVersionNumber, fmiInteger *index);
 
 fmiInteger checkOperatingSystem(fmiString errorMessage);
 
@@ -81,6 +81,149 @@ int delete(char* tmpPat){
 	return 0;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// Copy the content of a folder to another folder, which is
+/// created if it does not exist
+///
+///\param srcPat The path of the folder to be copied
+///\param dstPat The path of the destination folder
+///\return 0 if no error occurred
+/////////////////////////////////////////////////////////////////////////
+int copyFolder(const char* srcPat, const char* dstPat){
+  char* cmd;
+
+  cmd = calloc(sizeof(char), 2*strlen(srcPat) + 2*strlen(dstPat) + 40);
+  if (cmd == NULL){
+    printfError("Fail to allocate memory for cmd.\n", dstPat);
+    return -1;
+  }
+
+  if (WINDOWS)
+    sprintf(cmd, "xcopy \"%s\" \"%s\" /E /I /Q /Y > nul", srcPat, dstPat); // Command in windows
+  else
+    sprintf(cmd, "mkdir -p \"%s\" && cp -r \"%s/.\" \"%s\"", dstPat, srcPat, dstPat); // Command in Linux
+
+  printfDebug("Generated cmd: \"%s\".\n", cmd);
+  if ( system(cmd) != 0 ){
+    printfError("Fail to copy folder \"%s\".\n", srcPat);
+    free(cmd);
+    return -1;
+  }
+  free(cmd);
+  return 0;
+}
+
+// SHA-256 round constants (FIPS 180-4)
+static const unsigned long sha256K[64] = {
+  0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL, 0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+  0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL, 0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+  0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL, 0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+  0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL, 0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+  0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL, 0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+  0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL, 0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+  0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL, 0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+  0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL, 0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+#define SHA256_ROTR(x, n) ((((x) >> (n)) | ((x) << (32 - (n)))) & 0xffffffffUL)
+
+//////////////////////////////////////////////////////////////////////////
+/// Process one 64 byte block of SHA-256.
+///
+///\param state The hash state, updated in place
+///\param block The block
+/////////////////////////////////////////////////////////////////////////
+static void sha256Block(unsigned long state[8], const unsigned char block[64]){
+  unsigned long w[64];
+  unsigned long a, b, c, d, e, f, g, h, t1, t2;
+  int i;
+
+  for (i=0; i<16; i++)
+    w[i] = ((unsigned long)block[4*i] << 24) | ((unsigned long)block[4*i+1] << 16) |
+           ((unsigned long)block[4*i+2] << 8) | (unsigned long)block[4*i+3];
+  for (i=16; i<64; i++)
+    w[i] = (w[i-16] + (SHA256_ROTR(w[i-15], 7) ^ SHA256_ROTR(w[i-15], 18) ^ (w[i-15] >> 3)) +
+            w[i-7] + (SHA256_ROTR(w[i-2], 17) ^ SHA256_ROTR(w[i-2], 19) ^ (w[i-2] >> 10))) & 0xffffffffUL;
+
+  a = state[0]; b = state[1]; c = state[2]; d = state[3];
+  e = state[4]; f = state[5]; g = state[6]; h = state[7];
+  for (i=0; i<64; i++){
+    t1 = (h + (SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11) ^ SHA256_ROTR(e, 25)) +
+          ((e & f) ^ (~e & g)) + sha256K[i] + w[i]) & 0xffffffffUL;
+    t2 = ((SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13) ^ SHA256_ROTR(a, 22)) +
+          ((a & b) ^ (a & c) ^ (b & c))) & 0xffffffffUL;
+    h = g; g = f; f = e;
+    e = (d + t1) & 0xffffffffUL;
+    d = c; c = b; b = a;
+    a = (t1 + t2) & 0xffffffffUL;
+  }
+  state[0] = (state[0] + a) & 0xffffffffUL; state[1] = (state[1] + b) & 0xffffffffUL;
+  state[2] = (state[2] + c) & 0xffffffffUL; state[3] = (state[3] + d) & 0xffffffffUL;
+  state[4] = (state[4] + e) & 0xffffffffUL; state[5] = (state[5] + f) & 0xffffffffUL;
+  state[6] = (state[6] + g) & 0xffffffffUL; state[7] = (state[7] + h) & 0xffffffffUL;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// Get a key of the content of a file. The key is the SHA-256 digest 
+/// of the content followed by the size of the file. Files with a 
+/// different content get the same key only if they collide in SHA-256, 
+/// which is not feasible to find, accidentally or on purpose.
+///
+///\param filNam The name of the file
+///\param key The key, at least 82 characters
+///\return 0 if no error occurred
+/////////////////////////////////////////////////////////////////////////
+int hashFile(const char* filNam, char* key){
+  FILE *fil;
+  unsigned char buffer[4096];
+  unsigned char block[64];
+  unsigned long state[8] = {
+    0x6a09e667UL, 0xbb67ae85UL, 0x3c6ef372UL, 0xa54ff53aUL,
+    0x510e527fUL, 0x9b05688cUL, 0x1f83d9abUL, 0x5be0cd19UL
+  };
+  unsigned long long size = 0;
+  unsigned long long bits;
+  size_t i, n, used = 0;
+
+  fil = fopen(filNam, "rb");
+  if (fil == NULL){
+    printfError("Cannot open file \"%s\".\n", filNam);
+    return -1;
+  }
+  while ((n = fread(buffer, 1, sizeof(buffer), fil)) > 0){
+    for (i=0; i<n; i++){
+      block[used++] = buffer[i];
+      if (used == 64){
+        sha256Block(state, block);
+        used = 0;
+      }
+    }
+    size += n;
+  }
+  if (ferror(fil)){
+    printfError("Cannot read file \"%s\".\n", filNam);
+    fclose(fil);
+    return -1;
+  }
+  fclose(fil);
+
+  // padding: a one bit, zeros, and the length in bits
+  block[used++] = 0x80;
+  if (used > 56){
+    while (used < 64) block[used++] = 0;
+    sha256Block(state, block);
+    used = 0;
+  }
+  while (used < 56) block[used++] = 0;
+  bits = size * 8;
+  for (i=0; i<8; i++) block[56+i] = (unsigned char)(bits >> (56 - 8*i));
+  sha256Block(state, block);
+
+  for (i=0; i<8; i++) sprintf(key + 8*i, "%08lx", state[i]);
+  sprintf(key + 64, "-%llx", size);
+  return 0;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 /// Get temporary path
 ///
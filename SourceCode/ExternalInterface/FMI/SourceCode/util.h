@@ -28,6 +28,10 @@
 //static char* getfmuPat(const char* fmuFilNam);
 int delete(char* tmpPat);
 
+int copyFolder(const char* srcPat, const char* dstPat);
+
+int hashFile(const char* filNam, char* key);
+
 void doubleToCommaString(char* buffer, double r);
 
 char *getTmpPath(const char *nam, int length);
@@ -325,6 +325,111 @@ fmiValueReference getValueReference(void* scalarVariable) {
     return vr;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+/// Check if elements \c t1 and \c t2 have the same base type.
+/// \c Enumeration and \c Integer have the same base type while 
+/// \c Real, \c String, \c Boolean define own base types.
+///
+///\param t1 Element.
+///\param t2 Element.
+///\return 1 if they have the same type. Otherwise, 0.
+///////////////////////////////////////////////////////////////////////////////
+int sameBaseType(Elm t1, Elm t2){
+    return t1==t2 || 
+           t1==elm_Enumeration && t2==elm_Integer || 
+           t2==elm_Enumeration && t1==elm_Integer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Hash a variable name (FNV-1a).
+///
+///\param name Variable name.
+///\return Hash value.
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int hashName(const char* name) {
+    unsigned int h = 2166136261u;
+    for (; *name; name++) h = (h ^ (unsigned char)*name) * 16777619u;
+    return h;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Hash a value reference of a base type. 
+/// \c Enumeration and \c Integer hash to the same value.
+///
+///\param vr Value reference.
+///\param type Type of the variable.
+///\return Hash value.
+///////////////////////////////////////////////////////////////////////////////
+static unsigned int hashValueReference(fmiValueReference vr, Elm type) {
+    if (type == elm_Enumeration) type = elm_Integer;
+    return (vr ^ ((unsigned int)type << 24)) * 2654435761u;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Add a variable to the name index, unless a variable 
+/// with the same name is in the index already.
+///
+///\param md Model description.
+///\param i Position of the variable in modelVariables.
+///////////////////////////////////////////////////////////////////////////////
+static void addNameIndex(ModelDescription* md, int i) {
+    const char* name = getName(md->modelVariables[i]);
+    unsigned int k = hashName(name) & (md->indexSize - 1);
+    for (; md->nameIndex[k]; k = (k + 1) & (md->indexSize - 1))
+        if (!strcmp(getName(md->modelVariables[md->nameIndex[k] - 1]), name)) return;
+    md->nameIndex[k] = i + 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Add a variable to the value reference index, unless a variable 
+/// with the same value reference and base type is in the index already.
+///
+///\param md Model description.
+///\param i Position of the variable in modelVariables.
+///////////////////////////////////////////////////////////////////////////////
+static void addValueReferenceIndex(ModelDescription* md, int i) {
+    ScalarVariable* sv = md->modelVariables[i];
+    fmiValueReference vr = getValueReference(sv);
+    unsigned int k = hashValueReference(vr, sv->typeSpec->type) & (md->indexSize - 1);
+    for (; md->vrIndex[k]; k = (k + 1) & (md->indexSize - 1)) {
+        ScalarVariable* sv2 = md->modelVariables[md->vrIndex[k] - 1];
+        if (getValueReference(sv2) == vr && sameBaseType(sv->typeSpec->type, sv2->typeSpec->type)) return;
+    }
+    md->vrIndex[k] = i + 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Build the hash indexes of the model variables by name and by value reference, 
+/// so that getVariableByName() and getVariable() do not scan all variables.
+/// Names map to the first variable with that name. Value references map to 
+/// the first non-alias variable of that base type, or to the first alias 
+/// if all variables with that value reference are aliases.
+/// If memory cannot be allocated, the lookups fall back to a linear search.
+///
+///\param md Model description.
+///////////////////////////////////////////////////////////////////////////////
+static void buildVariableIndex(ModelDescription* md) {
+    int i, n;
+    if (!md->modelVariables) return;
+    for (n=0; md->modelVariables[n]; n++);
+    for (md->indexSize=16; md->indexSize < 2*n; md->indexSize*=2);
+    md->nameIndex = (int*)calloc(md->indexSize, sizeof(int));
+    md->vrIndex = (int*)calloc(md->indexSize, sizeof(int));
+    if (!md->nameIndex || !md->vrIndex) {
+        free(md->nameIndex);
+        free(md->vrIndex);
+        md->nameIndex = md->vrIndex = NULL;
+        md->indexSize = 0;
+        return;
+    }
+    for (i=0; i<n; i++) {
+        addNameIndex(md, i);
+        if (getAlias(md->modelVariables[i]) == enu_noAlias) addValueReferenceIndex(md, i);
+    }
+    for (i=0; i<n; i++)
+        if (getAlias(md->modelVariables[i]) != enu_noAlias) addValueReferenceIndex(md, i);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 /// Get the varible by its unique name. 
 ///
@@ -334,6 +439,14 @@ fmiValueReference getValueReference(void* scalarVariable) {
 ///////////////////////////////////////////////////////////////////////////////
 ScalarVariable* getVariableByName(ModelDescription* md, const char* name) {
     int i;
+    unsigned int k;
+    if (md->nameIndex) {
+        for (k = hashName(name) & (md->indexSize - 1); md->nameIndex[k]; k = (k + 1) & (md->indexSize - 1)) {
+            ScalarVariable* sv = md->modelVariables[md->nameIndex[k] - 1];
+            if (!strcmp(getName(sv), name)) return sv;
+        }
+        return NULL;
+    }
     if (md->modelVariables)
     for (i=0; md->modelVariables[i]; i++){
         ScalarVariable* sv = (ScalarVariable*)md->modelVariables[i];
@@ -342,32 +455,28 @@ ScalarVariable* getVariableByName(ModelDescription* md, const char* name) {
     return NULL;
 }
 
-///////////////////////////////////////////////////////////////////////////////
-/// Check if elements \c t1 and \c t2 have the same base type.
-/// \c Enumeration and \c Integer have the same base type while 
-/// \c Real, \c String, \c Boolean define own base types.
-///
-///\param t1 Element.
-///\param t2 Element.
-///\return 1 if they have the same type. Otherwise, 0.
-///////////////////////////////////////////////////////////////////////////////
-int sameBaseType(Elm t1, Elm t2){
-    return t1==t2 || 
-           t1==elm_Enumeration && t2==elm_Integer || 
-           t2==elm_Enumeration && t1==elm_Integer;
-}
-
 ///////////////////////////////////////////////////////////////////////////////
 /// Get scalar variable.
 ///
 ///\param md Model description.
 ///\param vr FMI value reference.
 ///\param type Element. 
-///\return NULL if variable not found or vr==fmiUndefinedValueReference
+///\return NULL if variable not found or vr==fmiUndefinedValueReference.
+///        A non-alias variable is returned in preference to its aliases.
 ///////////////////////////////////////////////////////////////////////////////
 ScalarVariable* getVariable(ModelDescription* md, fmiValueReference vr, Elm type){
     int i;
-    if (md->modelVariables && vr!=fmiUndefinedValueReference)
+    unsigned int k;
+    if (vr==fmiUndefinedValueReference) return NULL;
+    if (md->vrIndex) {
+        for (k = hashValueReference(vr, type) & (md->indexSize - 1); md->vrIndex[k]; k = (k + 1) & (md->indexSize - 1)) {
+            ScalarVariable* sv = md->modelVariables[md->vrIndex[k] - 1];
+            if (sameBaseType(type, sv->typeSpec->type) && getValueReference(sv) == vr) 
+                return sv;
+        }
+        return NULL;
+    }
+    if (md->modelVariables)
     for (i=0; md->modelVariables[i]; i++){
         ScalarVariable* sv = (ScalarVariable*)md->modelVariables[i];
         if (sameBaseType(type, sv->typeSpec->type) && getValueReference(sv) == vr) 
@@ -1168,6 +1277,8 @@ void freeElement(void* element){
             freeList((void **)md->vendorAnnotations);
             freeList((void **)md->modelVariables);
             freeList((void **)md->implementation); // added M. Wetter
+            free(md->nameIndex);
+            free(md->vrIndex);
             break;
     }
     // free the struct
@@ -1246,8 +1357,359 @@ ModelDescription* parse(const char* xmlPath) {
   md = stackPop(stack);
   assert(stackIsEmpty(stack));
   cleanup(file);
+  if (md) buildVariableIndex(md);
   //printElement(1, md); // Print the element for debugging
   return md; // Success if all refs are valid    
 }
 
 
+// Binary form of the AST written by writeModelDescription(). Integers and strings 
+// are written in the native format, since the file is only read on the machine 
+// that wrote it. The version must be increased when the format or the AST changes.
+#define MD_BIN_MAGIC   0x444d5045  // "EPMD"
+#define MD_BIN_VERSION 1
+
+static int writeNode(FILE* file, void* element);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write an integer to the binary form of the AST.
+///
+///\param file The file.
+///\param i The integer.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int writeInt(FILE* file, int i) {
+    return fwrite(&i, sizeof(int), 1, file) != 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write a string, that may be NULL, to the binary form of the AST.
+///
+///\param file The file.
+///\param s The string.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int writeString(FILE* file, const char* s) {
+    int n = s ? (int)strlen(s) : -1;
+    if (writeInt(file, n)) return 1;
+    return n > 0 && fwrite(s, sizeof(char), n, file) != (size_t)n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write a null-terminated list of elements, that may be NULL, 
+/// to the binary form of the AST.
+///
+///\param file The file.
+///\param list The list.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int writeList(FILE* file, void** list) {
+    int i, n = -1;
+    if (list) for (n=0; list[n]; n++);
+    if (writeInt(file, n)) return 1;
+    for (i=0; i<n; i++) 
+        if (writeNode(file, list[i])) return 1;
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write an element, that may be NULL, and its child nodes 
+/// to the binary form of the AST.
+/// Attribute names are written as index in attNames.
+///
+///\param file The file.
+///\param element The element.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+static int writeNode(FILE* file, void* element) {
+    int i, a;
+    Element* e = (Element*)element;
+    ModelDescription* md;
+    if (!e) return writeInt(file, -1);
+    if (writeInt(file, e->type) || writeInt(file, e->n)) return 1;
+    for (i=0; i<e->n; i+=2) {
+        a = checkAttribute(e->attributes[i]);
+        if (a == -1 || writeInt(file, a) || writeString(file, e->attributes[i+1])) return 1;
+    }
+    switch (getAstNodeType(e->type)) {
+        case astListElement:
+            return writeList(file, (void **)((ListElement*)e)->list);
+        case astScalarVariable:
+            return writeNode(file, ((ScalarVariable*)e)->typeSpec) 
+                || writeList(file, (void **)((ScalarVariable*)e)->directDependencies);
+        case astType:
+            return writeNode(file, ((Type*)e)->typeSpec);
+        case astModelDescription:
+            md = (ModelDescription*)e;
+            return writeList(file, (void **)md->unitDefinitions)
+                || writeList(file, (void **)md->typeDefinitions)
+                || writeNode(file, md->defaultExperiment)
+                || writeList(file, (void **)md->vendorAnnotations)
+                || writeList(file, (void **)md->modelVariables)
+                || writeList(file, (void **)md->implementation);
+        default:
+            return 0;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Write the AST in a binary form that readModelDescription() reads 
+/// without parsing the xml file again.
+///
+///\param md The model description.
+///\param binPath The file to be written.
+///\return 0 if no error occurred.
+///////////////////////////////////////////////////////////////////////////////
+int writeModelDescription(ModelDescription* md, const char* binPath) {
+    FILE *file;
+    int err;
+
+    file = fopen(binPath, "wb");
+    if (file == NULL) {
+        printfError("Cannot open file '%s'\n", binPath);
+        return 1;
+    }
+    err = writeInt(file, MD_BIN_MAGIC) || writeInt(file, MD_BIN_VERSION) || writeNode(file, md);
+    if (fclose(file)) err = 1;
+    if (err) {
+        printfError("Failed to write file '%s'\n", binPath);
+        remove(binPath);
+    }
+    return err;
+}
+
+// Reader of the binary form of the AST. All counts and indexes are checked 
+// against the size of the file, so that a damaged file cannot crash the reader.
+typedef struct {
+    const char* pos;
+    const char* end;
+    int error;
+} BinReader;
+
+static void* readNode(BinReader* r);
+static int isValidNode(Element* e);
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read an integer from the binary form of the AST.
+///
+///\param r The reader.
+///\return The integer, or -1 if the end of file is reached.
+///////////////////////////////////////////////////////////////////////////////
+static int readInt(BinReader* r) {
+    int i;
+    if (r->error || r->end - r->pos < (int)sizeof(int)) {
+        r->error = 1;
+        return -1;
+    }
+    memcpy(&i, r->pos, sizeof(int));
+    r->pos += sizeof(int);
+    return i;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read a string, that may be NULL, from the binary form of the AST.
+///
+///\param r The reader.
+///\return The string, allocated on the heap, or NULL.
+///////////////////////////////////////////////////////////////////////////////
+static char* readString(BinReader* r) {
+    char* s;
+    int n = readInt(r);
+    if (n < 0) {
+        if (n != -1) r->error = 1;
+        return NULL;
+    }
+    if (r->end - r->pos < n) {
+        r->error = 1;
+        return NULL;
+    }
+    s = (char*)malloc(n + 1);
+    if (!s) {
+        r->error = 1;
+        return NULL;
+    }
+    memcpy(s, r->pos, n);
+    s[n] = '\0';
+    r->pos += n;
+    return s;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read a null-terminated list of elements, that may be NULL, 
+/// from the binary form of the AST.
+///
+///\param r The reader.
+///\param ast The AST node type of the elements, or -1 for any type.
+///\return The list, or NULL.
+///////////////////////////////////////////////////////////////////////////////
+static void** readList(BinReader* r, int ast) {
+    int i;
+    void** list;
+    int n = readInt(r);
+    // each element takes at least one integer
+    if (n < 0 || r->end - r->pos < (long)n*(long)sizeof(int)) {
+        if (n != -1) r->error = 1;
+        return NULL;
+    }
+    list = (void**)calloc(n + 1, sizeof(void*));
+    if (!list) {
+        r->error = 1;
+        return NULL;
+    }
+    for (i=0; i<n && !r->error; i++) {
+        list[i] = readNode(r);
+        if (!list[i] || (ast != -1 && (int)getAstNodeType(((Element*)list[i])->type) != ast)) 
+            r->error = 1;
+    }
+    return list;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read an element, that may be NULL, and its child nodes 
+/// from the binary form of the AST.
+///
+///\param r The reader.
+///\return The element, or NULL. If r->error is set, 
+///        the parts that have been read are still linked into the element.
+///////////////////////////////////////////////////////////////////////////////
+static void* readNode(BinReader* r) {
+    int i, a, type, n, size;
+    Element* e;
+    ModelDescription* md;
+
+    type = readInt(r);
+    if (type == -1 || r->error) return NULL;
+    n = readInt(r);
+    if (type < 0 || type >= SIZEOF_ELM || n < 0 || n%2 || r->end - r->pos < (long)n*(long)sizeof(int)) {
+        r->error = 1;
+        return NULL;
+    }
+    switch (getAstNodeType((Elm)type)) {
+        case astListElement:      size = sizeof(ListElement); break;
+        case astType:             size = sizeof(Type); break;
+        case astScalarVariable:   size = sizeof(ScalarVariable); break;
+        case astModelDescription: size = sizeof(ModelDescription); break;
+        default:                  size = sizeof(Element); break;
+    }
+    e = (Element*)calloc(1, size);
+    if (!e) {
+        r->error = 1;
+        return NULL;
+    }
+    e->type = (Elm)type;
+    if (n > 0) {
+        e->attributes = (const char**)calloc(n, sizeof(char*));
+        if (!e->attributes) {
+            r->error = 1;
+            return e;
+        }
+    }
+    // n is increased as the attributes are read, so that freeElement() frees them
+    for (i=0; i<n && !r->error; i+=2) {
+        a = readInt(r);
+        if (a < 0 || a >= SIZEOF_ATT) {
+            r->error = 1;
+            break;
+        }
+        e->attributes[i] = attNames[a]; // no heap memory
+        e->attributes[i+1] = readString(r);
+        e->n = i+2;
+        if (!e->attributes[i+1]) r->error = 1;
+    }
+    if (r->error) return e;
+    switch (getAstNodeType(e->type)) {
+        case astListElement:
+            ((ListElement*)e)->list = (Element**)readList(r, -1);
+            break;
+        case astScalarVariable:
+            ((ScalarVariable*)e)->typeSpec = (Element*)readNode(r);
+            ((ScalarVariable*)e)->directDependencies = (Element**)readList(r, -1);
+            break;
+        case astType:
+            ((Type*)e)->typeSpec = (Element*)readNode(r);
+            break;
+        case astModelDescription:
+            md = (ModelDescription*)e;
+            md->unitDefinitions = (ListElement**)readList(r, astListElement);
+            md->typeDefinitions = (Type**)readList(r, astType);
+            md->defaultExperiment = (Element*)readNode(r);
+            md->vendorAnnotations = (ListElement**)readList(r, astListElement);
+            md->modelVariables = (ScalarVariable**)readList(r, astScalarVariable);
+            md->implementation = (ListElement**)readList(r, astListElement);
+            break;
+        default:
+            break;
+    }
+    if (!r->error && !isValidNode(e)) r->error = 1;
+    return e;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Check that an element read from the binary form has the parts 
+/// that parse() guarantees, and that the functions of this file rely on.
+///
+///\param e The element.
+///\return 1 if the element is valid.
+///////////////////////////////////////////////////////////////////////////////
+static int isValidNode(Element* e) {
+    ValueStatus vs;
+    Element* ts;
+    switch (getAstNodeType(e->type)) {
+        case astScalarVariable:
+            ts = ((ScalarVariable*)e)->typeSpec;
+            getUInt(e, att_valueReference, &vs);
+            return getString(e, att_name) && vs == valueDefined && ts 
+                && ts->type >= elm_Real && ts->type <= elm_Enumeration;
+        case astType:
+            return getString(e, att_name) && ((Type*)e)->typeSpec;
+        default:
+            return 1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// Read the AST from the binary form written by writeModelDescription(). 
+/// The receiver must call freeElement(md) to release AST memory.
+///
+///\param binPath The file to be read.
+///\return the root node md of the AST if no error occurred. NULL to indicate failure
+///////////////////////////////////////////////////////////////////////////////
+ModelDescription* readModelDescription(const char* binPath) {
+    FILE *file;
+    char* buffer;
+    long size;
+    BinReader r;
+    ModelDescription* md;
+
+    file = fopen(binPath, "rb");
+    if (file == NULL) return NULL;
+    if (fseek(file, 0, SEEK_END) || (size = ftell(file)) <= 0 || fseek(file, 0, SEEK_SET)) {
+        fclose(file);
+        return NULL;
+    }
+    buffer = (char*)malloc(size);
+    if (!buffer || fread(buffer, sizeof(char), size, file) != (size_t)size) {
+        free(buffer);
+        fclose(file);
+        return NULL;
+    }
+    fclose(file);
+
+    r.pos = buffer;
+    r.end = buffer + size;
+    r.error = 0;
+    if (readInt(&r) != MD_BIN_MAGIC || readInt(&r) != MD_BIN_VERSION) {
+        free(buffer);
+        return NULL;
+    }
+    md = (ModelDescription*)readNode(&r);
+    if (md && (md->type != elm_fmiModelDescription || r.pos != r.end)) r.error = 1;
+    free(buffer);
+    if (r.error) {
+        printfError("File '%s' is damaged\n", binPath);
+        if (md) freeElement(md);
+        return NULL;
+    }
+    if (md) buildVariableIndex(md);
+    return md;
+}
@@ -114,6 +114,9 @@ typedef struct {
     ListElement** vendorAnnotations;  // NULL or null-terminated list of Tools
     ScalarVariable** modelVariables;  // NULL or null-terminated list of ScalarVariable
     ListElement** implementation;     // Zuo: NULL or null-terminated list of CoSimulation_StandAlone 
+    int  indexSize;    // number of slots of the variable indexes below, a power of 2, or 0
+    int* nameIndex;    // NULL or hash index from name to 1 + position in modelVariables, 0 if empty 
+    int* vrIndex;      // NULL or hash index from value reference and base type to 1 + position in modelVariables
 } ModelDescription;
 
 // types of AST nodes used to represent an element
@@ -135,6 +138,8 @@ typedef enum {
 
 // Public methods: Parsing and low-level AST access
 ModelDescription* parse(const char* xmlPath);
+int writeModelDescription(ModelDescription* md, const char* binPath);
+ModelDescription* readModelDescription(const char* binPath);
 const char* getString(void* element, Att a);
 const char* getMyString(ModelDescription* element, Att a);
 double getDouble     (void* element, Att a, ValueStatus* vs);
@@ -195,6 +195,7 @@ SUBROUTINE InitSurfaceHeatBalance  ! Surface Heat Balance Initialization Manager
           !                      Added calls to alternative daylighting analysis using DElight
           !                      All modifications demarked with RJH (Rob Hitchcock)
           !                      RJH, Jul 2004: add error handling for DElight calls
+          !                      Oct 2026: DElight timestep call uses a zone handle and returns refpt illuminances
           !       RE-ENGINEERED  na
 
           ! PURPOSE OF THIS SUBROUTINE:
@@ -261,8 +262,6 @@ SUBROUTINE InitSurfaceHeatBalance  ! Surface Heat Balance Initialization Manager
   CHARACTER(len=210) cErrorLine     ! Each DElight Error line can be up to 210 characters long
   CHARACTER(len=200) cErrorMsg      ! Each DElight Error Message can be up to 200 characters long
   LOGICAL :: bEndofErrFile          ! End of Error File flag
-  INTEGER :: iDElightRefPt          ! Reference Point number for reading DElight Dump File (eplusout.delighteldmp)
-  REAL(r64) :: dRefPtIllum          ! tmp var for reading RefPt illuminance
   ! RJH DElight Modification End
   logical, save :: firsttime=.true.
   INTEGER :: MapNum
@@ -419,12 +418,20 @@ SUBROUTINE InitSurfaceHeatBalance  ! Surface Heat Balance Initialization Manager
         dCloudFraction = CloudFraction
         ! Init Error Flag to 0 (no Warnings or Errors)
         iErrorFlag = 0
-        CALL DElightElecLtgCtrl(LEN_TRIM(Zone(NZ)%Name), TRIM(Zone(NZ)%Name), dLatitude, &
+        ! Resolve the DElight zone handle once, then pass it on every timestep call;
+        ! refpt illuminances come back directly in DaylIllumAtRefPt
+        IF (ZoneDaylight(NZ)%DElightZoneIndex < 0) THEN
+          CALL DElightZoneIndex(LEN_TRIM(Zone(NZ)%Name), TRIM(Zone(NZ)%Name), &
+                                ZoneDaylight(NZ)%DElightZoneIndex, iErrorFlag)
+        ENDIF
+        IF (iErrorFlag == 0) THEN
+          CALL DElightElecLtgCtrlZone(ZoneDaylight(NZ)%DElightZoneIndex, dLatitude, &
                                 dHISKFFC, dHISUNFFC, dCloudFraction, &
                                 dSOLCOS1, dSOLCOS2, dSOLCOS3, &
-                                dPowerReducFac, iErrorFlag)
+                                dPowerReducFac, ZoneDaylight(NZ)%DaylIllumAtRefPt, &
+                                ZoneDaylight(NZ)%TotalDElightRefPts, iErrorFlag)
+        ENDIF
         ! Check Error Flag for Warnings or Errors returning from DElight
-        ! RJH 2008-03-07: If no warnings/errors then read refpt illuminances for standard output reporting
         IF (iErrorFlag .NE. 0) THEN
             ! Open DElight Electric Lighting Error File for reading
             iDElightErrorFile=GetNewUnitNumber()
@@ -471,41 +478,6 @@ SUBROUTINE InitSurfaceHeatBalance  ! Surface Heat Balance Initialization Manager
             IF (iErrorFlag .GT. 0) THEN
                 CALL ShowFatalError("End of DElight Error Messages")
             ENDIF
-        ELSE  ! RJH 2008-03-07: No errors
-              ! extract reference point illuminance values from DElight Electric Lighting dump file for reporting
-            ! Open DElight Electric Lighting Dump File for reading
-            iDElightErrorFile=GetNewUnitNumber()
-            Open (unit=iDElightErrorFile, file='eplusout.delighteldmp', action='READWRITE', IOSTAT=iwriteStatus)
-!            IF (iwriteStatus /= 0) THEN
-!              CALL ShowFatalError('InitSurfaceHeatBalance: Could not open file "eplusout.delighteldmp" for output (readwrite).')
-!            ENDIF
-            IF (iwriteStatus == 0) THEN
-              elOpened=.true.
-            ELSE
-              elOpened=.false.
-            ENDIF
-
-            ! Sequentially read lines in DElight Electric Lighting Dump File
-            ! and extract refpt illuminances for standard EPlus output handling
-            bEndofErrFile=.false.
-            iDElightRefPt = 0
-            ireadStatus=0
-            DO WHILE (.not. bEndofErrFile .and. iwriteStatus==0 .and. ireadStatus==0)
-                READ(iDElightErrorFile, * ,IOSTAT=iReadStatus) dRefPtIllum
-                IF (iReadStatus < GoodIOStatValue) THEN
-                    bEndofErrFile=.true.
-                    CYCLE
-                ENDIF
-                ! Increment refpt counter
-                iDElightRefPt = iDElightRefPt + 1
-                ! Assure refpt index does not exceed number of refpts in this zone
-                IF (iDElightRefPt <= ZoneDaylight(NZ)%TotalDElightRefPts) THEN
-                  ZoneDaylight(NZ)%DaylIllumAtRefPt(iDElightRefPt) = dRefPtIllum
-                ENDIF
-            ENDDO
-
-            ! Close DElight Electric Lighting Dump File and delete
-            IF (elOpened) Close (unit=iDElightErrorFile, status='DELETE')
         ENDIF
         ! Store the calculated total zone Power Reduction Factor due to DElight daylighting
         ! in the ZoneDaylight structure for later use